@@ -0,0 +1,803 @@
+﻿/**
+ *\file census.cpp
+ *\version 1.0
+ *\date October 2026
+ *\details Перепись объектов случайных водоёмов. Супа SOUP_SIZE x SOUP_SIZE помещается в центр
+ * поля CENSUS_FIELD x CENSUS_FIELD и вычисляется, пока количество живых клеток не станет
+ * периодичным. Корабли, долетевшие до края поля, снимаются с поля и учитываются сразу.
+ * Остаток делится на связные объекты, каждый объект вычисляется отдельно.
+ * Параметры запуска: soups=10000 seed=строка maxgen=20000 threads=0 out=census.txt
+ */
+
+#include "census.h"
+#include "options.h"
+#include "pool.h"
+#include "random.h"
+#include "rules.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iterator>
+#include <map>
+#include <unordered_map>
+
+using namespace std;
+
+/**Сторона случайной супы*/
+#define SOUP_SIZE 16
+/**Сторона поля, на котором вычисляется супа*/
+#define CENSUS_FIELD 256
+/**Ширина полосы у края поля, из которой снимаются корабли*/
+#define CENSUS_MARGIN 16
+/**Количество 64-битных слов в строке поля*/
+#define CENSUS_WORDS (CENSUS_FIELD / 64)
+/**Наибольший распознаваемый период; объединение фаз берётся за столько же поколений*/
+#define CENSUS_PERIOD 60
+/**Количество поколений, за которые проверяется, влияют ли части объекта друг на друга*/
+#define CENSUS_SPLIT 8
+
+/**Перепись: код объекта -> количество*/
+typedef unordered_map<string, long long> censusMap;
+
+/**
+ *\param g     водоём
+ *\param cells список живых клеток (строка, столбец)
+*/
+static void liveCells(const planeGrid& g, vector<pair<int, int>>& cells)
+{
+	cells.clear();
+	for (int i = 0; i < g.h; i++)
+	{
+		for (int k = 0; k < g.words; k++)
+		{
+			for (uint64_t v = g.plane[0][(size_t)i * g.words + k]; v; v &= v - 1)
+			{
+				cells.push_back({i, k * 64 + lowBit(v)});
+			}
+		}
+	}
+}
+
+/**
+ *\param a текущее поколение поля (CENSUS_FIELD строк по CENSUS_WORDS слов)
+ *\param b следующее поколение
+ *\details Шаг поля по правилу "Жизни". Строка, у которой пусты она сама и обе соседние,
+ * остаётся пустой и не вычисляется: супа занимает малую часть поля.
+*/
+static void stepField(const uint64_t* a, uint64_t* b)
+{
+	bool any[CENSUS_FIELD + 2] = {false};
+	for (int i = 0; i < CENSUS_FIELD; i++)
+	{
+		uint64_t v = 0;
+		for (int k = 0; k < CENSUS_WORDS; k++)
+		{
+			v |= a[i * CENSUS_WORDS + k];
+		}
+		any[i + 1] = v != 0;
+	}
+	static const uint64_t zero[CENSUS_WORDS] = {0};
+	for (int i = 0; i < CENSUS_FIELD; i++)
+	{
+		uint64_t* out = b + i * CENSUS_WORDS;
+		if (!any[i] && !any[i + 1] && !any[i + 2])
+		{
+			memset(out, 0, CENSUS_WORDS * sizeof(uint64_t));
+			continue;
+		}
+		const uint64_t* rows[3] =
+		{
+			i > 0 ? a + (i - 1) * CENSUS_WORDS : zero,
+			a + i * CENSUS_WORDS,
+			i + 1 < CENSUS_FIELD ? a + (i + 1) * CENSUS_WORDS : zero
+		};
+		for (int k = 0; k < CENSUS_WORDS; k++)
+		{
+			uint64_t sh[3][3];
+			for (int t = 0; t < 3; t++)
+			{
+				uint64_t c = rows[t][k];
+				uint64_t prev = k > 0 ? rows[t][k - 1] >> 63 : 0;
+				uint64_t next = k + 1 < CENSUS_WORDS ? rows[t][k + 1] & 1 : 0;
+				sh[t][0] = (c << 1) | prev;
+				sh[t][1] = c;
+				sh[t][2] = (c >> 1) | (next << 63);
+			}
+			out[k] = lifeWord(sh);
+		}
+	}
+}
+
+/**
+ *\param g водоём
+ *\return количество живых клеток
+*/
+static int population(const planeGrid& g)
+{
+	int n = 0;
+	for (uint64_t v : g.plane[0])
+	{
+		for (; v; v &= v - 1)
+		{
+			n++;
+		}
+	}
+	return n;
+}
+
+/**
+ *\param cells живые клетки
+ *\return фигура в ограничивающем прямоугольнике клеток
+*/
+shape normalize(const vector<pair<int, int>>& cells)
+{
+	shape s;
+	s.h = s.w = 0;
+	if (cells.empty())
+	{
+		return s;
+	}
+	int i0 = cells[0].first, i1 = i0, j0 = cells[0].second, j1 = j0;
+	for (const auto& c : cells)
+	{
+		i0 = min(i0, c.first);
+		i1 = max(i1, c.first);
+		j0 = min(j0, c.second);
+		j1 = max(j1, c.second);
+	}
+	s.h = i1 - i0 + 1;
+	s.w = j1 - j0 + 1;
+	s.cells.assign((size_t)s.h * s.w, 0);
+	for (const auto& c : cells)
+	{
+		s.cells[(size_t)(c.first - i0) * s.w + (c.second - j0)] = 1;
+	}
+	return s;
+}
+
+/**
+ *\param s исходная фигура
+ *\param t номер преобразования: бит 0 - отражение строк, бит 1 - отражение столбцов,
+ * бит 2 - транспонирование
+ *\return фигура после поворота или отражения
+*/
+static shape orient(const shape& s, int t)
+{
+	shape r;
+	r.h = (t & 4) ? s.w : s.h;
+	r.w = (t & 4) ? s.h : s.w;
+	r.cells.assign(s.cells.size(), 0);
+	for (int i = 0; i < s.h; i++)
+	{
+		for (int j = 0; j < s.w; j++)
+		{
+			int y = (t & 1) ? s.h - 1 - i : i;
+			int x = (t & 2) ? s.w - 1 - j : j;
+			if (t & 4)
+			{
+				swap(y, x);
+			}
+			r.cells[(size_t)y * r.w + x] = s.cells[(size_t)i * s.w + j];
+		}
+	}
+	return r;
+}
+
+/**
+ *\param s фигура
+ *\return запись фигуры в расширенном формате Векслера: полосы по 5 строк, столбец полосы -
+ * цифра 0-9a-v, полосы разделяются 'z', серии нулей сокращаются буквами w, x и y
+ * (после y - длина серии минус 4 цифрой 0-9a-z, как в apgcode)
+*/
+string wechsler(const shape& s)
+{
+	static const char digits[] = "0123456789abcdefghijklmnopqrstuv";
+	/**длины серий нулей после y: 4..39*/
+	static const char runs[] = "0123456789abcdefghijklmnopqrstuvwxyz";
+	string out;
+	for (int strip = 0; strip * 5 < s.h; strip++)
+	{
+		if (strip)
+		{
+			out += 'z';
+		}
+		string col;
+		for (int j = 0; j < s.w; j++)
+		{
+			int v = 0;
+			for (int r = 0; r < 5 && strip * 5 + r < s.h; r++)
+			{
+				v |= s.cells[(size_t)(strip * 5 + r) * s.w + j] << r;
+			}
+			col += digits[v];
+		}
+		while (!col.empty() && col.back() == '0')
+		{
+			col.pop_back();
+		}
+		/**сокращение серий нулей внутри полосы*/
+		for (size_t k = 0; k < col.size();)
+		{
+			size_t n = 0;
+			while (k + n < col.size() && col[k + n] == '0' && n < 39)
+			{
+				n++;
+			}
+			if (n == 0)
+			{
+				out += col[k++];
+				continue;
+			}
+			if (n == 1)
+			{
+				out += '0';
+			}
+			else if (n == 2)
+			{
+				out += 'w';
+			}
+			else if (n == 3)
+			{
+				out += 'x';
+			}
+			else
+			{
+				out += 'y';
+				out += runs[n - 4];
+			}
+			k += n;
+		}
+	}
+	return out;
+}
+
+/**
+ *\param s         фигура (одна фаза объекта)
+ *\param maxPeriod наибольший проверяемый период
+ *\return класс объекта
+ *\details Объект вычисляется отдельно на поле с запасом для движения. Период - первое поколение,
+ * в котором фигура совпадает с исходной с точностью до сдвига. Канонический код - кратчайшая,
+ * а при равной длине наименьшая запись Векслера среди всех фаз и восьми поворотов и отражений.
+*/
+objectClass classify(const shape& s, int maxPeriod)
+{
+	objectClass res;
+	res.period = 0;
+	res.dy = res.dx = 0;
+	res.code = "UNKNOWN";
+	int pad = maxPeriod / 2 + 2;
+	rule life;
+	parseRule("B3/S23", life);
+	planeGrid g, g1;
+	planeInit(g, s.h + 2 * pad, s.w + 2 * pad, 1);
+	planeInit(g1, g.h, g.w, 1);
+	for (int i = 0; i < s.h; i++)
+	{
+		for (int j = 0; j < s.w; j++)
+		{
+			if (s.cells[(size_t)i * s.w + j])
+			{
+				planeSet(g, i + pad, j + pad, 1);
+			}
+		}
+	}
+	vector<shape> phases(1, s);
+	vector<pair<int, int>> cells;
+	for (int gen = 1; gen <= maxPeriod; gen++)
+	{
+		nextGenerationRule(g, g1, life);
+		liveCells(g, cells);
+		if (cells.empty())
+		{
+			return res;
+		}
+		shape t = normalize(cells);
+		if (t.h == s.h && t.w == s.w && t.cells == s.cells)
+		{
+			int i0 = cells[0].first, j0 = cells[0].second;
+			for (const auto& c : cells)
+			{
+				i0 = min(i0, c.first);
+				j0 = min(j0, c.second);
+			}
+			res.period = gen;
+			res.dy = i0 - pad;
+			res.dx = j0 - pad;
+			break;
+		}
+		phases.push_back(t);
+	}
+	if (res.period == 0)
+	{
+		return res;
+	}
+	string best;
+	for (const shape& p : phases)
+	{
+		for (int t = 0; t < 8; t++)
+		{
+			string w = wechsler(orient(p, t));
+			if (best.empty() || w.size() < best.size() || (w.size() == best.size() && w < best))
+			{
+				best = w;
+			}
+		}
+	}
+	int pop = 0;
+	for (unsigned char c : s.cells)
+	{
+		pop += c;
+	}
+	if (res.dx || res.dy)
+	{
+		res.code = "xq" + to_string(res.period) + "_" + best;
+	}
+	else if (res.period > 1)
+	{
+		res.code = "xp" + to_string(res.period) + "_" + best;
+	}
+	else
+	{
+		res.code = "xs" + to_string(pop) + "_" + best;
+	}
+	return res;
+}
+
+/**
+ *\param g     водоём
+ *\param live  маска клеток, по которой ищутся компоненты (слова как в plane[0])
+ *\param seen  отметки уже просмотренных клеток
+ *\param i, j  начальная клетка
+ *\param dist  наибольшее расстояние между соседними клетками одной компоненты
+ *\param comp  клетки найденной компоненты
+ *\details Обход в ширину по клеткам маски; клетки, удалённые не более чем на dist
+ * по каждой координате, принадлежат одной компоненте.
+*/
+static void component(const planeGrid& g, const uint64_t* live, vector<unsigned char>& seen,
+	int i, int j, int dist, vector<pair<int, int>>& comp)
+{
+	comp.clear();
+	comp.push_back({i, j});
+	seen[(size_t)i * g.w + j] = 1;
+	for (size_t q = 0; q < comp.size(); q++)
+	{
+		int y = comp[q].first, x = comp[q].second;
+		for (int a = max(0, y - dist); a <= min(g.h - 1, y + dist); a++)
+		{
+			for (int b = max(0, x - dist); b <= min(g.w - 1, x + dist); b++)
+			{
+				if (!seen[(size_t)a * g.w + b] && ((live[(size_t)a * g.words + b / 64] >> (b % 64)) & 1))
+				{
+					seen[(size_t)a * g.w + b] = 1;
+					comp.push_back({a, b});
+				}
+			}
+		}
+	}
+}
+
+/**
+ *\param cells живые клетки
+ *\param gens  количество поколений
+ *\return живые клетки через gens поколений в тех же координатах, по строкам
+ *\details Клетки вычисляются отдельно на поле с запасом для роста
+*/
+static vector<pair<int, int>> evolve(const vector<pair<int, int>>& cells, int gens)
+{
+	vector<pair<int, int>> out;
+	if (cells.empty())
+	{
+		return out;
+	}
+	int i0 = cells[0].first, i1 = i0, j0 = cells[0].second, j1 = j0;
+	for (const auto& c : cells)
+	{
+		i0 = min(i0, c.first);
+		i1 = max(i1, c.first);
+		j0 = min(j0, c.second);
+		j1 = max(j1, c.second);
+	}
+	int pad = gens + 1;
+	rule life;
+	parseRule("B3/S23", life);
+	planeGrid g, g1;
+	planeInit(g, i1 - i0 + 1 + 2 * pad, j1 - j0 + 1 + 2 * pad, 1);
+	planeInit(g1, g.h, g.w, 1);
+	for (const auto& c : cells)
+	{
+		planeSet(g, c.first - i0 + pad, c.second - j0 + pad, 1);
+	}
+	for (int gen = 0; gen < gens; gen++)
+	{
+		nextGenerationRule(g, g1, life);
+	}
+	liveCells(g, out);
+	for (auto& c : out)
+	{
+		c = {c.first + i0 - pad, c.second + j0 - pad};
+	}
+	return out;
+}
+
+/**
+ *\param comp    клетки компоненты (по строкам)
+ *\param classes классы объектов (по одному на объект)
+ *\return объекты компоненты
+ *\details Разделение объектов, как в apgsearch: компонента делится на части, связные по
+ * соседству клеток, затем объединяются части, которые за CENSUS_SPLIT поколений влияют друг
+ * на друга (вместе дают не то же, что по отдельности). Так корабли, летящие рядом,
+ * учитываются каждый сам по себе, а не связные по соседству части одного корабля остаются вместе.
+ * Если хотя бы один объект не распознан (искра корабля гаснет, ни на что не влияя, и остаток
+ * без неё уже не корабль), компонента учитывается целиком.
+*/
+static vector<vector<pair<int, int>>> splitObjects(const vector<pair<int, int>>& comp, vector<objectClass>& classes)
+{
+	classes.clear();
+	if (comp.empty())
+	{
+		return {};
+	}
+	vector<pair<int, int>> sorted = comp;
+	sort(sorted.begin(), sorted.end());
+	vector<int> part(sorted.size(), -1);
+	vector<vector<pair<int, int>>> parts;
+	for (size_t k = 0; k < sorted.size(); k++)
+	{
+		if (part[k] >= 0)
+		{
+			continue;
+		}
+		part[k] = (int)parts.size();
+		parts.push_back({sorted[k]});
+		for (size_t q = 0; q < parts.back().size(); q++)
+		{
+			pair<int, int> c = parts.back()[q];
+			for (int a = c.first - 1; a <= c.first + 1; a++)
+			{
+				for (int b = c.second - 1; b <= c.second + 1; b++)
+				{
+					auto it = lower_bound(sorted.begin(), sorted.end(), make_pair(a, b));
+					if (it != sorted.end() && *it == make_pair(a, b) && part[it - sorted.begin()] < 0)
+					{
+						part[it - sorted.begin()] = part[k];
+						parts.back().push_back(*it);
+					}
+				}
+			}
+		}
+	}
+	/**объединение взаимодействующих частей (номер старшей части группы)*/
+	vector<int> group(parts.size());
+	for (size_t a = 0; a < parts.size(); a++)
+	{
+		group[a] = (int)a;
+	}
+	auto root = [&](int a)
+	{
+		while (group[a] != a)
+		{
+			a = group[a] = group[group[a]];
+		}
+		return a;
+	};
+	vector<vector<pair<int, int>>> alone(parts.size());
+	for (size_t a = 0; a < parts.size() && parts.size() > 1; a++)
+	{
+		sort(parts[a].begin(), parts[a].end());
+		alone[a] = evolve(parts[a], CENSUS_SPLIT);
+	}
+	for (size_t a = 0; a < parts.size(); a++)
+	{
+		for (size_t b = a + 1; b < parts.size(); b++)
+		{
+			if (root((int)a) == root((int)b))
+			{
+				continue;
+			}
+			vector<pair<int, int>> both, apart;
+			merge(parts[a].begin(), parts[a].end(), parts[b].begin(), parts[b].end(), back_inserter(both));
+			set_union(alone[a].begin(), alone[a].end(), alone[b].begin(), alone[b].end(), back_inserter(apart));
+			if (evolve(both, CENSUS_SPLIT) != apart)
+			{
+				group[root((int)a)] = root((int)b);
+			}
+		}
+	}
+	vector<vector<pair<int, int>>> objects;
+	vector<int> index(parts.size(), -1);
+	for (size_t a = 0; a < parts.size(); a++)
+	{
+		int r = root((int)a);
+		if (index[r] < 0)
+		{
+			index[r] = (int)objects.size();
+			objects.emplace_back();
+		}
+		vector<pair<int, int>>& o = objects[index[r]];
+		o.insert(o.end(), parts[a].begin(), parts[a].end());
+	}
+	for (const auto& o : objects)
+	{
+		classes.push_back(classify(normalize(o), CENSUS_PERIOD));
+		if (objects.size() > 1 && classes.back().code == "UNKNOWN")
+		{
+			classes.assign(1, classify(normalize(comp), CENSUS_PERIOD));
+			return {comp};
+		}
+	}
+	return objects;
+}
+
+/**
+ *\param g      поле супы
+ *\param census перепись
+ *\details Снятие кораблей из полосы у края поля: пока корабль не долетел до края,
+ * он вычисляется отдельно, учитывается в переписи и стирается. Компонента у края сначала
+ * делится на независимые объекты (splitObjects), поэтому корабли, летящие рядом,
+ * учитываются по одному. Прочие объекты остаются.
+*/
+static void removeEscapees(planeGrid& g, censusMap& census)
+{
+	vector<pair<int, int>> cells, comp;
+	liveCells(g, cells);
+	vector<unsigned char> seen;
+	for (const auto& c : cells)
+	{
+		bool edge = c.first < CENSUS_MARGIN || c.first >= g.h - CENSUS_MARGIN ||
+			c.second < CENSUS_MARGIN || c.second >= g.w - CENSUS_MARGIN;
+		if (!edge)
+		{
+			continue;
+		}
+		if (seen.empty())
+		{
+			seen.assign((size_t)g.h * g.w, 0);
+		}
+		if (seen[(size_t)c.first * g.w + c.second])
+		{
+			continue;
+		}
+		component(g, g.plane[0].data(), seen, c.first, c.second, 2, comp);
+		vector<objectClass> classes;
+		vector<vector<pair<int, int>>> objects = splitObjects(comp, classes);
+		for (size_t k = 0; k < objects.size(); k++)
+		{
+			if (classes[k].dx || classes[k].dy)
+			{
+				census[classes[k].code]++;
+				for (const auto& p : objects[k])
+				{
+					planeSet(g, p.first, p.second, 0);
+				}
+			}
+		}
+	}
+}
+
+/**
+ *\param pop количество живых клеток по поколениям
+ *\return наименьший период, с которым повторяется конец последовательности, или 0
+*/
+static int populationPeriod(const vector<int>& pop)
+{
+	int n = (int)pop.size();
+	for (int p = 1; p <= CENSUS_PERIOD; p++)
+	{
+		int window = max(3 * p, 24);
+		if (n < window + p)
+		{
+			return 0;
+		}
+		int k = n - window;
+		while (k < n && pop[k] == pop[k - p])
+		{
+			k++;
+		}
+		if (k == n)
+		{
+			return p;
+		}
+	}
+	return 0;
+}
+
+/**
+ *\param seed   начальное значение генератора супы
+ *\param maxGen наибольшее количество поколений до установления
+ *\param census перепись потока
+ *\details Вычисление одной супы до установления и учёт её объектов. Объекты - связные
+ * компоненты объединения фаз за CENSUS_PERIOD поколений, поэтому части одного осциллятора
+ * или корабля попадают в одну компоненту; клетки компоненты затем делятся на независимые
+ * объекты (splitObjects). Не установившаяся супа учитывается как PATHOLOGICAL.
+*/
+static void runSoup(uint64_t seed, int maxGen, censusMap& census)
+{
+	planeGrid g, g1;
+	planeInit(g, CENSUS_FIELD, CENSUS_FIELD, 1);
+	planeInit(g1, CENSUS_FIELD, CENSUS_FIELD, 1);
+	uint64_t s = seed;
+	int at = (CENSUS_FIELD - SOUP_SIZE) / 2;
+	for (int i = 0; i < SOUP_SIZE; i++)
+	{
+		uint64_t row = splitmix64(s);
+		for (int j = 0; j < SOUP_SIZE; j++)
+		{
+			if ((row >> j) & 1)
+			{
+				planeSet(g, at + i, at + j, 1);
+			}
+		}
+	}
+	vector<int> pop(1, population(g));
+	int period = 0;
+	for (int gen = 1; gen <= maxGen && period == 0; gen++)
+	{
+		stepField(g.plane[0].data(), g1.plane[0].data());
+		g.plane[0].swap(g1.plane[0]);
+		if (gen % 16 == 0)
+		{
+			removeEscapees(g, census);
+		}
+		pop.push_back(population(g));
+		period = populationPeriod(pop);
+	}
+	if (period == 0)
+	{
+		census["PATHOLOGICAL"]++;
+		return;
+	}
+	/**объединение фаз; период по количеству клеток может быть меньше периодов объектов
+	(мигалки не меняют количество клеток), поэтому фазы берутся за CENSUS_PERIOD поколений*/
+	vector<uint64_t> hull(g.plane[0].size(), 0);
+	for (int k = 0; k < CENSUS_PERIOD; k++)
+	{
+		stepField(g.plane[0].data(), g1.plane[0].data());
+		g.plane[0].swap(g1.plane[0]);
+		for (size_t w = 0; w < hull.size(); w++)
+		{
+			hull[w] |= g.plane[0][w];
+		}
+	}
+	vector<pair<int, int>> cells, comp, phase;
+	vector<objectClass> classes;
+	liveCells(g, cells);
+	vector<unsigned char> seen((size_t)g.h * g.w, 0);
+	for (int i = 0; i < g.h; i++)
+	{
+		for (int k = 0; k < g.words; k++)
+		{
+			for (uint64_t v = hull[(size_t)i * g.words + k]; v; v &= v - 1)
+			{
+				int j = k * 64 + lowBit(v);
+				if (seen[(size_t)i * g.w + j])
+				{
+					continue;
+				}
+				component(g, hull.data(), seen, i, j, 1, comp);
+				phase.clear();
+				for (const auto& c : comp)
+				{
+					if (planeGet(g, c.first, c.second))
+					{
+						phase.push_back(c);
+					}
+				}
+				splitObjects(phase, classes);
+				for (const auto& oc : classes)
+				{
+					census[oc.code]++;
+				}
+			}
+		}
+	}
+}
+
+/**
+ *\param argc количество параметров
+ *\param argv параметры ключ=значение
+ *\return код завершения программы
+ *\details Запуск переписи. Супы раздаются потокам пула с перехватом работы; у каждого потока
+ * своя перепись, поэтому учёт объектов не требует блокировок. Переписи потоков
+ * сливаются после вычисления всех суп и записываются в файл по убыванию количества.
+*/
+int censusRun(int argc, char* argv[])
+{
+	long long soups = atoll(option(argc, argv, "soups", "10000").c_str());
+	string seed = option(argc, argv, "seed", "gameLife");
+	int maxGen = atoi(option(argc, argv, "maxgen", "20000").c_str());
+	int threads = atoi(option(argc, argv, "threads", "0").c_str());
+	string out = option(argc, argv, "out", "census.txt");
+	/**начальное значение генератора - хеш строки seed (FNV-1a)*/
+	uint64_t base = 0xcbf29ce484222325ull;
+	for (unsigned char c : seed)
+	{
+		base = (base ^ c) * 0x100000001b3ull;
+	}
+	auto t0 = chrono::steady_clock::now();
+	map<string, long long> total;
+	{
+		workPool pool(threads);
+		vector<censusMap> perThread((size_t)pool.size());
+		parallelFor(pool, soups, 4, [&](int64_t lo, int64_t hi)
+		{
+			censusMap& census = perThread[(size_t)workPool::current()];
+			for (int64_t u = lo; u < hi; u++)
+			{
+				uint64_t s = base + (uint64_t)u;
+				runSoup(splitmix64(s), maxGen, census);
+			}
+		});
+		for (const censusMap& c : perThread)
+		{
+			for (const auto& e : c)
+			{
+				total[e.first] += e.second;
+			}
+		}
+	}
+	double sec = chrono::duration<double>(chrono::steady_clock::now() - t0).count();
+	vector<pair<long long, string>> sorted;
+	long long objects = 0;
+	for (const auto& e : total)
+	{
+		sorted.push_back({-e.second, e.first});
+		objects += e.second;
+	}
+	sort(sorted.begin(), sorted.end());
+	printf("%lld soups, %.3f s, %.0f soups/s, %lld objects, %zu kinds\n", soups, sec, soups / sec,
+		objects, sorted.size());
+	for (size_t k = 0; k < sorted.size() && k < 10; k++)
+	{
+		printf("%-24s %lld\n", sorted[k].second.c_str(), -sorted[k].first);
+	}
+	FILE* f = fopen(out.c_str(), "w");
+	if (f == nullptr)
+	{
+		printf("cannot write %s\n", out.c_str());
+		return 1;
+	}
+	fprintf(f, "# rule B3/S23, soups %dx%d, seed %s, %lld soups\n", SOUP_SIZE, SOUP_SIZE, seed.c_str(), soups);
+	for (const auto& e : sorted)
+	{
+		fprintf(f, "%s %lld\n", e.second.c_str(), -e.first);
+	}
+	fclose(f);
+	return 0;
+}
+
+/**
+ *\return код завершения программы (0 - все коды совпали)
+ *\details Проверка кодов объектов: известные объекты и строки с длинными сериями нулей
+ * (серия из 36 и более нулей кодируется последними символами y-серии apgcode).
+*/
+int censusCheck()
+{
+	struct sample
+	{
+		const char* name;
+		vector<pair<int, int>> cells;
+		const char* code;
+		bool classified;
+	};
+	vector<sample> samples = {
+		{"block", {{0, 0}, {0, 1}, {1, 0}, {1, 1}}, "xs4_33", true},
+		{"blinker", {{0, 0}, {0, 1}, {0, 2}}, "xp2_7", true},
+		{"glider", {{0, 1}, {1, 2}, {2, 0}, {2, 1}, {2, 2}}, "xq4_153", true},
+		{"gap 36", {{0, 0}, {0, 37}}, "1yw1", false},
+		{"gap 39", {{0, 0}, {0, 40}}, "1yz1", false},
+		{"gap 40", {{0, 0}, {0, 41}}, "1yz01", false} };
+	int bad = 0;
+	for (const sample& t : samples)
+	{
+		shape sh = normalize(t.cells);
+		string code = t.classified ? classify(sh, CENSUS_PERIOD).code : wechsler(sh);
+		bool ok = code == t.code;
+		bad += !ok;
+		printf("%-8s %-10s %s\n", t.name, code.c_str(), ok ? "ok" : "MISMATCH");
+	}
+	printf(bad ? "census check failed\n" : "census check passed\n");
+	return bad ? 1 : 0;
+}
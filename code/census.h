@@ -0,0 +1,46 @@
+﻿/**
+ *\file census.h
+ *\version 1.0
+ *\date October 2026
+ *\details Перепись объектов случайных водоёмов (по образцу apgsearch). Случайная "супа"
+ * 16x16 вычисляется до установления, остаток разбивается на связные объекты, каждый объект
+ * классифицируется (устойчивый, осциллятор с периодом, корабль со смещением) и получает
+ * канонический код; коды собираются в перепись.
+ */
+
+#pragma once
+
+#include <string>
+#include <vector>
+
+/**
+ *\struct shape
+ *\details Фигура в ограничивающем прямоугольнике
+*/
+struct shape
+{
+	/**количество строк и столбцов*/
+	int h, w;
+	/**клетки по строкам (1 - живая)*/
+	std::vector<unsigned char> cells;
+};
+
+/**
+ *\struct objectClass
+ *\details Результат классификации объекта
+*/
+struct objectClass
+{
+	/**период (0 - не удалось определить)*/
+	int period;
+	/**смещение за период (у корабля не нулевое)*/
+	int dy, dx;
+	/**канонический код в стиле apgcode: xs - устойчивый, xp - осциллятор, xq - корабль*/
+	std::string code;
+};
+
+shape normalize(const std::vector<std::pair<int, int>>& cells);
+std::string wechsler(const shape& s);
+objectClass classify(const shape& s, int maxPeriod);
+int censusRun(int argc, char* argv[]);
+int censusCheck();
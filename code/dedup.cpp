@@ -0,0 +1,553 @@
+﻿/**
+ *\file dedup.cpp
+ *\version 1.0
+ *\date October 2026
+ *\details Водоём с общими неизменяемыми плитками и памятью шагов плиток
+ */
+
+#include "dedup.h"
+#include "edit.h"
+#include "library.h"
+#include "memtrack.h"
+#include "options.h"
+#include "profile.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+using namespace std;
+
+/**Номер плитки за границей водоёма*/
+#define DEDUP_NONE UINT32_MAX
+
+/**
+ *\param t плитка
+ *\return хеш содержимого плитки
+*/
+static uint64_t tileHash(const uint64_t* t)
+{
+	uint64_t h = 0x243f6a8885a308d3ull;
+	for (int r = 0; r < DEDUP_TILE; r++)
+	{
+		h = (h ^ t[r]) * 0x9e3779b97f4a7c15ull;
+		h ^= h >> 29;
+	}
+	return h;
+}
+
+/**
+ *\param g водоём
+ *\param t содержимое плитки
+ *\return номер плитки с таким содержимым; на плитку добавляется ссылка
+ *\details Плитка с таким же содержимым берётся из индекса, иначе копируется в новую.
+ * При совпадении хешей разных плиток новая плитка в индекс не попадает и остаётся необщей.
+*/
+static uint32_t intern(dedupGrid& g, const uint64_t* t)
+{
+	uint64_t h = tileHash(t);
+	auto it = g.index.find(h);
+	if (it != g.index.end() && memcmp(&g.data[(size_t)it->second * DEDUP_TILE], t, DEDUP_TILE * sizeof(uint64_t)) == 0)
+	{
+		g.refs[it->second]++;
+		return it->second;
+	}
+	uint32_t id;
+	if (!g.freeIds.empty())
+	{
+		id = g.freeIds.back();
+		g.freeIds.pop_back();
+	}
+	else
+	{
+		id = (uint32_t)g.refs.size();
+		g.data.resize(g.data.size() + DEDUP_TILE);
+		g.refs.push_back(0);
+		g.hash.push_back(0);
+		g.pop.push_back(0);
+	}
+	memcpy(&g.data[(size_t)id * DEDUP_TILE], t, DEDUP_TILE * sizeof(uint64_t));
+	uint32_t n = 0;
+	for (int r = 0; r < DEDUP_TILE; r++)
+	{
+		for (uint64_t v = t[r]; v != 0; v &= v - 1)
+		{
+			n++;
+		}
+	}
+	g.refs[id] = 1;
+	g.hash[id] = h;
+	g.pop[id] = n;
+	if (it == g.index.end())
+	{
+		g.index[h] = id;
+	}
+	return id;
+}
+
+/**
+ *\param g  водоём
+ *\param id номер плитки
+*/
+static void acquire(dedupGrid& g, uint32_t id)
+{
+	if (id != DEDUP_EMPTY && id != DEDUP_NONE)
+	{
+		g.refs[id]++;
+	}
+}
+
+/**
+ *\param g  водоём
+ *\param id номер плитки
+ *\details Снятие ссылки; плитка без ссылок освобождается. Пустая плитка не освобождается никогда.
+*/
+static void release(dedupGrid& g, uint32_t id)
+{
+	if (id == DEDUP_EMPTY || id == DEDUP_NONE || --g.refs[id] != 0)
+	{
+		return;
+	}
+	auto it = g.index.find(g.hash[id]);
+	if (it != g.index.end() && it->second == id)
+	{
+		g.index.erase(it);
+	}
+	g.freeIds.push_back(id);
+}
+
+/**
+ *\param g водоём
+ *\return примерный объём памяти шагов: узел таблицы - ключ, значение, хеш и указатель на следующий
+*/
+static uint64_t stepBytes(const dedupGrid& g)
+{
+	return g.steps.size() * (sizeof(dedupKey) + 2 * sizeof(uint32_t) + 2 * sizeof(void*));
+}
+
+/**
+ *\param g водоём
+ *\details Очистка памяти шагов со снятием ссылок её записей
+*/
+static void forgetSteps(dedupGrid& g)
+{
+	for (const auto& e : g.steps)
+	{
+		for (int k = 0; k < 9; k++)
+		{
+			release(g, e.first.id[k]);
+		}
+		release(g, e.second);
+	}
+	g.steps.clear();
+	memAccount(MEM_CACHE, g.cacheBytes, 0);
+}
+
+/**
+ *\param g водоём
+ *\param h количество строк
+ *\param w количество столбцов
+ *\return false, если размеры не положительны или таблица плиток слишком велика
+*/
+bool dedupInit(dedupGrid& g, int64_t h, int64_t w)
+{
+	if (h < 1 || w < 1)
+	{
+		return false;
+	}
+	int64_t tilesY = (h + DEDUP_TILE - 1) / DEDUP_TILE, tilesX = (w + DEDUP_TILE - 1) / DEDUP_TILE;
+	if (tilesY > (int64_t)UINT32_MAX / tilesX)
+	{
+		return false;
+	}
+	g.h = h;
+	g.w = w;
+	g.tilesY = tilesY;
+	g.tilesX = tilesX;
+	g.steps.clear();
+	memAccount(MEM_CACHE, g.cacheBytes, 0);
+	g.index.clear();
+	g.freeIds.clear();
+	g.data.assign(DEDUP_TILE, 0);
+	g.refs.assign(1, 1);
+	g.hash.assign(1, tileHash(g.data.data()));
+	g.pop.assign(1, 0);
+	g.index[g.hash[0]] = DEDUP_EMPTY;
+	g.ids.assign((size_t)(tilesY * tilesX), DEDUP_EMPTY);
+	g.nextIds.clear();
+	g.hits = 0;
+	g.misses = 0;
+	return true;
+}
+
+/**
+ *\param g водоём
+ *\details Все клетки становятся мёртвыми, память шагов очищается
+*/
+void dedupClear(dedupGrid& g)
+{
+	for (uint32_t& id : g.ids)
+	{
+		release(g, id);
+		id = DEDUP_EMPTY;
+	}
+	forgetSteps(g);
+}
+
+/**
+ *\param g  водоём
+ *\param ty строка плиток
+ *\param tx столбец плиток
+ *\return DEDUP_TILE слов плитки (только для чтения) или nullptr, если плитка за границей водоёма
+*/
+const uint64_t* dedupTile(const dedupGrid& g, int64_t ty, int64_t tx)
+{
+	if (ty < 0 || tx < 0 || ty >= g.tilesY || tx >= g.tilesX)
+	{
+		return nullptr;
+	}
+	return &g.data[(size_t)g.ids[(size_t)(ty * g.tilesX + tx)] * DEDUP_TILE];
+}
+
+/**
+ *\param g водоём
+ *\param i строка
+ *\param j столбец
+ *\return жива ли клетка (клетки за границей водоёма мертвы)
+*/
+bool dedupGet(const dedupGrid& g, int64_t i, int64_t j)
+{
+	if (i < 0 || i >= g.h || j < 0 || j >= g.w)
+	{
+		return false;
+	}
+	const uint64_t* t = dedupTile(g, i / DEDUP_TILE, j / DEDUP_TILE);
+	return (t[i % DEDUP_TILE] >> (j % DEDUP_TILE)) & 1;
+}
+
+/**
+ *\param g    водоём
+ *\param i    строка
+ *\param j    столбец
+ *\param live новое состояние клетки
+ *\details Общая плитка не меняется: изменённая копия получает свой номер (или номер
+ * такой же существующей плитки), а ссылка на прежнюю снимается
+*/
+void dedupSet(dedupGrid& g, int64_t i, int64_t j, bool live)
+{
+	if (i < 0 || i >= g.h || j < 0 || j >= g.w)
+	{
+		return;
+	}
+	size_t p = (size_t)((i / DEDUP_TILE) * g.tilesX + j / DEDUP_TILE);
+	uint64_t t[DEDUP_TILE];
+	memcpy(t, &g.data[(size_t)g.ids[p] * DEDUP_TILE], sizeof(t));
+	uint64_t bit = 1ull << (j % DEDUP_TILE), &word = t[i % DEDUP_TILE];
+	if (((word & bit) != 0) == live)
+	{
+		return;
+	}
+	word ^= bit;
+	uint32_t id = intern(g, t);
+	release(g, g.ids[p]);
+	g.ids[p] = id;
+}
+
+/**
+ *\param g водоём
+ *\return количество живых клеток
+*/
+int64_t dedupPopulation(const dedupGrid& g)
+{
+	int64_t n = 0;
+	for (uint32_t id : g.ids)
+	{
+		n += g.pop[id];
+	}
+	return n;
+}
+
+/**
+ *\param g водоём
+ *\return счётчики водоёма
+*/
+dedupStats dedupInfo(const dedupGrid& g)
+{
+	dedupStats s;
+	s.unique = g.refs.size() - g.freeIds.size();
+	s.tiles = g.ids.size();
+	s.cached = g.steps.size();
+	s.hits = g.hits;
+	s.misses = g.misses;
+	s.bytes = g.data.capacity() * sizeof(uint64_t) + (g.ids.capacity() + g.nextIds.capacity()) * sizeof(uint32_t)
+		+ stepBytes(g) + g.index.size() * (sizeof(uint64_t) + sizeof(uint32_t) + 2 * sizeof(void*));
+	return s;
+}
+
+/**
+ *\param g   водоём
+ *\param ty  строка плиток
+ *\param tx  столбец плиток
+ *\param nb  номера плитки и её соседей
+ *\param out плитка следующего поколения
+ *\details Вычисление плитки по правилу B3/S23 с окаймлением в одну клетку из соседних плиток.
+ * Соседи считаются побитовыми сумматорами сразу для 64 клеток строки.
+*/
+static void stepTile(const dedupGrid& g, int64_t ty, int64_t tx, const dedupKey& nb, uint64_t* out)
+{
+	const uint64_t* t[9];
+	for (int k = 0; k < 9; k++)
+	{
+		t[k] = nb.id[k] == DEDUP_NONE ? nullptr : &g.data[(size_t)nb.id[k] * DEDUP_TILE];
+	}
+	/**строки -1..DEDUP_TILE и биты столбцов -1 и DEDUP_TILE*/
+	uint64_t ext[DEDUP_TILE + 2], left[DEDUP_TILE + 2], right[DEDUP_TILE + 2];
+	for (int r = 0; r < DEDUP_TILE + 2; r++)
+	{
+		int dy = r == 0 ? 0 : (r == DEDUP_TILE + 1 ? 2 : 1);
+		int rr = r == 0 ? DEDUP_TILE - 1 : (r == DEDUP_TILE + 1 ? 0 : r - 1);
+		ext[r] = t[dy * 3 + 1] ? t[dy * 3 + 1][rr] : 0;
+		left[r] = t[dy * 3] ? t[dy * 3][rr] >> 63 : 0;
+		right[r] = t[dy * 3 + 2] ? t[dy * 3 + 2][rr] & 1 : 0;
+	}
+	int64_t first = tx * DEDUP_TILE;
+	uint64_t mask = first + 64 <= g.w ? ~0ull : (1ull << (g.w - first)) - 1;
+	for (int r = 0; r < DEDUP_TILE; r++)
+	{
+		if (ty * DEDUP_TILE + r >= g.h)
+		{
+			out[r] = 0;
+			continue;
+		}
+		uint64_t sh[3][3];
+		for (int k = 0; k < 3; k++)
+		{
+			uint64_t a = ext[r + k];
+			sh[k][0] = (a << 1) | left[r + k];
+			sh[k][1] = a;
+			sh[k][2] = (a >> 1) | (right[r + k] << 63);
+		}
+		out[r] = lifeWord(sh) & mask;
+	}
+}
+
+/**
+ *\param g водоём
+ *\return isOpt флаг остановки цикла жизни
+ *\details Генерирование следующего поколения по правилу B3/S23. Для каждого места водоёма
+ * составляется ключ из номеров плитки и её соседей. Одинаковые ключи дают одинаковый результат,
+ * поэтому вычисляется только первая плитка с таким ключом, а остальные получают номер
+ * готовой плитки; пустая окрестность сразу даёт пустую плитку. Записи памяти шагов держат
+ * ссылки на свои плитки, поэтому шаги осцилляторов и устойчивых фигур переживают поколение.
+ * Память шагов очищается, когда в ней больше DEDUP_CACHE записей, когда удерживаемых ею
+ * плиток становится больше, чем мест в водоёме, или когда кэши вышли за бюджет памяти.
+*/
+bool nextGenerationDedup(dedupGrid& g)
+{
+	PROFILE_SCOPE("nextGenerationDedup");
+	g.nextIds.resize(g.ids.size());
+	bool isOpt = true;
+	uint64_t tile[DEDUP_TILE];
+	/**окрестность и результат предыдущего места: в решётке одинаковые окрестности идут подряд*/
+	dedupKey last;
+	uint32_t lastId = DEDUP_NONE;
+	for (int64_t ty = 0; ty < g.tilesY; ty++)
+	{
+		for (int64_t tx = 0; tx < g.tilesX; tx++)
+		{
+			dedupKey key;
+			bool empty = true;
+			for (int dy = -1; dy <= 1; dy++)
+			{
+				for (int dx = -1; dx <= 1; dx++)
+				{
+					int64_t y = ty + dy, x = tx + dx;
+					uint32_t id = y < 0 || x < 0 || y >= g.tilesY || x >= g.tilesX ? DEDUP_NONE : g.ids[(size_t)(y * g.tilesX + x)];
+					key.id[(dy + 1) * 3 + dx + 1] = id;
+					empty &= id == DEDUP_EMPTY || id == DEDUP_NONE;
+				}
+			}
+			size_t p = (size_t)(ty * g.tilesX + tx);
+			uint32_t id = DEDUP_EMPTY;
+			if (!empty && lastId != DEDUP_NONE && key == last)
+			{
+				id = lastId;
+				g.hits++;
+			}
+			else if (!empty)
+			{
+				auto it = g.steps.find(key);
+				if (it != g.steps.end())
+				{
+					id = it->second;
+					g.hits++;
+				}
+				else
+				{
+					stepTile(g, ty, tx, key, tile);
+					/**одна ссылка - у записи памяти шагов, вторая добавляется ниже для таблицы*/
+					id = intern(g, tile);
+					for (int k = 0; k < 9; k++)
+					{
+						acquire(g, key.id[k]);
+					}
+					g.steps.emplace(key, id);
+					g.misses++;
+				}
+				last = key;
+				lastId = id;
+			}
+			acquire(g, id);
+			g.nextIds[p] = id;
+			isOpt &= id == g.ids[p];
+		}
+	}
+	for (uint32_t id : g.ids)
+	{
+		release(g, id);
+	}
+	g.ids.swap(g.nextIds);
+	memAccount(MEM_CACHE, g.cacheBytes, stepBytes(g));
+	if (g.steps.size() > DEDUP_CACHE || g.refs.size() - g.freeIds.size() > 2 * g.ids.size() + 1 || memOver(MEM_CACHE))
+	{
+		forgetSteps(g);
+	}
+	return isOpt;
+}
+
+/**
+ *\param p водоём с битовыми плоскостями
+ *\param g водоём из общих плиток тех же размеров; живыми становятся клетки с ненулевым состоянием
+*/
+void dedupFromPlanes(const planeGrid& p, dedupGrid& g)
+{
+	dedupInit(g, p.h, p.w);
+	uint64_t t[DEDUP_TILE];
+	for (int64_t ty = 0; ty < g.tilesY; ty++)
+	{
+		for (int64_t tx = 0; tx < g.tilesX; tx++)
+		{
+			for (int r = 0; r < DEDUP_TILE; r++)
+			{
+				int64_t i = ty * DEDUP_TILE + r;
+				t[r] = 0;
+				for (int b = 0; b < p.bits && i < p.h; b++)
+				{
+					t[r] |= p.plane[b][(size_t)i * p.words + tx];
+				}
+			}
+			uint32_t id = intern(g, t);
+			release(g, g.ids[(size_t)(ty * g.tilesX + tx)]);
+			g.ids[(size_t)(ty * g.tilesX + tx)] = id;
+		}
+	}
+}
+
+/**
+ *\param g водоём из общих плиток (не больше INT_MAX клеток по каждой стороне)
+ *\param p водоём с одной плоскостью размером с g
+*/
+void dedupToPlanes(const dedupGrid& g, planeGrid& p)
+{
+	planeInit(p, (int)g.h, (int)g.w, 1);
+	for (int i = 0; i < p.h; i++)
+	{
+		for (int k = 0; k < p.words; k++)
+		{
+			p.plane[0][(size_t)i * p.words + k] = dedupTile(g, i / DEDUP_TILE, k)[i % DEDUP_TILE];
+		}
+	}
+}
+
+/**
+ *\param argc количество параметров
+ *\param argv параметры ключ=значение
+ *\return код завершения программы
+ *\details Вычисление поколений повторяющегося водоёма: фигура из библиотеки размещается
+ * решёткой с шагом spacing клеток, а в середине можно добавить случайный суп soup x soup.
+ * С check=1 те же поколения вычисляются обычным водоёмом и результаты сверяются.
+*/
+int dedupRun(int argc, char* argv[])
+{
+	int64_t rows = atoll(option(argc, argv, "rows", "16384").c_str());
+	int64_t cols = atoll(option(argc, argv, "cols", "16384").c_str());
+	long long gens = atoll(option(argc, argv, "gens", "1000").c_str());
+	int pattern = atoi(option(argc, argv, "pattern", "8").c_str());
+	int64_t spacing = atoll(option(argc, argv, "spacing", "64").c_str());
+	int64_t soup = atoll(option(argc, argv, "soup", "0").c_str());
+	bool check = atoi(option(argc, argv, "check", "0").c_str()) != 0;
+	dedupGrid g;
+	if (pattern < 0 || pattern >= LIBRARY_SIZE || spacing < 1 || !dedupInit(g, rows, cols))
+	{
+		printf("bad board size, pattern or spacing\n");
+		return 1;
+	}
+	editCommand c = editPlace(library[pattern], 0, false, 0, 0);
+	for (int64_t i0 = 0; i0 + c.i1 <= rows; i0 += spacing)
+	{
+		for (int64_t j0 = 0; j0 + c.j1 <= cols; j0 += spacing)
+		{
+			for (int64_t i = 0; i < c.i1; i++)
+			{
+				for (int64_t j = 0; j < c.j1; j++)
+				{
+					if ((c.bits[(size_t)i * c.words + (size_t)j / 64] >> (j % 64)) & 1)
+					{
+						dedupSet(g, i0 + i, j0 + j, true);
+					}
+				}
+			}
+		}
+	}
+	uint64_t s = 0x9e3779b97f4a7c15ull;
+	for (int64_t i = (rows - soup) / 2; i < (rows + soup) / 2; i++)
+	{
+		for (int64_t j = (cols - soup) / 2; j < (cols + soup) / 2; j++)
+		{
+			s ^= s << 13;
+			s ^= s >> 7;
+			s ^= s << 17;
+			dedupSet(g, i, j, (s & 1) != 0);
+		}
+	}
+	planeGrid a, b;
+	rule life;
+	if (check)
+	{
+		dedupToPlanes(g, a);
+		planeInit(b, (int)rows, (int)cols, 1);
+		parseRule("B3/S23", life);
+	}
+	int64_t start = dedupPopulation(g);
+	auto t0 = chrono::steady_clock::now();
+	long long gen = 0;
+	while (gen < gens && !nextGenerationDedup(g))
+	{
+		gen++;
+	}
+	double sec = chrono::duration<double>(chrono::steady_clock::now() - t0).count();
+	dedupStats st = dedupInfo(g);
+	printf("%lldx%lld, pattern %d every %lld cells: %lld gens%s, population %lld -> %lld, %.3f s\n",
+		(long long)rows, (long long)cols, pattern, (long long)spacing, gen,
+		gen < gens ? " (still life)" : "", (long long)start, (long long)dedupPopulation(g), sec);
+	printf("tiles %llu, unique %llu, cached steps %llu, hits %llu, misses %llu, %.1f MB (flat %.1f MB)\n",
+		(unsigned long long)st.tiles, (unsigned long long)st.unique, (unsigned long long)st.cached,
+		(unsigned long long)st.hits, (unsigned long long)st.misses, st.bytes / 1048576.0,
+		st.tiles * DEDUP_TILE * sizeof(uint64_t) / 1048576.0);
+	if (check)
+	{
+		auto t1 = chrono::steady_clock::now();
+		for (long long k = 0; k <= gen && k < gens; k++)
+		{
+			nextGenerationRule(a, b, life);
+		}
+		double flat = chrono::duration<double>(chrono::steady_clock::now() - t1).count();
+		planeGrid d;
+		dedupToPlanes(g, d);
+		bool same = d.plane[0] == a.plane[0];
+		printf("flat board %.3f s, %s\n", flat, same ? "same result" : "DIFFERENT result");
+		return same ? 0 : 1;
+	}
+	return 0;
+}
@@ -0,0 +1,118 @@
+﻿/**
+ *\file dedup.h
+ *\version 1.0
+ *\date October 2026
+ *\details Водоём с общими плитками для повторяющихся полей. Водоём - плоская таблица номеров
+ * плиток DEDUP_TILE x DEDUP_TILE, а сами плитки хранятся по хешу содержимого: одинаковые
+ * плитки (пустая вода, повторяющиеся устойчивые фигуры и осцилляторы) занимают одну
+ * неизменяемую копию. Изменение клетки копирует плитку. Следующее поколение плитки зависит
+ * только от неё и восьми соседних, поэтому результат запоминается по номерам девяти плиток
+ * и повторно не вычисляется - ни в том же поколении, ни в следующих. Память шагов
+ * учитывается как кэш (MEM_CACHE) и очищается при превышении бюджета.
+ */
+
+#pragma once
+
+#include "rules.h"
+
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+/**Сторона плитки в клетках (одно слово на строку)*/
+#define DEDUP_TILE 64
+/**Номер пустой плитки; она существует всегда*/
+#define DEDUP_EMPTY 0
+/**Наибольшее количество запомненных шагов, после которого память шагов очищается*/
+#define DEDUP_CACHE (1 << 22)
+
+/**
+ *\struct dedupKey
+ *\details Номера плитки и её восьми соседей по строкам; за границей водоёма - UINT32_MAX
+*/
+struct dedupKey
+{
+	uint32_t id[9];
+
+	bool operator==(const dedupKey& o) const
+	{
+		for (int k = 0; k < 9; k++)
+		{
+			if (id[k] != o.id[k])
+			{
+				return false;
+			}
+		}
+		return true;
+	}
+};
+
+/**
+ *\struct dedupKeyHash
+ *\details Хеш номеров девяти плиток
+*/
+struct dedupKeyHash
+{
+	size_t operator()(const dedupKey& k) const
+	{
+		uint64_t h = 0x9e3779b97f4a7c15ull;
+		for (int t = 0; t < 9; t++)
+		{
+			h = (h ^ k.id[t]) * 0xff51afd7ed558ccdull;
+		}
+		return (size_t)(h ^ (h >> 32));
+	}
+};
+
+/**
+ *\struct dedupStats
+ *\details Счётчики водоёма
+*/
+struct dedupStats
+{
+	/**различных плиток, плиток в таблице, запомненных шагов*/
+	uint64_t unique, tiles, cached;
+	/**шагов плиток, взятых из памяти, и вычисленных*/
+	uint64_t hits, misses;
+	/**байт в плитках, таблице и памяти шагов*/
+	size_t bytes;
+};
+
+/**
+ *\struct dedupGrid
+ *\details Водоём из общих плиток
+*/
+struct dedupGrid
+{
+	/**количество строк и столбцов водоёма и плиток*/
+	int64_t h, w, tilesY, tilesX;
+	/**номер плитки для каждого места водоёма, по строкам плиток*/
+	std::vector<uint32_t> ids, nextIds;
+	/**содержимое плиток (DEDUP_TILE слов на плитку), количество ссылок из таблицы,
+	 хеш содержимого и количество живых клеток*/
+	std::vector<uint64_t> data;
+	std::vector<uint32_t> refs;
+	std::vector<uint64_t> hash;
+	std::vector<uint32_t> pop;
+	/**освобождённые номера плиток*/
+	std::vector<uint32_t> freeIds;
+	/**плитка по хешу содержимого*/
+	std::unordered_map<uint64_t, uint32_t> index;
+	/**следующее поколение плитки по номерам её окрестности*/
+	std::unordered_map<dedupKey, uint32_t, dedupKeyHash> steps;
+	uint64_t hits, misses;
+	/**объём памяти шагов, учтённый как кэш (MEM_CACHE)*/
+	uint64_t cacheBytes = 0;
+};
+
+bool dedupInit(dedupGrid& g, int64_t h, int64_t w);
+void dedupClear(dedupGrid& g);
+bool dedupGet(const dedupGrid& g, int64_t i, int64_t j);
+void dedupSet(dedupGrid& g, int64_t i, int64_t j, bool live);
+const uint64_t* dedupTile(const dedupGrid& g, int64_t ty, int64_t tx);
+int64_t dedupPopulation(const dedupGrid& g);
+dedupStats dedupInfo(const dedupGrid& g);
+bool nextGenerationDedup(dedupGrid& g);
+void dedupFromPlanes(const planeGrid& p, dedupGrid& g);
+void dedupToPlanes(const dedupGrid& g, planeGrid& p);
+int dedupRun(int argc, char* argv[]);
@@ -0,0 +1,865 @@
+﻿/**
+ *\file distributed.cpp
+ *\version 1.0
+ *\date October 2026
+ *\details Координатор и рабочие процессы распределённого вычисления поколений.
+ * Параметры задаются в виде ключ=значение:
+ * координатор: port=5000 grid=2x2 board=1000x1000 gens=1000 halo=4 density=0.3 seed=1
+ * transport=shm|tcp spawn=1 (spawn=1 - запустить рабочие процессы на этой машине);
+ * рабочий процесс: host=127.0.0.1 port=5000.
+ */
+
+#include "distributed.h"
+#include "options.h"
+#include "random.h"
+
+#include <cstdio>
+
+#ifdef _WIN32
+
+int distCoordinator(int, char*[])
+{
+	printf("distributed mode is not supported on Windows\n");
+	return 1;
+}
+
+int distWorker(int, char*[])
+{
+	printf("distributed mode is not supported on Windows\n");
+	return 1;
+}
+
+#else
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <poll.h>
+#include <pthread.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+using namespace std;
+
+/**
+ *\struct distConfig
+ *\details Параметры, которые координатор рассылает рабочим процессам
+*/
+struct distConfig
+{
+	/**номер рабочего процесса и их количество*/
+	int32_t id, workers;
+	/**размеры сетки областей*/
+	int32_t px, py;
+	/**размеры водоёма*/
+	int64_t rows, cols;
+	/**ширина окаймления (поколений между обменами)*/
+	int32_t halo;
+	/**1 - обмен через разделяемую память, 0 - через TCP*/
+	int32_t shm;
+	/**начальное значение генератора и порог живой клетки (доля от 2^32)*/
+	uint32_t seed, threshold;
+	/**наибольшие размеры области (для разметки разделяемой памяти)*/
+	int64_t maxRh, maxRw;
+	/**имя сегмента разделяемой памяти*/
+	char shmName[64];
+};
+
+/**
+ *\struct peerAddr
+ *\details Адрес, на котором рабочий процесс принимает соединения соседей
+*/
+struct peerAddr
+{
+	uint32_t ip;
+	uint32_t port;
+};
+
+/**
+ *\struct roundReport
+ *\details Итог шага рабочего процесса для координатора
+*/
+struct roundReport
+{
+	/**количество живых клеток области*/
+	int64_t population;
+	/**изменилась ли область за последнее поколение*/
+	int32_t changed;
+	int32_t pad;
+};
+
+/**
+ *\param fd  сокет
+ *\param p   данные
+ *\param len длина
+ *\return true, если все данные отправлены
+*/
+static bool sendAll(int fd, const void* p, size_t len)
+{
+	const char* c = (const char*)p;
+	while (len > 0)
+	{
+		ssize_t n = send(fd, c, len, MSG_NOSIGNAL);
+		if (n <= 0)
+		{
+			return false;
+		}
+		c += n;
+		len -= (size_t)n;
+	}
+	return true;
+}
+
+/**
+ *\param fd  сокет
+ *\param p   буфер
+ *\param len длина
+ *\return true, если все данные получены
+*/
+static bool recvAll(int fd, void* p, size_t len)
+{
+	char* c = (char*)p;
+	while (len > 0)
+	{
+		ssize_t n = recv(fd, c, len, 0);
+		if (n <= 0)
+		{
+			return false;
+		}
+		c += n;
+		len -= (size_t)n;
+	}
+	return true;
+}
+
+/**
+ *\param port порт (0 - выбрать свободный)
+ *\return слушающий сокет или -1
+*/
+static int listenOn(int port)
+{
+	int fd = socket(AF_INET, SOCK_STREAM, 0);
+	int one = 1;
+	setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+	sockaddr_in a;
+	memset(&a, 0, sizeof(a));
+	a.sin_family = AF_INET;
+	a.sin_addr.s_addr = htonl(INADDR_ANY);
+	a.sin_port = htons((uint16_t)port);
+	if (bind(fd, (sockaddr*)&a, sizeof(a)) != 0 || listen(fd, 64) != 0)
+	{
+		close(fd);
+		return -1;
+	}
+	return fd;
+}
+
+/**
+ *\param fd слушающий сокет
+ *\return номер порта сокета
+*/
+static int portOf(int fd)
+{
+	sockaddr_in a;
+	socklen_t len = sizeof(a);
+	getsockname(fd, (sockaddr*)&a, &len);
+	return ntohs(a.sin_port);
+}
+
+/**
+ *\param ip   адрес (в сетевом порядке байт)
+ *\param port порт
+ *\return подключённый сокет или -1
+*/
+static int connectTo(uint32_t ip, int port)
+{
+	int fd = socket(AF_INET, SOCK_STREAM, 0);
+	sockaddr_in a;
+	memset(&a, 0, sizeof(a));
+	a.sin_family = AF_INET;
+	a.sin_addr.s_addr = ip;
+	a.sin_port = htons((uint16_t)port);
+	/**координатор или сосед могут ещё не начать приём соединений*/
+	for (int attempt = 0; attempt < 100; attempt++)
+	{
+		if (connect(fd, (sockaddr*)&a, sizeof(a)) == 0)
+		{
+			int one = 1;
+			setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+			return fd;
+		}
+		close(fd);
+		fd = socket(AF_INET, SOCK_STREAM, 0);
+		usleep(50000);
+	}
+	close(fd);
+	return -1;
+}
+
+/**
+ *\param seed      начальное значение генератора
+ *\param i         строка клетки
+ *\param j         столбец клетки
+ *\param cols      количество столбцов водоёма
+ *\param threshold порог живой клетки
+ *\return начальное состояние клетки
+ *\details Начальное состояние зависит только от координат клетки, поэтому каждый процесс
+ * заполняет свою область сам, и результат не зависит от разбиения водоёма.
+*/
+static uint8_t initialCell(uint32_t seed, int64_t i, int64_t j, int64_t cols, uint32_t threshold)
+{
+	uint64_t s = (uint64_t)(i * cols + j) + ((uint64_t)seed << 40);
+	return (uint32_t)splitmix64(s) < threshold;
+}
+
+/**
+ *\struct region
+ *\details Область рабочего процесса вместе с окаймлением шириной k
+*/
+struct region
+{
+	/**глобальные границы области: строки [r0, r1), столбцы [c0, c1)*/
+	int64_t r0, r1, c0, c1;
+	/**размеры области, ширина окаймления и размеры с окаймлением*/
+	int rh, rw, k, H, W;
+	/**текущее и следующее поколение (по байту на клетку)*/
+	vector<uint8_t> a, b;
+};
+
+/**
+ *\param cfg параметры
+ *\param id  номер области
+ *\param r   заполняемая область
+ *\details Границы области id в сетке px x py и её начальное заполнение
+*/
+static void regionInit(const distConfig& cfg, int id, region& r)
+{
+	int wx = id % cfg.px, wy = id / cfg.px;
+	r.r0 = cfg.rows * wy / cfg.py;
+	r.r1 = cfg.rows * (wy + 1) / cfg.py;
+	r.c0 = cfg.cols * wx / cfg.px;
+	r.c1 = cfg.cols * (wx + 1) / cfg.px;
+	r.rh = (int)(r.r1 - r.r0);
+	r.rw = (int)(r.c1 - r.c0);
+	r.k = cfg.halo;
+	r.H = r.rh + 2 * r.k;
+	r.W = r.rw + 2 * r.k;
+	r.a.assign((size_t)r.H * r.W, 0);
+	r.b.assign((size_t)r.H * r.W, 0);
+	for (int i = 0; i < r.rh; i++)
+	{
+		for (int j = 0; j < r.rw; j++)
+		{
+			r.a[(size_t)(i + r.k) * r.W + j + r.k] = initialCell(cfg.seed, r.r0 + i, r.c0 + j, cfg.cols, cfg.threshold);
+		}
+	}
+}
+
+/**
+ *\param r     область
+ *\param cfg   параметры
+ *\param steps количество поколений (не больше ширины окаймления)
+ *\return true, если область изменилась за последнее поколение
+ *\details Вычисление нескольких поколений без обмена: на шаге t достоверна часть
+ * с отступом t от края окаймления, после k шагов - вся область.
+ * Клетки за границей водоёма остаются мёртвыми.
+*/
+static bool regionStep(region& r, const distConfig& cfg, int steps)
+{
+	bool changed = false;
+	/**столбцы массива, лежащие внутри водоёма*/
+	int cl = (int)max<int64_t>(0, r.k - r.c0), ch = (int)min<int64_t>(r.W, cfg.cols - r.c0 + r.k);
+	for (int t = 1; t <= steps; t++)
+	{
+		bool last = t == steps;
+		for (int i = t; i < r.H - t; i++)
+		{
+			uint8_t* out = &r.b[(size_t)i * r.W];
+			int64_t gi = r.r0 + i - r.k;
+			if (gi < 0 || gi >= cfg.rows)
+			{
+				memset(out, 0, r.W);
+				continue;
+			}
+			const uint8_t* up = &r.a[(size_t)(i - 1) * r.W];
+			const uint8_t* mid = up + r.W;
+			const uint8_t* dn = mid + r.W;
+			int j0 = max(t, cl), j1 = min(r.W - t, ch);
+			for (int j = t; j < j0; j++)
+			{
+				out[j] = 0;
+			}
+			for (int j = j0; j < j1; j++)
+			{
+				int n = up[j - 1] + up[j] + up[j + 1] + mid[j - 1] + mid[j + 1] + dn[j - 1] + dn[j] + dn[j + 1];
+				out[j] = n == 3 || (n == 2 && mid[j]);
+			}
+			for (int j = max(j1, t); j < r.W - t; j++)
+			{
+				out[j] = 0;
+			}
+			/**признак изменения по самой области за последнее поколение*/
+			if (last && !changed && i >= r.k && i < r.k + r.rh
+				&& memcmp(out + r.k, mid + r.k, r.rw) != 0)
+			{
+				changed = true;
+			}
+		}
+		r.a.swap(r.b);
+	}
+	return changed;
+}
+
+/**
+ *\param r области
+ *\return количество живых клеток области без окаймления
+*/
+static int64_t regionPopulation(const region& r)
+{
+	int64_t n = 0;
+	for (int i = r.k; i < r.k + r.rh; i++)
+	{
+		const uint8_t* row = &r.a[(size_t)i * r.W + r.k];
+		for (int j = 0; j < r.rw; j++)
+		{
+			n += row[j];
+		}
+	}
+	return n;
+}
+
+/**
+ *\param r    область
+ *\param i0   первая строка прямоугольника
+ *\param j0   первый столбец прямоугольника
+ *\param rows количество строк
+ *\param cols количество столбцов
+ *\param buf  буфер rows x cols
+ *\param pack true - копировать из области в буфер, false - из буфера в область
+*/
+static void copyRect(region& r, int i0, int j0, int rows, int cols, uint8_t* buf, bool pack)
+{
+	for (int i = 0; i < rows; i++)
+	{
+		uint8_t* p = &r.a[(size_t)(i0 + i) * r.W + j0];
+		if (pack)
+		{
+			memcpy(buf + (size_t)i * cols, p, cols);
+		}
+		else
+		{
+			memcpy(p, buf + (size_t)i * cols, cols);
+		}
+	}
+}
+
+/**Стороны области: слева, справа, сверху, снизу*/
+enum { SIDE_LEFT, SIDE_RIGHT, SIDE_UP, SIDE_DOWN };
+
+/**
+ *\param r    область
+ *\param side сторона
+ *\param out  true - отправляемая полоса самой области, false - принимаемое окаймление
+ *\param rect заполняемые строка, столбец, высота и ширина полосы
+ *\details Горизонтальные полосы (влево и вправо) имеют высоту области, вертикальные - полную
+ * ширину с окаймлением, поэтому после двух этапов обмена угловые клетки тоже заполнены.
+*/
+static void sideRect(const region& r, int side, bool out, int rect[4])
+{
+	int k = r.k;
+	switch (side)
+	{
+	case SIDE_LEFT:
+		rect[0] = k; rect[1] = out ? k : 0; rect[2] = r.rh; rect[3] = k;
+		break;
+	case SIDE_RIGHT:
+		rect[0] = k; rect[1] = out ? r.rw : r.rw + k; rect[2] = r.rh; rect[3] = k;
+		break;
+	case SIDE_UP:
+		rect[0] = out ? k : 0; rect[1] = 0; rect[2] = k; rect[3] = r.W;
+		break;
+	default:
+		rect[0] = out ? r.rh : r.rh + k; rect[1] = 0; rect[2] = k; rect[3] = r.W;
+		break;
+	}
+}
+
+/**
+ *\struct transfer
+ *\details Одновременная отправка и приём полосы через сокет соседа
+*/
+struct transfer
+{
+	int fd;
+	const uint8_t* out;
+	uint8_t* in;
+	size_t len, sent, got;
+};
+
+/**
+ *\param t массив обменов
+ *\return true, если все обмены завершены
+ *\details Обмен со всеми соседями сразу: отправка и приём идут параллельно через poll,
+ * поэтому большие полосы не приводят к взаимной блокировке процессов.
+*/
+static bool exchangeAll(vector<transfer>& t)
+{
+	while (true)
+	{
+		vector<pollfd> p;
+		vector<int> idx;
+		for (size_t n = 0; n < t.size(); n++)
+		{
+			short ev = 0;
+			if (t[n].sent < t[n].len)
+			{
+				ev |= POLLOUT;
+			}
+			if (t[n].got < t[n].len)
+			{
+				ev |= POLLIN;
+			}
+			if (ev)
+			{
+				pollfd q = {t[n].fd, ev, 0};
+				p.push_back(q);
+				idx.push_back((int)n);
+			}
+		}
+		if (p.empty())
+		{
+			return true;
+		}
+		if (poll(p.data(), p.size(), -1) < 0)
+		{
+			return false;
+		}
+		for (size_t n = 0; n < p.size(); n++)
+		{
+			transfer& x = t[idx[n]];
+			if (p[n].revents & (POLLERR | POLLHUP | POLLNVAL) && !(p[n].revents & POLLIN))
+			{
+				return false;
+			}
+			if (p[n].revents & POLLOUT)
+			{
+				ssize_t k = send(x.fd, x.out + x.sent, x.len - x.sent, MSG_DONTWAIT | MSG_NOSIGNAL);
+				if (k > 0)
+				{
+					x.sent += (size_t)k;
+				}
+			}
+			if (p[n].revents & POLLIN)
+			{
+				ssize_t k = recv(x.fd, x.in + x.got, x.len - x.got, MSG_DONTWAIT);
+				if (k == 0)
+				{
+					return false;
+				}
+				if (k > 0)
+				{
+					x.got += (size_t)k;
+				}
+			}
+		}
+	}
+}
+
+/**
+ *\struct shmLayout
+ *\details Разметка сегмента разделяемой памяти: барьер всех рабочих процессов,
+ * затем для каждого процесса четыре отправляемые полосы
+*/
+struct shmLayout
+{
+	size_t barrier, slot, horiz, vert, total;
+};
+
+/**
+ *\param cfg параметры
+ *\return разметка сегмента
+*/
+static shmLayout shmLayoutFor(const distConfig& cfg)
+{
+	shmLayout l;
+	l.barrier = 256;
+	l.horiz = (size_t)cfg.halo * cfg.maxRh;
+	l.vert = (size_t)cfg.halo * (cfg.maxRw + 2 * cfg.halo);
+	l.slot = (2 * l.horiz + 2 * l.vert + 63) / 64 * 64;
+	l.total = l.barrier + l.slot * cfg.workers;
+	return l;
+}
+
+/**
+ *\param base  начало сегмента
+ *\param l     разметка
+ *\param id    номер процесса
+ *\param side  сторона
+ *\return полоса, которую процесс id отправляет соседу с этой стороны
+*/
+static uint8_t* shmStrip(unsigned char* base, const shmLayout& l, int id, int side)
+{
+	unsigned char* s = base + l.barrier + l.slot * id;
+	size_t off[4] = {0, l.horiz, 2 * l.horiz, 2 * l.horiz + l.vert};
+	return s + off[side];
+}
+
+/**
+ *\param argc количество параметров
+ *\param argv параметры host=адрес port=порт
+ *\return код завершения процесса
+ *\details Рабочий процесс: получает от координатора свою область, на каждом шаге обменивается
+ * окаймлениями с соседями, вычисляет поколения и сообщает итог координатору.
+*/
+int distWorker(int argc, char* argv[])
+{
+	string host = option(argc, argv, "host", "127.0.0.1");
+	int port = atoi(option(argc, argv, "port", "5000").c_str());
+	/**сокет для соединений соседей (используется при обмене через TCP)*/
+	int lfd = listenOn(0);
+	int cfd = connectTo(inet_addr(host.c_str()), port);
+	if (cfd < 0 || lfd < 0)
+	{
+		printf("worker: cannot connect to %s:%d\n", host.c_str(), port);
+		return 1;
+	}
+	uint32_t myPort = (uint32_t)portOf(lfd);
+	distConfig cfg;
+	if (!sendAll(cfd, &myPort, sizeof(myPort)) || !recvAll(cfd, &cfg, sizeof(cfg)))
+	{
+		return 1;
+	}
+	vector<peerAddr> peers(cfg.workers);
+	if (!recvAll(cfd, peers.data(), peers.size() * sizeof(peerAddr)))
+	{
+		return 1;
+	}
+	region r;
+	regionInit(cfg, cfg.id, r);
+	int wx = cfg.id % cfg.px, wy = cfg.id / cfg.px;
+	int nb[4] = {wx > 0 ? cfg.id - 1 : -1, wx + 1 < cfg.px ? cfg.id + 1 : -1,
+		wy > 0 ? cfg.id - cfg.px : -1, wy + 1 < cfg.py ? cfg.id + cfg.px : -1};
+	/**сокеты соседей: соединение устанавливает процесс с меньшим номером*/
+	int nfd[4] = {-1, -1, -1, -1};
+	unsigned char* shm = nullptr;
+	shmLayout layout = shmLayoutFor(cfg);
+	if (cfg.shm)
+	{
+		int fd = shm_open(cfg.shmName, O_RDWR, 0600);
+		if (fd >= 0)
+		{
+			void* p = mmap(NULL, layout.total, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+			shm = p == MAP_FAILED ? nullptr : (unsigned char*)p;
+			close(fd);
+		}
+		if (shm == nullptr)
+		{
+			printf("worker %d: cannot attach %s\n", cfg.id, cfg.shmName);
+			return 1;
+		}
+	}
+	else
+	{
+		int waiting = 0;
+		for (int s = 0; s < 4; s++)
+		{
+			if (nb[s] > cfg.id)
+			{
+				nfd[s] = connectTo(peers[nb[s]].ip, (int)peers[nb[s]].port);
+				int32_t me = cfg.id;
+				if (nfd[s] < 0 || !sendAll(nfd[s], &me, sizeof(me)))
+				{
+					return 1;
+				}
+			}
+			else if (nb[s] >= 0)
+			{
+				waiting++;
+			}
+		}
+		while (waiting-- > 0)
+		{
+			int fd = accept(lfd, NULL, NULL);
+			int32_t who = -1;
+			if (fd < 0 || !recvAll(fd, &who, sizeof(who)))
+			{
+				return 1;
+			}
+			int one = 1;
+			setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+			for (int s = 0; s < 4; s++)
+			{
+				if (nb[s] == who)
+				{
+					nfd[s] = fd;
+				}
+			}
+		}
+	}
+	close(lfd);
+	vector<uint8_t> outBuf[4], inBuf[4];
+	for (int s = 0; s < 4; s++)
+	{
+		int rect[4];
+		sideRect(r, s, true, rect);
+		outBuf[s].resize((size_t)rect[2] * rect[3]);
+		inBuf[s].resize((size_t)rect[2] * rect[3]);
+	}
+	/**стороны, противоположные данной*/
+	const int opposite[4] = {SIDE_RIGHT, SIDE_LEFT, SIDE_DOWN, SIDE_UP};
+	pthread_barrier_t* barrier = shm ? (pthread_barrier_t*)shm : nullptr;
+	while (true)
+	{
+		int32_t steps = 0;
+		if (!recvAll(cfd, &steps, sizeof(steps)) || steps <= 0)
+		{
+			break;
+		}
+		/**обмен окаймлениями: сначала по горизонтали, затем по вертикали*/
+		for (int phase = 0; phase < 2; phase++)
+		{
+			int sides[2] = {phase == 0 ? SIDE_LEFT : SIDE_UP, phase == 0 ? SIDE_RIGHT : SIDE_DOWN};
+			for (int s : sides)
+			{
+				int rect[4];
+				sideRect(r, s, true, rect);
+				uint8_t* dst = shm ? shmStrip(shm, layout, cfg.id, s) : outBuf[s].data();
+				if (nb[s] >= 0)
+				{
+					copyRect(r, rect[0], rect[1], rect[2], rect[3], dst, true);
+				}
+			}
+			vector<transfer> t;
+			/**полосы записываются не раньше, чем все прочитали их на предыдущем этапе:
+			 *между двумя записями одного этапа каждый процесс проходит хотя бы один барьер
+			*/
+			if (shm)
+			{
+				pthread_barrier_wait(barrier);
+			}
+			else
+			{
+				for (int s : sides)
+				{
+					if (nb[s] >= 0)
+					{
+						transfer x = {nfd[s], outBuf[s].data(), inBuf[s].data(), outBuf[s].size(), 0, 0};
+						t.push_back(x);
+					}
+				}
+				if (!exchangeAll(t))
+				{
+					printf("worker %d: neighbour lost\n", cfg.id);
+					return 1;
+				}
+			}
+			for (int s : sides)
+			{
+				if (nb[s] < 0)
+				{
+					continue;
+				}
+				int rect[4];
+				sideRect(r, s, false, rect);
+				uint8_t* src = shm ? shmStrip(shm, layout, nb[s], opposite[s]) : inBuf[s].data();
+				copyRect(r, rect[0], rect[1], rect[2], rect[3], src, false);
+			}
+		}
+		roundReport rep;
+		memset(&rep, 0, sizeof(rep));
+		rep.changed = regionStep(r, cfg, steps);
+		rep.population = regionPopulation(r);
+		if (!sendAll(cfd, &rep, sizeof(rep)))
+		{
+			break;
+		}
+	}
+	for (int s = 0; s < 4; s++)
+	{
+		if (nfd[s] >= 0)
+		{
+			close(nfd[s]);
+		}
+	}
+	if (shm)
+	{
+		munmap(shm, layout.total);
+	}
+	close(cfd);
+	return 0;
+}
+
+/**
+ *\param argc количество параметров
+ *\param argv параметры ключ=значение
+ *\return код завершения процесса
+ *\details Координатор: принимает подключения рабочих процессов, раздаёт им области,
+ * задаёт шаги по k поколений и после каждого шага сводит количество живых клеток и
+ * признак изменений. Вычисление прекращается, когда ни одна область не изменилась.
+*/
+int distCoordinator(int argc, char* argv[])
+{
+	int port = atoi(option(argc, argv, "port", "5000").c_str());
+	int px = 2, py = 2;
+	sscanf(option(argc, argv, "grid", "2x2").c_str(), "%dx%d", &px, &py);
+	long long rows = 1000, cols = 1000;
+	sscanf(option(argc, argv, "board", "1000x1000").c_str(), "%lldx%lld", &rows, &cols);
+	long long gens = atoll(option(argc, argv, "gens", "1000").c_str());
+	distConfig cfg;
+	memset(&cfg, 0, sizeof(cfg));
+	cfg.px = px;
+	cfg.py = py;
+	cfg.workers = px * py;
+	cfg.rows = rows;
+	cfg.cols = cols;
+	cfg.halo = max(1, atoi(option(argc, argv, "halo", "1").c_str()));
+	cfg.shm = option(argc, argv, "transport", "shm") == "shm";
+	cfg.seed = (uint32_t)atoi(option(argc, argv, "seed", "1").c_str());
+	cfg.threshold = (uint32_t)(atof(option(argc, argv, "density", "0.3").c_str()) * 4294967295.0);
+	cfg.maxRh = (rows + py - 1) / py;
+	cfg.maxRw = (cols + px - 1) / px;
+	/**полоса окаймления не должна быть шире самой маленькой области*/
+	if (px < 1 || py < 1 || rows / py < cfg.halo || cols / px < cfg.halo)
+	{
+		printf("regions are smaller than the halo\n");
+		return 1;
+	}
+	int lfd = listenOn(port);
+	if (lfd < 0)
+	{
+		printf("cannot listen on port %d\n", port);
+		return 1;
+	}
+	port = portOf(lfd);
+	printf("coordinator on port %d, %d workers, board %lldx%lld, halo %d, %s\n", port, cfg.workers,
+		cols, rows, cfg.halo, cfg.shm ? "shared memory" : "tcp");
+	fflush(stdout);
+	vector<pid_t> children;
+	if (option(argc, argv, "spawn", "0") == "1")
+	{
+		for (int n = 0; n < cfg.workers; n++)
+		{
+			pid_t pid = fork();
+			if (pid == 0)
+			{
+				close(lfd);
+				string p = "port=" + to_string(port);
+				char hostArg[] = "host=127.0.0.1";
+				char* args[] = {hostArg, (char*)p.c_str()};
+				_exit(distWorker(2, args));
+			}
+			children.push_back(pid);
+		}
+	}
+	vector<int> fds(cfg.workers);
+	vector<peerAddr> peers(cfg.workers);
+	for (int n = 0; n < cfg.workers; n++)
+	{
+		sockaddr_in a;
+		socklen_t len = sizeof(a);
+		fds[n] = accept(lfd, (sockaddr*)&a, &len);
+		uint32_t wport = 0;
+		if (fds[n] < 0 || !recvAll(fds[n], &wport, sizeof(wport)))
+		{
+			printf("worker handshake failed\n");
+			return 1;
+		}
+		int one = 1;
+		setsockopt(fds[n], IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+		peers[n].ip = a.sin_addr.s_addr;
+		peers[n].port = wport;
+	}
+	close(lfd);
+	/**сегмент разделяемой памяти с барьером, общим для всех рабочих процессов*/
+	shmLayout layout = shmLayoutFor(cfg);
+	if (cfg.shm)
+	{
+		snprintf(cfg.shmName, sizeof(cfg.shmName), "/gamelife-%d", (int)getpid());
+		int fd = shm_open(cfg.shmName, O_RDWR | O_CREAT | O_TRUNC, 0600);
+		void* p = MAP_FAILED;
+		if (fd >= 0 && ftruncate(fd, (off_t)layout.total) == 0)
+		{
+			p = mmap(NULL, layout.total, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+		}
+		if (fd >= 0)
+		{
+			close(fd);
+		}
+		if (p == MAP_FAILED)
+		{
+			printf("cannot create shared memory %s\n", cfg.shmName);
+			return 1;
+		}
+		pthread_barrierattr_t attr;
+		pthread_barrierattr_init(&attr);
+		pthread_barrierattr_setpshared(&attr, PTHREAD_PROCESS_SHARED);
+		pthread_barrier_init((pthread_barrier_t*)p, &attr, (unsigned)cfg.workers);
+		pthread_barrierattr_destroy(&attr);
+		munmap(p, layout.total);
+	}
+	for (int n = 0; n < cfg.workers; n++)
+	{
+		cfg.id = n;
+		sendAll(fds[n], &cfg, sizeof(cfg));
+		sendAll(fds[n], peers.data(), peers.size() * sizeof(peerAddr));
+	}
+	auto t0 = chrono::steady_clock::now();
+	long long done = 0;
+	int64_t population = 0;
+	bool ok = true, changed = true;
+	while (done < gens && changed && ok)
+	{
+		int32_t steps = (int32_t)min<long long>(cfg.halo, gens - done);
+		for (int n = 0; n < cfg.workers; n++)
+		{
+			ok = sendAll(fds[n], &steps, sizeof(steps)) && ok;
+		}
+		/**свод итогов шага: сумма живых клеток и "что-нибудь изменилось"*/
+		population = 0;
+		changed = false;
+		for (int n = 0; n < cfg.workers && ok; n++)
+		{
+			roundReport rep;
+			ok = recvAll(fds[n], &rep, sizeof(rep));
+			population += rep.population;
+			changed = changed || rep.changed;
+		}
+		done += steps;
+	}
+	double sec = chrono::duration<double>(chrono::steady_clock::now() - t0).count();
+	int32_t stop = 0;
+	for (int n = 0; n < cfg.workers; n++)
+	{
+		sendAll(fds[n], &stop, sizeof(stop));
+		close(fds[n]);
+	}
+	for (pid_t pid : children)
+	{
+		waitpid(pid, NULL, 0);
+	}
+	if (cfg.shm)
+	{
+		shm_unlink(cfg.shmName);
+	}
+	if (!ok)
+	{
+		printf("a worker failed\n");
+		return 1;
+	}
+	printf("%lld generations%s, %.3f s, %.1f gens/s, %.0f cells/s, population %lld\n", done,
+		changed ? "" : " (stable)", sec, done / sec, (double)done * rows * cols / sec, (long long)population);
+	return 0;
+}
+
+#endif
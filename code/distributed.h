@@ -0,0 +1,17 @@
+﻿/**
+ *\file distributed.h
+ *\version 1.0
+ *\date October 2026
+ *\details Распределённое вычисление поколений несколькими процессами. Водоём делится на
+ * прямоугольные области по сетке px x py, каждая область принадлежит одному процессу.
+ * Процессы обмениваются окаймлениями шириной k клеток раз в k поколений через
+ * разделяемую память (на одной машине) или TCP (на разных машинах).
+ * Координатор собирает количество живых клеток и признак изменений, который в
+ * однопроцессной программе вычисляет nextGeneration (isOpt).
+ * Работает только в POSIX-системах.
+ */
+
+#pragma once
+
+int distCoordinator(int argc, char* argv[]);
+int distWorker(int argc, char* argv[]);
@@ -0,0 +1,401 @@
+﻿/**
+ *\file edit.cpp
+ *\version 1.0
+ *\date October 2026
+ *\details Команды правки и их выполнение над упакованными строками
+ */
+
+#include "edit.h"
+#include "random.h"
+
+#include <algorithm>
+#include <cstring>
+
+using namespace std;
+
+/**
+ *\param lo, hi столбцы lo..hi-1
+ *\param base   первый столбец слова
+ *\return маска битов этих столбцов в слове
+*/
+static uint64_t span(int64_t lo, int64_t hi, int64_t base)
+{
+	lo = max(lo, base);
+	hi = min(hi, base + 64);
+	if (lo >= hi)
+	{
+		return 0;
+	}
+	int64_t n = hi - lo;
+	return (n == 64 ? ~0ull : (1ull << n) - 1) << (lo - base);
+}
+
+/**
+ *\param row   строка фигуры
+ *\param words количество слов строки
+ *\param start первый столбец фигуры (может быть отрицательным)
+ *\return биты столбцов фигуры start..start+63, вне фигуры - нули
+*/
+static uint64_t patternWord(const uint64_t* row, int words, int64_t start)
+{
+	if (start <= -64 || start >= (int64_t)words * 64)
+	{
+		return 0;
+	}
+	int64_t k = start >= 0 ? start / 64 : -1;
+	int off = (int)(start - k * 64);
+	uint64_t lo = k >= 0 ? row[k] : 0;
+	uint64_t hi = k + 1 < words ? row[k + 1] : 0;
+	return off == 0 ? lo : (lo >> off) | (hi << (64 - off));
+}
+
+/**
+ *\param c     команда
+ *\param row   строка водоёма
+ *\param base  первый столбец слова
+ *\param width количество столбцов водоёма
+ *\param alive живые клетки слова
+ *\param touched биты слова, которые меняет команда
+ *\param value   новые значения этих битов
+ *\details Правка одного слова. Случайные биты зависят только от seed, строки и номера слова,
+ * поэтому заполнение одинаково для матрицы и для водоёма из плиток.
+*/
+static void wordEdit(const editCommand& c, int64_t row, int64_t base, int64_t width, uint64_t alive, uint64_t& touched, uint64_t& value)
+{
+	uint64_t valid = span(0, width, base);
+	if (c.kind == EDIT_PASTE)
+	{
+		value = patternWord(&c.bits[(size_t)(row - c.i0) * c.words], c.words, base - c.j0) & valid;
+		touched = value;
+		return;
+	}
+	touched = span(c.j0, c.j1, base) & valid;
+	if (c.kind == EDIT_SET)
+	{
+		value = touched;
+	}
+	else if (c.kind == EDIT_CLEAR)
+	{
+		value = 0;
+	}
+	else if (c.kind == EDIT_TOGGLE)
+	{
+		value = ~alive & touched;
+	}
+	else
+	{
+		unsigned p = (unsigned)(c.density * 256.0 + 0.5);
+		uint64_t s = c.seed ^ ((uint64_t)row * 0xd1b54a32d192ed03ull) ^ ((uint64_t)(base / 64) * 0x8cb92ba72f3d8dd7ull);
+		value = randomWord(s, p) & touched;
+	}
+}
+
+/**
+ *\param kind EDIT_SET или EDIT_CLEAR
+ *\param i0, j0 первая строка и первый столбец
+ *\param i1, j1 строка и столбец за прямоугольником
+ *\return команда заливки или стирания прямоугольника
+*/
+editCommand editRect(int kind, int64_t i0, int64_t j0, int64_t i1, int64_t j1)
+{
+	editCommand c;
+	c.kind = kind;
+	c.i0 = min(i0, i1);
+	c.i1 = max(i0, i1);
+	c.j0 = min(j0, j1);
+	c.j1 = max(j0, j1);
+	c.density = 0;
+	c.seed = 0;
+	c.words = 0;
+	return c;
+}
+
+/**
+ *\param i0, j0 первая строка и первый столбец
+ *\param i1, j1 строка и столбец за прямоугольником
+ *\param density доля живых клеток
+ *\param seed начальное значение генератора
+ *\return команда случайного заполнения прямоугольника
+*/
+editCommand editRandom(int64_t i0, int64_t j0, int64_t i1, int64_t j1, double density, uint64_t seed)
+{
+	editCommand c = editRect(EDIT_RANDOM, i0, j0, i1, j1);
+	c.density = min(1.0, max(0.0, density));
+	c.seed = seed;
+	return c;
+}
+
+/**
+ *\param p    колония из библиотеки
+ *\param rot  количество поворотов на 90 градусов по часовой стрелке
+ *\param flip отражение слева направо (до поворота)
+ *\param i0, j0 строка и столбец левого верхнего угла колонии
+ *\return команда вставки колонии
+*/
+editCommand editPlace(const libPattern& p, int rot, bool flip, int64_t i0, int64_t j0)
+{
+	int h = p.h, w = (int)strlen(p.rows[0]);
+	vector<pair<int, int>> cells;
+	for (int i = 0; i < h; i++)
+	{
+		for (int j = 0; j < w; j++)
+		{
+			if (p.rows[i][j] == 'O')
+			{
+				cells.push_back({i, flip ? w - 1 - j : j});
+			}
+		}
+	}
+	for (int r = 0; r < (rot & 3); r++)
+	{
+		for (auto& c : cells)
+		{
+			c = {c.second, h - 1 - c.first};
+		}
+		swap(h, w);
+	}
+	editCommand c = editRect(EDIT_PASTE, i0, j0, i0 + h, j0 + w);
+	c.words = (w + 63) / 64;
+	c.bits.assign((size_t)h * c.words, 0);
+	for (const auto& x : cells)
+	{
+		c.bits[(size_t)x.first * c.words + x.second / 64] |= 1ull << (x.second % 64);
+	}
+	return c;
+}
+
+/**
+ *\param p    колония из библиотеки
+ *\param rot  количество поворотов на 90 градусов по часовой стрелке
+ *\param flip отражение слева направо (до поворота)
+ *\param ci, cj клетка, в которую попадает центр колонии
+ *\return команда вставки колонии
+*/
+editCommand editPaste(const libPattern& p, int rot, bool flip, int64_t ci, int64_t cj)
+{
+	editCommand c = editPlace(p, rot, flip, 0, 0);
+	int64_t h = c.i1, w = c.j1;
+	c.i0 = ci - h / 2;
+	c.j0 = cj - w / 2;
+	c.i1 = c.i0 + h;
+	c.j1 = c.j0 + w;
+	return c;
+}
+
+/**
+ *\param kind EDIT_UNDO или EDIT_REDO
+ *\return команда отмены или повтора
+*/
+editCommand editAction(int kind)
+{
+	return editRect(kind, 0, 0, 0, 0);
+}
+
+/**
+ *\param q очередь
+ *\param c команда (при успехе перемещается в очередь)
+ *\return false, если очередь заполнена; пишущий поток не ждёт и повторяет позже
+*/
+bool editPush(editQueue& q, editCommand& c)
+{
+	uint64_t t = q.tail.load(memory_order_relaxed);
+	if (t - q.head.load(memory_order_acquire) == EDIT_QUEUE)
+	{
+		return false;
+	}
+	q.slot[t % EDIT_QUEUE] = move(c);
+	q.tail.store(t + 1, memory_order_release);
+	return true;
+}
+
+/**
+ *\param q очередь
+ *\param c прочитанная команда
+ *\return false, если очередь пуста
+*/
+bool editPop(editQueue& q, editCommand& c)
+{
+	uint64_t h = q.head.load(memory_order_relaxed);
+	if (h == q.tail.load(memory_order_acquire))
+	{
+		return false;
+	}
+	c = move(q.slot[h % EDIT_QUEUE]);
+	q.head.store(h + 1, memory_order_release);
+	return true;
+}
+
+/**
+ *\param j журнал
+ *\details Удаление всех записей журнала (например, при смене правила, когда слова
+ * водоёма меняют смысл)
+*/
+void journalClear(editJournal& j)
+{
+	j.undo.clear();
+	j.redo.clear();
+	j.size = 0;
+}
+
+/**
+ *\param j    журнал
+ *\param diff изменения выполненной команды
+ *\param overflow изменений больше, чем помещается в журнал
+ *\details Новая команда делает повтор отменённых невозможным; старые записи удаляются,
+ * пока журнал не уложится в j.limit слов
+*/
+static void journalAdd(editJournal& j, vector<editDiff>& diff, bool overflow)
+{
+	for (const vector<editDiff>& d : j.redo)
+	{
+		j.size -= d.size();
+	}
+	j.redo.clear();
+	if (overflow)
+	{
+		journalClear(j);
+		return;
+	}
+	if (diff.empty())
+	{
+		return;
+	}
+	j.size += diff.size();
+	j.undo.push_back(move(diff));
+	size_t drop = 0;
+	while (j.size > j.limit)
+	{
+		j.size -= j.undo[drop++].size();
+	}
+	j.undo.erase(j.undo.begin(), j.undo.begin() + drop);
+}
+
+/**
+ *\param j     журнал
+ *\param words наибольшее количество слов в записях (не больше EDIT_JOURNAL)
+ *\details Уменьшение журнала под бюджет памяти: сначала удаляются отменённые команды,
+ * затем самые старые выполненные
+*/
+void journalLimit(editJournal& j, size_t words)
+{
+	j.limit = min<size_t>(words, EDIT_JOURNAL);
+	if (j.size <= j.limit)
+	{
+		return;
+	}
+	for (const vector<editDiff>& d : j.redo)
+	{
+		j.size -= d.size();
+	}
+	j.redo.clear();
+	size_t drop = 0;
+	while (j.size > j.limit)
+	{
+		j.size -= j.undo[drop++].size();
+	}
+	j.undo.erase(j.undo.begin(), j.undo.begin() + drop);
+}
+
+/**
+ *\param c    команда
+ *\param h, w размеры водоёма
+ *\param bits количество битовых плоскостей
+ *\param word адрес слова k строки i плоскости b
+ *\param j    журнал отмены или nullptr
+ *\details Выполнение команды над строками, которые она затрагивает. Изменённые клетки
+ * получают состояние 0 или 1: бит плоскости 0 принимает новое значение, биты остальных
+ * плоскостей (угасание в многоцветных правилах) сбрасываются. Отмена возвращает изменённым
+ * битам прежние значения, повтор - значения после команды; остальные клетки, в том числе
+ * изменившиеся с тех пор в поколениях, не трогаются.
+*/
+template <class Word>
+static void execute(const editCommand& c, int64_t h, int64_t w, int bits, Word word, editJournal* j)
+{
+	if (c.kind == EDIT_UNDO || c.kind == EDIT_REDO)
+	{
+		if (j == nullptr)
+		{
+			return;
+		}
+		vector<vector<editDiff>>& from = c.kind == EDIT_UNDO ? j->undo : j->redo;
+		vector<vector<editDiff>>& to = c.kind == EDIT_UNDO ? j->redo : j->undo;
+		if (from.empty())
+		{
+			return;
+		}
+		for (const editDiff& d : from.back())
+		{
+			uint64_t* x = word(d.i, d.k, d.plane);
+			*x = (*x & ~d.mask) | (c.kind == EDIT_UNDO ? d.before : ~d.before & d.mask);
+		}
+		to.push_back(move(from.back()));
+		from.pop_back();
+		return;
+	}
+	vector<editDiff> diff;
+	bool overflow = false;
+	int64_t lo = max<int64_t>(0, c.j0), hi = min<int64_t>(w, c.j1);
+	for (int64_t i = max<int64_t>(0, c.i0); i < min<int64_t>(h, c.i1) && lo < hi; i++)
+	{
+		for (int64_t k = lo / 64; k <= (hi - 1) / 64; k++)
+		{
+			uint64_t* x[MAX_PLANES];
+			uint64_t alive = 0;
+			for (int b = 0; b < bits; b++)
+			{
+				x[b] = word(i, k, b);
+				alive = b == 0 ? *x[b] : alive & ~*x[b];
+			}
+			uint64_t touched, value;
+			wordEdit(c, i, k * 64, w, alive, touched, value);
+			for (int b = 0; b < bits; b++)
+			{
+				uint64_t old = *x[b];
+				*x[b] = (old & ~touched) | (b == 0 ? value : 0);
+				if (j != nullptr && old != *x[b])
+				{
+					if (diff.size() < j->limit)
+					{
+						diff.push_back({i, (int32_t)k, b, old ^ *x[b], old & (old ^ *x[b])});
+					}
+					else
+					{
+						overflow = true;
+					}
+				}
+			}
+		}
+	}
+	if (j != nullptr)
+	{
+		journalAdd(*j, diff, overflow);
+	}
+}
+
+/**
+ *\param g водоём с битовыми плоскостями
+ *\param c команда
+ *\param j журнал отмены или nullptr
+*/
+void editApply(planeGrid& g, const editCommand& c, editJournal* j)
+{
+	execute(c, g.h, g.w, g.bits, [&](int64_t i, int64_t k, int b)
+	{
+		return &g.plane[b][(size_t)i * g.words + k];
+	}, j);
+}
+
+/**
+ *\param g водоём из плиток
+ *\param c команда
+ *\param j журнал отмены или nullptr
+ *\details Выполнение команды над текущим поколением водоёма из плиток: слово k строки
+ * лежит в плитке k / TILE_WORDS
+*/
+void editApplyTiled(tiledGrid& g, const editCommand& c, editJournal* j)
+{
+	execute(c, g.h, g.w, 1, [&](int64_t i, int64_t k, int)
+	{
+		return tiledRow(g, i, k / TILE_WORDS) + k % TILE_WORDS;
+	}, j);
+}
@@ -0,0 +1,111 @@
+﻿/**
+ *\file edit.h
+ *\version 1.0
+ *\date October 2026
+ *\details Правка областей водоёма: заливка и стирание прямоугольника, случайное заполнение
+ * с заданной плотностью и вставка колонии из библиотеки с поворотом и отражением.
+ * Правка описывается командой и выполняется над упакованными строками целыми словами,
+ * поэтому заливка миллиона клеток занимает тысячи операций над словами.
+ * Команды передаются от окна к вычислению поколений через очередь без блокировок
+ * (один пишущий поток и один читающий) и выполняются между поколениями; выполненные
+ * команды записываются в журнал отмены как изменённые биты слов.
+ */
+
+#pragma once
+
+#include "library.h"
+#include "rules.h"
+#include "tiled.h"
+
+#include <atomic>
+#include <cstdint>
+#include <vector>
+
+/**Заливка прямоугольника живыми клетками*/
+#define EDIT_SET 0
+/**Стирание прямоугольника*/
+#define EDIT_CLEAR 1
+/**Случайное заполнение прямоугольника*/
+#define EDIT_RANDOM 2
+/**Вставка фигуры (живые клетки фигуры добавляются к водоёму)*/
+#define EDIT_PASTE 3
+/**Переключение клеток прямоугольника: живые становятся водой, остальные - живыми*/
+#define EDIT_TOGGLE 4
+/**Отмена последней выполненной команды*/
+#define EDIT_UNDO 5
+/**Повтор последней отменённой команды*/
+#define EDIT_REDO 6
+
+/**Количество мест в очереди команд (степень двойки)*/
+#define EDIT_QUEUE 256
+/**Наибольшее количество изменённых слов, хранимых в журнале отмены*/
+#define EDIT_JOURNAL (1 << 20)
+
+/**
+ *\struct editCommand
+ *\details Команда правки
+*/
+struct editCommand
+{
+	/**вид правки (EDIT_SET, EDIT_CLEAR, EDIT_RANDOM, EDIT_PASTE, EDIT_TOGGLE, EDIT_UNDO, EDIT_REDO)*/
+	int kind;
+	/**строки i0..i1-1 и столбцы j0..j1-1; у вставки - место фигуры*/
+	int64_t i0, j0, i1, j1;
+	/**доля живых клеток и начальное значение генератора случайного заполнения*/
+	double density;
+	uint64_t seed;
+	/**фигура вставки: i1 - i0 строк по words слов*/
+	int words;
+	std::vector<uint64_t> bits;
+};
+
+/**
+ *\struct editDiff
+ *\details Изменение одного слова: биты mask поменяли значение, before - их прежние значения
+*/
+struct editDiff
+{
+	int64_t i;
+	int32_t k, plane;
+	uint64_t mask, before;
+};
+
+/**
+ *\struct editJournal
+ *\details Журнал отмены: изменения выполненных и отменённых команд. Журнал принадлежит
+ * вычислению поколений и меняется только при выполнении команд.
+*/
+struct editJournal
+{
+	std::vector<std::vector<editDiff>> undo, redo;
+	/**количество слов во всех записях*/
+	size_t size = 0;
+	/**наибольшее количество слов в записях (не больше EDIT_JOURNAL)*/
+	size_t limit = EDIT_JOURNAL;
+};
+
+/**
+ *\struct editQueue
+ *\details Кольцо команд от окна к вычислению поколений. Окно пишет в хвост, вычисление
+ * читает из головы; каждый счётчик меняет только один поток, поэтому блокировки не нужны.
+*/
+struct editQueue
+{
+	editCommand slot[EDIT_QUEUE];
+	/**количество прочитанных команд (пишет читающий поток)*/
+	alignas(64) std::atomic<uint64_t> head{0};
+	/**количество записанных команд (пишет пишущий поток)*/
+	alignas(64) std::atomic<uint64_t> tail{0};
+};
+
+editCommand editRect(int kind, int64_t i0, int64_t j0, int64_t i1, int64_t j1);
+editCommand editRandom(int64_t i0, int64_t j0, int64_t i1, int64_t j1, double density, uint64_t seed);
+editCommand editPlace(const libPattern& p, int rot, bool flip, int64_t i0, int64_t j0);
+editCommand editPaste(const libPattern& p, int rot, bool flip, int64_t ci, int64_t cj);
+editCommand editAction(int kind);
+bool editPush(editQueue& q, editCommand& c);
+bool editPop(editQueue& q, editCommand& c);
+void editApply(planeGrid& g, const editCommand& c, editJournal* j = nullptr);
+void editApplyTiled(tiledGrid& g, const editCommand& c, editJournal* j = nullptr);
+void journalClear(editJournal& j);
+void journalLimit(editJournal& j, size_t words);
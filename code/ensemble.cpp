@@ -0,0 +1,197 @@
+﻿/**
+ *\file ensemble.cpp
+ *\version 1.0
+ *\date October 2026
+ *\details Вычисление ансамбля малых водоёмов. Водоём хранится по столбцам: слово - столбец,
+ * бит i - клетка строки i, поэтому столбец из 60 клеток занимает одно 64-битное слово.
+ * Параметры запуска: count=10000 density=0.5 seed=1 maxgen=10000 threads=0 out=файл.csv
+ */
+
+#include "ensemble.h"
+#include "options.h"
+#include "pool.h"
+#include "random.h"
+#include "rules.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+using namespace std;
+
+/**Маска существующих строк в слове столбца*/
+#define ENS_MASK ((1ull << ENS_ROWS) - 1)
+
+/**
+ *\param a текущее поколение (ENS_COLS слов)
+ *\param b следующее поколение
+ *\details Шаг водоёма по столбцам: соседи по строкам - сдвиги слова,
+ * соседи по столбцам - соседние слова; за границей клетки мёртвые.
+*/
+static void stepColumns(const uint64_t* a, uint64_t* b)
+{
+	for (int j = 0; j < ENS_COLS; j++)
+	{
+		uint64_t l = j > 0 ? a[j - 1] : 0, c = a[j], r = j + 1 < ENS_COLS ? a[j + 1] : 0;
+		/**столбцы слева направо играют роль строк, сдвиги слова - соседей по строкам*/
+		const uint64_t sh[3][3] = {{l << 1, l, l >> 1}, {c << 1, c, c >> 1}, {r << 1, r, r >> 1}};
+		b[j] = lifeWord(sh) & ENS_MASK;
+	}
+}
+
+/**
+ *\param a состояние водоёма
+ *\return хеш состояния
+*/
+static uint64_t hashColumns(const uint64_t* a)
+{
+	uint64_t h = 0x84222325cbf29ce4ull;
+	for (int j = 0; j < ENS_COLS; j++)
+	{
+		h = (h ^ a[j]) * 0x100000001b3ull;
+		h ^= h >> 29;
+	}
+	return h;
+}
+
+/**
+ *\param seed    начальное значение генератора
+ *\param density доля живых клеток начального заполнения
+ *\param maxGen  наибольшее количество поколений
+ *\param res     итог
+ *\details Вычисление одного водоёма. Последние ENS_HISTORY состояний хранятся в кольце;
+ * при совпадении нового состояния с состоянием p поколений назад водоём установился
+ * с периодом p (период 1 - устойчивое состояние или пустой водоём).
+*/
+void runUniverse(uint64_t seed, double density, int maxGen, universeResult& res)
+{
+	uint64_t hist[ENS_HISTORY][ENS_COLS];
+	uint64_t hashes[ENS_HISTORY];
+	unsigned p = (unsigned)(density * 256.0 + 0.5);
+	uint64_t s = seed;
+	for (int j = 0; j < ENS_COLS; j++)
+	{
+		hist[0][j] = randomWord(s, p) & ENS_MASK;
+	}
+	hashes[0] = hashColumns(hist[0]);
+	res.seed = seed;
+	res.settle = -1;
+	res.period = 0;
+	int gen = 0;
+	while (gen < maxGen && res.period == 0)
+	{
+		const uint64_t* cur = hist[gen % ENS_HISTORY];
+		gen++;
+		uint64_t* nxt = hist[gen % ENS_HISTORY];
+		/**новое состояние затирает самое старое в кольце, поэтому сравнение с ним делается до шага*/
+		uint64_t tmp[ENS_COLS];
+		stepColumns(cur, tmp);
+		uint64_t h = hashColumns(tmp);
+		for (int per = 1; per <= ENS_HISTORY && per <= gen; per++)
+		{
+			int k = (gen - per) % ENS_HISTORY;
+			if (hashes[k] == h && memcmp(hist[k], tmp, sizeof(tmp)) == 0)
+			{
+				res.period = per;
+				res.settle = gen - per;
+				break;
+			}
+		}
+		memcpy(nxt, tmp, sizeof(tmp));
+		hashes[gen % ENS_HISTORY] = h;
+	}
+	const uint64_t* last = hist[gen % ENS_HISTORY];
+	res.population = 0;
+	for (int j = 0; j < ENS_COLS; j++)
+	{
+		for (uint64_t v = last[j]; v; v &= v - 1)
+		{
+			res.population++;
+		}
+	}
+}
+
+/**
+ *\param argc количество параметров
+ *\param argv параметры ключ=значение
+ *\return код завершения программы
+ *\details Запуск ансамбля: вычисление всех водоёмов в пуле потоков, итоговая статистика
+ * и скорость в водоёмах в секунду, при необходимости - итоги каждого водоёма в CSV-файл.
+*/
+int ensembleRun(int argc, char* argv[])
+{
+	long long count = atoll(option(argc, argv, "count", "10000").c_str());
+	double density = atof(option(argc, argv, "density", "0.5").c_str());
+	uint64_t seed = strtoull(option(argc, argv, "seed", "1").c_str(), nullptr, 10);
+	int maxGen = atoi(option(argc, argv, "maxgen", "10000").c_str());
+	int threads = atoi(option(argc, argv, "threads", "0").c_str());
+	string out = option(argc, argv, "out", "");
+	vector<universeResult> res((size_t)count);
+	auto t0 = chrono::steady_clock::now();
+	{
+		workPool pool(threads);
+		parallelFor(pool, count, 16, [&](int64_t lo, int64_t hi)
+		{
+			for (int64_t u = lo; u < hi; u++)
+			{
+				uint64_t s = seed * 0x9e3779b97f4a7c15ull + (uint64_t)u;
+				runUniverse(splitmix64(s), density, maxGen, res[(size_t)u]);
+			}
+		});
+	}
+	double sec = chrono::duration<double>(chrono::steady_clock::now() - t0).count();
+	/**сводка: погибшие, устойчивые, периодические и не установившиеся водоёмы*/
+	long long died = 0, still = 0, osc = 0, open = 0, gens = 0;
+	long long byPeriod[ENS_HISTORY + 1] = {0};
+	for (const universeResult& r : res)
+	{
+		if (r.period == 0)
+		{
+			open++;
+			gens += maxGen;
+			continue;
+		}
+		gens += r.settle + r.period;
+		byPeriod[r.period]++;
+		if (r.population == 0)
+		{
+			died++;
+		}
+		else if (r.period == 1)
+		{
+			still++;
+		}
+		else
+		{
+			osc++;
+		}
+	}
+	printf("%lld universes %dx%d, %.3f s, %.0f universes/s, %.0f gens/s\n", count, ENS_COLS, ENS_ROWS,
+		sec, count / sec, gens / sec);
+	printf("died %lld, still %lld, oscillating %lld, unsettled %lld\n", died, still, osc, open);
+	for (int p = 2; p <= ENS_HISTORY; p++)
+	{
+		if (byPeriod[p])
+		{
+			printf("period %d: %lld\n", p, byPeriod[p]);
+		}
+	}
+	if (!out.empty())
+	{
+		FILE* f = fopen(out.c_str(), "w");
+		if (f == nullptr)
+		{
+			printf("cannot write %s\n", out.c_str());
+			return 1;
+		}
+		fprintf(f, "seed,population,settle,period\n");
+		for (const universeResult& r : res)
+		{
+			fprintf(f, "%llu,%d,%d,%d\n", (unsigned long long)r.seed, r.population, r.settle, r.period);
+		}
+		fclose(f);
+	}
+	return 0;
+}
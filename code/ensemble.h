@@ -0,0 +1,38 @@
+﻿/**
+ *\file ensemble.h
+ *\version 1.0
+ *\date October 2026
+ *\details Ансамбль из множества независимых малых водоёмов размером с основной (65x60).
+ * Водоёмы раздаются потокам пула с перехватом работы, каждый водоём вычисляется до гибели
+ * или установления периодического состояния независимо от остальных.
+ */
+
+#pragma once
+
+#include <cstdint>
+
+/**Количество столбцов и строк малого водоёма*/
+#define ENS_COLS 65
+#define ENS_ROWS 60
+/**Наибольший обнаруживаемый период (глубина истории состояний)*/
+#define ENS_HISTORY 64
+
+/**
+ *\struct universeResult
+ *\details Итог вычисления одного водоёма ансамбля
+*/
+struct universeResult
+{
+	/**начальное значение генератора водоёма*/
+	uint64_t seed;
+	/**количество живых клеток в конце*/
+	int32_t population;
+	/**поколение, с которого состояние повторяется (-1 - не установилось)*/
+	int32_t settle;
+	/**период повторения (0 - не установилось)*/
+	int32_t period;
+	int32_t pad;
+};
+
+void runUniverse(uint64_t seed, double density, int maxGen, universeResult& res);
+int ensembleRun(int argc, char* argv[]);
@@ -0,0 +1,218 @@
+﻿/**
+ *\file framebuf.cpp
+ *\version 1.0
+ *\date October 2026
+ *\details Раскрытие бит водоёма в точки RGBA: таблицы строк образцов, векторное копирование
+ * и потоковая запись строк буфера
+ */
+
+#include "framebuf.h"
+#include "profile.h"
+
+#include <algorithm>
+#include <cstring>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define FRAME_SSE2
+#include <emmintrin.h>
+#endif
+
+using namespace std;
+
+/**
+ *\param s внешний вид клеток (номера цветов палитры)
+ *\param f образцы клеток в точках RGBA
+ *\details Образцы переводятся из номеров цветов в точки; для двух состояний собираются
+ * строки образцов всех наборов из FRAME_GROUP клеток
+*/
+void frameStyleFrom(const cellStyle& s, frameStyle& f)
+{
+	f.cell = s.cell;
+	f.states = s.states;
+	f.tile.resize(s.tile.size());
+	for (size_t k = 0; k < s.tile.size(); k++)
+	{
+		const uint8_t* c = &s.rgb[s.tile[k] * 3];
+		f.tile[k] = (uint32_t)c[0] | ((uint32_t)c[1] << 8) | ((uint32_t)c[2] << 16) | 0xff000000u;
+	}
+	const int cell = f.cell;
+	f.same.resize(cell);
+	for (int v = 0; v < cell; v++)
+	{
+		f.same[v] = v;
+		for (int u = 0; u < v && f.same[v] == v; u++)
+		{
+			bool equal = true;
+			for (int st = 0; st < f.states && equal; st++)
+			{
+				const uint32_t* t = &f.tile[(size_t)st * cell * cell];
+				equal = memcmp(t + (size_t)u * cell, t + (size_t)v * cell, cell * sizeof(uint32_t)) == 0;
+			}
+			if (equal)
+			{
+				f.same[v] = u;
+			}
+		}
+	}
+	f.group.clear();
+	if (f.states != 2)
+	{
+		return;
+	}
+	const int span = FRAME_GROUP * cell;
+	f.group.resize((size_t)cell * (1 << FRAME_GROUP) * span);
+	for (int v = 0; v < cell; v++)
+	{
+		for (int bits = 0; bits < (1 << FRAME_GROUP); bits++)
+		{
+			uint32_t* out = &f.group[((size_t)v * (1 << FRAME_GROUP) + bits) * span];
+			for (int c = 0; c < FRAME_GROUP; c++)
+			{
+				memcpy(out + c * cell, &f.tile[((size_t)((bits >> c) & 1) * cell + v) * cell], cell * sizeof(uint32_t));
+			}
+		}
+	}
+}
+
+/**
+ *\param dst куда
+ *\param src откуда
+ *\param n   количество точек
+ *\details Копирование точек по четыре за команду
+*/
+static inline void copySpan(uint32_t* dst, const uint32_t* src, int n)
+{
+	int k = 0;
+#ifdef FRAME_SSE2
+	for (; k + 4 <= n; k += 4)
+	{
+		_mm_storeu_si128((__m128i*)(dst + k), _mm_loadu_si128((const __m128i*)(src + k)));
+	}
+#endif
+	for (; k < n; k++)
+	{
+		dst[k] = src[k];
+	}
+}
+
+/**
+ *\param dst строка буфера
+ *\param src готовая строка точек
+ *\param n   количество точек
+ *\details Запись строки в буфер в обход кэша: буфер только пишется и затем передаётся
+ * текстуре, поэтому чтение его строк в кэш перед записью было бы лишним
+*/
+static void streamRow(uint32_t* dst, const uint32_t* src, int n)
+{
+	int k = 0;
+#ifdef FRAME_SSE2
+	for (; k < n && ((uintptr_t)(dst + k) & 15) != 0; k++)
+	{
+		dst[k] = src[k];
+	}
+	for (; k + 4 <= n; k += 4)
+	{
+		_mm_stream_si128((__m128i*)(dst + k), _mm_loadu_si128((const __m128i*)(src + k)));
+	}
+#endif
+	for (; k < n; k++)
+	{
+		dst[k] = src[k];
+	}
+}
+
+/**
+ *\param fb    буфер точек
+ *\param g     водоём
+ *\param s     образцы клеток
+ *\param i0    первая строка клеток
+ *\param i1    строка клеток за последней
+ *\details Вывод строк клеток i0..i1-1. Строка точек собирается в небольшом буфере,
+ * остающемся в кэше, и записывается во все строки буфера с той же строкой образца.
+ * Барьер в конце упорядочивает записи в обход кэша потока, который их выполнил: барьер
+ * действует только на записи своего потока, поэтому каждая задача пула ставит свой.
+*/
+static void fillRows(frameBuffer& fb, const planeGrid& g, const frameStyle& s, int i0, int i1)
+{
+	const int cell = s.cell, w = g.w, span = FRAME_GROUP * cell;
+	vector<uint32_t> line((size_t)fb.width + span);
+	vector<uint8_t> state(s.states == 2 ? 0 : (size_t)w);
+	for (int i = i0; i < i1; i++)
+	{
+		const uint64_t* row = &g.plane[0][(size_t)i * g.words];
+		if (s.states != 2)
+		{
+			for (int j = 0; j < w; j++)
+			{
+				int st = 0;
+				for (int b = 0; b < g.bits; b++)
+				{
+					st |= (int)((g.plane[b][(size_t)i * g.words + j / 64] >> (j % 64)) & 1) << b;
+				}
+				state[j] = (uint8_t)min(st, s.states - 1);
+			}
+		}
+		uint32_t* base = &fb.pixels[(size_t)i * cell * fb.width];
+		for (int v = 0; v < cell; v++)
+		{
+			if (s.same[v] != v)
+			{
+				continue;
+			}
+			if (s.states == 2)
+			{
+				/**наборы из FRAME_GROUP клеток не переходят границу слова: 64 делится на FRAME_GROUP*/
+				const uint32_t* table = &s.group[(size_t)v * (1 << FRAME_GROUP) * span];
+				for (int j = 0; j < w; j += FRAME_GROUP)
+				{
+					unsigned bits = (unsigned)(row[j / 64] >> (j % 64)) & ((1u << FRAME_GROUP) - 1);
+					copySpan(&line[(size_t)j * cell], table + (size_t)bits * span, span);
+				}
+			}
+			else
+			{
+				for (int j = 0; j < w; j++)
+				{
+					copySpan(&line[(size_t)j * cell], &s.tile[((size_t)state[j] * cell + v) * cell], cell);
+				}
+			}
+			for (int u = v; u < cell; u++)
+			{
+				if (s.same[u] == v)
+				{
+					streamRow(base + (size_t)u * fb.width, line.data(), fb.width);
+				}
+			}
+		}
+	}
+#ifdef FRAME_SSE2
+	_mm_sfence();
+#endif
+}
+
+/**
+ *\param fb   буфер точек; размеры становятся g.w * cell x g.h * cell
+ *\param g    водоём
+ *\param s    образцы клеток (не меньше состояний, чем у клеток водоёма)
+ *\param pool пул потоков, между которыми делятся строки клеток (nullptr - вывод в текущем потоке)
+*/
+void frameFill(frameBuffer& fb, const planeGrid& g, const frameStyle& s, workPool* pool)
+{
+	PROFILE_SCOPE("frameFill");
+	fb.width = g.w * s.cell;
+	fb.height = g.h * s.cell;
+	fb.pixels.resize((size_t)fb.width * fb.height);
+	if (pool == nullptr || pool->size() < 2)
+	{
+		fillRows(fb, g, s, 0, g.h);
+	}
+	else
+	{
+		/**строк клеток на задачу: не меньше 64 КБ точек*/
+		int64_t grain = max<int64_t>(1, 16384 / max(1, fb.width) / s.cell);
+		parallelFor(*pool, g.h, grain, [&](int64_t lo, int64_t hi)
+		{
+			fillRows(fb, g, s, (int)lo, (int)hi);
+		});
+	}
+}
@@ -0,0 +1,53 @@
+﻿/**
+ *\file framebuf.h
+ *\version 1.0
+ *\date October 2026
+ *\details Вывод водоёма в буфер точек RGBA для одной потоковой текстуры окна. Каждая клетка
+ * раскрывается в образец cell x cell точек из текстуры воды. Для водоёма с двумя состояниями
+ * строки образцов заранее собираются для всех наборов из четырёх соседних клеток, поэтому
+ * четыре бита водоёма превращаются в 4 * cell точек одним копированием векторными командами.
+ * Одинаковые строки образцов вычисляются один раз, строки буфера пишутся потоковой записью
+ * в обход кэша, а строки клеток делятся между потоками пула.
+ */
+
+#pragma once
+
+#include "image.h"
+#include "pool.h"
+#include "rules.h"
+
+#include <cstdint>
+#include <vector>
+
+/**Количество соседних клеток, раскрываемых одним копированием*/
+#define FRAME_GROUP 4
+
+/**
+ *\struct frameStyle
+ *\details Образцы клеток в точках RGBA (байты r, g, b, a в памяти)
+*/
+struct frameStyle
+{
+	/**сторона клетки в точках и количество состояний*/
+	int cell, states;
+	/**образцы: для каждого состояния cell строк по cell точек*/
+	std::vector<uint32_t> tile;
+	/**строки образцов FRAME_GROUP клеток с двумя состояниями: для каждой строки образца
+	 и каждого набора бит - FRAME_GROUP * cell точек*/
+	std::vector<uint32_t> group;
+	/**наименьший номер строки образца с теми же точками у всех состояний*/
+	std::vector<int> same;
+};
+
+/**
+ *\struct frameBuffer
+ *\details Буфер точек RGBA по строкам, выровненный по строке кэша
+*/
+struct frameBuffer
+{
+	int width, height;
+	std::vector<uint32_t, slabAllocator<uint32_t>> pixels;
+};
+
+void frameStyleFrom(const cellStyle& s, frameStyle& f);
+void frameFill(frameBuffer& fb, const planeGrid& g, const frameStyle& s, workPool* pool);
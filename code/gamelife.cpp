@@ -0,0 +1,503 @@
+﻿/**
+ *\file gamelife.cpp
+ *\version 1.0
+ *\date October 2026
+ *\details Библиотека libgamelife: водоём с битовыми плоскостями и правилом, шаги через
+ * nextGenerationRule, загрузка колоний из библиотеки и в формате RLE
+ */
+
+/**функции интерфейса экспортируются из библиотеки (и из программы, в которую файл добавлен)*/
+#define GAMELIFE_BUILD
+#include "gamelife.h"
+
+#include "edit.h"
+#include "library.h"
+#include "rules.h"
+
+#include <algorithm>
+#include <cctype>
+#include <new>
+
+using namespace std;
+
+/**
+ *\struct life_universe
+ *\details Водоём библиотеки: текущее и следующее поколения, правило и номер поколения
+*/
+struct life_universe
+{
+	planeGrid g, g1;
+	rule r;
+	uint64_t generation;
+	/**поколений на проход временных плиток (0 - отдельные шаги)*/
+	int temporal;
+};
+
+/**
+ *\return версия интерфейса библиотеки
+*/
+int life_api_version(void)
+{
+	return LIFE_API_VERSION;
+}
+
+/**
+ *\param rows, cols размеры водоёма
+ *\param rule правило в записи parseRule ("B3/S23", "B2/S/C3", "R5,C0,M1,S34..58,B34..45,NM");
+ * NULL - классическая "Жизнь"
+ *\return новый водоём, заполненный водой, или NULL при неверных параметрах или нехватке памяти
+*/
+life_universe* life_create(int64_t rows, int64_t cols, const char* rule)
+{
+	if (rows <= 0 || cols <= 0 || rows > 0x7fffffff || cols > 0x7fffffff)
+	{
+		return nullptr;
+	}
+	life_universe* u = new (nothrow) life_universe;
+	if (u == nullptr)
+	{
+		return nullptr;
+	}
+	try
+	{
+		if (!parseRule(rule == nullptr ? "B3/S23" : rule, u->r))
+		{
+			delete u;
+			return nullptr;
+		}
+		int bits = planesFor(u->r.states);
+		planeInit(u->g, (int)rows, (int)cols, bits);
+		planeInit(u->g1, (int)rows, (int)cols, bits);
+	}
+	catch (const bad_alloc&)
+	{
+		delete u;
+		return nullptr;
+	}
+	u->generation = 0;
+	u->temporal = 0;
+	return u;
+}
+
+/**
+ *\param u водоём (NULL допускается)
+*/
+void life_destroy(life_universe* u)
+{
+	delete u;
+}
+
+/**
+ *\param u водоём
+ *\return количество строк
+*/
+int64_t life_rows_count(const life_universe* u)
+{
+	return u == nullptr ? LIFE_EINVAL : u->g.h;
+}
+
+/**
+ *\param u водоём
+ *\return количество столбцов
+*/
+int64_t life_cols_count(const life_universe* u)
+{
+	return u == nullptr ? LIFE_EINVAL : u->g.w;
+}
+
+/**
+ *\param u водоём
+ *\return количество состояний клетки (2 для классической "Жизни")
+*/
+int life_states(const life_universe* u)
+{
+	return u == nullptr ? LIFE_EINVAL : u->r.states;
+}
+
+/**
+ *\param u водоём
+ *\return количество вычисленных поколений
+*/
+uint64_t life_generation(const life_universe* u)
+{
+	return u == nullptr ? 0 : u->generation;
+}
+
+/**
+ *\param u водоём
+ *\return количество живых клеток (состояние 1)
+*/
+int64_t life_population(const life_universe* u)
+{
+	if (u == nullptr)
+	{
+		return LIFE_EINVAL;
+	}
+	return planePopulation(u->g);
+}
+
+/**
+ *\param u водоём
+ *\param n количество поколений
+ *\return количество вычисленных поколений (меньше n, если водоём перестал меняться) или код ошибки
+ *\details После каждого шага поколения меняются местами, поэтому указатели life_packed_rows
+ * после шага нужно получить заново. Если включены временные плитки (life_set_temporal),
+ * поколения вычисляются проходами nextGenerationsBlocked, и остановка водоёма проверяется
+ * в конце каждого прохода.
+*/
+int64_t life_step(life_universe* u, int64_t n)
+{
+	if (u == nullptr || n < 0)
+	{
+		return LIFE_EINVAL;
+	}
+	int64_t k = 0;
+	while (k < n)
+	{
+		int t = u->temporal >= 2 ? (int)min<int64_t>(u->temporal, n - k) : 1;
+		k += t;
+		u->generation += t;
+		if (nextGenerationsBlocked(u->g, u->g1, u->r, t))
+		{
+			break;
+		}
+	}
+	return k;
+}
+
+/**
+ *\param u водоём
+ *\param k поколений на проход временных плиток (2..TEMPORAL_MAX); 0 или 1 - отдельные шаги
+ *\return LIFE_OK или код ошибки
+ *\details Временные плитки читают и пишут водоём один раз на k поколений. Выигрыш зависит
+ * от размера водоёма, правила и машины (см. --bench), поэтому режим включает вызывающая сторона.
+*/
+int life_set_temporal(life_universe* u, int k)
+{
+	if (u == nullptr || k < 0 || k > TEMPORAL_MAX)
+	{
+		return LIFE_EINVAL;
+	}
+	u->temporal = k;
+	return LIFE_OK;
+}
+
+/**
+ *\param u водоём
+ *\return LIFE_OK или код ошибки
+*/
+int life_clear(life_universe* u)
+{
+	if (u == nullptr)
+	{
+		return LIFE_EINVAL;
+	}
+	planeClear(u->g);
+	return LIFE_OK;
+}
+
+/**
+ *\param u      водоём
+ *\param coords пары (строка, столбец) n клеток
+ *\param states новые состояния клеток; NULL - все клетки становятся живыми
+ *\param n      количество клеток
+ *\return LIFE_OK или код ошибки; при ошибке клетки до ошибочной уже изменены
+*/
+int life_set_cells(life_universe* u, const int64_t* coords, const uint8_t* states, size_t n)
+{
+	if (u == nullptr || (coords == nullptr && n > 0))
+	{
+		return LIFE_EINVAL;
+	}
+	for (size_t k = 0; k < n; k++)
+	{
+		int64_t i = coords[2 * k], j = coords[2 * k + 1];
+		int s = states == nullptr ? 1 : states[k];
+		if (i < 0 || j < 0 || i >= u->g.h || j >= u->g.w || s >= u->r.states)
+		{
+			return LIFE_ERANGE;
+		}
+		planeSet(u->g, (int)i, (int)j, s);
+	}
+	return LIFE_OK;
+}
+
+/**
+ *\param u      водоём
+ *\param coords пары (строка, столбец) n клеток
+ *\param states состояния клеток
+ *\param n      количество клеток
+ *\return LIFE_OK или код ошибки
+*/
+int life_get_cells(const life_universe* u, const int64_t* coords, uint8_t* states, size_t n)
+{
+	if (u == nullptr || ((coords == nullptr || states == nullptr) && n > 0))
+	{
+		return LIFE_EINVAL;
+	}
+	for (size_t k = 0; k < n; k++)
+	{
+		int64_t i = coords[2 * k], j = coords[2 * k + 1];
+		if (i < 0 || j < 0 || i >= u->g.h || j >= u->g.w)
+		{
+			return LIFE_ERANGE;
+		}
+		states[k] = (uint8_t)planeGet(u->g, (int)i, (int)j);
+	}
+	return LIFE_OK;
+}
+
+/**
+ *\param u      водоём
+ *\param i0, j0 левый верхний угол прямоугольника
+ *\param h, w   размеры прямоугольника
+ *\param states состояния клеток по строкам
+ *\param stride расстояние между строками states в байтах
+ *\return true, если прямоугольник лежит в водоёме
+*/
+static bool rectValid(const life_universe* u, int64_t i0, int64_t j0, int64_t h, int64_t w, const void* states, int64_t stride)
+{
+	return u != nullptr && states != nullptr && h >= 0 && w >= 0 && stride >= w && i0 >= 0 && j0 >= 0
+		&& i0 + h <= u->g.h && j0 + w <= u->g.w;
+}
+
+/**
+ *\param u      водоём
+ *\param i0, j0 левый верхний угол прямоугольника
+ *\param h, w   размеры прямоугольника
+ *\param states состояния клеток по строкам (байт на клетку)
+ *\param stride расстояние между строками states в байтах
+ *\return LIFE_OK или код ошибки
+ *\details Загрузка прямоугольника из матрицы вызывающей стороны. Строки плоскостей
+ * собираются целыми словами, поэтому загрузка всего водоёма - один проход по матрице.
+*/
+int life_set_rect(life_universe* u, int64_t i0, int64_t j0, int64_t h, int64_t w, const uint8_t* states, int64_t stride)
+{
+	if (!rectValid(u, i0, j0, h, w, states, stride))
+	{
+		return LIFE_EINVAL;
+	}
+	planeGrid& g = u->g;
+	for (int64_t i = 0; i < h; i++)
+	{
+		const uint8_t* src = states + i * stride;
+		for (int64_t j = 0; j < w; j++)
+		{
+			if (src[j] >= u->r.states)
+			{
+				return LIFE_ERANGE;
+			}
+		}
+		for (int64_t j = j0; j < j0 + w;)
+		{
+			/**слово k строки: столбцы j..e-1 прямоугольника*/
+			int64_t k = j / 64, e = min<int64_t>(j0 + w, (k + 1) * 64);
+			uint64_t mask = (e - j == 64 ? ~0ull : ((1ull << (e - j)) - 1)) << (j % 64);
+			uint64_t v[MAX_PLANES] = {};
+			for (int64_t c = j; c < e; c++)
+			{
+				for (int b = 0; b < g.bits; b++)
+				{
+					v[b] |= (uint64_t)((src[c - j0] >> b) & 1) << (c % 64);
+				}
+			}
+			for (int b = 0; b < g.bits; b++)
+			{
+				uint64_t& x = g.plane[b][(size_t)(i0 + i) * g.words + k];
+				x = (x & ~mask) | v[b];
+			}
+			j = e;
+		}
+	}
+	return LIFE_OK;
+}
+
+/**
+ *\param u      водоём
+ *\param i0, j0 левый верхний угол прямоугольника
+ *\param h, w   размеры прямоугольника
+ *\param states состояния клеток по строкам (байт на клетку)
+ *\param stride расстояние между строками states в байтах
+ *\return LIFE_OK или код ошибки
+*/
+int life_get_rect(const life_universe* u, int64_t i0, int64_t j0, int64_t h, int64_t w, uint8_t* states, int64_t stride)
+{
+	if (!rectValid(u, i0, j0, h, w, states, stride))
+	{
+		return LIFE_EINVAL;
+	}
+	const planeGrid& g = u->g;
+	for (int64_t i = 0; i < h; i++)
+	{
+		uint8_t* dst = states + i * stride;
+		size_t row = (size_t)(i0 + i) * g.words;
+		for (int64_t j = 0; j < w; j++)
+		{
+			int64_t c = j0 + j;
+			int s = 0;
+			for (int b = 0; b < g.bits; b++)
+			{
+				s |= (int)((g.plane[b][row + c / 64] >> (c % 64)) & 1) << b;
+			}
+			dst[j] = (uint8_t)s;
+		}
+	}
+	return LIFE_OK;
+}
+
+/**
+ *\param u водоём
+ *\return количество битовых плоскостей
+*/
+int life_planes(const life_universe* u)
+{
+	return u == nullptr ? LIFE_EINVAL : u->g.bits;
+}
+
+/**
+ *\param u      водоём
+ *\param plane  номер плоскости (0..life_planes-1)
+ *\param stride количество 64-битных слов в строке
+ *\return начало упакованных строк плоскости без копирования или NULL.
+ * Бит b состояния клетки (i, j) - бит j % 64 слова [i * stride + j / 64] плоскости b;
+ * биты за последним столбцом равны нулю. Указатель действителен до следующего изменения
+ * водоёма (life_step, life_set_*, life_load_*, life_clear, life_destroy).
+*/
+const uint64_t* life_packed_rows(const life_universe* u, int plane, int64_t* stride)
+{
+	if (u == nullptr || plane < 0 || plane >= u->g.bits)
+	{
+		return nullptr;
+	}
+	if (stride != nullptr)
+	{
+		*stride = u->g.words;
+	}
+	return u->g.plane[plane].data();
+}
+
+/**
+ *\return количество колоний во встроенной библиотеке (окно "Фигуры")
+*/
+int life_pattern_count(void)
+{
+	return LIBRARY_SIZE;
+}
+
+/**
+ *\param u      водоём
+ *\param index  номер колонии (0..life_pattern_count-1)
+ *\param rot    количество поворотов на 90 градусов по часовой стрелке
+ *\param flip   отражение слева направо (до поворота)
+ *\param i0, j0 левый верхний угол колонии; клетки за краем водоёма отбрасываются
+ *\return LIFE_OK или код ошибки
+*/
+int life_load_pattern(life_universe* u, int index, int rot, int flip, int64_t i0, int64_t j0)
+{
+	if (u == nullptr || index < 0 || index >= LIBRARY_SIZE)
+	{
+		return LIFE_EINVAL;
+	}
+	try
+	{
+		editApply(u->g, editPlace(library[index], rot, flip != 0, i0, j0));
+	}
+	catch (const bad_alloc&)
+	{
+		return LIFE_ENOMEM;
+	}
+	return LIFE_OK;
+}
+
+/**
+ *\param u      водоём
+ *\param text   колония в формате RLE: строки "#..." и заголовок "x = ..." пропускаются,
+ * b и . - вода, o и A - живая клетка, B..X - состояния угасания 2..24, $ - конец строки, ! - конец
+ *\param i0, j0 левый верхний угол колонии; клетки за верхним и левым краем водоёма отбрасываются
+ *\return LIFE_OK или код ошибки
+ *\details Серия длиннее остатка строки или столбца водоёма (от начала серии до правого или
+ * нижнего края) отвергается с LIFE_ERANGE, поэтому огромное число повторений не переполняет
+ * счётчик и не занимает загрузку надолго.
+*/
+int life_load_rle(life_universe* u, const char* text, int64_t i0, int64_t j0)
+{
+	if (u == nullptr || text == nullptr)
+	{
+		return LIFE_EINVAL;
+	}
+	int64_t i = i0, j = j0, count = 0;
+	bool lineStart = true;
+	for (const char* p = text; *p != 0 && *p != '!'; p++)
+	{
+		char c = *p;
+		/**строки комментариев и заголовка пропускаются целиком*/
+		if (lineStart && (c == '#' || c == 'x'))
+		{
+			while (*p != 0 && *p != '\n')
+			{
+				p++;
+			}
+			if (*p == 0)
+			{
+				break;
+			}
+			continue;
+		}
+		lineStart = c == '\n';
+		if (isspace((unsigned char)c))
+		{
+			continue;
+		}
+		if (isdigit((unsigned char)c))
+		{
+			count = count * 10 + (c - '0');
+			if (count > u->g.w - j && count > u->g.h - i)
+			{
+				return LIFE_ERANGE;
+			}
+			continue;
+		}
+		int64_t n = count == 0 ? 1 : count;
+		count = 0;
+		if (c == '$')
+		{
+			if (n > u->g.h - i)
+			{
+				return LIFE_ERANGE;
+			}
+			i += n;
+			j = j0;
+			continue;
+		}
+		int s;
+		if (c == 'b' || c == '.')
+		{
+			s = 0;
+		}
+		else if (c == 'o')
+		{
+			s = 1;
+		}
+		else if (c >= 'A' && c <= 'X')
+		{
+			s = c - 'A' + 1;
+		}
+		else
+		{
+			return LIFE_EPARSE;
+		}
+		if (s >= u->r.states || n > u->g.w - j)
+		{
+			return LIFE_ERANGE;
+		}
+		if (s != 0 && i >= 0 && i < u->g.h)
+		{
+			for (int64_t k = max<int64_t>(j, 0); k < j + n; k++)
+			{
+				planeSet(u->g, (int)i, (int)k, s);
+			}
+		}
+		j += n;
+	}
+	return LIFE_OK;
+}
@@ -0,0 +1,74 @@
+﻿/**
+ *\file gamelife.h
+ *\version 1.0
+ *\date October 2026
+ *\details Интерфейс библиотеки libgamelife на языке C для встраивания вычисления поколений
+ * в другие программы. Водоём (universe) создаётся с правилом из rules.h, клетки задаются
+ * и читаются пачками, а упакованные строки доступны только для чтения без копирования.
+ * Библиотека не хранит общего изменяемого состояния: разные водоёмы можно вычислять
+ * из разных потоков одновременно, а вызовы для одного водоёма вызывающая сторона
+ * выполняет по очереди.
+ */
+
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+#if defined(_WIN32)
+#ifdef GAMELIFE_BUILD
+#define LIFE_API __declspec(dllexport)
+#else
+#define LIFE_API __declspec(dllimport)
+#endif
+#else
+#define LIFE_API __attribute__((visibility("default")))
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**Версия интерфейса; меняется только при несовместимых изменениях*/
+#define LIFE_API_VERSION 1
+
+/**Коды завершения: успех и ошибки (отрицательные)*/
+#define LIFE_OK 0
+#define LIFE_EINVAL -1
+#define LIFE_ERANGE -2
+#define LIFE_ENOMEM -3
+#define LIFE_EPARSE -4
+
+/**Водоём; содержимое скрыто*/
+typedef struct life_universe life_universe;
+
+LIFE_API int life_api_version(void);
+
+LIFE_API life_universe* life_create(int64_t rows, int64_t cols, const char* rule);
+LIFE_API void life_destroy(life_universe* u);
+
+LIFE_API int64_t life_rows_count(const life_universe* u);
+LIFE_API int64_t life_cols_count(const life_universe* u);
+LIFE_API int life_states(const life_universe* u);
+LIFE_API uint64_t life_generation(const life_universe* u);
+LIFE_API int64_t life_population(const life_universe* u);
+
+LIFE_API int64_t life_step(life_universe* u, int64_t n);
+LIFE_API int life_set_temporal(life_universe* u, int k);
+
+LIFE_API int life_clear(life_universe* u);
+LIFE_API int life_set_cells(life_universe* u, const int64_t* coords, const uint8_t* states, size_t n);
+LIFE_API int life_get_cells(const life_universe* u, const int64_t* coords, uint8_t* states, size_t n);
+LIFE_API int life_set_rect(life_universe* u, int64_t i0, int64_t j0, int64_t h, int64_t w, const uint8_t* states, int64_t stride);
+LIFE_API int life_get_rect(const life_universe* u, int64_t i0, int64_t j0, int64_t h, int64_t w, uint8_t* states, int64_t stride);
+
+LIFE_API int life_planes(const life_universe* u);
+LIFE_API const uint64_t* life_packed_rows(const life_universe* u, int plane, int64_t* stride);
+
+LIFE_API int life_pattern_count(void);
+LIFE_API int life_load_pattern(life_universe* u, int index, int rot, int flip, int64_t i0, int64_t j0);
+LIFE_API int life_load_rle(life_universe* u, const char* text, int64_t i0, int64_t j0);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,577 @@
+﻿/**
+ *\file image.cpp
+ *\version 1.0
+ *\date October 2026
+ *\details Образцы клеток, кодировщик PNG (deflate с постоянными кодами Хаффмана) и кодировщик GIF (LZW)
+ */
+
+#include "image.h"
+
+#include <algorithm>
+#include <array>
+#include <cstring>
+
+using namespace std;
+
+/**
+ *\param s     внешний вид клеток
+ *\param cell  сторона клетки в точках
+ *\param states количество состояний
+ *\details Пустая палитра; образцы всех состояний заполнены цветом 0
+*/
+void styleInit(cellStyle& s, int cell, int states)
+{
+	s.cell = max(1, cell);
+	s.states = min(max(1, states), IMAGE_STATES);
+	s.colors = 0;
+	memset(s.rgb, 0, sizeof(s.rgb));
+	s.tile.assign((size_t)s.states * s.cell * s.cell, 0);
+}
+
+/**
+ *\param s внешний вид клеток
+ *\param r, g, b цвет
+ *\return номер цвета в палитре; если палитра заполнена - номер ближайшего цвета
+*/
+int styleColor(cellStyle& s, uint8_t r, uint8_t g, uint8_t b)
+{
+	int best = 0, bestD = 1 << 30;
+	for (int k = 0; k < s.colors; k++)
+	{
+		int dr = s.rgb[k * 3] - r, dg = s.rgb[k * 3 + 1] - g, db = s.rgb[k * 3 + 2] - b;
+		int d = dr * dr + dg * dg + db * db;
+		if (d == 0)
+		{
+			return k;
+		}
+		if (d < bestD)
+		{
+			best = k;
+			bestD = d;
+		}
+	}
+	if (s.colors == IMAGE_COLORS)
+	{
+		return best;
+	}
+	s.rgb[s.colors * 3] = r;
+	s.rgb[s.colors * 3 + 1] = g;
+	s.rgb[s.colors * 3 + 2] = b;
+	return s.colors++;
+}
+
+/**
+ *\param s      внешний вид клеток
+ *\param states состояния n клеток строки
+ *\param n      количество клеток
+ *\param y      строка точек внутри клетки (0..cell-1)
+ *\param out    номера цветов n * cell точек
+*/
+void styleRow(const cellStyle& s, const uint8_t* states, int64_t n, int y, uint8_t* out)
+{
+	for (int64_t j = 0; j < n; j++)
+	{
+		memcpy(out + j * s.cell, &s.tile[((size_t)states[j] * s.cell + y) * s.cell], s.cell);
+	}
+}
+
+/**
+ *\param crc предыдущее значение (0 в начале)
+ *\param p   байты
+ *\param n   количество байтов
+ *\return CRC-32 (многочлен 0xEDB88320), как в блоках PNG
+*/
+uint32_t crc32(uint32_t crc, const uint8_t* p, size_t n)
+{
+	/**таблица строится один раз при первом вызове (потокобезопасно)*/
+	static const array<uint32_t, 256> table = []
+	{
+		array<uint32_t, 256> t;
+		for (uint32_t k = 0; k < 256; k++)
+		{
+			uint32_t c = k;
+			for (int b = 0; b < 8; b++)
+			{
+				c = (c & 1) ? 0xedb88320u ^ (c >> 1) : c >> 1;
+			}
+			t[k] = c;
+		}
+		return t;
+	}();
+	crc = ~crc;
+	for (size_t k = 0; k < n; k++)
+	{
+		crc = table[(crc ^ p[k]) & 255] ^ (crc >> 8);
+	}
+	return ~crc;
+}
+
+/**Основание контрольной суммы Adler-32*/
+#define ADLER_BASE 65521u
+
+/**
+ *\param a предыдущее значение (1 в начале)
+ *\param p байты
+ *\param n количество байтов
+ *\return контрольная сумма Adler-32 потока zlib
+*/
+uint32_t adler32(uint32_t a, const uint8_t* p, size_t n)
+{
+	uint32_t s1 = a & 0xffff, s2 = a >> 16;
+	while (n > 0)
+	{
+		/**5552 байта - наибольшая порция, при которой суммы не переполняются*/
+		size_t m = min<size_t>(n, 5552);
+		n -= m;
+		while (m-- > 0)
+		{
+			s1 += *p++;
+			s2 += s1;
+		}
+		s1 %= ADLER_BASE;
+		s2 %= ADLER_BASE;
+	}
+	return s1 | (s2 << 16);
+}
+
+/**
+ *\param a1   контрольная сумма первой части
+ *\param a2   контрольная сумма второй части
+ *\param len2 длина второй части
+ *\return контрольная сумма соединения частей
+*/
+uint32_t adlerCombine(uint32_t a1, uint32_t a2, uint64_t len2)
+{
+	uint64_t rem = len2 % ADLER_BASE;
+	uint64_t s1 = a1 & 0xffff;
+	uint64_t s2 = (rem * s1) % ADLER_BASE;
+	s1 += (a2 & 0xffff) + ADLER_BASE - 1;
+	s2 += (a1 >> 16) + (a2 >> 16) + ADLER_BASE - rem;
+	s1 %= ADLER_BASE;
+	s2 %= ADLER_BASE;
+	return (uint32_t)(s1 | (s2 << 16));
+}
+
+/**
+ *\param colors количество цветов палитры
+ *\return наименьшая глубина PNG (бит на точку), вмещающая палитру
+*/
+int pngDepth(int colors)
+{
+	return colors <= 2 ? 1 : colors <= 4 ? 2 : colors <= 16 ? 4 : 8;
+}
+
+/**
+ *\param px    номера цветов n точек
+ *\param n     количество точек
+ *\param depth бит на точку
+ *\param out   упакованная строка PNG (старшие биты - левые точки)
+*/
+void pngPack(const uint8_t* px, int64_t n, int depth, uint8_t* out)
+{
+	if (depth == 8)
+	{
+		memcpy(out, px, (size_t)n);
+		return;
+	}
+	int per = 8 / depth;
+	for (int64_t j = 0; j < n; j += per)
+	{
+		uint8_t b = 0;
+		for (int k = 0; k < per; k++)
+		{
+			b = (uint8_t)(b << depth);
+			if (j + k < n)
+			{
+				b |= px[j + k];
+			}
+		}
+		out[j / per] = b;
+	}
+}
+
+/**
+ *\struct bitWriter
+ *\details Запись битов потока deflate (младшие биты - первыми)
+*/
+struct bitWriter
+{
+	vector<uint8_t>& out;
+	uint64_t acc;
+	int n;
+	void put(uint32_t v, int bits)
+	{
+		acc |= (uint64_t)v << n;
+		n += bits;
+		while (n >= 8)
+		{
+			out.push_back((uint8_t)acc);
+			acc >>= 8;
+			n -= 8;
+		}
+	}
+	void align()
+	{
+		if (n > 0)
+		{
+			put(0, 8 - n);
+		}
+	}
+};
+
+/**
+ *\struct fixedCodes
+ *\details Постоянные коды Хаффмана deflate (RFC 1951, 3.2.6), заранее записанные
+ * младшими битами вперёд
+*/
+struct fixedCodes
+{
+	uint16_t lit[288], dist[30];
+	uint8_t litBits[288];
+	fixedCodes()
+	{
+		for (int sym = 0; sym < 288; sym++)
+		{
+			int code = sym < 144 ? 0x30 + sym : sym < 256 ? 0x190 + sym - 144 : sym < 280 ? sym - 256 : 0xc0 + sym - 280;
+			int bits = sym < 144 ? 8 : sym < 256 ? 9 : sym < 280 ? 7 : 8;
+			lit[sym] = reverse(code, bits);
+			litBits[sym] = (uint8_t)bits;
+		}
+		for (int d = 0; d < 30; d++)
+		{
+			dist[d] = reverse(d, 5);
+		}
+	}
+	static uint16_t reverse(int code, int bits)
+	{
+		int r = 0;
+		for (int b = 0; b < bits; b++)
+		{
+			r |= ((code >> b) & 1) << (bits - 1 - b);
+		}
+		return (uint16_t)r;
+	}
+};
+
+/**начала длин и дистанций deflate и количество дополнительных битов*/
+static const int lenBase[29] = {3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17, 19, 23, 27, 31, 35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258};
+static const int lenExtra[29] = {0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2, 3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0};
+static const int distBase[30] = {1, 2, 3, 4, 5, 7, 9, 13, 17, 25, 33, 49, 65, 97, 129, 193, 257, 385, 513, 769, 1025, 1537, 2049, 3073, 4097, 6145, 8193, 12289, 16385, 24577};
+static const int distExtra[30] = {0, 0, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 6, 7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13};
+
+/**Размер окна и таблицы начал цепочек deflate*/
+#define DEFLATE_WINDOW 32768
+#define DEFLATE_HASH (1 << 15)
+
+/**
+ *\param raw байты полосы (строки PNG с байтом фильтра)
+ *\param n   количество байтов
+ *\param last последняя полоса изображения
+ *\param s   сжатая полоса
+ *\details Сжатие одним блоком с постоянными кодами: жадный поиск совпадения по таблице
+ * последних позиций трёхбайтных цепочек. Водоём состоит из повторяющихся образцов клеток
+ * и повторяющихся строк, поэтому совпадения длинные. Полоса, кроме последней, завершается
+ * пустым несжатым блоком, чтобы следующая полоса начиналась с целого байта.
+*/
+void pngDeflate(const uint8_t* raw, size_t n, bool last, pngStrip& s)
+{
+	/**номер кода каждой длины совпадения*/
+	static const array<int, 259> lenCode = []
+	{
+		array<int, 259> t{};
+		for (int c = 0; c < 29; c++)
+		{
+			for (int l = lenBase[c]; l < (c == 28 ? 259 : lenBase[c + 1]); l++)
+			{
+				t[l] = c;
+			}
+		}
+		return t;
+	}();
+	static const fixedCodes codes;
+	s.data.clear();
+	s.data.reserve(n / 4 + 64);
+	s.adler = adler32(1, raw, n);
+	s.raw = n;
+	bitWriter w{s.data, 0, 0};
+	w.put(last ? 1 : 0, 1);
+	w.put(1, 2);
+	vector<int32_t> head(DEFLATE_HASH, -1);
+	size_t p = 0;
+	while (p < n)
+	{
+		size_t len = 0, dist = 0;
+		if (p + 3 <= n)
+		{
+			uint32_t h = ((uint32_t)raw[p] << 16 | (uint32_t)raw[p + 1] << 8 | raw[p + 2]) * 2654435761u >> 17;
+			int32_t c = head[h];
+			head[h] = (int32_t)p;
+			if (c >= 0 && p - c <= DEFLATE_WINDOW)
+			{
+				size_t m = min<size_t>(258, n - p);
+				/**сравнение по 8 байтов, затем по одному*/
+				while (len + 8 <= m)
+				{
+					uint64_t x, y;
+					memcpy(&x, raw + c + len, 8);
+					memcpy(&y, raw + p + len, 8);
+					if (x != y)
+					{
+						break;
+					}
+					len += 8;
+				}
+				while (len < m && raw[c + len] == raw[p + len])
+				{
+					len++;
+				}
+				dist = p - c;
+			}
+		}
+		if (len >= 3)
+		{
+			int lc = lenCode[len];
+			w.put(codes.lit[257 + lc], codes.litBits[257 + lc]);
+			w.put((uint32_t)(len - lenBase[lc]), lenExtra[lc]);
+			int dc = (int)(upper_bound(distBase, distBase + 30, (int)dist) - distBase) - 1;
+			w.put(codes.dist[dc], 5);
+			w.put((uint32_t)(dist - distBase[dc]), distExtra[dc]);
+			p += len;
+		}
+		else
+		{
+			w.put(codes.lit[raw[p]], codes.litBits[raw[p]]);
+			p++;
+		}
+	}
+	w.put(codes.lit[256], codes.litBits[256]);
+	if (!last)
+	{
+		w.put(0, 3);
+		w.align();
+		w.put(0xffff0000u, 32);
+	}
+	w.align();
+}
+
+/**
+ *\param f    файл
+ *\param type имя блока
+ *\param p    данные блока
+ *\param n    размер данных
+ *\return true, если блок записан
+*/
+static bool pngChunk(FILE* f, const char* type, const uint8_t* p, size_t n)
+{
+	uint8_t hdr[8] = {(uint8_t)(n >> 24), (uint8_t)(n >> 16), (uint8_t)(n >> 8), (uint8_t)n,
+		(uint8_t)type[0], (uint8_t)type[1], (uint8_t)type[2], (uint8_t)type[3]};
+	uint32_t crc = crc32(crc32(0, hdr + 4, 4), p, n);
+	uint8_t tail[4] = {(uint8_t)(crc >> 24), (uint8_t)(crc >> 16), (uint8_t)(crc >> 8), (uint8_t)crc};
+	return fwrite(hdr, 1, 8, f) == 8 && (n == 0 || fwrite(p, 1, n, f) == n) && fwrite(tail, 1, 4, f) == 4;
+}
+
+/**
+ *\param f     файл
+ *\param w, h  ширина и высота изображения в точках
+ *\param depth бит на точку (pngDepth)
+ *\param s     внешний вид клеток (палитра)
+ *\return true, если начало файла записано
+ *\details Подпись, заголовок, палитра и начало потока zlib. Дальше записываются полосы
+ * (pngPut) и конец (pngEnd).
+*/
+bool pngBegin(FILE* f, int64_t w, int64_t h, int depth, const cellStyle& s)
+{
+	static const uint8_t sign[8] = {0x89, 'P', 'N', 'G', '\r', '\n', 0x1a, '\n'};
+	uint8_t ihdr[13] = {(uint8_t)(w >> 24), (uint8_t)(w >> 16), (uint8_t)(w >> 8), (uint8_t)w,
+		(uint8_t)(h >> 24), (uint8_t)(h >> 16), (uint8_t)(h >> 8), (uint8_t)h, (uint8_t)depth, 3, 0, 0, 0};
+	static const uint8_t zlib[2] = {0x78, 0x01};
+	return fwrite(sign, 1, 8, f) == 8 && pngChunk(f, "IHDR", ihdr, 13)
+		&& pngChunk(f, "PLTE", s.rgb, (size_t)max(1, s.colors) * 3) && pngChunk(f, "IDAT", zlib, 2);
+}
+
+/**
+ *\param f     файл
+ *\param s     сжатая полоса
+ *\param adler контрольная сумма записанных полос (1 в начале)
+ *\return true, если полоса записана
+*/
+bool pngPut(FILE* f, const pngStrip& s, uint32_t& adler)
+{
+	adler = adlerCombine(adler, s.adler, s.raw);
+	return s.data.empty() || pngChunk(f, "IDAT", s.data.data(), s.data.size());
+}
+
+/**
+ *\param f     файл
+ *\param adler контрольная сумма всех полос
+ *\return true, если конец файла записан
+*/
+bool pngEnd(FILE* f, uint32_t adler)
+{
+	uint8_t a[4] = {(uint8_t)(adler >> 24), (uint8_t)(adler >> 16), (uint8_t)(adler >> 8), (uint8_t)adler};
+	return pngChunk(f, "IDAT", a, 4) && pngChunk(f, "IEND", nullptr, 0);
+}
+
+/**
+ *\param g  кодировщик
+ *\param b  байт сжатых данных
+ *\details Данные кадра GIF записываются подблоками по 255 байт
+*/
+static void gifByte(gifWriter& g, uint8_t b)
+{
+	g.block[g.blockLen++] = b;
+	if (g.blockLen == 255)
+	{
+		fputc(255, g.f);
+		fwrite(g.block, 1, 255, g.f);
+		g.blockLen = 0;
+	}
+}
+
+/**
+ *\param g    кодировщик
+ *\param code код LZW текущей ширины
+*/
+static void gifCode(gifWriter& g, int code)
+{
+	g.acc |= (uint32_t)code << g.accBits;
+	g.accBits += g.bits;
+	while (g.accBits >= 8)
+	{
+		gifByte(g, (uint8_t)g.acc);
+		g.acc >>= 8;
+		g.accBits -= 8;
+	}
+}
+
+/**
+ *\param g кодировщик
+ *\details Очистка таблицы цепочек: остаются только коды отдельных точек
+*/
+static void gifReset(gifWriter& g)
+{
+	fill(g.key, g.key + GIF_HASH, -1);
+	g.bits = g.minBits + 1;
+	g.maxCode = (1 << g.minBits) + 1;
+}
+
+/**
+ *\param g    кодировщик
+ *\param f    файл
+ *\param w, h ширина и высота кадра в точках (не больше 65535)
+ *\param s    внешний вид клеток (палитра)
+ *\return true, если заголовок записан
+ *\details Заголовок GIF89a с общей палитрой и бесконечным повтором анимации
+*/
+bool gifBegin(gifWriter& g, FILE* f, int w, int h, const cellStyle& s)
+{
+	g.f = f;
+	g.w = w;
+	g.h = h;
+	int n = 0;
+	while ((2 << n) < s.colors)
+	{
+		n++;
+	}
+	g.minBits = max(2, n + 1);
+	uint8_t hdr[13] = {'G', 'I', 'F', '8', '9', 'a', (uint8_t)w, (uint8_t)(w >> 8), (uint8_t)h, (uint8_t)(h >> 8),
+		(uint8_t)(0xf0 | n), 0, 0};
+	fwrite(hdr, 1, 13, f);
+	uint8_t table[IMAGE_COLORS * 3] = {};
+	memcpy(table, s.rgb, (size_t)s.colors * 3);
+	fwrite(table, 1, (size_t)(2 << n) * 3, f);
+	static const uint8_t loop[19] = {0x21, 0xff, 11, 'N', 'E', 'T', 'S', 'C', 'A', 'P', 'E', '2', '.', '0', 3, 1, 0, 0, 0};
+	return fwrite(loop, 1, 19, f) == 19;
+}
+
+/**
+ *\param g     кодировщик
+ *\param delay задержка кадра в сотых долях секунды
+*/
+void gifFrameBegin(gifWriter& g, int delay)
+{
+	uint8_t hdr[19] = {0x21, 0xf9, 4, 0, (uint8_t)delay, (uint8_t)(delay >> 8), 0, 0,
+		0x2c, 0, 0, 0, 0, (uint8_t)g.w, (uint8_t)(g.w >> 8), (uint8_t)g.h, (uint8_t)(g.h >> 8), 0, (uint8_t)g.minBits};
+	fwrite(hdr, 1, 19, g.f);
+	g.acc = 0;
+	g.accBits = 0;
+	g.blockLen = 0;
+	g.cur = -1;
+	gifReset(g);
+	gifCode(g, 1 << g.minBits);
+}
+
+/**
+ *\param g  кодировщик
+ *\param px номера цветов строки кадра (w точек)
+ *\details Сжатие LZW: цепочка продолжается, пока она есть в таблице; при заполнении
+ * таблицы (4096 кодов) выдаётся код очистки
+*/
+void gifRow(gifWriter& g, const uint8_t* px)
+{
+	for (int x = 0; x < g.w; x++)
+	{
+		if (g.cur < 0)
+		{
+			g.cur = px[x];
+			continue;
+		}
+		int32_t key = g.cur << 8 | px[x];
+		uint32_t h = (uint32_t)key * 2654435761u >> 19;
+		while (g.key[h] != -1 && g.key[h] != key)
+		{
+			h = (h + 1) & (GIF_HASH - 1);
+		}
+		if (g.key[h] == key)
+		{
+			g.cur = g.code[h];
+			continue;
+		}
+		gifCode(g, g.cur);
+		g.key[h] = key;
+		g.code[h] = (int16_t)++g.maxCode;
+		if (g.maxCode >= (1 << g.bits))
+		{
+			g.bits++;
+		}
+		if (g.maxCode == 4095)
+		{
+			gifCode(g, 1 << g.minBits);
+			gifReset(g);
+		}
+		g.cur = px[x];
+	}
+}
+
+/**
+ *\param g кодировщик
+ *\details Последняя цепочка, код конца данных и остаток битов
+*/
+void gifFrameEnd(gifWriter& g)
+{
+	if (g.cur >= 0)
+	{
+		gifCode(g, g.cur);
+	}
+	gifCode(g, (1 << g.minBits) + 1);
+	if (g.accBits > 0)
+	{
+		gifByte(g, (uint8_t)g.acc);
+	}
+	if (g.blockLen > 0)
+	{
+		fputc(g.blockLen, g.f);
+		fwrite(g.block, 1, g.blockLen, g.f);
+	}
+	fputc(0, g.f);
+}
+
+/**
+ *\param g кодировщик
+ *\return true, если файл записан без ошибок
+*/
+bool gifEnd(gifWriter& g)
+{
+	fputc(0x3b, g.f);
+	return ferror(g.f) == 0;
+}
@@ -0,0 +1,94 @@
+﻿/**
+ *\file image.h
+ *\version 1.0
+ *\date October 2026
+ *\details Вывод водоёма в изображения без графической библиотеки: строки точек строятся из
+ * состояний клеток по образцам клеток (внешнему виду каждого состояния), затем кодируются
+ * в PNG с палитрой или в анимированный GIF. Оба кодировщика потоковые: изображение
+ * подаётся строками и целиком в памяти не хранится.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <cstdio>
+#include <vector>
+
+/**Наибольшее количество цветов палитры*/
+#define IMAGE_COLORS 256
+/**Наибольшее количество состояний клетки*/
+#define IMAGE_STATES 16
+
+/**
+ *\struct cellStyle
+ *\details Внешний вид клеток: палитра и образец cell x cell точек для каждого состояния
+*/
+struct cellStyle
+{
+	/**сторона клетки в точках*/
+	int cell;
+	int states;
+	/**количество цветов и цвета палитры (r, g, b)*/
+	int colors;
+	uint8_t rgb[IMAGE_COLORS * 3];
+	/**номера цветов образцов: states образцов по cell x cell*/
+	std::vector<uint8_t> tile;
+};
+
+void styleInit(cellStyle& s, int cell, int states);
+int styleColor(cellStyle& s, uint8_t r, uint8_t g, uint8_t b);
+void styleRow(const cellStyle& s, const uint8_t* states, int64_t n, int y, uint8_t* out);
+
+uint32_t crc32(uint32_t crc, const uint8_t* p, size_t n);
+uint32_t adler32(uint32_t a, const uint8_t* p, size_t n);
+uint32_t adlerCombine(uint32_t a1, uint32_t a2, uint64_t len2);
+
+/**
+ *\struct pngStrip
+ *\details Сжатая полоса строк PNG: блоки deflate и контрольная сумма несжатых байтов.
+ * Полосы сжимаются независимо и записываются в файл по порядку отдельными блоками IDAT.
+*/
+struct pngStrip
+{
+	std::vector<uint8_t> data;
+	uint32_t adler;
+	uint64_t raw;
+};
+
+int pngDepth(int colors);
+void pngPack(const uint8_t* px, int64_t n, int depth, uint8_t* out);
+void pngDeflate(const uint8_t* raw, size_t n, bool last, pngStrip& s);
+bool pngBegin(FILE* f, int64_t w, int64_t h, int depth, const cellStyle& s);
+bool pngPut(FILE* f, const pngStrip& s, uint32_t& adler);
+bool pngEnd(FILE* f, uint32_t adler);
+
+/**Количество мест в таблице кодов LZW (степень двойки, не меньше удвоенных 4096 кодов)*/
+#define GIF_HASH 8192
+
+/**
+ *\struct gifWriter
+ *\details Потоковый кодировщик анимированного GIF: состояние LZW и накопитель битов
+*/
+struct gifWriter
+{
+	FILE* f;
+	int w, h;
+	/**начальная ширина кода LZW*/
+	int minBits;
+	/**текущая ширина кода, последний выданный код, текущая цепочка*/
+	int bits, maxCode, cur;
+	/**таблица цепочек: ключ (цепочка << 8 | точка) и код*/
+	int32_t key[GIF_HASH];
+	int16_t code[GIF_HASH];
+	/**накопитель битов и подблок данных (до 255 байт)*/
+	uint32_t acc;
+	int accBits;
+	uint8_t block[255];
+	int blockLen;
+};
+
+bool gifBegin(gifWriter& g, FILE* f, int w, int h, const cellStyle& s);
+void gifFrameBegin(gifWriter& g, int delay);
+void gifRow(gifWriter& g, const uint8_t* px);
+void gifFrameEnd(gifWriter& g);
+bool gifEnd(gifWriter& g);
@@ -0,0 +1,141 @@
+﻿/**
+ *\file library.cpp
+ *\version 1.0
+ *\date October 2026
+ *\details Таблица стандартных колоний
+ */
+
+#include "library.h"
+
+/**Колонии в порядке кнопок окна "фигуры"*/
+const libPattern library[LIBRARY_SIZE] =
+{
+	/**глайдер*/
+	{L"глайдер", 29, 30, 3,
+		{".O.",
+		"..O",
+		"OOO"}},
+	/**звездолёт*/
+	{L"звездолёт", 25, 30, 4,
+		{"O..O.",
+		"....O",
+		"O...O",
+		".OOOO"}},
+	/**база глайдеров*/
+	{L"база глайдеров", 26, 28, 9,
+		{"...OOOO...",
+		"..........",
+		".OOOOOOOO.",
+		"..........",
+		"OOOOOOOOOO",
+		"..........",
+		".OOOOOOOO.",
+		"..........",
+		"...OOOO..."}},
+	/**пентаполе*/
+	{L"пентаполе", 26, 28, 8,
+		{"OO......",
+		"O.......",
+		".O.O....",
+		"........",
+		"...O.O..",
+		"........",
+		".....O.O",
+		"......OO"}},
+	/**феникс*/
+	{L"феникс", 26, 28, 8,
+		{"...O....",
+		"...O.O..",
+		".O......",
+		"......OO",
+		"OO......",
+		"......O.",
+		"..O.O...",
+		"....O..."}},
+	/**часы*/
+	{L"часы", 24, 26, 12,
+		{"......OO....",
+		"......OO....",
+		"............",
+		"....OOOO....",
+		"OO.O..O.O...",
+		"OO.O.O..O...",
+		"...O.O..O.OO",
+		"...O....O.OO",
+		"....OOOO....",
+		"............",
+		"....OO......",
+		"....OO......"}},
+	/**бриллиант*/
+	{L"бриллиант", 23, 25, 13,
+		{"......O......",
+		".....O.O.....",
+		"....O.O.O....",
+		"....O...O....",
+		"..OO..O..OO..",
+		".O....O....O.",
+		"O.O.OO.OO.O.O",
+		".O....O....O.",
+		"..OO..O..OO..",
+		"....O...O....",
+		"....O.O.O....",
+		".....O.O.....",
+		"......O......"}},
+	/**звезда*/
+	{L"звезда", 24, 26, 11,
+		{".....O.....",
+		"....OOO....",
+		"..OOO.OOO..",
+		"..O.....O..",
+		".OO.....OO.",
+		"OO.......OO",
+		".OO.....OO.",
+		"..O.....O..",
+		"..OOO.OOO..",
+		"....OOO....",
+		".....O....."}},
+	/**галактика*/
+	{L"галактика", 25, 27, 9,
+		{"OOOOOO.OO",
+		"OOOOOO.OO",
+		".......OO",
+		"OO.....OO",
+		"OO.....OO",
+		"OO.....OO",
+		"OO.......",
+		"OO.OOOOOO",
+		"OO.OOOOOO"}},
+	/**тумблер*/
+	{L"тумблер", 26, 27, 5,
+		{"..OO.OO..",
+		".........",
+		"...O.O...",
+		"OO.O.O.OO",
+		"OOO...OOO"}},
+	/**лилия*/
+	{L"лилия", 24, 26, 11,
+		{".....O.....",
+		"....O.O....",
+		"...O.O.O...",
+		"...O.O.O...",
+		"OO.OOOOO.OO",
+		"O.O.....O.O",
+		"...OOOOO...",
+		"...........",
+		".....O.....",
+		"....O.O....",
+		".....O....."}},
+	/**R2-D2*/
+	{L"R2-D2", 24, 28, 11,
+		{"...OO...",
+		"...OO...",
+		"........",
+		".OOOOOO.",
+		"O......O",
+		"OO..OOOO",
+		"........",
+		"OOOOOOOO",
+		"O......O",
+		"...OO...",
+		"...OO..."}}
+};
@@ -0,0 +1,32 @@
+﻿/**
+ *\file library.h
+ *\version 1.0
+ *\date October 2026
+ *\details Библиотека стандартных колоний из окна "фигуры". Колония задана строками
+ * ('O' - бактерия, '.' - вода) и положением левого верхнего угла в водоёме MH x MW.
+ */
+
+#pragma once
+
+/**Количество колоний в библиотеке*/
+#define LIBRARY_SIZE 12
+/**Наибольшее количество строк колонии*/
+#define LIBRARY_ROWS 13
+
+/**
+ *\struct libPattern
+ *\details Колония из библиотеки
+*/
+struct libPattern
+{
+	/**название колонии*/
+	const wchar_t* name;
+	/**строка и столбец левого верхнего угла при выводе из окна "фигуры"*/
+	int top, left;
+	/**количество строк*/
+	int h;
+	/**строки колонии*/
+	const char* rows[LIBRARY_ROWS];
+};
+
+extern const libPattern library[LIBRARY_SIZE];
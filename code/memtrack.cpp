@@ -0,0 +1,229 @@
+﻿/**
+ *\file memtrack.cpp
+ *\version 1.0
+ *\date October 2026
+ *\details Счётчики памяти частей программы, бюджеты и выгрузка сводки
+ */
+
+#include "memtrack.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+using namespace std;
+
+/**Текущий и наибольший объём частей и всей программы (последний элемент)*/
+static atomic<uint64_t> current[MEM_KINDS + 1], peak[MEM_KINDS + 1], budget[MEM_KINDS + 1];
+
+/**Имена частей в сводке и в ключе budget=*/
+static const char* names[MEM_KINDS + 1] = {"grid", "second", "history", "render", "textures", "cache", "total"};
+
+/**
+ *\param kind часть (MEM_GRID..MEM_TOTAL)
+ *\return имя части
+*/
+const char* memName(int kind)
+{
+	return names[kind];
+}
+
+/**
+ *\param slot счётчик
+ *\param now  новый объём
+ *\details Наибольший объём поднимается до now, если он меньше
+*/
+static void raisePeak(int slot, uint64_t now)
+{
+	uint64_t was = peak[slot].load(memory_order_relaxed);
+	while (was < now && !peak[slot].compare_exchange_weak(was, now, memory_order_relaxed))
+	{
+	}
+}
+
+/**
+ *\param kind  часть (MEM_GRID..MEM_CACHE)
+ *\param bytes изменение объёма: положительное - выделение, отрицательное - освобождение
+*/
+void memAdd(int kind, int64_t bytes)
+{
+	uint64_t part = current[kind].fetch_add((uint64_t)bytes, memory_order_relaxed) + (uint64_t)bytes;
+	uint64_t total = current[MEM_TOTAL].fetch_add((uint64_t)bytes, memory_order_relaxed) + (uint64_t)bytes;
+	if (bytes > 0)
+	{
+		raisePeak(kind, part);
+		raisePeak(MEM_TOTAL, total);
+	}
+}
+
+/**
+ *\param kind      часть
+ *\param accounted объём, учтённый за владельцем раньше; становится равным bytes
+ *\param bytes     объём, занимаемый владельцем сейчас
+ *\details Учёт владельца, размер которого удобнее пересчитать, чем отслеживать изменения
+*/
+void memAccount(int kind, uint64_t& accounted, uint64_t bytes)
+{
+	if (bytes != accounted)
+	{
+		memAdd(kind, (int64_t)bytes - (int64_t)accounted);
+		accounted = bytes;
+	}
+}
+
+/**
+ *\param kind часть
+ *\return сколько байт части можно добавить в пределах её бюджета и бюджета всей программы
+*/
+uint64_t memRoom(int kind)
+{
+	uint64_t room = UINT64_MAX;
+	for (int slot : {kind, MEM_TOTAL})
+	{
+		uint64_t b = budget[slot].load(memory_order_relaxed), c = current[slot].load(memory_order_relaxed);
+		if (b != 0)
+		{
+			room = min(room, b > c ? b - c : 0);
+		}
+	}
+	return room;
+}
+
+/**
+ *\param kind  часть
+ *\param bytes сколько байт части нужно добавить
+ *\return true, если добавление укладывается в бюджеты; сам объём не меняется
+*/
+bool memFits(int kind, uint64_t bytes)
+{
+	return bytes <= memRoom(kind);
+}
+
+/**
+ *\param kind часть
+ *\return true, если часть или вся программа вышли за бюджет - пора освобождать кэши
+*/
+bool memOver(int kind)
+{
+	for (int slot : {kind, MEM_TOTAL})
+	{
+		uint64_t b = budget[slot].load(memory_order_relaxed);
+		if (b != 0 && current[slot].load(memory_order_relaxed) > b)
+		{
+			return true;
+		}
+	}
+	return false;
+}
+
+/**
+ *\param kind  часть или MEM_TOTAL
+ *\param bytes бюджет в байтах (0 - без ограничения)
+*/
+void memBudget(int kind, uint64_t bytes)
+{
+	budget[kind].store(bytes, memory_order_relaxed);
+}
+
+/**
+ *\param spec бюджеты вида "total:1G,history:16M,cache:64M" (суффиксы K, M, G)
+ *\return false, если в записи есть неизвестная часть или неверное число
+*/
+bool memBudgets(const string& spec)
+{
+	size_t pos = 0;
+	while (pos < spec.size())
+	{
+		size_t end = spec.find(',', pos);
+		string item = spec.substr(pos, end == string::npos ? string::npos : end - pos);
+		pos = end == string::npos ? spec.size() : end + 1;
+		size_t colon = item.find(':');
+		if (colon == string::npos)
+		{
+			return false;
+		}
+		int kind = 0;
+		while (kind <= MEM_TOTAL && item.compare(0, colon, names[kind]) != 0)
+		{
+			kind++;
+		}
+		char* tail = nullptr;
+		double value = strtod(item.c_str() + colon + 1, &tail);
+		if (kind > MEM_TOTAL || tail == item.c_str() + colon + 1 || value < 0)
+		{
+			return false;
+		}
+		const char* units = "KMG";
+		const char* u = *tail != 0 ? strchr(units, *tail) : nullptr;
+		if (*tail != 0 && (u == nullptr || tail[1] != 0))
+		{
+			return false;
+		}
+		for (int k = 0; u != nullptr && k <= u - units; k++)
+		{
+			value *= 1024;
+		}
+		memBudget(kind, (uint64_t)value);
+	}
+	return true;
+}
+
+/**
+ *\param kind часть или MEM_TOTAL
+ *\return текущий и наибольший объём и бюджет
+*/
+memUsage memInfo(int kind)
+{
+	return {current[kind].load(memory_order_relaxed), peak[kind].load(memory_order_relaxed),
+		budget[kind].load(memory_order_relaxed)};
+}
+
+/**
+ *\return сводка для наложения: объём занятых частей и всей программы в мегабайтах
+*/
+string memText()
+{
+	string text;
+	char buf[128];
+	for (int kind = 0; kind <= MEM_TOTAL; kind++)
+	{
+		memUsage u = memInfo(kind);
+		if (u.peak == 0 && kind != MEM_TOTAL)
+		{
+			continue;
+		}
+		int n = snprintf(buf, sizeof(buf), "%s %.2f MB (peak %.2f", names[kind], u.current / 1048576.0, u.peak / 1048576.0);
+		if (u.budget != 0)
+		{
+			n += snprintf(buf + n, sizeof(buf) - n, ", budget %.0f", u.budget / 1048576.0);
+		}
+		snprintf(buf + n, sizeof(buf) - n, ")\n");
+		text += buf;
+	}
+	return text;
+}
+
+/**
+ *\param path файл CSV
+ *\param note первая строка-комментарий (например, размеры водоёма)
+ *\return false, если файл не записался
+ *\details Сводка по частям: имя, текущий и наибольший объём, бюджет в байтах
+*/
+bool memExport(const char* path, const string& note)
+{
+	FILE* f = fopen(path, "w");
+	if (f == nullptr)
+	{
+		return false;
+	}
+	fprintf(f, "# %s\npart,current,peak,budget\n", note.c_str());
+	for (int kind = 0; kind <= MEM_TOTAL; kind++)
+	{
+		memUsage u = memInfo(kind);
+		fprintf(f, "%s,%llu,%llu,%llu\n", names[kind], (unsigned long long)u.current, (unsigned long long)u.peak,
+			(unsigned long long)u.budget);
+	}
+	return fclose(f) == 0;
+}
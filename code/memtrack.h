@@ -0,0 +1,53 @@
+﻿/**
+ *\file memtrack.h
+ *\version 1.0
+ *\date October 2026
+ *\details Учёт памяти по частям программы: водоём, второй водоём, журнал отмены, буферы
+ * вывода, текстуры и кэши. Для каждой части и для всей программы хранятся текущий и
+ * наибольший объём и бюджет. Кэши при превышении бюджета освобождаются, а водоём, которому
+ * не хватает бюджета, не создаётся и не растёт - до того, как систему исчерпает память.
+ * Счётчики атомарны, учитывать память можно из любого потока.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <string>
+
+/**Водоём (матрица, битовые плоскости или файл плиток)*/
+#define MEM_GRID 0
+/**Второй водоём для способов вычисления с двумя водоёмами*/
+#define MEM_SECOND 1
+/**Журнал отмены правок*/
+#define MEM_HISTORY 2
+/**Буферы вывода: упакованная копия, видимая часть, очередь кадров записи*/
+#define MEM_RENDER 3
+/**Текстуры окна*/
+#define MEM_TEXTURES 4
+/**Кэши: пул освобождённых участков, память шагов плиток*/
+#define MEM_CACHE 5
+/**Количество частей*/
+#define MEM_KINDS 6
+/**Вся программа (сумма частей)*/
+#define MEM_TOTAL MEM_KINDS
+
+/**
+ *\struct memUsage
+ *\details Текущий и наибольший объём части и её бюджет (0 - без ограничения), в байтах
+*/
+struct memUsage
+{
+	uint64_t current, peak, budget;
+};
+
+const char* memName(int kind);
+void memAdd(int kind, int64_t bytes);
+void memAccount(int kind, uint64_t& accounted, uint64_t bytes);
+bool memFits(int kind, uint64_t bytes);
+bool memOver(int kind);
+uint64_t memRoom(int kind);
+void memBudget(int kind, uint64_t bytes);
+bool memBudgets(const std::string& spec);
+memUsage memInfo(int kind);
+std::string memText();
+bool memExport(const char* path, const std::string& note);
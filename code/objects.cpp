@@ -0,0 +1,409 @@
+﻿/**
+ *\file objects.cpp
+ *\version 1.0
+ *\date October 2026
+ *\details Разметка связных компонент по отрезкам живых клеток и слежение за объектами
+ */
+
+#include "objects.h"
+#include "profile.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+
+using namespace std;
+
+/**Сторона корзины поиска объектов предыдущего поколения*/
+#define OBJ_BUCKET 8
+
+/**
+ *\param p массив предков системы непересекающихся множеств
+ *\param x элемент
+ *\return представитель множества элемента (с сокращением путей)
+*/
+static int find(vector<int>& p, int x)
+{
+	while (p[x] != x)
+	{
+		p[x] = p[p[x]];
+		x = p[x];
+	}
+	return x;
+}
+
+/**
+ *\param p массив предков
+ *\param a, b объединяемые элементы; представителем становится меньший
+*/
+static void unite(vector<int>& p, int a, int b)
+{
+	a = find(p, a);
+	b = find(p, b);
+	if (a != b)
+	{
+		p[max(a, b)] = min(a, b);
+	}
+}
+
+/**
+ *\param x, y отрезки
+ *\param d    расстояние объединения
+ *\return true, если какие-то клетки отрезков удалены не более чем на d по каждой координате
+*/
+static bool near(const objRun& x, const objRun& y, int d)
+{
+	return abs(x.row - y.row) <= d && max(x.a, y.a) - min(x.b, y.b) <= d;
+}
+
+/**
+ *\param s сводка, дополняемая другой сводкой
+ *\param o добавляемая сводка
+*/
+static void addStat(objStat& s, const objStat& o)
+{
+	if (s.cells == 0)
+	{
+		s = o;
+		return;
+	}
+	s.cells += o.cells;
+	s.i0 = min(s.i0, o.i0);
+	s.j0 = min(s.j0, o.j0);
+	s.i1 = max(s.i1, o.i1);
+	s.j1 = max(s.j1, o.j1);
+	s.sumI += o.sumI;
+	s.sumJ += o.sumJ;
+}
+
+/**
+ *\param t  слежение
+ *\param h  количество строк водоёма
+ *\param w  количество столбцов водоёма
+ *\param dist расстояние объединения клеток в объект (1 - восьмисвязность, не больше OBJ_MAX_DIST)
+*/
+void trackerInit(objectTracker& t, int h, int w, int dist)
+{
+	t.h = h;
+	t.w = w;
+	t.words = (w + 63) / 64;
+	t.dist = max(1, min(dist, OBJ_MAX_DIST));
+	t.tilesY = (h + OBJ_TILE - 1) / OBJ_TILE;
+	t.tilesX = t.words;
+	t.prev.assign((size_t)h * t.words, 0);
+	t.tiles.assign((size_t)t.tilesY * t.tilesX, objTile());
+	t.objects.clear();
+	t.nextId = 1;
+	t.gliders = 0;
+	t.relabeled = 0;
+}
+
+/**
+ *\param t  слежение
+ *\param g  водоём (живые клетки - plane[0])
+ *\param ty строка плиток
+ *\param tx столбец плиток (номер слова в строке)
+ *\details Разметка плитки: отрезки единичных битов каждого слова, объединение отрезков
+ * соседних строк внутри плитки, сводки компонент и отрезки у границ.
+*/
+static void labelTile(objectTracker& t, const planeGrid& g, int ty, int tx)
+{
+	objTile& T = t.tiles[(size_t)ty * t.tilesX + tx];
+	T.runs.clear();
+	T.border.clear();
+	T.stats.clear();
+	int r0 = ty * OBJ_TILE, r1 = min(t.h, r0 + OBJ_TILE);
+	int c0 = tx * 64, c1 = c0 + 63;
+	/**начало отрезков каждой строки плитки*/
+	int rowStart[OBJ_TILE + 1];
+	for (int r = r0; r < r1; r++)
+	{
+		rowStart[r - r0] = (int)T.runs.size();
+		uint64_t v = g.plane[0][(size_t)r * g.words + tx];
+		while (v)
+		{
+			int a = lowBit(v);
+			uint64_t rest = ~(v >> a);
+			int len = rest ? lowBit(rest) : 64 - a;
+			T.runs.push_back({r, c0 + a, c0 + a + len - 1, 0});
+			v = a + len >= 64 ? 0 : v & (~0ull << (a + len));
+		}
+	}
+	rowStart[r1 - r0] = (int)T.runs.size();
+	int n = (int)T.runs.size();
+	if (n == 0)
+	{
+		return;
+	}
+	vector<int> parent(n);
+	for (int q = 0; q < n; q++)
+	{
+		parent[q] = q;
+	}
+	int d = t.dist;
+	for (int r = r0; r < r1; r++)
+	{
+		/**отрезки строки упорядочены по столбцам, поэтому в каждой из предыдущих d строк
+		 просмотр начинается с указателя, который только сдвигается вправо*/
+		int ptr[OBJ_MAX_DIST];
+		for (int k = 1; k <= d && r - k >= r0; k++)
+		{
+			ptr[k - 1] = rowStart[r - k - r0];
+		}
+		for (int q = rowStart[r - r0]; q < rowStart[r - r0 + 1]; q++)
+		{
+			const objRun& x = T.runs[q];
+			for (int p = q - 1; p >= rowStart[r - r0] && x.a - T.runs[p].b <= d; p--)
+			{
+				unite(parent, p, q);
+			}
+			for (int k = 1; k <= d && r - k >= r0; k++)
+			{
+				int end = rowStart[r - k - r0 + 1];
+				int& p = ptr[k - 1];
+				while (p < end && T.runs[p].b + d < x.a)
+				{
+					p++;
+				}
+				for (int z = p; z < end && T.runs[z].a - d <= x.b; z++)
+				{
+					unite(parent, z, q);
+				}
+			}
+		}
+	}
+	vector<int> compOf(n, -1);
+	for (int q = 0; q < n; q++)
+	{
+		int root = find(parent, q);
+		if (compOf[root] < 0)
+		{
+			compOf[root] = (int)T.stats.size();
+			T.stats.push_back(objStat());
+			T.stats.back().cells = 0;
+		}
+		objRun& x = T.runs[q];
+		x.comp = compOf[root];
+		int len = x.b - x.a + 1;
+		objStat s = {len, x.row, x.a, x.row, x.b, (double)x.row * len, (x.a + x.b) * 0.5 * len};
+		addStat(T.stats[x.comp], s);
+		if (x.row - r0 < d || r1 - 1 - x.row < d || x.a - c0 < d || c1 - x.b < d)
+		{
+			T.border.push_back(x);
+		}
+	}
+}
+
+/**
+ *\param t слежение
+ *\param objs объекты нового поколения (без номеров)
+ *\details Сопоставление объектов нового поколения с объектами предыдущего. Для каждого нового
+ * объекта выбирается ближайший предыдущий с близким центром и пересекающимся (с запасом 2 клетки)
+ * прямоугольником; цена - расстояние между центрами и разница количеств клеток. Если предыдущий
+ * объект выбран несколькими новыми, он достаётся самому дешёвому. Сопоставленный объект
+ * сохраняет номер, остальные получают новые.
+*/
+static void match(objectTracker& t, vector<objectInfo>& objs)
+{
+	const vector<objectInfo>& old = t.objects;
+	/**предыдущие объекты по корзинам OBJ_BUCKET x OBJ_BUCKET по положению центра,
+	 корзины хранятся подряд: first[b]..first[b + 1] - объекты корзины b в массиве box*/
+	int by = t.h / OBJ_BUCKET + 1, bx = t.w / OBJ_BUCKET + 1;
+	vector<int> first((size_t)by * bx + 1, 0);
+	for (const objectInfo& o : old)
+	{
+		first[(size_t)((int)o.ci / OBJ_BUCKET) * bx + (int)o.cj / OBJ_BUCKET + 1]++;
+	}
+	for (size_t b = 1; b < first.size(); b++)
+	{
+		first[b] += first[b - 1];
+	}
+	/**копия прямоугольников и центров подряд по корзинам - просмотр корзины идёт по памяти подряд*/
+	struct box
+	{
+		int i0, j0, i1, j1, cells, k;
+		double ci, cj;
+	};
+	vector<box> boxes(old.size());
+	vector<int> fill(first.begin(), first.end() - 1);
+	for (int k = 0; k < (int)old.size(); k++)
+	{
+		const objectInfo& o = old[k];
+		boxes[fill[(size_t)((int)o.ci / OBJ_BUCKET) * bx + (int)o.cj / OBJ_BUCKET]++] =
+			{o.stat.i0, o.stat.j0, o.stat.i1, o.stat.j1, o.stat.cells, k, o.ci, o.cj};
+	}
+	vector<int> best(objs.size(), -1);
+	vector<double> bestCost(objs.size());
+	for (int n = 0; n < (int)objs.size(); n++)
+	{
+		const objectInfo& o = objs[n];
+		int bi = (int)o.ci / OBJ_BUCKET, bj = (int)o.cj / OBJ_BUCKET;
+		for (int i = max(0, bi - 1); i <= min(by - 1, bi + 1); i++)
+		{
+			size_t b = (size_t)i * bx;
+			for (int z = first[b + max(0, bj - 1)]; z < first[b + min(bx - 1, bj + 1) + 1]; z++)
+			{
+				const box& a = boxes[z];
+				if (a.i0 - 2 > o.stat.i1 || o.stat.i0 > a.i1 + 2 || a.j0 - 2 > o.stat.j1 || o.stat.j0 > a.j1 + 2)
+				{
+					continue;
+				}
+				double cost = fabs(a.ci - o.ci) + fabs(a.cj - o.cj) + 0.1 * abs(a.cells - o.stat.cells);
+				if (best[n] < 0 || cost < bestCost[n])
+				{
+					best[n] = a.k;
+					bestCost[n] = cost;
+				}
+			}
+		}
+	}
+	/**владелец каждого предыдущего объекта - самый дешёвый из выбравших его новых*/
+	vector<int> owner(old.size(), -1);
+	for (int n = 0; n < (int)objs.size(); n++)
+	{
+		int k = best[n];
+		if (k >= 0 && (owner[k] < 0 || bestCost[n] < bestCost[owner[k]]))
+		{
+			owner[k] = n;
+		}
+	}
+	for (int n = 0; n < (int)objs.size(); n++)
+	{
+		objectInfo& o = objs[n];
+		int k = best[n];
+		if (k < 0 || owner[k] != n)
+		{
+			o.id = t.nextId++;
+			o.trailI[0] = o.ci;
+			o.trailJ[0] = o.cj;
+			continue;
+		}
+		const objectInfo& a = old[k];
+		o.id = a.id;
+		o.age = a.age + 1;
+		memcpy(o.trailI, a.trailI, sizeof(o.trailI));
+		memcpy(o.trailJ, a.trailJ, sizeof(o.trailJ));
+		/**в ячейке age % 4 лежит центр четыре поколения назад*/
+		int slot = o.age % 4;
+		if (o.age >= 4)
+		{
+			o.vi = (o.ci - o.trailI[slot]) / 4;
+			o.vj = (o.cj - o.trailJ[slot]) / 4;
+		}
+		o.trailI[slot] = o.ci;
+		o.trailJ[slot] = o.cj;
+	}
+}
+
+/**
+ *\param t слежение
+ *\param g водоём того же размера, что при trackerInit (живые клетки - plane[0])
+ *\details Обновление после очередного поколения: повторная разметка изменившихся плиток,
+ * объединение компонент через границы плиток, сопоставление объектов с предыдущим поколением.
+ * Планер - объект из 5 клеток в квадрате 3x3, сместившийся за 4 поколения на клетку по диагонали.
+*/
+void trackerUpdate(objectTracker& t, const planeGrid& g)
+{
+	PROFILE_SCOPE("trackerUpdate");
+	t.relabeled = 0;
+	for (int ty = 0; ty < t.tilesY; ty++)
+	{
+		int r0 = ty * OBJ_TILE, r1 = min(t.h, r0 + OBJ_TILE);
+		for (int tx = 0; tx < t.tilesX; tx++)
+		{
+			bool changed = false;
+			for (int r = r0; r < r1; r++)
+			{
+				size_t k = (size_t)r * t.words + tx;
+				if (t.prev[k] != g.plane[0][k])
+				{
+					t.prev[k] = g.plane[0][k];
+					changed = true;
+				}
+			}
+			if (changed)
+			{
+				labelTile(t, g, ty, tx);
+				t.relabeled++;
+			}
+		}
+	}
+	/**узлы - компоненты плиток, пронумерованные подряд*/
+	vector<int> offset(t.tiles.size() + 1, 0);
+	for (size_t k = 0; k < t.tiles.size(); k++)
+	{
+		offset[k + 1] = offset[k] + (int)t.tiles[k].stats.size();
+	}
+	vector<int> parent(offset.back());
+	for (int q = 0; q < (int)parent.size(); q++)
+	{
+		parent[q] = q;
+	}
+	/**соседи справа, снизу слева, снизу и снизу справа*/
+	const int nb[4][2] = {{0, 1}, {1, -1}, {1, 0}, {1, 1}};
+	for (int ty = 0; ty < t.tilesY; ty++)
+	{
+		for (int tx = 0; tx < t.tilesX; tx++)
+		{
+			size_t a = (size_t)ty * t.tilesX + tx;
+			if (t.tiles[a].border.empty())
+			{
+				continue;
+			}
+			for (int k = 0; k < 4; k++)
+			{
+				int y = ty + nb[k][0], x = tx + nb[k][1];
+				if (y >= t.tilesY || x < 0 || x >= t.tilesX)
+				{
+					continue;
+				}
+				size_t b = (size_t)y * t.tilesX + x;
+				for (const objRun& p : t.tiles[a].border)
+				{
+					for (const objRun& q : t.tiles[b].border)
+					{
+						if (near(p, q, t.dist))
+						{
+							unite(parent, offset[a] + p.comp, offset[b] + q.comp);
+						}
+					}
+				}
+			}
+		}
+	}
+	vector<objectInfo> objs;
+	vector<int> objOf(parent.size(), -1);
+	for (size_t k = 0; k < t.tiles.size(); k++)
+	{
+		for (int c = 0; c < (int)t.tiles[k].stats.size(); c++)
+		{
+			int root = find(parent, offset[k] + c);
+			if (objOf[root] < 0)
+			{
+				objOf[root] = (int)objs.size();
+				objectInfo o;
+				memset(&o, 0, sizeof(o));
+				objs.push_back(o);
+			}
+			addStat(objs[objOf[root]].stat, t.tiles[k].stats[c]);
+		}
+	}
+	for (objectInfo& o : objs)
+	{
+		o.ci = o.stat.sumI / o.stat.cells;
+		o.cj = o.stat.sumJ / o.stat.cells;
+	}
+	match(t, objs);
+	t.gliders = 0;
+	for (objectInfo& o : objs)
+	{
+		o.glider = o.stat.cells == 5 && o.stat.i1 - o.stat.i0 == 2 && o.stat.j1 - o.stat.j0 == 2 && o.age >= 4 &&
+			fabs(fabs(o.vi) - 0.25) < 1e-9 && fabs(fabs(o.vj) - 0.25) < 1e-9;
+		if (o.glider)
+		{
+			t.gliders++;
+		}
+	}
+	t.objects.swap(objs);
+}
@@ -0,0 +1,102 @@
+﻿/**
+ *\file objects.h
+ *\version 1.0
+ *\date October 2026
+ *\details Выделение объектов (связных компонент живых клеток) и слежение за ними между поколениями.
+ * Водоём делится на плитки OBJ_TILE x OBJ_TILE; в каждой плитке отрезки живых клеток из
+ * упакованных слов объединяются системой непересекающихся множеств. Плитки, в которых
+ * клетки не изменились, повторно не размечаются; затем компоненты соседних плиток
+ * объединяются по отрезкам у границ.
+ */
+
+#pragma once
+
+#include "rules.h"
+
+#include <cstdint>
+#include <vector>
+
+/**Сторона плитки разметки (одно 64-битное слово строки)*/
+#define OBJ_TILE 64
+/**Наибольшее расстояние объединения клеток в один объект*/
+#define OBJ_MAX_DIST 16
+
+/**
+ *\struct objRun
+ *\details Отрезок живых клеток строки: столбцы a..b включительно
+*/
+struct objRun
+{
+	int row, a, b;
+	/**номер компоненты внутри плитки*/
+	int comp;
+};
+
+/**
+ *\struct objStat
+ *\details Сводка компоненты: количество клеток, ограничивающий прямоугольник, суммы координат
+*/
+struct objStat
+{
+	int cells;
+	int i0, j0, i1, j1;
+	double sumI, sumJ;
+};
+
+/**
+ *\struct objTile
+ *\details Разметка одной плитки, сохраняемая до изменения клеток плитки
+*/
+struct objTile
+{
+	std::vector<objRun> runs;
+	/**отрезки на расстоянии не больше dist от края плитки*/
+	std::vector<objRun> border;
+	std::vector<objStat> stats;
+};
+
+/**
+ *\struct objectInfo
+ *\details Объект, за которым ведётся слежение
+*/
+struct objectInfo
+{
+	/**номер объекта, сохраняющийся между поколениями*/
+	int id;
+	/**количество поколений, в течение которых объект прослежен*/
+	int age;
+	objStat stat;
+	/**центр объекта*/
+	double ci, cj;
+	/**скорость центра в клетках за поколение (по последним 4 поколениям)*/
+	double vi, vj;
+	/**центры за последние 4 поколения*/
+	double trailI[4], trailJ[4];
+	/**объект - планер*/
+	bool glider;
+};
+
+/**
+ *\struct objectTracker
+ *\details Разметка водоёма и список прослеживаемых объектов
+*/
+struct objectTracker
+{
+	/**размеры водоёма и количество слов в строке*/
+	int h, w, words;
+	/**клетки на расстоянии не больше dist (по каждой координате) принадлежат одному объекту*/
+	int dist;
+	int tilesY, tilesX;
+	/**клетки при предыдущей разметке*/
+	std::vector<uint64_t> prev;
+	std::vector<objTile> tiles;
+	std::vector<objectInfo> objects;
+	int nextId;
+	/**количество планеров*/
+	int gliders;
+	/**количество плиток, размеченных заново при последнем обновлении*/
+	int relabeled;
+};
+
+void trackerInit(objectTracker& t, int h, int w, int dist);
+void trackerUpdate(objectTracker& t, const planeGrid& g);
@@ -0,0 +1,32 @@
+﻿/**
+ *\file options.cpp
+ *\version 1.0
+ *\date October 2026
+ *\details Разбор параметров командной строки вида ключ=значение
+ */
+
+#include "options.h"
+
+#include <cstring>
+
+using namespace std;
+
+/**
+ *\param argc количество параметров
+ *\param argv параметры
+ *\param key  имя параметра
+ *\param def  значение по умолчанию
+ *\return значение параметра вида key=значение
+*/
+string option(int argc, char* argv[], const char* key, const char* def)
+{
+	size_t n = strlen(key);
+	for (int i = 0; i < argc; i++)
+	{
+		if (strncmp(argv[i], key, n) == 0 && argv[i][n] == '=')
+		{
+			return argv[i] + n + 1;
+		}
+	}
+	return def;
+}
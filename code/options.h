@@ -0,0 +1,12 @@
+﻿/**
+ *\file options.h
+ *\version 1.0
+ *\date October 2026
+ *\details Разбор параметров командной строки вида ключ=значение
+ */
+
+#pragma once
+
+#include <string>
+
+std::string option(int argc, char* argv[], const char* key, const char* def);
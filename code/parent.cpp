@@ -0,0 +1,582 @@
+﻿/**
+ *\file parent.cpp
+ *\version 1.0
+ *\date October 2026
+ *\details Поиск родителей колонии: автомат строки, дерево строк с таблицей тупиков
+ * и раздача ветвей пулу потоков
+ */
+
+#include "parent.h"
+#include "edit.h"
+#include "library.h"
+#include "memtrack.h"
+#include "options.h"
+#include "profile.h"
+#include "thumbs.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <mutex>
+#include <random>
+#include <unordered_set>
+
+using namespace std;
+
+/**
+ *\param q    запрос
+ *\param h, w размеры колонии
+ *\param words слов в строке колонии
+ *\param bits строки колонии (бит j слова j / 64 - клетка столбца j)
+ *\param r    правило (двух состояний, окрестность Мура)
+ *\param ring колония окружается мёртвыми клетками: родитель должен дать и пустое окаймление
+ *\return false, если правило не подходит или колония больше PARENT_SIDE x PARENT_LONG клеток
+ *\details Колония поворачивается так, чтобы строки шли вдоль меньшей стороны (правило не
+ * зависит от направления соседей), и строятся таблицы автомата строки.
+*/
+bool parentPrepare(parentQuery& q, int h, int w, int words, const vector<uint64_t>& bits, const rule& r, bool ring)
+{
+	if (r.family != RULE_GENERATIONS || r.states != 2 || r.radius != 1 || h < 1 || w < 1)
+	{
+		return false;
+	}
+	int b = ring ? 1 : 0;
+	int th = h + 2 * b, tw = w + 2 * b;
+	q.transposed = tw > th;
+	q.h = q.transposed ? tw : th;
+	q.w = q.transposed ? th : tw;
+	if (q.w > PARENT_SIDE || q.h > PARENT_LONG)
+	{
+		return false;
+	}
+	q.target.assign(q.h, 0);
+	for (int i = 0; i < h; i++)
+	{
+		for (int j = 0; j < w; j++)
+		{
+			if ((bits[(size_t)i * words + j / 64] >> (j % 64)) & 1)
+			{
+				int ti = i + b, tj = j + b;
+				if (q.transposed)
+				{
+					swap(ti, tj);
+				}
+				q.target[ti] |= 1u << tj;
+			}
+		}
+	}
+	for (int idx = 0; idx < 512; idx++)
+	{
+		int n = 0;
+		for (int k = 0; k < 9; k++)
+		{
+			n += k != 4 && ((idx >> k) & 1);
+		}
+		q.next[idx] = (uint8_t)((((idx >> 4) & 1) ? r.survive : r.birth) >> n & 1);
+	}
+	for (int idx6 = 0; idx6 < 64; idx6++)
+	{
+		for (int t = 0; t < 2; t++)
+		{
+			uint8_t allow = 0;
+			for (int s = 0; s < 4; s++)
+			{
+				for (int x = 0; x < 2; x++)
+				{
+					if (q.next[idx6 | (s | x << 2) << 6] == t)
+					{
+						allow |= (uint8_t)(1 << (s * 2 + x));
+					}
+				}
+			}
+			q.allow[idx6][t] = allow;
+			for (int g = 0; g < 16; g++)
+			{
+				uint8_t from = 0;
+				for (int s = 0; s < 4; s++)
+				{
+					for (int x = 0; x < 2; x++)
+					{
+						if (((allow >> (s * 2 + x)) & 1) && ((g >> ((s >> 1) | x << 1)) & 1))
+						{
+							from |= (uint8_t)(1 << s);
+						}
+					}
+				}
+				q.reach[idx6][t][g] = from;
+			}
+		}
+	}
+	return true;
+}
+
+/**
+ *\param q     запрос
+ *\param width клеток в строке родителя
+ *\param a, b  две предыдущие строки родителя
+ *\param t     строка колонии под строкой b
+ *\param visit вызывается для каждой подходящей строки; false - прекратить перебор
+ *\details Перебор строк c, при которых строки a, b, c дают строку колонии t. Состояние
+ * автомата после столбца k - клетки k - 1 и k строки c. Проход справа налево находит для
+ * каждого столбца состояния, из которых строка достраивается (одно обращение к таблице
+ * reach на столбец), поэтому перебор слева направо не заходит в тупики.
+*/
+template <class F> static void rowsAfter(const parentQuery& q, int width, uint32_t a, uint32_t b, uint32_t t, F& visit)
+{
+	uint8_t idx[PARENT_SIDE + 2], tb[PARENT_SIDE + 2], good[PARENT_SIDE + 2];
+	good[width - 1] = 15;
+	for (int k = width - 2; k >= 1; k--)
+	{
+		idx[k] = (uint8_t)(((a >> (k - 1)) & 7) | ((b >> (k - 1)) & 7) << 3);
+		tb[k] = (uint8_t)((t >> (k - 1)) & 1);
+		good[k] = q.reach[idx[k]][tb[k]][good[k + 1]];
+	}
+	/**на шаге k ставится клетка k + 1; choice - следующая пробуемая клетка (2 - обе испробованы)*/
+	uint32_t row[PARENT_SIDE + 2];
+	int state[PARENT_SIDE + 2], choice[PARENT_SIDE + 2];
+	for (int s0 = 0; s0 < 4; s0++)
+	{
+		if (((good[1] >> s0) & 1) == 0)
+		{
+			continue;
+		}
+		int k = 1;
+		state[1] = s0;
+		row[1] = (uint32_t)s0;
+		choice[1] = 0;
+		while (k >= 1)
+		{
+			if (k == width - 1)
+			{
+				if (!visit(row[k]))
+				{
+					return;
+				}
+				k--;
+				continue;
+			}
+			if (choice[k] == 2)
+			{
+				k--;
+				continue;
+			}
+			int x = choice[k]++, s = state[k], s1 = (s >> 1) | x << 1;
+			if (((q.allow[idx[k]][tb[k]] >> (s * 2 + x)) & 1) && ((good[k + 1] >> s1) & 1))
+			{
+				state[k + 1] = s1;
+				row[k + 1] = row[k] | (uint32_t)x << (k + 1);
+				choice[k + 1] = 0;
+				k++;
+			}
+		}
+	}
+}
+
+/**
+ *\struct parentStripe
+ *\details Часть таблицы тупиков: пары строк (a | b << 32), после которых родитель не достраивается
+*/
+struct parentStripe
+{
+	mutex m;
+	unordered_set<uint64_t> dead;
+};
+
+/**
+ *\struct parentContext
+ *\details Общее состояние поиска
+*/
+struct parentContext
+{
+	const parentQuery* q;
+	workPool* pool;
+	/**строк родителя и клеток в строке*/
+	int rows, width;
+	uint64_t limit;
+	bool timed;
+	chrono::steady_clock::time_point deadline;
+	atomic<bool> stop{false};
+	/**задач в очередях пула, ещё не начатых*/
+	atomic<int> queued{0};
+	atomic<uint64_t> solutions{0}, nodes{0}, pruned{0}, memo{0};
+	uint64_t memoMax;
+	/**таблица тупиков: PARENT_STRIPES частей на строку родителя*/
+	vector<parentStripe> stripes;
+	mutex out;
+	const function<void(int, int, int, const vector<uint64_t>&)>* found;
+};
+
+/**
+ *\struct parentCounts
+ *\details Счётчики одной задачи; складываются в общие по её окончании
+*/
+struct parentCounts
+{
+	uint64_t nodes = 0, pruned = 0;
+};
+
+/**
+ *\param c    поиск
+ *\param L    строка родителя, перед которой стоят строки a и b
+ *\param a, b две предыдущие строки
+ *\return часть таблицы тупиков и ключ пары
+*/
+static parentStripe& stripeOf(parentContext& c, int L, uint32_t a, uint32_t b, uint64_t& key)
+{
+	key = (uint64_t)a | (uint64_t)b << 32;
+	return c.stripes[(size_t)L * PARENT_STRIPES + (size_t)((key * 0x9e3779b97f4a7c15ull) >> 58)];
+}
+
+/**
+ *\return true, если пара строк a, b перед строкой L уже известна как тупик
+*/
+static bool memoDead(parentContext& c, int L, uint32_t a, uint32_t b)
+{
+	uint64_t key;
+	parentStripe& s = stripeOf(c, L, a, b, key);
+	lock_guard<mutex> g(s.m);
+	return s.dead.count(key) != 0;
+}
+
+/**
+ *\details Запись тупиковой пары строк, пока таблица помещается в свой размер и в бюджет кэшей
+*/
+static void memoAdd(parentContext& c, int L, uint32_t a, uint32_t b)
+{
+	if (c.memo >= c.memoMax || !memFits(MEM_CACHE, PARENT_MEMO_ENTRY))
+	{
+		return;
+	}
+	uint64_t key;
+	parentStripe& s = stripeOf(c, L, a, b, key);
+	lock_guard<mutex> g(s.m);
+	if (s.dead.insert(key).second)
+	{
+		c.memo++;
+		memAdd(MEM_CACHE, PARENT_MEMO_ENTRY);
+	}
+}
+
+/**
+ *\param c    поиск
+ *\param path строки найденного родителя
+ *\details Передача родителя вызывающему в положении заданной колонии
+*/
+static void report(parentContext& c, const vector<uint32_t>& path)
+{
+	lock_guard<mutex> g(c.out);
+	if (c.limit != 0 && c.solutions >= c.limit)
+	{
+		c.stop = true;
+		return;
+	}
+	int oh = c.q->transposed ? c.width : c.rows, ow = c.q->transposed ? c.rows : c.width;
+	int words = (ow + 63) / 64;
+	vector<uint64_t> bits((size_t)oh * words, 0);
+	for (int i = 0; i < c.rows; i++)
+	{
+		for (int k = 0; k < c.width; k++)
+		{
+			if ((path[i] >> k) & 1)
+			{
+				int oi = c.q->transposed ? k : i, oj = c.q->transposed ? i : k;
+				bits[(size_t)oi * words + oj / 64] |= 1ull << (oj % 64);
+			}
+		}
+	}
+	(*c.found)(oh, ow, words, bits);
+	if (++c.solutions == c.limit)
+	{
+		c.stop = true;
+	}
+}
+
+static bool explore(parentContext& c, vector<uint32_t>& path, int L, parentCounts& t, bool& found);
+
+/**
+ *\param c    поиск
+ *\param path строки 0..L-1 ветви
+ *\param L    следующая строка
+ *\details Задача пула: просмотр ветви дерева
+*/
+static void branch(parentContext& c, vector<uint32_t> path, int L)
+{
+	c.queued--;
+	parentCounts t;
+	bool found = false;
+	explore(c, path, L, t, found);
+	c.nodes += t.nodes;
+	c.pruned += t.pruned;
+}
+
+/**
+ *\param c     поиск
+ *\param path  строки родителя (размер - все строки; заполнены 0..L-1)
+ *\param L     следующая строка
+ *\param t     счётчики задачи
+ *\param found становится true, если в ветви найден родитель
+ *\return true, если ветвь просмотрена целиком в этой задаче
+ *\details Первые две строки родителя ничем не ограничены; каждая следующая перебирается
+ * автоматом строки. Пока пул недогружен, ветви отдаются новым задачам (их забирают
+ * свободные потоки), иначе просматриваются здесь же. Ветвь, целиком просмотренная здесь
+ * и не давшая родителя, записывается в таблицу тупиков.
+*/
+static bool explore(parentContext& c, vector<uint32_t>& path, int L, parentCounts& t, bool& found)
+{
+	if (c.stop)
+	{
+		return false;
+	}
+	if ((++t.nodes & 1023) == 0 && c.timed && chrono::steady_clock::now() > c.deadline)
+	{
+		c.stop = true;
+		return false;
+	}
+	if (L == c.rows)
+	{
+		report(c, path);
+		found = true;
+		return true;
+	}
+	bool complete = true, any = false;
+	auto child = [&](uint32_t row) -> bool
+	{
+		if (c.stop)
+		{
+			complete = false;
+			return false;
+		}
+		if (L + 1 >= 3 && L + 1 < c.rows && memoDead(c, L + 1, path[L - 1], row))
+		{
+			t.pruned++;
+			return true;
+		}
+		if (c.queued < 2 * c.pool->size() && c.rows - L > 4)
+		{
+			vector<uint32_t> copy = path;
+			copy[L] = row;
+			c.queued++;
+			parentContext* pc = &c;
+			c.pool->spawn([pc, copy, L]()
+			{
+				branch(*pc, copy, L + 1);
+			});
+			complete = false;
+			return true;
+		}
+		path[L] = row;
+		bool sub = false;
+		complete = explore(c, path, L + 1, t, sub) && complete;
+		any = any || sub;
+		return true;
+	};
+	if (L < 2)
+	{
+		for (uint64_t row = 0; row < (1ull << c.width); row++)
+		{
+			if (!child((uint32_t)row))
+			{
+				break;
+			}
+		}
+	}
+	else
+	{
+		rowsAfter(*c.q, c.width, path[L - 2], path[L - 1], c.q->target[L - 2], child);
+	}
+	found = found || any;
+	if (complete && !any && L >= 3)
+	{
+		memoAdd(c, L, path[L - 2], path[L - 1]);
+	}
+	return complete;
+}
+
+/**
+ *\param q         запрос
+ *\param pool      пул потоков (вызывается не из задачи пула)
+ *\param limit     сколько родителей искать (0 - всех)
+ *\param seconds   наибольшее время поиска (0 - без ограничения)
+ *\param memoBytes наибольший размер таблицы тупиков
+ *\param found     получает каждого найденного родителя (h x w клеток, строки по words слов) сразу
+ * по нахождении; вызовы не пересекаются
+ *\return итоги поиска
+*/
+parentStats parentSearch(const parentQuery& q, workPool& pool, uint64_t limit, double seconds, uint64_t memoBytes,
+	const function<void(int h, int w, int words, const vector<uint64_t>& bits)>& found)
+{
+	PROFILE_SCOPE("parentSearch");
+	auto t0 = chrono::steady_clock::now();
+	parentContext c;
+	c.q = &q;
+	c.pool = &pool;
+	c.rows = q.h + 2;
+	c.width = q.w + 2;
+	c.limit = limit;
+	c.timed = seconds > 0;
+	c.deadline = t0 + chrono::duration_cast<chrono::steady_clock::duration>(chrono::duration<double>(seconds));
+	c.memoMax = memoBytes / PARENT_MEMO_ENTRY;
+	c.stripes = vector<parentStripe>((size_t)c.rows * PARENT_STRIPES);
+	c.found = &found;
+	c.queued++;
+	parentContext* pc = &c;
+	pool.spawn([pc]()
+	{
+		branch(*pc, vector<uint32_t>(pc->rows, 0), 0);
+	});
+	pool.wait();
+	memAdd(MEM_CACHE, -(int64_t)(c.memo * PARENT_MEMO_ENTRY));
+	parentStats st;
+	st.solutions = c.solutions;
+	st.nodes = c.nodes;
+	st.pruned = c.pruned;
+	st.memo = c.memo;
+	st.complete = !c.stop;
+	st.seconds = chrono::duration<double>(chrono::steady_clock::now() - t0).count();
+	return st;
+}
+
+/**
+ *\param q      запрос
+ *\param e      колония
+ *\param ring   колония окружена мёртвыми клетками
+ *\param oh, ow размеры родителя
+ *\param words  слов в строке родителя
+ *\param bits   строки родителя
+ *\return true, если родитель за одно поколение даёт колонию (с окаймлением при ring)
+*/
+static bool parentValid(const parentQuery& q, const thumbEntry& e, bool ring, int oh, int ow, int words, const vector<uint64_t>& bits)
+{
+	int b = ring ? 1 : 0;
+	for (int i = 1; i < oh - 1; i++)
+	{
+		for (int j = 1; j < ow - 1; j++)
+		{
+			int idx = 0;
+			for (int di = 0; di < 3; di++)
+			{
+				for (int dj = 0; dj < 3; dj++)
+				{
+					int y = i - 1 + di, x = j - 1 + dj;
+					idx |= (int)((bits[(size_t)y * words + x / 64] >> (x % 64)) & 1) << (di * 3 + dj);
+				}
+			}
+			int ti = i - 1 - b, tj = j - 1 - b;
+			int want = ti >= 0 && ti < e.h && tj >= 0 && tj < e.w ? (int)((e.bits[(size_t)ti * e.words + tj / 64] >> (tj % 64)) & 1) : 0;
+			if (q.next[idx] != want)
+			{
+				return false;
+			}
+		}
+	}
+	return true;
+}
+
+/**
+ *\param argc количество параметров после ключа --parent
+ *\param argv параметры pattern= (номер колонии библиотеки 1..LIBRARY_SIZE, файл RLE / .cells или random),
+ * rows=, cols=, density=, seed= (случайная колония), ring=, rule=, limit=, time= (секунд, 0 - без
+ * ограничения), memo= (МБ таблицы тупиков), threads=, out= (файл .cells найденных родителей)
+ *\return код завершения программы
+ *\details Поиск родителей колонии. Каждый найденный родитель сразу выводится (или дописывается
+ * в файл) и проверяется вычислением поколения; если дерево просмотрено целиком и родителей
+ * нет, колония - Сад Эдема.
+*/
+int parentRun(int argc, char* argv[])
+{
+	string pattern = option(argc, argv, "pattern", "1"), out = option(argc, argv, "out", "");
+	bool ring = atoi(option(argc, argv, "ring", "1").c_str()) != 0;
+	uint64_t limit = strtoull(option(argc, argv, "limit", "1").c_str(), nullptr, 10);
+	double seconds = atof(option(argc, argv, "time", "0").c_str());
+	uint64_t memoBytes = strtoull(option(argc, argv, "memo", "512").c_str(), nullptr, 10) << 20;
+	workPool pool(atoi(option(argc, argv, "threads", "0").c_str()));
+	rule r;
+	if (!parseRule(option(argc, argv, "rule", "B3/S23"), r))
+	{
+		printf("bad rule\n");
+		return 1;
+	}
+	thumbEntry e;
+	int n = atoi(pattern.c_str());
+	if (pattern == "random")
+	{
+		e.h = atoi(option(argc, argv, "rows", "8").c_str());
+		e.w = atoi(option(argc, argv, "cols", "8").c_str());
+		e.h = max(1, min(e.h, PARENT_LONG));
+		e.w = max(1, min(e.w, PARENT_LONG));
+		e.words = (e.w + 63) / 64;
+		e.bits.assign((size_t)e.h * e.words, 0);
+		double density = atof(option(argc, argv, "density", "0.3").c_str());
+		mt19937_64 rng(strtoull(option(argc, argv, "seed", "1").c_str(), nullptr, 10));
+		for (int i = 0; i < e.h; i++)
+		{
+			for (int j = 0; j < e.w; j++)
+			{
+				if ((double)(rng() >> 11) / 9007199254740992.0 < density)
+				{
+					e.bits[(size_t)i * e.words + j / 64] |= 1ull << (j % 64);
+				}
+			}
+		}
+	}
+	else if (n >= 1 && n <= LIBRARY_SIZE)
+	{
+		editCommand c = editPlace(library[n - 1], 0, false, 0, 0);
+		e.h = (int)c.i1;
+		e.w = (int)c.j1;
+		e.words = c.words;
+		e.bits = c.bits;
+	}
+	else if (!thumbLoad(pattern, e))
+	{
+		printf("cannot read pattern %s\n", pattern.c_str());
+		return 1;
+	}
+	parentQuery q;
+	if (!parentPrepare(q, e.h, e.w, e.words, e.bits, r, ring))
+	{
+		printf("parent search needs a two-state Moore rule and a pattern up to %dx%d with the ring\n", PARENT_SIDE, PARENT_LONG);
+		return 1;
+	}
+	FILE* f = stdout;
+	if (!out.empty() && (f = fopen(out.c_str(), "w")) == nullptr)
+	{
+		printf("cannot write %s\n", out.c_str());
+		return 1;
+	}
+	auto t0 = chrono::steady_clock::now();
+	uint64_t bad = 0, count = 0;
+	parentStats st = parentSearch(q, pool, limit, seconds, memoBytes,
+		[&](int oh, int ow, int words, const vector<uint64_t>& bits)
+	{
+		count++;
+		bad += !parentValid(q, e, ring, oh, ow, words, bits);
+		fprintf(f, "!Parent %llu (%.3f s)\n", (unsigned long long)count,
+			chrono::duration<double>(chrono::steady_clock::now() - t0).count());
+		for (int i = 0; i < oh; i++)
+		{
+			string line((size_t)ow, '.');
+			for (int j = 0; j < ow; j++)
+			{
+				if ((bits[(size_t)i * words + j / 64] >> (j % 64)) & 1)
+				{
+					line[j] = 'O';
+				}
+			}
+			fprintf(f, "%s\n", line.c_str());
+		}
+		fflush(f);
+	});
+	if (f != stdout)
+	{
+		fclose(f);
+	}
+	printf("%dx%d pattern (%d target cells), %s: %llu parents, %llu nodes, %llu pruned, %llu dead pairs, %.3f s (%d threads), %llu invalid\n",
+		e.h, e.w, (q.h * q.w), st.complete ? (st.solutions == 0 ? "garden of eden" : "search complete")
+		: (limit != 0 && st.solutions >= limit ? "limit reached" : "time is up"),
+		(unsigned long long)st.solutions, (unsigned long long)st.nodes, (unsigned long long)st.pruned,
+		(unsigned long long)st.memo, st.seconds, pool.size(), (unsigned long long)bad);
+	return bad == 0 ? 0 : 1;
+}
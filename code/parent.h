@@ -0,0 +1,72 @@
+﻿/**
+ *\file parent.h
+ *\version 1.0
+ *\date October 2026
+ *\details Поиск родителей колонии: водоёмов, из которых колония получается за одно поколение.
+ * Колония без родителей - "Сад Эдема". Родитель строится по строкам: очередная строка должна
+ * вместе с двумя предыдущими дать нужную строку колонии. Строка собирается по столбцам
+ * автоматом из четырёх состояний (две последние клетки строки); таблицы переходов проверяют
+ * сразу все состояния одним обращением, а проход справа налево заранее отбрасывает
+ * состояния без продолжения, поэтому перебираются только подходящие строки. Пары строк, после
+ * которых родитель не достраивается, запоминаются в общей для потоков таблице и больше не
+ * просматриваются. Ветви дерева поиска раздаются задачам пула с перехватом работы, а найденные
+ * родители передаются вызывающему сразу.
+ */
+
+#pragma once
+
+#include "pool.h"
+#include "rules.h"
+
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+/**Наибольшая меньшая сторона колонии (строка родителя с окаймлением помещается в 32 бита)*/
+#define PARENT_SIDE 30
+/**Наибольшая большая сторона колонии*/
+#define PARENT_LONG 1024
+/**Частей таблицы тупиковых пар строк на строку родителя (у каждой части свой замок)*/
+#define PARENT_STRIPES 64
+/**Память одной записи таблицы тупиковых пар строк в байтах (оценка для учёта)*/
+#define PARENT_MEMO_ENTRY 40
+
+/**
+ *\struct parentQuery
+ *\details Колония, для которой ищутся родители, и таблицы правила. Колония хранится так,
+ * чтобы строки были её меньшей стороной (transposed - колония повёрнута относительно заданной)
+*/
+struct parentQuery
+{
+	/**размеры колонии после поворота; у родителя h + 2 строк по w + 2 клеток*/
+	int h, w;
+	bool transposed;
+	/**строки колонии по w бит*/
+	std::vector<uint32_t> target;
+	/**состояние клетки в следующем поколении по окрестности 3x3: биты 0-2 - строка выше,
+	 * 3-5 - строка клетки (бит 4 - сама клетка), 6-8 - строка ниже*/
+	uint8_t next[512];
+	/**переходы автомата строки по клеткам двух предыдущих строк (6 бит) и клетке колонии:
+	 * бит s * 2 + x - из состояния s можно поставить клетку x*/
+	uint8_t allow[64][2];
+	/**состояния, из которых есть переход в одно из состояний маски (4 бита), по тем же клеткам*/
+	uint8_t reach[64][2][16];
+};
+
+/**
+ *\struct parentStats
+ *\details Итоги поиска
+*/
+struct parentStats
+{
+	/**найдено родителей, просмотрено узлов, отброшено по таблице тупиков, записей в таблице*/
+	uint64_t solutions, nodes, pruned, memo;
+	/**дерево просмотрено целиком (при solutions == 0 колония - Сад Эдема)*/
+	bool complete;
+	double seconds;
+};
+
+bool parentPrepare(parentQuery& q, int h, int w, int words, const std::vector<uint64_t>& bits, const rule& r, bool ring);
+parentStats parentSearch(const parentQuery& q, workPool& pool, uint64_t limit, double seconds, uint64_t memoBytes,
+	const std::function<void(int h, int w, int words, const std::vector<uint64_t>& bits)>& found);
+int parentRun(int argc, char* argv[]);
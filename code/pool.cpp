@@ -0,0 +1,181 @@
+﻿/**
+ *\file pool.cpp
+ *\version 1.0
+ *\date October 2026
+ *\details Реализация пула потоков с перехватом работы
+ */
+
+#include "pool.h"
+#include "profile.h"
+
+#include <algorithm>
+#include <chrono>
+
+using namespace std;
+
+/**Номер рабочего потока пула (-1 для остальных потоков)*/
+static thread_local int workerIndex = -1;
+
+/**
+ *\param threads количество потоков (0 - по числу ядер)
+*/
+workPool::workPool(int threads) : pending(0), next(0), stop(false)
+{
+	if (threads <= 0)
+	{
+		threads = max(1, (int)thread::hardware_concurrency());
+	}
+	for (int t = 0; t < threads; t++)
+	{
+		queues.emplace_back(new queue);
+	}
+	for (int t = 0; t < threads; t++)
+	{
+		workers.emplace_back(&workPool::loop, this, t);
+	}
+}
+
+/**
+ *\details Ожидание оставшихся задач и остановка потоков
+*/
+workPool::~workPool()
+{
+	wait();
+	stop = true;
+	{
+		lock_guard<mutex> lock(sleepM);
+		sleepCv.notify_all();
+	}
+	for (auto& th : workers)
+	{
+		th.join();
+	}
+}
+
+/**
+ *\return количество потоков пула
+*/
+int workPool::size() const
+{
+	return (int)workers.size();
+}
+
+/**
+ *\return номер текущего потока пула или -1
+*/
+int workPool::current()
+{
+	return workerIndex;
+}
+
+/**
+ *\param task задача
+ *\details Добавление задачи. Задача, созданная потоком пула, кладётся в конец его очереди,
+ * остальные задачи распределяются по очередям по кругу.
+*/
+void workPool::spawn(function<void()> task)
+{
+	pending++;
+	int q = workerIndex >= 0 ? workerIndex : (int)(next++ % queues.size());
+	{
+		lock_guard<mutex> lock(queues[q]->m);
+		queues[q]->tasks.push_back(move(task));
+	}
+	lock_guard<mutex> lock(sleepM);
+	sleepCv.notify_one();
+}
+
+/**
+ *\param self номер потока
+ *\return true, если задача была выполнена
+ *\details Выполнение одной задачи: сначала последней из своей очереди,
+ * затем первой из очереди другого потока.
+*/
+bool workPool::runOne(int self)
+{
+	function<void()> task;
+	int n = (int)queues.size();
+	for (int k = 0; k < n && !task; k++)
+	{
+		queue& q = *queues[(self + k) % n];
+		lock_guard<mutex> lock(q.m);
+		if (q.tasks.empty())
+		{
+			continue;
+		}
+		if (k == 0)
+		{
+			task = move(q.tasks.back());
+			q.tasks.pop_back();
+		}
+		else
+		{
+			task = move(q.tasks.front());
+			q.tasks.pop_front();
+		}
+	}
+	if (!task)
+	{
+		return false;
+	}
+	task();
+	if (--pending == 0)
+	{
+		lock_guard<mutex> lock(sleepM);
+		doneCv.notify_all();
+	}
+	return true;
+}
+
+/**
+ *\param self номер потока
+ *\details Основной цикл потока пула
+*/
+void workPool::loop(int self)
+{
+	workerIndex = self;
+	while (!stop)
+	{
+		if (!runOne(self))
+		{
+			unique_lock<mutex> lock(sleepM);
+			sleepCv.wait_for(lock, chrono::milliseconds(2));
+		}
+	}
+}
+
+/**
+ *\details Ожидание выполнения всех задач. Вызывается не из задач пула.
+*/
+void workPool::wait()
+{
+	unique_lock<mutex> lock(sleepM);
+	doneCv.wait(lock, [this] { return pending == 0; });
+}
+
+/**
+ *\param pool  пул потоков
+ *\param n     количество элементов
+ *\param grain наименьший размер части
+ *\param body  обработка элементов [lo, hi)
+ *\details Параллельный цикл: диапазон делится пополам, пока части больше grain,
+ * половины становятся задачами, которые свободные потоки перехватывают друг у друга.
+ * Вызывается не из задач пула.
+*/
+void parallelFor(workPool& pool, int64_t n, int64_t grain, const function<void(int64_t, int64_t)>& body)
+{
+	grain = max<int64_t>(1, grain);
+	function<void(int64_t, int64_t)> split = [&](int64_t lo, int64_t hi)
+	{
+		while (hi - lo > grain)
+		{
+			int64_t mid = lo + (hi - lo) / 2;
+			pool.spawn([&split, mid, hi] { split(mid, hi); });
+			hi = mid;
+		}
+		PROFILE_SCOPE("parallelFor");
+		body(lo, hi);
+	};
+	pool.spawn([&split, n] { split(0, n); });
+	pool.wait();
+}
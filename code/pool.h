@@ -0,0 +1,55 @@
+﻿/**
+ *\file pool.h
+ *\version 1.0
+ *\date October 2026
+ *\details Пул потоков с перехватом работы (work stealing). У каждого потока своя очередь
+ * задач: поток берёт задачи с конца своей очереди, а освободившийся поток забирает задачи
+ * из начала очереди другого потока.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/**
+ *\struct workPool
+ *\details Пул потоков с перехватом работы
+*/
+struct workPool
+{
+	explicit workPool(int threads = 0);
+	~workPool();
+	void spawn(std::function<void()> task);
+	void wait();
+	int size() const;
+	static int current();
+
+private:
+	/**очередь задач одного потока*/
+	struct queue
+	{
+		std::mutex m;
+		std::deque<std::function<void()>> tasks;
+	};
+	std::vector<std::unique_ptr<queue>> queues;
+	std::vector<std::thread> workers;
+	/**количество невыполненных задач*/
+	std::atomic<long> pending;
+	/**очередь для задач, добавленных не из потоков пула*/
+	std::atomic<unsigned> next;
+	std::atomic<bool> stop;
+	std::mutex sleepM;
+	std::condition_variable sleepCv, doneCv;
+	bool runOne(int self);
+	void loop(int self);
+};
+
+void parallelFor(workPool& pool, int64_t n, int64_t grain, const std::function<void(int64_t, int64_t)>& body);
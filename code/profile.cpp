@@ -0,0 +1,144 @@
+﻿/**
+ *\file profile.cpp
+ *\version 1.0
+ *\date October 2026
+ *\details Кольца замеров потоков и выгрузка в формат trace_event
+ */
+
+#include "profile.h"
+
+#include <chrono>
+#include <cstdio>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+using namespace std;
+
+/**
+ *\struct profileEvent
+ *\details Один замер: место и время начала и конца в наносекундах от запуска программы
+*/
+struct profileEvent
+{
+	const char* name;
+	uint64_t start, end;
+};
+
+/**
+ *\struct profileRing
+ *\details Кольцо замеров одного потока. Пишет только свой поток; количество записанных
+ * событий публикуется после записи события, поэтому выгрузка видит записанные события целиком
+ * (кроме самых старых, если поток успел обойти кольцо во время выгрузки).
+*/
+struct profileRing
+{
+	unique_ptr<profileEvent[]> ev;
+	atomic<uint64_t> n;
+	int tid;
+};
+
+/**начало отсчёта времени*/
+static const chrono::steady_clock::time_point epoch = chrono::steady_clock::now();
+/**кольца всех потоков; кольцо живёт дольше потока, чтобы его можно было выгрузить*/
+static mutex ringsM;
+static vector<shared_ptr<profileRing>> rings;
+/**начало списка мест замера*/
+static atomic<profileSite*> sites(nullptr);
+
+/**
+ *\param name имя места замера (строковая константа)
+ *\details Место добавляется в начало списка мест без блокировки
+*/
+profileSite::profileSite(const char* name) : name(name), ns(0), count(0), next(nullptr)
+{
+	profileSite* head = sites.load();
+	do
+	{
+		next = head;
+	} while (!sites.compare_exchange_weak(head, this));
+}
+
+/**
+ *\return время в наносекундах от запуска программы
+*/
+uint64_t profileNow()
+{
+	return (uint64_t)chrono::duration_cast<chrono::nanoseconds>(chrono::steady_clock::now() - epoch).count();
+}
+
+/**
+ *\return кольцо замеров текущего потока (создаётся при первом замере в потоке)
+*/
+static profileRing& threadRing()
+{
+	static thread_local shared_ptr<profileRing> ring;
+	if (!ring)
+	{
+		ring = make_shared<profileRing>();
+		ring->ev.reset(new profileEvent[PROFILE_RING]);
+		ring->n = 0;
+		lock_guard<mutex> lock(ringsM);
+		ring->tid = (int)rings.size() + 1;
+		rings.push_back(ring);
+	}
+	return *ring;
+}
+
+/**
+ *\param site  место замера
+ *\param start начало участка (profileNow)
+ *\param end   конец участка
+ *\details Запись замера в кольцо потока и в накопленное время места
+*/
+void profileRecord(profileSite& site, uint64_t start, uint64_t end)
+{
+	site.ns.fetch_add(end - start, memory_order_relaxed);
+	site.count.fetch_add(1, memory_order_relaxed);
+	profileRing& r = threadRing();
+	uint64_t k = r.n.load(memory_order_relaxed);
+	r.ev[k % PROFILE_RING] = {site.name, start, end};
+	r.n.store(k + 1, memory_order_release);
+}
+
+/**
+ *\return первое место замера в списке (дальше - по полю next)
+*/
+profileSite* profileSites()
+{
+	return sites.load();
+}
+
+/**
+ *\param path путь к файлу
+ *\return true, если файл записан
+ *\details Выгрузка последних PROFILE_RING замеров каждого потока в формате trace_event:
+ * каждый замер - событие "X" с началом и длительностью в микросекундах.
+ * Файл открывается в chrome://tracing или ui.perfetto.dev.
+*/
+bool profileExport(const char* path)
+{
+	FILE* f = fopen(path, "w");
+	if (f == nullptr)
+	{
+		return false;
+	}
+	fprintf(f, "{\"traceEvents\":[\n");
+	bool first = true;
+	lock_guard<mutex> lock(ringsM);
+	for (const shared_ptr<profileRing>& r : rings)
+	{
+		fprintf(f, "%s{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%d,\"args\":{\"name\":\"thread %d\"}}",
+			first ? "" : ",\n", r->tid, r->tid);
+		first = false;
+		uint64_t n = r->n.load(memory_order_acquire);
+		for (uint64_t k = n > PROFILE_RING ? n - PROFILE_RING : 0; k < n; k++)
+		{
+			const profileEvent& e = r->ev[k % PROFILE_RING];
+			fprintf(f, ",\n{\"name\":\"%s\",\"ph\":\"X\",\"pid\":1,\"tid\":%d,\"ts\":%.3f,\"dur\":%.3f}",
+				e.name, r->tid, e.start / 1000.0, (e.end - e.start) / 1000.0);
+		}
+	}
+	fprintf(f, "\n]}\n");
+	return fclose(f) == 0;
+}
@@ -0,0 +1,78 @@
+﻿/**
+ *\file profile.h
+ *\version 1.0
+ *\date October 2026
+ *\details Замеры времени участков программы. Участок отмечается макросом PROFILE_SCOPE (до конца
+ * блока) или парой PROFILE_BEGIN/PROFILE_END. Каждый поток пишет замеры в своё кольцо из
+ * PROFILE_RING событий без блокировок; кольца выгружаются в формате trace_event (chrome://tracing).
+ * Для каждого места замера накапливаются суммарное время и количество вызовов - из них
+ * строится наложение с временем участков в окне.
+ * Замеры включаются ключом компиляции LIFE_PROFILE, без него макросы не порождают кода.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+
+/**Количество событий в кольце одного потока*/
+#define PROFILE_RING 65536
+
+/**
+ *\struct profileSite
+ *\details Место замера: имя и накопленные время и количество вызовов.
+ * Места образуют список, в который добавляются при первом проходе через замер.
+*/
+struct profileSite
+{
+	explicit profileSite(const char* name);
+	const char* name;
+	std::atomic<uint64_t> ns;
+	std::atomic<uint64_t> count;
+	profileSite* next;
+};
+
+uint64_t profileNow();
+void profileRecord(profileSite& site, uint64_t start, uint64_t end);
+profileSite* profileSites();
+bool profileExport(const char* path);
+
+/**
+ *\struct profileScope
+ *\details Замер от создания до stop() или уничтожения объекта
+*/
+struct profileScope
+{
+	explicit profileScope(profileSite& s) : site(s), start(profileNow()), done(false) {}
+	~profileScope() { stop(); }
+	void stop()
+	{
+		if (!done)
+		{
+			done = true;
+			profileRecord(site, start, profileNow());
+		}
+	}
+	profileSite& site;
+	uint64_t start;
+	bool done;
+};
+
+#define PROFILE_JOIN2(a, b) a##b
+#define PROFILE_JOIN(a, b) PROFILE_JOIN2(a, b)
+
+#ifdef LIFE_PROFILE
+/**замер до конца текущего блока*/
+#define PROFILE_SCOPE(name) \
+	static profileSite PROFILE_JOIN(profileSite_, __LINE__)(name); \
+	profileScope PROFILE_JOIN(profileScope_, __LINE__)(PROFILE_JOIN(profileSite_, __LINE__))
+/**замер от PROFILE_BEGIN(var, name) до PROFILE_END(var) в том же блоке*/
+#define PROFILE_BEGIN(var, name) \
+	static profileSite PROFILE_JOIN(var, _site)(name); \
+	profileScope var(PROFILE_JOIN(var, _site))
+#define PROFILE_END(var) var.stop()
+#else
+#define PROFILE_SCOPE(name)
+#define PROFILE_BEGIN(var, name)
+#define PROFILE_END(var)
+#endif
@@ -0,0 +1,41 @@
+﻿/**
+ *\file random.h
+ *\version 1.0
+ *\date October 2026
+ *\details Псевдослучайные числа для заполнения водоёмов: генератор splitmix64 и случайное
+ * слово с заданной плотностью единичных битов. Генератор задаётся одним 64-битным состоянием,
+ * поэтому заполнение можно сделать зависящим только от начального значения и координат.
+ */
+
+#pragma once
+
+#include <cstdint>
+
+/**
+ *\param s состояние генератора
+ *\return следующее псевдослучайное 64-битное число (splitmix64)
+*/
+static inline uint64_t splitmix64(uint64_t& s)
+{
+	uint64_t z = (s += 0x9e3779b97f4a7c15ull);
+	z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ull;
+	z = (z ^ (z >> 27)) * 0x94d049bb133111ebull;
+	return z ^ (z >> 31);
+}
+
+/**
+ *\param s состояние генератора
+ *\param p плотность единичных битов в 256-х долях (256 - все биты)
+ *\return случайное слово
+ *\details Плотность приближается восьмибитной двоичной дробью: каждая цифра - И или ИЛИ
+ * со случайным словом, без обработки отдельных битов
+*/
+static inline uint64_t randomWord(uint64_t& s, unsigned p)
+{
+	uint64_t x = p >= 256 ? ~0ull : 0;
+	for (int b = 0; b < 8 && p < 256; b++)
+	{
+		x = ((p >> b) & 1) ? (x | splitmix64(s)) : (x & splitmix64(s));
+	}
+	return x;
+}
@@ -0,0 +1,296 @@
+﻿/**
+ *\file record.cpp
+ *\version 1.0
+ *\date October 2026
+ *\details Очередь кадров записи и поток кодирования
+ */
+
+#include "record.h"
+#include "profile.h"
+
+#include <algorithm>
+#include <csignal>
+#include <cstring>
+
+#ifdef _WIN32
+#define popen _popen
+#define pclose _pclose
+/**канал открывается в двоичном режиме, иначе байты 10 заменяются на 13 10*/
+#define PIPE_MODE "wb"
+#else
+#define PIPE_MODE "w"
+#endif
+
+using namespace std;
+
+/**Размер несжатой полосы кадра PNG, после которого полоса сжимается и записывается*/
+#define REC_STRIP (1 << 18)
+
+/**
+ *\param r   запись
+ *\param g   клетки кадра
+ *\param n   номер кадра
+ *\param states состояния клеток строки (буфер)
+ *\param px     номера цветов строки точек (буфер)
+ *\param line   строка для записи в файл или канал (буфер)
+ *\return true, если кадр записан
+ *\details Кадр строится построчно: строка клеток превращается в cell строк точек,
+ * которые сразу передаются кодировщику
+*/
+static bool encodeFrame(recorder& r, const planeGrid& g, uint64_t n, vector<uint8_t>& states, vector<uint8_t>& px, vector<uint8_t>& line)
+{
+	PROFILE_SCOPE("recordFrame");
+	int cell = r.style.cell;
+	int64_t pw = (int64_t)r.w * cell;
+	FILE* png = nullptr;
+	int depth = pngDepth(r.style.colors);
+	size_t rowBytes = (size_t)(pw * depth + 7) / 8;
+	uint32_t adler = 1;
+	pngStrip strip;
+	bool ok = true;
+	if (r.format == REC_PNG)
+	{
+		char name[32];
+		snprintf(name, sizeof(name), "%06llu.png", (unsigned long long)n);
+		png = fopen((r.out + name).c_str(), "wb");
+		if (png == nullptr)
+		{
+			return false;
+		}
+		ok = pngBegin(png, pw, (int64_t)r.h * cell, depth, r.style);
+		line.clear();
+	}
+	else if (r.format == REC_GIF)
+	{
+		gifFrameBegin(*r.gif, r.delay);
+	}
+	for (int i = 0; i < r.h; i++)
+	{
+		for (int j = 0; j < r.w; j++)
+		{
+			states[j] = (uint8_t)planeGet(g, i, j);
+		}
+		for (int y = 0; y < cell; y++)
+		{
+			styleRow(r.style, states.data(), r.w, y, px.data());
+			if (r.format == REC_GIF)
+			{
+				gifRow(*r.gif, px.data());
+			}
+			else if (r.format == REC_PNG)
+			{
+				/**строка PNG: байт фильтра 0 (без фильтра) и упакованные точки*/
+				size_t k = line.size();
+				line.resize(k + 1 + rowBytes);
+				line[k] = 0;
+				pngPack(px.data(), pw, depth, &line[k + 1]);
+				bool last = i == r.h - 1 && y == cell - 1;
+				if (line.size() >= REC_STRIP || last)
+				{
+					pngDeflate(line.data(), line.size(), last, strip);
+					ok = pngPut(png, strip, adler) && ok;
+					line.clear();
+				}
+			}
+			else
+			{
+				for (int64_t x = 0; x < pw; x++)
+				{
+					memcpy(&line[x * 3], &r.style.rgb[px[x] * 3], 3);
+				}
+				ok = fwrite(line.data(), 1, (size_t)pw * 3, r.f) == (size_t)pw * 3 && ok;
+			}
+		}
+	}
+	if (r.format == REC_GIF)
+	{
+		gifFrameEnd(*r.gif);
+	}
+	else if (r.format == REC_PNG)
+	{
+		ok = pngEnd(png, adler) && ok;
+		ok = fclose(png) == 0 && ok;
+	}
+	return ok;
+}
+
+/**
+ *\param r запись
+ *\details Поток кодирования: ждёт кадры в очереди и кодирует их по порядку;
+ * после остановки записи дописывает оставшиеся кадры. Кадр, который не удалось записать
+ * (файл PNG не создан, ошибка записи), учитывается в dropped и отмечается в failed.
+*/
+static void encoder(recorder& r)
+{
+	vector<uint8_t> states(r.w), px((size_t)r.w * r.style.cell), line((size_t)r.w * r.style.cell * 3);
+	unique_lock<mutex> lock(r.m);
+	for (;;)
+	{
+		r.cv.wait(lock, [&] { return r.stop || r.head < r.tail; });
+		if (r.head == r.tail)
+		{
+			return;
+		}
+		uint64_t k = r.head;
+		/**место head не трогается производителем, пока head не увеличен*/
+		lock.unlock();
+		if (encodeFrame(r, r.slot[k % REC_QUEUE], r.written, states, px, line))
+		{
+			r.written++;
+		}
+		else
+		{
+			r.failed = true;
+			r.dropped++;
+		}
+		lock.lock();
+		r.head++;
+	}
+}
+
+/**
+ *\param r      запись
+ *\param format вид записи
+ *\param out    файл GIF, начало имён файлов PNG или команда внешнего кодировщика
+ *\param style  внешний вид клеток
+ *\param h, w   размеры водоёма в клетках
+ *\param bits   количество битовых плоскостей водоёма
+ *\param every  записывается каждое every-е поколение
+ *\param delay  задержка кадра GIF в сотых долях секунды
+ *\return true, если запись начата
+*/
+bool recordStart(recorder& r, int format, const string& out, const cellStyle& style, int h, int w, int bits, int every, int delay)
+{
+	if (r.active)
+	{
+		return false;
+	}
+	r.format = format;
+	r.out = out;
+	r.style = style;
+	r.h = h;
+	r.w = w;
+	r.every = max(1, every);
+	r.delay = delay;
+	int ph = h * style.cell, pw = w * style.cell;
+	if (format == REC_GIF)
+	{
+		/**размеры кадра GIF - 16-битные*/
+		if (pw > 65535 || ph > 65535)
+		{
+			return false;
+		}
+		r.f = fopen(out.c_str(), "wb");
+		if (r.f == nullptr)
+		{
+			return false;
+		}
+		r.gif = new gifWriter;
+		gifBegin(*r.gif, r.f, pw, ph, style);
+	}
+	else if (format == REC_RAW)
+	{
+#ifndef _WIN32
+		/**запись в канал завершившегося кодировщика без SIGPIPE возвращает ошибку,
+		 и кадр отмечается в failed, а не завершает программу*/
+		r.pipeHandler = signal(SIGPIPE, SIG_IGN);
+#endif
+		r.f = popen(out.c_str(), PIPE_MODE);
+		if (r.f == nullptr)
+		{
+#ifndef _WIN32
+			signal(SIGPIPE, r.pipeHandler);
+#endif
+			return false;
+		}
+	}
+	for (int k = 0; k < REC_QUEUE; k++)
+	{
+		planeInit(r.slot[k], h, w, bits);
+	}
+	r.head = r.tail = 0;
+	r.offered = 0;
+	r.written = 0;
+	r.dropped = 0;
+	r.failed = false;
+	r.stop = false;
+	r.active = true;
+	r.th = thread(encoder, ref(r));
+	return true;
+}
+
+/**
+ *\param r запись
+ *\param g водоём после очередного поколения
+ *\details Копирование клеток в свободное место очереди. Вычисление поколений не ждёт
+ * кодирования: если очередь заполнена, кадр пропускается и учитывается в dropped.
+*/
+void recordFrame(recorder& r, const planeGrid& g)
+{
+	if (!r.active || r.offered++ % r.every != 0)
+	{
+		return;
+	}
+	if (g.h != r.h || g.w != r.w || g.bits != r.slot[0].bits)
+	{
+		r.dropped++;
+		return;
+	}
+	uint64_t k;
+	{
+		lock_guard<mutex> lock(r.m);
+		if (r.tail - r.head == REC_QUEUE)
+		{
+			r.dropped++;
+			return;
+		}
+		k = r.tail;
+	}
+	/**место tail не читается потоком кодирования, пока tail не увеличен; размеры совпадают,
+	 поэтому копирование не выделяет память*/
+	for (int b = 0; b < g.bits; b++)
+	{
+		copy(g.plane[b].begin(), g.plane[b].end(), r.slot[k % REC_QUEUE].plane[b].begin());
+	}
+	{
+		lock_guard<mutex> lock(r.m);
+		r.tail++;
+	}
+	r.cv.notify_one();
+}
+
+/**
+ *\param r запись
+ *\return true, если все кадры записаны и файл закрыт без ошибок (для любого вида записи)
+*/
+bool recordStop(recorder& r)
+{
+	if (!r.active)
+	{
+		return false;
+	}
+	{
+		lock_guard<mutex> lock(r.m);
+		r.stop = true;
+	}
+	r.cv.notify_one();
+	r.th.join();
+	bool ok = true;
+	if (r.format == REC_GIF)
+	{
+		ok = gifEnd(*r.gif);
+		ok = fclose(r.f) == 0 && ok;
+		delete r.gif;
+		r.gif = nullptr;
+	}
+	else if (r.format == REC_RAW)
+	{
+		ok = pclose(r.f) == 0;
+#ifndef _WIN32
+		signal(SIGPIPE, r.pipeHandler);
+#endif
+	}
+	r.f = nullptr;
+	r.active = false;
+	return ok && !r.failed;
+}
@@ -0,0 +1,73 @@
+﻿/**
+ *\file record.h
+ *\version 1.0
+ *\date October 2026
+ *\details Запись поколений водоёма: анимированный GIF, последовательность PNG или сырые кадры
+ * RGB, передаваемые внешнему кодировщику через канал. Вычисление поколений только копирует
+ * клетки в свободное место очереди из REC_QUEUE кадров; отрисовка кадра с заданным размером
+ * клетки и кодирование выполняются в отдельном потоке. Память записи не зависит от её длины:
+ * места очереди выделяются при начале записи, кадр строится построчно.
+ */
+
+#pragma once
+
+#include "image.h"
+#include "rules.h"
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+/**Анимированный GIF*/
+#define REC_GIF 0
+/**Последовательность файлов PNG*/
+#define REC_PNG 1
+/**Сырые кадры RGB в канал внешнего кодировщика*/
+#define REC_RAW 2
+
+/**Количество кадров в очереди записи*/
+#define REC_QUEUE 8
+
+/**
+ *\struct recorder
+ *\details Запись: настройки, очередь кадров и поток кодирования
+*/
+struct recorder
+{
+	/**вид записи (REC_GIF, REC_PNG, REC_RAW)*/
+	int format;
+	/**файл GIF, начало имён файлов PNG или команда внешнего кодировщика*/
+	std::string out;
+	/**записывается каждое every-е поколение; задержка кадра GIF в сотых долях секунды*/
+	int every, delay;
+	cellStyle style;
+	/**размеры водоёма в клетках*/
+	int h, w;
+	/**места очереди: клетки кадра; кадры head..tail-1 ждут кодирования*/
+	planeGrid slot[REC_QUEUE];
+	uint64_t head, tail;
+	std::mutex m;
+	std::condition_variable cv;
+	bool stop;
+	std::thread th;
+	FILE* f = nullptr;
+	gifWriter* gif = nullptr;
+	/**прежний обработчик SIGPIPE: на время записи в канал сигнал не обрабатывается*/
+	void (*pipeHandler)(int) = nullptr;
+	/**количество поколений, поданных на запись, записанных и пропущенных кадров
+	 (пропущенные - не поместившиеся в очередь и не записанные из-за ошибки)*/
+	uint64_t offered;
+	std::atomic<uint64_t> written{0}, dropped{0};
+	/**хотя бы один кадр не записан из-за ошибки; сбрасывается только при начале записи*/
+	bool failed = false;
+	bool active = false;
+};
+
+bool recordStart(recorder& r, int format, const std::string& out, const cellStyle& style, int h, int w, int bits, int every, int delay);
+void recordFrame(recorder& r, const planeGrid& g);
+bool recordStop(recorder& r);
@@ -0,0 +1,645 @@
+﻿/**
+ *\file rules.cpp
+ *\version 1.0
+ *\date October 2026
+ *\details Разбор записи правил и вычисление следующего поколения для семейств
+ * "Generations" и "Larger than Life" над битовыми плоскостями.
+ */
+
+#include "rules.h"
+#include "profile.h"
+
+#include <algorithm>
+#include <cctype>
+#include <cstdlib>
+
+using namespace std;
+
+/**
+ *\param text запись вида "R5,C0,M1,S34..58,B34..45,NM"
+ *\param r    заполняемое правило
+ *\return true, если запись корректна
+ *\details Разбор правила семейства "Larger than Life" (запись как в Golly).
+*/
+static bool parseLtl(const string& text, rule& r)
+{
+	r.family = RULE_LTL;
+	r.center = true;
+	bool hasB = false, hasS = false;
+	size_t pos = 0;
+	while (pos < text.size())
+	{
+		size_t end = text.find(',', pos);
+		if (end == string::npos)
+		{
+			end = text.size();
+		}
+		string tok = text.substr(pos, end - pos);
+		pos = end + 1;
+		if (tok.empty())
+		{
+			return false;
+		}
+		char key = (char)toupper((unsigned char)tok[0]);
+		/**окрестность: поддерживается только квадратная (Мура)*/
+		if (key == 'N')
+		{
+			if (tok.size() != 2 || toupper((unsigned char)tok[1]) != 'M')
+			{
+				return false;
+			}
+			continue;
+		}
+		const char* s = tok.c_str() + 1;
+		char* e;
+		long v1 = strtol(s, &e, 10);
+		if (e == s)
+		{
+			return false;
+		}
+		long v2 = v1;
+		/**диапазон вида "34..58"*/
+		if (e[0] == '.' && e[1] == '.')
+		{
+			s = e + 2;
+			v2 = strtol(s, &e, 10);
+			if (e == s)
+			{
+				return false;
+			}
+		}
+		if (*e != '\0')
+		{
+			return false;
+		}
+		switch (key)
+		{
+		case 'R':
+			r.radius = (int)v1;
+			break;
+		case 'C':
+			/**C0 и C1 означают обычные два состояния*/
+			r.states = v1 < 2 ? 2 : (int)v1;
+			break;
+		case 'M':
+			r.center = v1 != 0;
+			break;
+		case 'S':
+			r.s1 = (int)v1; r.s2 = (int)v2; hasS = true;
+			break;
+		case 'B':
+			r.b1 = (int)v1; r.b2 = (int)v2; hasB = true;
+			break;
+		default:
+			return false;
+		}
+	}
+	return hasB && hasS && r.radius >= 1 && r.radius <= 100 && r.states <= 16;
+}
+
+/**
+ *\param text запись правила: "B3/S23", "B2/S/C3", "B2/S345/C4" или запись LtL
+ *\param r    заполняемое правило
+ *\return true, если запись корректна
+ *\details Разбор записи правила. Запись, начинающаяся с 'R', считается правилом
+ * "Larger than Life", остальные - правилами "Generations".
+*/
+bool parseRule(const string& text, rule& r)
+{
+	r = rule();
+	r.states = 2;
+	r.radius = 1;
+	r.name = text;
+	if (!text.empty() && toupper((unsigned char)text[0]) == 'R')
+	{
+		return parseLtl(text, r);
+	}
+	r.family = RULE_GENERATIONS;
+	/**текущая часть записи: 'B', 'S' или 'C'*/
+	char part = 0;
+	for (size_t k = 0; k < text.size(); k++)
+	{
+		char c = (char)toupper((unsigned char)text[k]);
+		if (c == 'B' || c == 'S')
+		{
+			part = c;
+		}
+		else if (c == 'C' || c == 'G')
+		{
+			part = 'C';
+			r.states = 0;
+		}
+		else if (c == '/')
+		{
+			part = 0;
+		}
+		else if (c >= '0' && c <= '9')
+		{
+			int d = c - '0';
+			if (part == 'C')
+			{
+				r.states = r.states * 10 + d;
+			}
+			else if (part == 'B' && d <= 8)
+			{
+				r.birth |= 1u << d;
+			}
+			else if (part == 'S' && d <= 8)
+			{
+				r.survive |= 1u << d;
+			}
+			else
+			{
+				return false;
+			}
+		}
+		else
+		{
+			return false;
+		}
+	}
+	return r.states >= 2 && r.states <= 16;
+}
+
+/**
+ *\param states количество состояний клетки
+ *\return количество битовых плоскостей для хранения состояния
+*/
+int planesFor(int states)
+{
+	int bits = 1;
+	while ((1 << bits) < states && bits < MAX_PLANES)
+	{
+		bits++;
+	}
+	return bits;
+}
+
+/**
+ *\param g    водоём
+ *\param h    количество строк
+ *\param w    количество столбцов
+ *\param bits количество битовых плоскостей
+ *\details Создание пустого водоёма заданного размера.
+*/
+void planeInit(planeGrid& g, int h, int w, int bits)
+{
+	g.h = h;
+	g.w = w;
+	g.words = (w + 63) / 64;
+	g.bits = bits;
+	for (int b = 0; b < MAX_PLANES; b++)
+	{
+		g.plane[b].assign(b < bits ? (size_t)h * g.words : 0, 0);
+	}
+}
+
+/**
+ *\param g водоём
+ *\return объём памяти, выделенной под плоскости водоёма, в байтах
+*/
+uint64_t planeBytes(const planeGrid& g)
+{
+	uint64_t bytes = 0;
+	for (int b = 0; b < MAX_PLANES; b++)
+	{
+		bytes += g.plane[b].capacity() * sizeof(uint64_t);
+	}
+	return bytes;
+}
+
+/**
+ *\param g водоём
+ *\details Все клетки переводятся в состояние 0 (вода).
+*/
+void planeClear(planeGrid& g)
+{
+	for (int b = 0; b < g.bits; b++)
+	{
+		fill(g.plane[b].begin(), g.plane[b].end(), 0);
+	}
+}
+
+/**
+ *\param g водоём
+ *\param i строка
+ *\param j столбец
+ *\return состояние клетки
+*/
+int planeGet(const planeGrid& g, int i, int j)
+{
+	size_t k = (size_t)i * g.words + (j >> 6);
+	int state = 0;
+	for (int b = 0; b < g.bits; b++)
+	{
+		state |= (int)((g.plane[b][k] >> (j & 63)) & 1) << b;
+	}
+	return state;
+}
+
+/**
+ *\param g     водоём
+ *\param i     строка
+ *\param j     столбец
+ *\param state новое состояние клетки
+*/
+void planeSet(planeGrid& g, int i, int j, int state)
+{
+	size_t k = (size_t)i * g.words + (j >> 6);
+	uint64_t bit = 1ull << (j & 63);
+	for (int b = 0; b < g.bits; b++)
+	{
+		if ((state >> b) & 1)
+		{
+			g.plane[b][k] |= bit;
+		}
+		else
+		{
+			g.plane[b][k] &= ~bit;
+		}
+	}
+}
+
+/**
+ *\param g водоём
+ *\return количество живых клеток (состояние 1)
+*/
+int64_t planePopulation(const planeGrid& g)
+{
+	int64_t n = 0;
+	for (size_t k = 0; k < (size_t)g.h * g.words; k++)
+	{
+		uint64_t alive = g.plane[0][k];
+		for (int b = 1; b < g.bits; b++)
+		{
+			alive &= ~g.plane[b][k];
+		}
+		for (; alive; alive &= alive - 1)
+		{
+			n++;
+		}
+	}
+	return n;
+}
+
+/**
+ *\param g     водоём
+ *\param alive массив для маски живых клеток (состояние 1)
+ *\param i0    первая строка маски
+ *\param i1    строка за последней строкой маски
+ *\details Построение маски живых клеток строк [i0, i1) по битовым плоскостям.
+*/
+static void aliveMask(const planeGrid& g, vector<uint64_t>& alive, int i0, int i1)
+{
+	size_t n0 = (size_t)i0 * g.words, n1 = (size_t)i1 * g.words;
+	alive.resize((size_t)g.h * g.words);
+	copy(g.plane[0].begin() + n0, g.plane[0].begin() + n1, alive.begin() + n0);
+	for (int b = 1; b < g.bits; b++)
+	{
+		for (size_t k = n0; k < n1; k++)
+		{
+			alive[k] &= ~g.plane[b][k];
+		}
+	}
+}
+
+/**
+ *\param n    битовые разряды количества соседей
+ *\param mask множество допустимых количеств соседей (бит k - k соседей)
+ *\return маска клеток, количество соседей которых входит в множество
+*/
+static uint64_t countIn(const uint64_t n[4], unsigned mask)
+{
+	uint64_t res = 0;
+	for (int k = 0; k <= 8; k++)
+	{
+		if ((mask >> k) & 1)
+		{
+			res |= ((k & 1) ? n[0] : ~n[0]) & ((k & 2) ? n[1] : ~n[1])
+				& ((k & 4) ? n[2] : ~n[2]) & ((k & 8) ? n[3] : ~n[3]);
+		}
+	}
+	return res;
+}
+
+/**
+ *\param g      текущее поколение
+ *\param g1     следующее поколение
+ *\param k      индекс слова в плоскости
+ *\param alive  маска живых клеток текущего поколения
+ *\param born   маска рождающихся клеток слова
+ *\param stay   маска выживающих живых клеток слова
+ *\param last   маска существующих столбцов слова
+ *\param states количество состояний клетки
+ *\return true, если слово не изменилось
+ *\details Запись нового состояния 64 клеток: рождённые и выжившие становятся живыми (1),
+ * погибшие живые и угасающие клетки переходят в следующее состояние, последнее
+ * состояние угасания сменяется водой.
+*/
+static bool applyWord(const planeGrid& g, planeGrid& g1, size_t k, const vector<uint64_t>& alive,
+	uint64_t born, uint64_t stay, uint64_t last, int states)
+{
+	uint64_t any = 0;
+	for (int b = 0; b < g.bits; b++)
+	{
+		any |= g.plane[b][k];
+	}
+	/**клетки, переходящие в следующее состояние угасания*/
+	uint64_t inc = (any & ~alive[k]) | (alive[k] & ~stay);
+	if (states == 2)
+	{
+		inc = 0;
+	}
+	uint64_t nw[MAX_PLANES];
+	uint64_t carry = inc;
+	uint64_t wrap = inc;
+	for (int b = 0; b < g.bits; b++)
+	{
+		nw[b] = g.plane[b][k] ^ carry;
+		carry &= g.plane[b][k];
+		wrap &= ((states >> b) & 1) ? nw[b] : ~nw[b];
+	}
+	uint64_t live = ((born & ~any) | (alive[k] & stay)) & last;
+	bool same = true;
+	for (int b = 0; b < g.bits; b++)
+	{
+		uint64_t v = (inc & ~wrap & nw[b]) | (b == 0 ? live : 0);
+		if (v != g.plane[b][k])
+		{
+			same = false;
+		}
+		g1.plane[b][k] = v;
+	}
+	return same;
+}
+
+/**
+ *\param g     текущее поколение
+ *\param g1    следующее поколение
+ *\param r     правило
+ *\param alive массив для маски живых клеток
+ *\param i0    первая вычисляемая строка
+ *\param i1    строка за последней вычисляемой строкой
+ *\return true, если строки [i0, i1) не изменились
+ *\details Шаг правила "Generations". Количество живых соседей считается сразу для 64 клеток
+ * побитовыми сумматорами над сдвинутыми словами соседних строк.
+*/
+static bool stepGenerations(const planeGrid& g, planeGrid& g1, const rule& r, vector<uint64_t>& alive, int i0, int i1)
+{
+	bool isOpt = true;
+	aliveMask(g, alive, max(0, i0 - 1), min(g.h, i1 + 1));
+	int words = g.words;
+	uint64_t tail = (g.w & 63) ? (1ull << (g.w & 63)) - 1 : ~0ull;
+	for (int i = i0; i < i1; i++)
+	{
+		const uint64_t* up = i > 0 ? &alive[(size_t)(i - 1) * words] : nullptr;
+		const uint64_t* mid = &alive[(size_t)i * words];
+		const uint64_t* dn = i + 1 < g.h ? &alive[(size_t)(i + 1) * words] : nullptr;
+		for (int k = 0; k < words; k++)
+		{
+			/**слова трёх строк и их сдвиги на столбец влево и вправо*/
+			uint64_t row[3][3];
+			const uint64_t* src[3] = {up, mid, dn};
+			for (int t = 0; t < 3; t++)
+			{
+				if (src[t] == nullptr)
+				{
+					row[t][0] = row[t][1] = row[t][2] = 0;
+					continue;
+				}
+				uint64_t a = src[t][k];
+				uint64_t prev = k > 0 ? src[t][k - 1] : 0;
+				uint64_t next = k + 1 < words ? src[t][k + 1] : 0;
+				row[t][0] = (a << 1) | (prev >> 63);
+				row[t][1] = a;
+				row[t][2] = (a >> 1) | (next << 63);
+			}
+			uint64_t n[4];
+			neighbourCount(row, n);
+			uint64_t last = k + 1 == words ? tail : ~0ull;
+			if (!applyWord(g, g1, (size_t)i * words + k, alive, countIn(n, r.birth), countIn(n, r.survive), last, r.states))
+			{
+				isOpt = false;
+			}
+		}
+	}
+	return isOpt;
+}
+
+/**
+ *\param g  текущее поколение
+ *\param g1 следующее поколение
+ *\param r  правило
+ *\return true, если поколение не изменилось
+ *\details Шаг правила "Larger than Life". Количество соседей в квадрате (2R+1)x(2R+1)
+ * считается скользящим окном: суммы по столбцам сдвигаются на строку вниз,
+ * а сумма окна - на столбец вправо, поэтому стоимость не зависит от R.
+*/
+static bool stepLtl(const planeGrid& g, planeGrid& g1, const rule& r)
+{
+	bool isOpt = true;
+	vector<uint64_t> alive;
+	aliveMask(g, alive, 0, g.h);
+	int R = r.radius;
+	int words = g.words;
+	/**количество живых клеток столбца в полосе строк [i-R, i+R]*/
+	vector<int> colSum(g.w, 0);
+	for (int i = 0; i <= R && i < g.h; i++)
+	{
+		for (int j = 0; j < g.w; j++)
+		{
+			colSum[j] += (int)((alive[(size_t)i * words + (j >> 6)] >> (j & 63)) & 1);
+		}
+	}
+	uint64_t tail = (g.w & 63) ? (1ull << (g.w & 63)) - 1 : ~0ull;
+	for (int i = 0; i < g.h; i++)
+	{
+		const uint64_t* mid = &alive[(size_t)i * words];
+		/**сумма окна для столбца 0*/
+		int s = 0;
+		for (int j = 0; j <= R && j < g.w; j++)
+		{
+			s += colSum[j];
+		}
+		for (int k = 0; k < words; k++)
+		{
+			uint64_t born = 0, stay = 0;
+			int jEnd = min(g.w, (k + 1) * 64);
+			for (int j = k * 64; j < jEnd; j++)
+			{
+				int self = (int)((mid[k] >> (j & 63)) & 1);
+				int n = r.center ? s : s - self;
+				uint64_t bit = 1ull << (j & 63);
+				if (n >= r.b1 && n <= r.b2)
+				{
+					born |= bit;
+				}
+				if (n >= r.s1 && n <= r.s2)
+				{
+					stay |= bit;
+				}
+				/**сдвиг окна на столбец вправо*/
+				if (j + R + 1 < g.w)
+				{
+					s += colSum[j + R + 1];
+				}
+				if (j - R >= 0)
+				{
+					s -= colSum[j - R];
+				}
+			}
+			uint64_t last = k + 1 == words ? tail : ~0ull;
+			if (!applyWord(g, g1, (size_t)i * words + k, alive, born, stay, last, r.states))
+			{
+				isOpt = false;
+			}
+		}
+		/**сдвиг полосы строк на строку вниз*/
+		int add = i + R + 1, sub = i - R;
+		for (int j = 0; j < g.w; j++)
+		{
+			if (add < g.h)
+			{
+				colSum[j] += (int)((alive[(size_t)add * words + (j >> 6)] >> (j & 63)) & 1);
+			}
+			if (sub >= 0)
+			{
+				colSum[j] -= (int)((alive[(size_t)sub * words + (j >> 6)] >> (j & 63)) & 1);
+			}
+		}
+	}
+	return isOpt;
+}
+
+/**
+ *\param g  текущее поколение
+ *\param g1 водоём для следующего поколения (того же размера)
+ *\param r  правило
+ *\return isOpt флаг остановки цикла жизни
+ *\details Генерирование следующего поколения по правилу r. Как и в nextGeneration,
+ * клетки за границей водоёма считаются мёртвыми, а после шага водоёмы меняются местами.
+*/
+bool nextGenerationRule(planeGrid& g, planeGrid& g1, const rule& r)
+{
+	PROFILE_SCOPE("nextGenerationRule");
+	vector<uint64_t> alive;
+	bool isOpt = r.family == RULE_LTL ? stepLtl(g, g1, r) : stepGenerations(g, g1, r, alive, 0, g.h);
+	for (int b = 0; b < MAX_PLANES; b++)
+	{
+		g.plane[b].swap(g1.plane[b]);
+	}
+	return isOpt;
+}
+
+/**
+ *\param a  плитка с окаймлением
+ *\param i0 строка водоёма, соответствующая строке 0 плитки
+ *\param w0 слово водоёма, соответствующее слову 0 плитки
+ *\param g  водоём
+ *\details Клетки плитки за границей водоёма снова становятся мёртвыми: за границей
+ * водоёма клетки всегда мертвы, как и при вычислении без плиток.
+*/
+static void clearOutside(planeGrid& a, int i0, int w0, const planeGrid& g)
+{
+	uint64_t tail = (g.w & 63) ? (1ull << (g.w & 63)) - 1 : ~0ull;
+	int k0 = max(0, -w0), k1 = min(a.words, g.words - w0);
+	for (int b = 0; b < a.bits; b++)
+	{
+		for (int li = 0; li < a.h; li++)
+		{
+			uint64_t* row = &a.plane[b][(size_t)li * a.words];
+			int gi = i0 + li;
+			if (gi < 0 || gi >= g.h || k1 <= k0)
+			{
+				fill(row, row + a.words, 0);
+				continue;
+			}
+			fill(row, row + k0, 0);
+			fill(row + k1, row + a.words, 0);
+			row[k1 - 1] &= k1 + w0 == g.words ? tail : ~0ull;
+		}
+	}
+}
+
+/**
+ *\param g  текущее поколение
+ *\param g1 водоём того же размера (после вызова содержимое не определено)
+ *\param r  правило
+ *\param k  количество поколений
+ *\return true, если последнее из k поколений не изменило водоём
+ *\details k шагов nextGenerationRule с временными плитками для правил "Generations".
+ * Водоём делится на плитки TEMPORAL_ROWS строк x TEMPORAL_WORDS слов; плитка вместе с
+ * окаймлением в k строк и одно слово (до 64 столбцов) с каждой стороны копируется в
+ * буфер, помещающийся в кэш, и вычисляется k поколений подряд. Достоверная часть буфера
+ * сужается на клетку за поколение, и на шаге t вычисляются только строки, ещё нужные
+ * плитке (трапеция); после k поколений достоверна вся плитка, и она записывается в g1.
+ * Водоём читается и записывается один раз на k поколений, а результат совпадает с k
+ * отдельными шагами до бита. Для "Larger than Life" и k < 2 выполняются отдельные шаги.
+*/
+bool nextGenerationsBlocked(planeGrid& g, planeGrid& g1, const rule& r, int k)
+{
+	PROFILE_SCOPE("nextGenerationsBlocked");
+	bool isOpt = false;
+	if (r.family != RULE_GENERATIONS || k < 2)
+	{
+		for (int t = 0; t < k; t++)
+		{
+			isOpt = nextGenerationRule(g, g1, r);
+		}
+		return isOpt;
+	}
+	while (k > TEMPORAL_MAX)
+	{
+		nextGenerationsBlocked(g, g1, r, TEMPORAL_MAX);
+		k -= TEMPORAL_MAX;
+	}
+	isOpt = true;
+	planeGrid a, b;
+	planeInit(a, TEMPORAL_ROWS + 2 * k, (TEMPORAL_WORDS + 2) * 64, g.bits);
+	planeInit(b, a.h, a.w, g.bits);
+	vector<uint64_t> alive;
+	for (int ti = 0; ti < g.h; ti += TEMPORAL_ROWS)
+	{
+		for (int tw = 0; tw < g.words; tw += TEMPORAL_WORDS)
+		{
+			int rows = min(TEMPORAL_ROWS, g.h - ti), words = min(TEMPORAL_WORDS, g.words - tw);
+			int i0 = ti - k, w0 = tw - 1;
+			/**загрузка плитки с окаймлением; слова за границей водоёма обнуляет clearOutside*/
+			int k0 = max(0, -w0), k1 = min(a.words, g.words - w0);
+			for (int p = 0; p < g.bits; p++)
+			{
+				for (int li = max(0, -i0); li < a.h && i0 + li < g.h; li++)
+				{
+					copy(&g.plane[p][(size_t)(i0 + li) * g.words + w0 + k0], &g.plane[p][(size_t)(i0 + li) * g.words + w0 + k1],
+						&a.plane[p][(size_t)li * a.words + k0]);
+				}
+			}
+			clearOutside(a, i0, w0, g);
+			for (int t = 0; t < k; t++)
+			{
+				stepGenerations(a, b, r, alive, t + 1, a.h - t - 1);
+				for (int p = 0; p < g.bits; p++)
+				{
+					a.plane[p].swap(b.plane[p]);
+				}
+				clearOutside(a, i0, w0, g);
+			}
+			/**a - поколение k, b - поколение k - 1; внутренняя часть плитки переносится в g1*/
+			for (int p = 0; p < g.bits; p++)
+			{
+				for (int li = 0; li < rows; li++)
+				{
+					const uint64_t* src = &a.plane[p][(size_t)(k + li) * a.words + 1];
+					const uint64_t* prev = &b.plane[p][(size_t)(k + li) * a.words + 1];
+					copy(src, src + words, &g1.plane[p][(size_t)(ti + li) * g.words + tw]);
+					isOpt = isOpt && equal(src, src + words, prev);
+				}
+			}
+		}
+	}
+	for (int p = 0; p < MAX_PLANES; p++)
+	{
+		g.plane[p].swap(g1.plane[p]);
+	}
+	return isOpt;
+}
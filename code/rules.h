@@ -0,0 +1,140 @@
+﻿/**
+ *\file rules.h
+ *\version 1.0
+ *\date October 2026
+ *\details Многоцветные семейства правил: "Generations" (клетка после гибели
+ * проходит через несколько состояний угасания) и "Larger than Life"
+ * (соседство радиуса R). Состояния клеток упакованы по 2-4 бита
+ * в битовые плоскости из 64-битных слов.
+ */
+
+#pragma once
+
+#include "slab.h"
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/**Максимальное количество битовых плоскостей (до 16 состояний клетки)*/
+#define MAX_PLANES 4
+
+/**Наибольшее количество поколений за один проход временных плиток (окаймление - одно слово)*/
+#define TEMPORAL_MAX 64
+/**Размер временной плитки: строк и 64-битных слов в строке*/
+#define TEMPORAL_ROWS 128
+#define TEMPORAL_WORDS 32
+
+/**Семейство правил "Generations" (окрестность Мура, радиус 1)*/
+#define RULE_GENERATIONS 0
+/**Семейство правил "Larger than Life" (квадратная окрестность радиуса R)*/
+#define RULE_LTL 1
+
+/**
+ *\struct rule
+ *\details Описание правила клеточного автомата.
+ * Состояние 0 - вода, 1 - живая бактерия, 2..states-1 - угасающая бактерия.
+ * Для обычной "Жизни" states = 2.
+*/
+struct rule
+{
+	/**семейство правил (RULE_GENERATIONS или RULE_LTL)*/
+	int family;
+	/**количество состояний клетки (2..16)*/
+	int states;
+	/**радиус окрестности*/
+	int radius;
+	/**учитывается ли сама клетка при подсчёте соседей (только LtL)*/
+	bool center;
+	/**битовая маска количеств соседей для рождения (Generations)*/
+	unsigned birth;
+	/**битовая маска количеств соседей для выживания (Generations)*/
+	unsigned survive;
+	/**границы количеств соседей для рождения и выживания (LtL)*/
+	int b1, b2, s1, s2;
+	/**исходная запись правила*/
+	std::string name;
+};
+
+/**
+ *\struct planeGrid
+ *\details Водоём с многобитными клетками. Бит b состояния клетки (i, j) хранится
+ * в бите (j % 64) слова plane[b][i * words + j / 64]. Плоскости выделяются slabAlloc.
+*/
+struct planeGrid
+{
+	/**количество строк*/
+	int h;
+	/**количество столбцов*/
+	int w;
+	/**количество 64-битных слов в строке одной плоскости*/
+	int words;
+	/**количество битовых плоскостей*/
+	int bits;
+	/**битовые плоскости состояний*/
+	std::vector<uint64_t, slabAllocator<uint64_t>> plane[MAX_PLANES];
+};
+
+/**
+ *\param sh слова трёх строк сверху вниз со сдвигами на столбец: sh[t][0] - соседи слева,
+ * sh[t][1] - сама строка, sh[t][2] - соседи справа
+ *\param n  количество соседей 64 клеток в битах n[0]..n[3]
+ *\details Сложение восьми однобитных слагаемых в четырёхбитный счётчик (сама клетка sh[1][1]
+ * не считается)
+*/
+static inline void neighbourCount(const uint64_t sh[3][3], uint64_t n[4])
+{
+	uint64_t x, y, z;
+	x = sh[0][0]; y = sh[0][1]; z = sh[0][2];
+	uint64_t s1 = x ^ y ^ z, c1 = (x & y) | (z & (x ^ y));
+	x = sh[1][0]; y = sh[1][2]; z = sh[2][0];
+	uint64_t s2 = x ^ y ^ z, c2 = (x & y) | (z & (x ^ y));
+	uint64_t s3 = sh[2][1] ^ sh[2][2], c3 = sh[2][1] & sh[2][2];
+	n[0] = s1 ^ s2 ^ s3;
+	uint64_t cs = (s1 & s2) | (s3 & (s1 ^ s2));
+	uint64_t t4 = c1 ^ c2 ^ c3, ct = (c1 & c2) | (c3 & (c1 ^ c2));
+	n[1] = t4 ^ cs;
+	uint64_t ct2 = t4 & cs;
+	n[2] = ct ^ ct2;
+	n[3] = ct & ct2;
+}
+
+/**
+ *\param sh слова трёх строк со сдвигами, как у neighbourCount
+ *\return следующее поколение 64 клеток средней строки по правилу B3/S23
+*/
+static inline uint64_t lifeWord(const uint64_t sh[3][3])
+{
+	uint64_t n[4];
+	neighbourCount(sh, n);
+	/**живая, если соседей ровно 3 или ровно 2 у живой клетки (n[2] | n[3] - 4 и более соседей)*/
+	return n[1] & ~(n[2] | n[3]) & (n[0] | sh[1][1]);
+}
+
+/**
+ *\param v не нулевое слово
+ *\return номер младшего единичного бита
+ *\details Умножение на последовательность де Брёйна, без встроенных функций компилятора
+*/
+static inline int lowBit(uint64_t v)
+{
+	static const int index[64] =
+	{
+		0, 1, 2, 53, 3, 7, 54, 27, 4, 38, 41, 8, 34, 55, 48, 28,
+		62, 5, 39, 46, 44, 42, 22, 9, 24, 35, 59, 56, 49, 18, 29, 11,
+		63, 52, 6, 26, 37, 40, 33, 47, 61, 45, 43, 21, 23, 58, 17, 10,
+		51, 25, 36, 32, 60, 20, 57, 16, 50, 31, 19, 15, 30, 14, 13, 12
+	};
+	return index[((v & (0 - v)) * 0x022fdd63cc95386dull) >> 58];
+}
+
+bool parseRule(const std::string& text, rule& r);
+int planesFor(int states);
+void planeInit(planeGrid& g, int h, int w, int bits);
+uint64_t planeBytes(const planeGrid& g);
+void planeClear(planeGrid& g);
+int planeGet(const planeGrid& g, int i, int j);
+void planeSet(planeGrid& g, int i, int j, int state);
+int64_t planePopulation(const planeGrid& g);
+bool nextGenerationRule(planeGrid& g, planeGrid& g1, const rule& r);
+bool nextGenerationsBlocked(planeGrid& g, planeGrid& g1, const rule& r, int k);
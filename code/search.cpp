@@ -0,0 +1,407 @@
+﻿/**
+ *\file search.cpp
+ *\version 1.0
+ *\date October 2026
+ *\details Поиск колонии в водоёме: положения колонии, просмотр строк словами и режим --search
+ */
+
+#include "search.h"
+#include "edit.h"
+#include "library.h"
+#include "options.h"
+#include "profile.h"
+#include "thumbs.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <mutex>
+#include <random>
+
+using namespace std;
+
+/**
+ *\param q        запрос
+ *\param h, w     размеры колонии
+ *\param words    слов в строке колонии
+ *\param bits     строки колонии (бит j слова j / 64 - клетка столбца j)
+ *\param isolated колония должна быть окружена мёртвыми клетками
+ *\return false, если в колонии нет живых клеток или она больше SEARCH_SIDE клеток по стороне
+ *\details Колония обрезается по живым клеткам, затем строятся её восемь положений (как у
+ * editPlace: отражение столбцов, затем повороты по часовой стрелке); совпадающие положения
+ * симметричных колоний остаются в одном экземпляре.
+*/
+bool searchPrepare(searchQuery& q, int h, int w, int words, const vector<uint64_t>& bits, bool isolated)
+{
+	q.isolated = isolated;
+	q.shapes.clear();
+	vector<pair<int, int>> cells;
+	int i0 = h, j0 = w, i1 = -1, j1 = -1;
+	for (int i = 0; i < h; i++)
+	{
+		for (int j = 0; j < w; j++)
+		{
+			if ((bits[(size_t)i * words + j / 64] >> (j % 64)) & 1)
+			{
+				cells.push_back({i, j});
+				i0 = min(i0, i); i1 = max(i1, i);
+				j0 = min(j0, j); j1 = max(j1, j);
+			}
+		}
+	}
+	if (cells.empty() || i1 - i0 + 1 > SEARCH_SIDE || j1 - j0 + 1 > SEARCH_SIDE)
+	{
+		return false;
+	}
+	for (auto& x : cells)
+	{
+		x = {x.first - i0, x.second - j0};
+	}
+	int b = isolated ? 1 : 0;
+	vector<vector<uint64_t>> seen;
+	for (int o = 0; o < SEARCH_ORIENTS; o++)
+	{
+		int sh = i1 - i0 + 1, sw = j1 - j0 + 1;
+		vector<pair<int, int>> oc = cells;
+		if (o >= 4)
+		{
+			for (auto& x : oc)
+			{
+				x.second = sw - 1 - x.second;
+			}
+		}
+		for (int r = 0; r < o % 4; r++)
+		{
+			for (auto& x : oc)
+			{
+				x = {x.second, sh - 1 - x.first};
+			}
+			swap(sh, sw);
+		}
+		/**строки окна с окаймлением: живые клетки по столбцам*/
+		vector<uint64_t> live(sh + 2 * b, 0);
+		for (const auto& x : oc)
+		{
+			live[x.first + b] |= 1ull << (x.second + b);
+		}
+		live.push_back((uint64_t)sh << 32 | (uint32_t)sw);
+		if (find(seen.begin(), seen.end(), live) != seen.end())
+		{
+			continue;
+		}
+		seen.push_back(live);
+		searchShape s;
+		s.h = sh;
+		s.w = sw;
+		s.orient = o;
+		for (int pass = 1; pass >= 0; pass--)
+		{
+			for (int r = 0; r < sh + 2 * b; r++)
+			{
+				for (int c = 0; c < sw + 2 * b; c++)
+				{
+					if ((int)((live[r] >> c) & 1) == pass)
+					{
+						s.probes.push_back({r, c, pass == 1});
+					}
+				}
+			}
+		}
+		q.shapes.push_back(move(s));
+	}
+	return true;
+}
+
+/**
+ *\param row строка буфера
+ *\param pos номер бита строки
+ *\return 64 бита строки, начиная с pos
+*/
+static inline uint64_t bitsAt(const uint64_t* row, int64_t pos)
+{
+	int64_t k = pos >> 6;
+	int s = (int)(pos & 63);
+	return s == 0 ? row[k] : (row[k] >> s) | (row[k + 1] << (64 - s));
+}
+
+/**
+ *\param q     запрос
+ *\param h, w  размеры водоёма
+ *\param fetch запись строки i водоёма в (w + 63) / 64 слов (клетки за столбцом w - мёртвые)
+ *\param pool  пул потоков
+ *\return найденные колонии по строкам, столбцам и положениям
+ *\details Строки, на которых может начинаться колония, делятся на полосы. Для полосы строки
+ * водоёма вместе с окаймлением копируются в буфер со словом воды слева и справа. Для каждых
+ * 64 столбцов строки полосы один раз сдвигаются на каждый столбец окна, после чего каждое
+ * положение колонии проверяется для 64 мест сразу: клетка окна - одно сдвинутое слово,
+ * сравниваемое с её ожидаемым состоянием во всех 64 местах.
+*/
+vector<searchMatch> searchRows(const searchQuery& q, int64_t h, int64_t w, const function<void(int64_t i, uint64_t* row)>& fetch,
+	workPool& pool)
+{
+	PROFILE_SCOPE("search");
+	vector<searchMatch> found;
+	if (q.shapes.empty() || h <= 0 || w <= 0)
+	{
+		return found;
+	}
+	int b = q.isolated ? 1 : 0, tall = 0, wide = 0;
+	for (const searchShape& s : q.shapes)
+	{
+		tall = max(tall, s.h);
+		wide = max(wide, s.w + 2 * b);
+	}
+	/**клетки окна как смещения в таблице сдвинутых слов: строка окна * wide + столбец*/
+	vector<vector<pair<int, bool>>> offsets(q.shapes.size());
+	for (size_t n = 0; n < q.shapes.size(); n++)
+	{
+		for (const searchProbe& p : q.shapes[n].probes)
+		{
+			offsets[n].push_back({p.r * wide + p.c, p.live});
+		}
+	}
+	int64_t words = (w + 63) / 64, stride = words + 4;
+	uint64_t tailMask = w % 64 == 0 ? ~0ull : (1ull << (w % 64)) - 1;
+	mutex lock;
+	parallelFor(pool, h, 64, [&](int64_t lo, int64_t hi)
+	{
+		/**буфер строк lo - b .. hi + tall + b - 1; строка водоёма начинается со второго слова*/
+		int64_t top = lo - b, rows = hi - lo + tall + 2 * b;
+		vector<uint64_t> buf((size_t)(rows * stride), 0);
+		for (int64_t r = 0; r < rows; r++)
+		{
+			if (top + r >= 0 && top + r < h)
+			{
+				uint64_t* row = &buf[(size_t)(r * stride) + 1];
+				fetch(top + r, row);
+				row[words - 1] &= tailMask;
+			}
+		}
+		vector<searchMatch> local;
+		/**строки буфера, сдвинутые на каждый столбец окна, для 64 мест текущего слова*/
+		vector<uint64_t> shifted((size_t)(rows * wide));
+		for (int64_t k = 0; k < words; k++)
+		{
+			for (int64_t r = 0; r < rows; r++)
+			{
+				for (int c = 0; c < wide; c++)
+				{
+					shifted[(size_t)(r * wide + c)] = bitsAt(&buf[(size_t)(r * stride)], 64 + k * 64 - b + c);
+				}
+			}
+			for (size_t n = 0; n < q.shapes.size(); n++)
+			{
+				const searchShape& s = q.shapes[n];
+				/**места k * 64 + t, где колония помещается в водоём*/
+				int64_t last = w - s.w - k * 64;
+				if (last < 0)
+				{
+					continue;
+				}
+				uint64_t valid = last >= 63 ? ~0ull : (1ull << (last + 1)) - 1;
+				for (int64_t i = lo; i < min(hi, h - s.h + 1); i++)
+				{
+					const uint64_t* window = &shifted[(size_t)((i - lo) * wide)];
+					uint64_t alive = valid;
+					for (const auto& p : offsets[n])
+					{
+						alive &= p.second ? window[p.first] : ~window[p.first];
+						if (alive == 0)
+						{
+							break;
+						}
+					}
+					while (alive != 0)
+					{
+						int t = 0;
+						while (((alive >> t) & 1) == 0)
+						{
+							t++;
+						}
+						alive &= alive - 1;
+						local.push_back({i, k * 64 + t, s.h, s.w, s.orient});
+					}
+				}
+			}
+		}
+		lock_guard<mutex> g(lock);
+		found.insert(found.end(), local.begin(), local.end());
+	});
+	sort(found.begin(), found.end(), [](const searchMatch& a, const searchMatch& b)
+	{
+		return a.i != b.i ? a.i < b.i : a.j != b.j ? a.j < b.j : a.orient < b.orient;
+	});
+	return found;
+}
+
+/**
+ *\param q    запрос
+ *\param g    водоём с битовыми плоскостями (живые клетки - в плоскости 0)
+ *\param pool пул потоков
+ *\return найденные колонии
+*/
+vector<searchMatch> searchPlanes(const searchQuery& q, const planeGrid& g, workPool& pool)
+{
+	return searchRows(q, g.h, g.w, [&](int64_t i, uint64_t* row)
+	{
+		memcpy(row, &g.plane[0][(size_t)i * g.words], (size_t)g.words * sizeof(uint64_t));
+	}, pool);
+}
+
+/**
+ *\param q    запрос
+ *\param g    водоём из плиток
+ *\param pool пул потоков
+ *\return найденные колонии
+ *\details Строка водоёма собирается из строк плиток
+*/
+vector<searchMatch> searchTiled(const searchQuery& q, tiledGrid& g, workPool& pool)
+{
+	return searchRows(q, g.h, g.w, [&](int64_t i, uint64_t* row)
+	{
+		int64_t words = (g.w + 63) / 64;
+		for (int64_t tx = 0; tx < g.tilesX; tx++)
+		{
+			const uint64_t* t = tiledRow(g, i, tx);
+			int64_t n = min<int64_t>(TILE_WORDS, words - tx * TILE_WORDS);
+			memcpy(row + tx * TILE_WORDS, t, (size_t)n * sizeof(uint64_t));
+		}
+	}, pool);
+}
+
+/**
+ *\param argc количество параметров после ключа --search
+ *\param argv параметры rows=, cols=, density=, seed=, pattern= (номер колонии библиотеки 1..LIBRARY_SIZE
+ * или файл RLE / .cells), isolated=, plant=, threads=, board= (файл водоёма из плиток rows x cols
+ * вместо случайного), out= (файл CSV найденных колоний)
+ *\return код завершения программы
+ *\details Поиск колонии в случайном водоёме с plant= вставленными копиями в случайных
+ * положениях (или в водоёме из плиток) и сверка: все вставленные копии должны найтись.
+*/
+int searchRun(int argc, char* argv[])
+{
+	int64_t h = atoll(option(argc, argv, "rows", "16384").c_str()), w = atoll(option(argc, argv, "cols", "16384").c_str());
+	double density = atof(option(argc, argv, "density", "0.3").c_str());
+	string pattern = option(argc, argv, "pattern", "1");
+	bool isolated = atoi(option(argc, argv, "isolated", "1").c_str()) != 0;
+	int plant = atoi(option(argc, argv, "plant", "100").c_str());
+	string board = option(argc, argv, "board", ""), out = option(argc, argv, "out", "");
+	workPool pool(atoi(option(argc, argv, "threads", "0").c_str()));
+	thumbEntry e;
+	int n = atoi(pattern.c_str());
+	if (n >= 1 && n <= LIBRARY_SIZE)
+	{
+		editCommand c = editPlace(library[n - 1], 0, false, 0, 0);
+		e.h = (int)c.i1;
+		e.w = (int)c.j1;
+		e.words = c.words;
+		e.bits = c.bits;
+	}
+	else if (!thumbLoad(pattern, e))
+	{
+		printf("cannot read pattern %s\n", pattern.c_str());
+		return 1;
+	}
+	searchQuery q;
+	if (!searchPrepare(q, e.h, e.w, e.words, e.bits, isolated) || h <= 0 || w <= 0 || h > INT32_MAX || w > INT32_MAX)
+	{
+		printf("pattern must have live cells and fit in %dx%d, board must be positive\n", SEARCH_SIDE, SEARCH_SIDE);
+		return 1;
+	}
+	vector<searchMatch> found;
+	vector<searchMatch> planted;
+	double sec;
+	if (!board.empty())
+	{
+		tiledGrid g;
+		if (!tiledOpen(g, board.c_str(), h, w))
+		{
+			printf("cannot open %s\n", board.c_str());
+			return 1;
+		}
+		auto t0 = chrono::steady_clock::now();
+		found = searchTiled(q, g, pool);
+		sec = chrono::duration<double>(chrono::steady_clock::now() - t0).count();
+		tiledClose(g);
+	}
+	else
+	{
+		planeGrid g;
+		planeInit(g, (int)h, (int)w, 1);
+		mt19937_64 rng(atoll(option(argc, argv, "seed", "1").c_str()));
+		uint64_t threshold = (uint64_t)(density * 65536);
+		for (int64_t i = 0; i < h; i++)
+		{
+			for (int64_t k = 0; k < g.words; k++)
+			{
+				uint64_t word = 0;
+				for (int t = 0; t < 64; t += 4)
+				{
+					uint64_t r = rng();
+					for (int u = 0; u < 4; u++, r >>= 16)
+					{
+						word |= (uint64_t)((r & 65535) < threshold) << (t + u);
+					}
+				}
+				g.plane[0][(size_t)i * g.words + k] = word;
+			}
+		}
+		/**вставка копий с окаймлением в случайных положениях; копии не перекрываются*/
+		int b = isolated ? 1 : 0;
+		for (int k = 0; k < plant * 4 && (int)planted.size() < plant; k++)
+		{
+			const searchShape& s = q.shapes[rng() % q.shapes.size()];
+			if (h < s.h + 2 * b || w < s.w + 2 * b)
+			{
+				break;
+			}
+			int64_t i = b + (int64_t)(rng() % (uint64_t)(h - s.h - 2 * b + 1)), j = b + (int64_t)(rng() % (uint64_t)(w - s.w - 2 * b + 1));
+			bool overlap = false;
+			for (const searchMatch& m : planted)
+			{
+				overlap = overlap || (i - b < m.i + m.h + b && m.i - b < i + s.h + b && j - b < m.j + m.w + b && m.j - b < j + s.w + b);
+			}
+			if (overlap)
+			{
+				continue;
+			}
+			for (const searchProbe& p : s.probes)
+			{
+				planeSet(g, (int)(i - b + p.r), (int)(j - b + p.c), p.live ? 1 : 0);
+			}
+			planted.push_back({i, j, s.h, s.w, s.orient});
+		}
+		auto t0 = chrono::steady_clock::now();
+		found = searchPlanes(q, g, pool);
+		sec = chrono::duration<double>(chrono::steady_clock::now() - t0).count();
+	}
+	int hits = 0;
+	for (const searchMatch& m : planted)
+	{
+		hits += binary_search(found.begin(), found.end(), m, [](const searchMatch& a, const searchMatch& b)
+		{
+			return a.i != b.i ? a.i < b.i : a.j != b.j ? a.j < b.j : a.orient < b.orient;
+		});
+	}
+	printf("%lldx%lld board, %d orientations, %zu matches in %.3f s (%d threads)", (long long)h, (long long)w,
+		(int)q.shapes.size(), found.size(), sec, pool.size());
+	printf(board.empty() ? ", planted %d found %d\n" : "\n", (int)planted.size(), hits);
+	if (!out.empty())
+	{
+		FILE* f = fopen(out.c_str(), "w");
+		if (f == nullptr)
+		{
+			printf("cannot write %s\n", out.c_str());
+			return 1;
+		}
+		fprintf(f, "row,col,rows,cols,orientation\n");
+		for (const searchMatch& m : found)
+		{
+			fprintf(f, "%lld,%lld,%d,%d,%d\n", (long long)m.i, (long long)m.j, m.h, m.w, m.orient);
+		}
+		fclose(f);
+	}
+	return hits == (int)planted.size() ? 0 : 1;
+}
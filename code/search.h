@@ -0,0 +1,75 @@
+﻿/**
+ *\file search.h
+ *\version 1.0
+ *\date October 2026
+ *\details Поиск колонии в водоёме во всех восьми поворотах и отражениях. Для каждого различного
+ * положения колонии заранее составляется список проверяемых клеток окна (сначала живые - они
+ * отсекают больше мест), а водоём просматривается словами: одно слово строки, сдвинутое на
+ * столбец клетки окна, проверяет эту клетку сразу для 64 мест колонии подряд. Места, где
+ * колония не совпала, выбывают после первой же несовпавшей клетки. Полосы строк водоёма
+ * просматриваются потоками пула.
+ */
+
+#pragma once
+
+#include "pool.h"
+#include "rules.h"
+#include "tiled.h"
+
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+/**Наибольшая сторона колонии в клетках (окно с окаймлением помещается в слово)*/
+#define SEARCH_SIDE 62
+/**Количество поворотов и отражений*/
+#define SEARCH_ORIENTS 8
+
+/**
+ *\struct searchProbe
+ *\details Проверяемая клетка окна: строка, столбец и ожидаемое состояние
+*/
+struct searchProbe
+{
+	int r, c;
+	bool live;
+};
+
+/**
+ *\struct searchShape
+ *\details Одно положение колонии: размеры, номер положения (поворот orient % 4 по часовой стрелке
+ * после отражения при orient >= 4) и клетки окна в порядке проверки
+*/
+struct searchShape
+{
+	int h, w, orient;
+	std::vector<searchProbe> probes;
+};
+
+/**
+ *\struct searchQuery
+ *\details Различные положения колонии; у отдельно стоящей колонии (isolated) окно включает
+ * окаймление из мёртвых клеток в одну клетку
+*/
+struct searchQuery
+{
+	bool isolated;
+	std::vector<searchShape> shapes;
+};
+
+/**
+ *\struct searchMatch
+ *\details Найденная колония: левый верхний угол, размеры и номер положения
+*/
+struct searchMatch
+{
+	int64_t i, j;
+	int h, w, orient;
+};
+
+bool searchPrepare(searchQuery& q, int h, int w, int words, const std::vector<uint64_t>& bits, bool isolated);
+std::vector<searchMatch> searchRows(const searchQuery& q, int64_t h, int64_t w,
+	const std::function<void(int64_t i, uint64_t* row)>& fetch, workPool& pool);
+std::vector<searchMatch> searchPlanes(const searchQuery& q, const planeGrid& g, workPool& pool);
+std::vector<searchMatch> searchTiled(const searchQuery& q, tiledGrid& g, workPool& pool);
+int searchRun(int argc, char* argv[]);
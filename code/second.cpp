@@ -18,6 +18,35 @@
 */
 
 #include <SFML/Graphics.hpp>
+#include "census.h"
+#include "dedup.h"
+#include "distributed.h"
+#include "edit.h"
+#include "ensemble.h"
+#include "framebuf.h"
+#include "memtrack.h"
+#include "objects.h"
+#include "options.h"
+#include "parent.h"
+#include "profile.h"
+#include "record.h"
+#include "rules.h"
+#include "search.h"
+#include "slab.h"
+#include "sparse.h"
+#include "thumbs.h"
+#include "tiled.h"
+#include "tiledpng.h"
+#include "viewer.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <thread>
+#include <unordered_map>
+#include <vector>
 
 using namespace sf;
 using namespace std;
@@ -39,37 +68,238 @@ struct point
 };
 
 /**
- *\param w окно вывода
  *\param texture текстура воды
+ *\param states  количество состояний клетки
+ *\param pal     массив цветов состояний (не меньше states элементов)
+ *\details Построение палитры состояний по текстуре водоёма: средний цвет первого кадра - вода,
+ * второго - живая бактерия, угасающие состояния плавно переходят от цвета бактерии к цвету воды.
+*/
+void statePalette(const Texture& texture, int states, Color* pal)
+{
+	/**цвета на случай, если текстура не загружена*/
+	Color water(225, 235, 254), live(29, 173, 47);
+	Image img = texture.copyToImage();
+	if (img.getSize().x >= 2 * POINT_SIZE && img.getSize().y >= POINT_SIZE)
+	{
+		/**усредняем цвет каждого из двух кадров*/
+		for (int f = 0; f < 2; f++)
+		{
+			unsigned r = 0, g = 0, b = 0;
+			for (int y = 0; y < POINT_SIZE; y++)
+			{
+				for (int x = 0; x < POINT_SIZE; x++)
+				{
+					Color c = img.getPixel(f * POINT_SIZE + x, y);
+					r += c.r; g += c.g; b += c.b;
+				}
+			}
+			int n = POINT_SIZE * POINT_SIZE;
+			(f == 0 ? water : live) = Color((Uint8)(r / n), (Uint8)(g / n), (Uint8)(b / n));
+		}
+	}
+	pal[0] = water;
+	pal[1] = live;
+	for (int s = 2; s < states; s++)
+	{
+		/**доля цвета воды растёт с номером состояния угасания*/
+		float t = (float)(s - 1) / (float)(states - 1);
+		pal[s] = Color((Uint8)(live.r + (water.r - live.r) * t), (Uint8)(live.g + (water.g - live.g) * t),
+			(Uint8)(live.b + (water.b - live.b) * t));
+	}
+}
+
+/**
+ *\param img      изображение текстуры воды (два кадра POINT_SIZE x POINT_SIZE)
+ *\param pal      цвета состояний
+ *\param states   количество состояний клетки
+ *\param textured клетки выводятся кадрами текстуры (классическая "Жизнь")
+ *\param cell     сторона клетки в точках
+ *\param s        внешний вид клеток для записи
+ *\details Клетки записываются так же, как выводятся в окне: кадрами текстуры воды или
+ * квадратами цвета состояния. Кадр текстуры приводится к cell точкам: при уменьшении
+ * точка - средний цвет своей части кадра (при cell = 1 - средний цвет кадра, как в statePalette),
+ * при увеличении - цвет ближайшей точки кадра.
+*/
+void cellStyleFrom(const Image& img, const Color* pal, int states, bool textured, int cell, cellStyle& s)
+{
+	styleInit(s, cell, states);
+	textured = textured && img.getSize().x >= 2 * POINT_SIZE && img.getSize().y >= POINT_SIZE;
+	for (int st = 0; st < s.states; st++)
+	{
+		for (int y = 0; y < s.cell; y++)
+		{
+			for (int x = 0; x < s.cell; x++)
+			{
+				Color c = pal[st];
+				if (textured && st < 2)
+				{
+					int x0 = x * POINT_SIZE / s.cell, x1 = max(x0 + 1, (x + 1) * POINT_SIZE / s.cell);
+					int y0 = y * POINT_SIZE / s.cell, y1 = max(y0 + 1, (y + 1) * POINT_SIZE / s.cell);
+					unsigned r = 0, g = 0, b = 0;
+					for (int v = y0; v < y1; v++)
+					{
+						for (int u = x0; u < x1; u++)
+						{
+							Color t = img.getPixel(st * POINT_SIZE + u, v);
+							r += t.r; g += t.g; b += t.b;
+						}
+					}
+					int n = (x1 - x0) * (y1 - y0);
+					c = Color((Uint8)(r / n), (Uint8)(g / n), (Uint8)(b / n));
+				}
+				s.tile[((size_t)st * s.cell + y) * s.cell + x] = (uint8_t)styleColor(s, c.r, c.g, c.b);
+			}
+		}
+	}
+}
+
+/**
  *\param matrix матрица водоёма
- *\details Отрисовка водоёма после каждого шага
+ *\param g      водоём с многобитными клетками
+ *\details Перенос живых клеток из матрицы водоёма в многобитный водоём
 */
-void waterDraw(RenderWindow& w, Texture &texture, point **matrix)
+void toPlanes(point** matrix, planeGrid& g)
 {
-	/**создание спрайта (текстура+форма) первые два параметра - откуда отсчёт,
-	  *вторые два параметра - сколько на сколько вырезаем
-	*/
-	Sprite sprite0(texture, IntRect(0, 0, POINT_SIZE, POINT_SIZE));
-	Sprite sprite1(texture, IntRect(POINT_SIZE, 0, POINT_SIZE, POINT_SIZE));
-	/**циклом проходим по массиву точек*/
+	planeClear(g);
 	for (int i = 0; i < MW; i++)
 	{
 		for (int j = 0; j < MH; j++)
 		{
-			/**если точка мёртвая, то выводим клетку водоёма*/
-			if (matrix[i][j].is_live == 0)
+			if (matrix[i][j].is_live == 1)
 			{
-				sprite0.setPosition(j * (float)POINT_SIZE, i * (float)POINT_SIZE);
-				w.draw(sprite0);
+				planeSet(g, i, j, 1);
 			}
-			/**если точка живая, то выводим бактерию*/
-			else
+		}
+	}
+}
+
+/**
+ *\param g      водоём с многобитными клетками
+ *\param matrix матрица водоёма
+ *\details Перенос живых клеток (состояние 1) в матрицу водоёма, угасающие клетки становятся водой
+*/
+void fromPlanes(const planeGrid& g, point** matrix)
+{
+	for (int i = 0; i < MW; i++)
+	{
+		for (int j = 0; j < MH; j++)
+		{
+			matrix[i][j].is_live = planeGet(g, i, j) == 1;
+		}
+	}
+}
+
+/**
+ *\struct boardView
+ *\details Вывод водоёма одной потоковой текстурой: образцы клеток в точках, буфер точек,
+ * который заполняется потоками пула, текстура размера водоёма и клетки видимой части
+*/
+struct boardView
+{
+	frameStyle style;
+	frameBuffer frame;
+	Texture texture;
+	/**клетки видимой части для матрицы и водоёма из плиток*/
+	planeGrid cells;
+	/**пул потоков заполнения буфера (nullptr - в потоке окна)*/
+	workPool* pool = nullptr;
+};
+
+/**
+ *\param w    окно вывода
+ *\param view вывод водоёма
+ *\param g    водоём (клетки не больше состояний образцов)
+ *\details Все клетки раскрываются в буфер точек, который одним обновлением переносится в
+ * текстуру и выводится одним спрайтом вместо спрайта или четырёхугольника на каждую клетку.
+*/
+void boardDraw(RenderWindow& w, boardView& view, const planeGrid& g)
+{
+	frameFill(view.frame, g, view.style, view.pool);
+	if (view.texture.getSize().x != (unsigned)view.frame.width || view.texture.getSize().y != (unsigned)view.frame.height)
+	{
+		view.texture.create(view.frame.width, view.frame.height);
+	}
+	view.texture.update((const Uint8*)view.frame.pixels.data());
+	w.draw(Sprite(view.texture));
+}
+
+/**
+ *\param w окно вывода
+ *\param view вывод водоёма
+ *\param matrix матрица водоёма
+ *\param objs объекты для выделения (nullptr - без выделения)
+ *\details Отрисовка водоёма после каждого шага. Планеры обводятся красной рамкой,
+ * прочие движущиеся объекты - оранжевой.
+*/
+void waterDraw(RenderWindow& w, boardView& view, point **matrix, const objectTracker* objs = nullptr)
+{
+	if (view.cells.h != (int)MW || view.cells.w != (int)MH)
+	{
+		planeInit(view.cells, (int)MW, (int)MH, 1);
+	}
+	toPlanes(matrix, view.cells);
+	boardDraw(w, view, view.cells);
+	if (objs == nullptr)
+	{
+		return;
+	}
+	for (const objectInfo& o : objs->objects)
+	{
+		if (!o.glider && o.vi == 0 && o.vj == 0)
+		{
+			continue;
+		}
+		RectangleShape frame(Vector2f((o.stat.j1 - o.stat.j0 + 1) * (float)POINT_SIZE - 2, (o.stat.i1 - o.stat.i0 + 1) * (float)POINT_SIZE - 2));
+		frame.setPosition(o.stat.j0 * (float)POINT_SIZE + 1, o.stat.i0 * (float)POINT_SIZE + 1);
+		frame.setFillColor(Color::Transparent);
+		frame.setOutlineThickness(1);
+		frame.setOutlineColor(o.glider ? Color(220, 50, 50) : Color(235, 150, 40));
+		w.draw(frame);
+	}
+}
+
+/**
+ *\param w окно вывода
+ *\param view вывод водоёма
+ *\param g водоём из плиток
+ *\param i0 первая выводимая строка
+ *\param j0 первый выводимый столбец
+ *\details Отрисовка видимой части водоёма из плиток (не больше MW x MH клеток)
+*/
+void waterDrawTiled(RenderWindow& w, boardView& view, const tiledGrid& g, int64_t i0, int64_t j0)
+{
+	int rows = (int)min<int64_t>((int64_t)MW, g.h - i0), cols = (int)min<int64_t>((int64_t)MH, g.w - j0);
+	if (view.cells.h != rows || view.cells.w != cols)
+	{
+		planeInit(view.cells, rows, cols, 1);
+	}
+	planeClear(view.cells);
+	for (int i = 0; i < rows; i++)
+	{
+		for (int j = 0; j < cols; j++)
+		{
+			if (tiledGet(g, i0 + i, j0 + j))
 			{
-				sprite1.setPosition(j * (float)POINT_SIZE, i * (float)POINT_SIZE);
-				w.draw(sprite1);
+				planeSet(view.cells, i, j, 1);
 			}
 		}
 	}
+	boardDraw(w, view, view.cells);
+}
+
+/**
+ *\param view     вывод водоёма
+ *\param texture  текстура воды
+ *\param states   количество состояний клетки
+ *\param textured клетки выводятся кадрами текстуры (классическая "Жизнь"), иначе - квадратами цвета состояния
+*/
+void boardStyle(boardView& view, const Texture& texture, int states, bool textured)
+{
+	Color pal[16];
+	statePalette(texture, states, pal);
+	cellStyle style;
+	cellStyleFrom(texture.copyToImage(), pal, states, textured, POINT_SIZE, style);
+	frameStyleFrom(style, view.style);
 }
 
 /**
@@ -173,6 +403,7 @@ void swapM(point** &m, point** &m1)
 */
 bool nextGeneration(point** matrix, point** matrix1)
 {
+	PROFILE_SCOPE("nextGeneration");
 	/**Флаг остановки активирован. Если ничего не произойдёт - игра остановится*/
 	bool isOpt = true;
 	int i, j;
@@ -225,6 +456,374 @@ bool nextGeneration(point** matrix, point** matrix1)
 	return isOpt;
 }
 
+/**
+ *\struct lutTable
+ *\details Таблица переходов блока 4x4 клеток: индекс - 16 бит блока (бит 4*r + c - клетка
+ * строки r и столбца c), значение - 4 бита центрального блока 2x2 через одно поколение
+ * (бит 2*(r-1) + (c-1)).
+*/
+struct lutTable
+{
+	unsigned char next[65536];
+};
+
+/**
+ *\param m9 окрестность 3x3 (бит 3*r + c), центральная клетка - бит 4
+ *\return состояние центральной клетки через одно поколение
+*/
+constexpr unsigned cell3x3(unsigned m9)
+{
+	unsigned self = (m9 >> 4) & 1u;
+	unsigned v = m9 & ~0x10u;
+	/**количество живых соседей: параллельное сложение битов*/
+	v = (v & 0x155u) + ((v >> 1) & 0x55u);
+	v = (v & 0x133u) + ((v >> 2) & 0x33u);
+	v = (v & 0x10fu) + ((v >> 4) & 0x0fu);
+	v = (v & 0xffu) + (v >> 8);
+	return (v == 3 || (v == 2 && self)) ? 1u : 0u;
+}
+
+/**
+ *\return таблица переходов блоков 4x4
+ *\details Построение таблицы на этапе компиляции: каждая клетка центрального блока 2x2
+ * вычисляется по своей окрестности 3x3, вырезанной из индекса блока.
+ * Для Visual Studio может потребоваться увеличить лимит вычислений ключом /constexpr:steps.
+*/
+constexpr lutTable makeLut()
+{
+	lutTable t = {};
+	for (unsigned idx = 0; idx < 65536; idx++)
+	{
+		unsigned out = 0;
+		for (unsigned q = 0; q < 4; q++)
+		{
+			/**левый верхний угол окрестности клетки (1 + q / 2, 1 + q % 2)*/
+			unsigned sh = 4 * (q >> 1) + (q & 1);
+			unsigned a = idx >> sh;
+			out |= cell3x3((a & 7u) | (((a >> 4) & 7u) << 3) | (((a >> 8) & 7u) << 6)) << q;
+		}
+		t.next[idx] = (unsigned char)out;
+	}
+	return t;
+}
+
+/**Таблица переходов, вычисленная при компиляции*/
+constexpr lutTable LUT = makeLut();
+
+/**Размер плитки обхода водоёма в блоках 2x2*/
+#define LUT_TILE 8
+
+/**
+ *\param matrix  матрица текущего состояния водоёма
+ *\param matrix1 матрица водоёма во время следущего цикла жизни
+ *\param h       количество строк
+ *\param w       количество столбцов
+ *\return isOpt  флаг остановки цикла жизни
+ *\details Табличное вычисление поколения. Строки водоёма упаковываются в биты со сдвигом
+ * на один столбец, чтобы столбец -1 был нулевым битом. Затем водоём обходится плитками
+ * из LUT_TILE x LUT_TILE блоков 2x2, каждый блок вычисляется одним обращением к таблице.
+*/
+bool lutStep(point** matrix, point** matrix1, int h, int w)
+{
+	PROFILE_SCOPE("lutStep");
+	bool isOpt = true;
+	/**количество 64-битных слов упакованной строки (с запасом на столбцы -1 и w, w+1)*/
+	int words = (w + 2 + 63) / 64 + 1;
+	/**упакованные строки -1..h+2 (крайние строки нулевые)*/
+	vector<uint64_t> bits((size_t)(h + 4) * words, 0);
+	for (int i = 0; i < h; i++)
+	{
+		uint64_t* row = &bits[(size_t)(i + 1) * words];
+		for (int j = 0; j < w; j++)
+		{
+			row[(j + 1) >> 6] |= (uint64_t)matrix[i][j].is_live << ((j + 1) & 63);
+		}
+	}
+	for (int ti = 0; ti < h; ti += 2 * LUT_TILE)
+	{
+		for (int tj = 0; tj < w; tj += 2 * LUT_TILE)
+		{
+			int iEnd = min(h, ti + 2 * LUT_TILE), jEnd = min(w, tj + 2 * LUT_TILE);
+			for (int i = ti; i < iEnd; i += 2)
+			{
+				/**строки i-1..i+2 в упакованном виде имеют номера i..i+3*/
+				const uint64_t* r0 = &bits[(size_t)i * words];
+				for (int j = tj; j < jEnd; j += 2)
+				{
+					/**4 бита столбцов j-1..j+2 лежат с позиции j упакованной строки*/
+					int k = j >> 6, s = j & 63;
+					unsigned idx = 0;
+					for (int r = 0; r < 4; r++)
+					{
+						const uint64_t* row = r0 + (size_t)r * words;
+						uint64_t v = row[k] >> s;
+						if (s > 60)
+						{
+							v |= row[k + 1] << (64 - s);
+						}
+						idx |= (unsigned)(v & 15) << (4 * r);
+					}
+					unsigned out = LUT.next[idx];
+					for (int r = 0; r < 2 && i + r < h; r++)
+					{
+						for (int c = 0; c < 2 && j + c < w; c++)
+						{
+							unsigned v = (out >> (2 * r + c)) & 1;
+							matrix1[i + r][j + c].is_live = v;
+							if (v != matrix[i + r][j + c].is_live)
+							{
+								isOpt = false;
+							}
+						}
+					}
+				}
+			}
+		}
+	}
+	return isOpt;
+}
+
+/**
+ *\param matrix  матрица текущего состояния водоёма
+ *\param matrix1 матрица водоёма во время следущего цикла жизни
+ *\return isOpt  флаг остановки цикла жизни
+ *\details Табличное генерирование следующего поколения. Интерфейс совпадает с nextGeneration.
+*/
+bool nextGenerationLut(point** matrix, point** matrix1)
+{
+	bool isOpt = lutStep(matrix, matrix1, (int)MW, (int)MH);
+	/**Новая матрица становится текущей. Переход к следущему поколению*/
+	swapM(matrix, matrix1);
+	return isOpt;
+}
+
+/**
+ *\param m      матрица водоёма
+ *\param i0     первая строка полосы
+ *\param i1     строка за последней строкой полосы
+ *\param h      количество строк водоёма
+ *\param w      количество столбцов
+ *\param top    сохранённая прежняя строка i0-1 (nullptr у верхнего края)
+ *\param bottom сохранённая прежняя строка i1 (nullptr у нижнего края)
+ *\param ring   два буфера строк длины w
+ *\return true, если полоса не изменилась
+ *\details Вычисление поколения полосы строк на месте. Перед перезаписью строки i её прежнее
+ * состояние копируется в кольцо из двух буферов, так что при вычислении строки i
+ * прежние строки i-1 и i берутся из кольца, а строка i+1 ещё не перезаписана.
+ * Последняя строка полосы берёт соседнюю снизу строку из сохранённой границы,
+ * так как её может перезаписывать соседний поток.
+*/
+static bool inPlaceStripe(point** m, int i0, int i1, int h, int w, const point* top, const point* bottom, point* ring[2])
+{
+	PROFILE_SCOPE("inPlaceStripe");
+	bool isOpt = true;
+	const point* prev = top;
+	/**суммы трёх строк по столбцам с нулевыми столбцами -1 и w*/
+	vector<int> cs(w + 2, 0);
+	for (int i = i0; i < i1; i++)
+	{
+		point* cur = ring[i & 1];
+		memcpy(cur, m[i], w * sizeof(point));
+		const point* next = i + 1 == i1 ? bottom : (i + 1 < h ? m[i + 1] : nullptr);
+		for (int j = 0; j < w; j++)
+		{
+			cs[j + 1] = cur[j].is_live + (prev ? prev[j].is_live : 0) + (next ? next[j].is_live : 0);
+		}
+		for (int j = 0; j < w; j++)
+		{
+			unsigned liveNb = cs[j] + cs[j + 1] + cs[j + 2] - cur[j].is_live;
+			unsigned v = liveNb == 3 || (liveNb == 2 && cur[j].is_live);
+			if (v != cur[j].is_live)
+			{
+				isOpt = false;
+			}
+			m[i][j].is_live = v;
+		}
+		prev = cur;
+	}
+	return isOpt;
+}
+
+/**Количество полос строк (потоков) при вычислении поколения на месте, ключ step=*/
+static int inPlaceThreads = 1;
+
+/**
+ *\return пул потоков вычисления на месте (создаётся при первом обращении)
+*/
+static workPool& inPlacePool()
+{
+	static workPool pool(inPlaceThreads);
+	return pool;
+}
+
+/**
+ *\param h       количество строк
+ *\param threads количество полос строк
+ *\param t       номер полосы (t = threads - конец последней полосы)
+ *\return первая строка полосы t
+ *\details Одинаковое деление на полосы при вычислении на месте и при первом обнулении матрицы
+*/
+int stripeStart(int h, int threads, int t)
+{
+	return (int)((long long)h * t / threads);
+}
+
+/**
+ *\param m       матрица водоёма
+ *\param h       количество строк
+ *\param w       количество столбцов
+ *\param threads количество потоков (полос строк)
+ *\return isOpt  флаг остановки цикла жизни
+ *\details Генерирование следующего поколения без второй матрицы. Водоём делится на полосы
+ * строк; перед запуском потоков сохраняются только граничные строки полос, а внутри полосы
+ * используется кольцо из двух строк. Дополнительная память - 4 строки на полосу.
+ * Полосы вычисляются задачами пула inPlacePool (вызывающий поток ждёт их завершения);
+ * при одной полосе пул не используется, и полоса вычисляется в вызывающем потоке.
+*/
+bool inPlaceStep(point** m, int h, int w, int threads)
+{
+	threads = max(1, min(threads, h));
+	/**граничные строки полос и кольца строк*/
+	vector<point> saved((size_t)threads * 4 * w);
+	vector<int> start(threads + 1);
+	for (int t = 0; t <= threads; t++)
+	{
+		start[t] = stripeStart(h, threads, t);
+	}
+	for (int t = 0; t < threads; t++)
+	{
+		if (start[t] > 0)
+		{
+			memcpy(&saved[(size_t)t * 4 * w], m[start[t] - 1], w * sizeof(point));
+		}
+		if (start[t + 1] < h)
+		{
+			memcpy(&saved[((size_t)t * 4 + 1) * w], m[start[t + 1]], w * sizeof(point));
+		}
+	}
+	vector<char> opt(threads, 1);
+	auto run = [&](int t)
+	{
+		point* base = &saved[(size_t)t * 4 * w];
+		point* ring[2] = {base + 2 * w, base + 3 * w};
+		opt[t] = inPlaceStripe(m, start[t], start[t + 1], h, w, start[t] > 0 ? base : nullptr,
+			start[t + 1] < h ? base + w : nullptr, ring);
+	};
+	if (threads == 1)
+	{
+		run(0);
+	}
+	else
+	{
+		parallelFor(inPlacePool(), threads, 1, [&](int64_t lo, int64_t hi)
+		{
+			for (int64_t t = lo; t < hi; t++)
+			{
+				run((int)t);
+			}
+		});
+	}
+	return find(opt.begin(), opt.end(), 0) == opt.end();
+}
+
+/**
+ *\param matrix  матрица текущего состояния водоёма
+ *\param matrix1 не используется (вторая матрица не нужна)
+ *\return isOpt  флаг остановки цикла жизни
+ *\details Генерирование следующего поколения на месте. Интерфейс совпадает с nextGeneration.
+*/
+bool nextGenerationInPlace(point** matrix, point** /*matrix1*/)
+{
+	return inPlaceStep(matrix, (int)MW, (int)MH, inPlaceThreads);
+}
+
+/**
+ *\struct engine
+ *\details Способ вычисления следующего поколения классической "Жизни"
+*/
+struct engine
+{
+	/**название для вывода в окне*/
+	const wchar_t* title;
+	/**функция смены поколения*/
+	bool (*step)(point**, point**);
+	/**нужна ли вторая матрица водоёма*/
+	bool twoBoards;
+};
+
+/**Количество способов вычисления поколения*/
+#define ENGINES 3
+/**Доступные способы вычисления, переключаются клавишей E*/
+const engine engines[ENGINES] = { {L"перебор", nextGeneration, true}, {L"таблица 4x4", nextGenerationLut, true},
+	{L"на месте", nextGenerationInPlace, false} };
+
+/**
+ *\return размер участка матрицы водоёма в байтах
+*/
+size_t matrixBytes()
+{
+	size_t head = ((int)MW * sizeof(point*) + SLAB_ALIGN - 1) / SLAB_ALIGN * SLAB_ALIGN;
+	size_t stride = ((int)MH * sizeof(point) + SLAB_ALIGN - 1) / SLAB_ALIGN * SLAB_ALIGN;
+	return head + (int)MW * stride;
+}
+
+/**
+ *\param threads количество полос строк, вычисляемых разными потоками
+ *\param kind    часть программы, за которой учитывается память матрицы (MEM_GRID или MEM_SECOND)
+ *\return матрица водоёма MW x MH, заполненная "водой"
+ *\details Матрица - один участок памяти из slabAlloc: массив указателей на строки, за ним
+ * строки, каждая с начала строки кэша. Полосы строк нового участка обнуляются потоками пула
+ * inPlacePool с тем же делением, что в inPlaceStep, так что в системах NUMA страницы при
+ * первом касании распределяются по узлам потоков вычисления (полоса не закреплена за потоком,
+ * поэтому совпадение узла не гарантируется). Участок, выданный из пула slabAlloc, уже размещён
+ * в памяти и обнуляется одним потоком.
+*/
+point** newMatrix(int threads, int kind)
+{
+	int h = (int)MW, w = (int)MH;
+	size_t head = (h * sizeof(point*) + SLAB_ALIGN - 1) / SLAB_ALIGN * SLAB_ALIGN;
+	size_t stride = (w * sizeof(point) + SLAB_ALIGN - 1) / SLAB_ALIGN * SLAB_ALIGN;
+	uint64_t reused = slabInfo().reused;
+	char* base = (char*)slabAlloc(matrixBytes());
+	if (base == nullptr)
+	{
+		throw bad_alloc();
+	}
+	bool fresh = slabInfo().reused == reused;
+	memAdd(kind, (int64_t)matrixBytes());
+	point** m = (point**)base;
+	for (int i = 0; i < h; i++)
+	{
+		m[i] = (point*)(base + head + i * stride);
+	}
+	threads = max(1, min(threads, h));
+	if (!fresh || threads == 1)
+	{
+		memset(m[0], 0, h * stride);
+		return m;
+	}
+	parallelFor(inPlacePool(), threads, 1, [&](int64_t lo, int64_t hi)
+	{
+		int i0 = stripeStart(h, threads, (int)lo), i1 = stripeStart(h, threads, (int)hi);
+		memset(m[i0], 0, (i1 - i0) * stride);
+	});
+	return m;
+}
+
+/**
+ *\param m    матрица водоёма (может быть nullptr)
+ *\param kind часть программы, за которой учтена память матрицы
+ *\details Участок матрицы возвращается в пул, следующая матрица берёт его без обращения к системе
+*/
+void deleteMatrix(point** m, int kind)
+{
+	if (m != nullptr)
+	{
+		memAdd(kind, -(int64_t)matrixBytes());
+	}
+	slabFree(m);
+}
+
 /**
  *\details Вывод окна с информацией об игре и её правилами. 
 */
@@ -329,222 +928,41 @@ void clear(point** matrix)
 }
 
 /**
- *\param matrix матрица водоёма
+ *\param edits  команды правки
  *\param button номер кнопки стандартной конфигурации колонии
- *\details Очищает водоём от всех старых клеток. Заселяет в водоём устойчивую колонию бактерий
+ *\param top, left левый верхний угол видимой части водоёма
+ *\details Очищает видимую часть водоёма от всех старых клеток. Заселяет в неё устойчивую колонию бактерий
 */
-void button(point** matrix, int button)
+void button(vector<editCommand>& edits, int button, int64_t top, int64_t left)
 {
-	/**очистка водоёма*/
-	clear(matrix);
-	/**выбор конфигурации*/
-	switch (button)
-	{
-	/**глайдер*/
-	case 1:
-		matrix[29][31].is_live = 1;
-		matrix[30][32].is_live = 1;
-		matrix[31][30].is_live = 1; matrix[31][31].is_live = 1; matrix[31][32].is_live = 1;
-		break;
-	/**звездолёт*/
-	case 2:
-		matrix[25][30].is_live = 1; matrix[25][33].is_live = 1;
-		matrix[26][34].is_live = 1;
-		matrix[27][30].is_live = 1; matrix[27][34].is_live = 1;
-		matrix[28][31].is_live = 1; matrix[28][32].is_live = 1;
-		matrix[28][33].is_live = 1; matrix[28][34].is_live = 1;
-		break;
-	/**база глайдеров*/
-	case 3:
-		matrix[26][31].is_live = 1; matrix[26][32].is_live = 1;
-		matrix[26][33].is_live = 1; matrix[26][34].is_live = 1;
-		matrix[28][29].is_live = 1; matrix[28][30].is_live = 1;
-		matrix[28][31].is_live = 1; matrix[28][32].is_live = 1;
-		matrix[28][33].is_live = 1; matrix[28][34].is_live = 1;
-		matrix[28][35].is_live = 1; matrix[28][36].is_live = 1;
-		matrix[30][29].is_live = 1; matrix[30][30].is_live = 1;
-		matrix[30][31].is_live = 1; matrix[30][32].is_live = 1;
-		matrix[30][33].is_live = 1; matrix[30][34].is_live = 1;
-		matrix[30][35].is_live = 1; matrix[30][36].is_live = 1;
-		matrix[30][28].is_live = 1; matrix[30][37].is_live = 1;
-		matrix[32][29].is_live = 1; matrix[32][30].is_live = 1;
-		matrix[32][31].is_live = 1; matrix[32][32].is_live = 1;
-		matrix[32][33].is_live = 1; matrix[32][34].is_live = 1;
-		matrix[32][35].is_live = 1; matrix[32][36].is_live = 1;
-		matrix[34][31].is_live = 1; matrix[34][32].is_live = 1;
-		matrix[34][33].is_live = 1; matrix[34][34].is_live = 1;
-		break;
-
-	/**пентаполе*/
-	case 4:
-		matrix[26][28].is_live = 1; matrix[26][29].is_live = 1;
-		matrix[27][28].is_live = 1; 
-		matrix[28][29].is_live = 1; matrix[28][31].is_live = 1;
-		matrix[30][31].is_live = 1; matrix[30][33].is_live = 1;
-		matrix[32][33].is_live = 1; matrix[32][35].is_live = 1;
-		matrix[33][34].is_live = 1; matrix[33][35].is_live = 1;
-		break;
-	//феникс
-	case 5:
-		matrix[26][31].is_live = 1; 
-		matrix[27][31].is_live = 1; matrix[27][33].is_live = 1;
-		matrix[28][29].is_live = 1; 
-		matrix[29][34].is_live = 1; matrix[29][35].is_live = 1; 
-		matrix[30][28].is_live = 1; matrix[30][29].is_live = 1; 
-		matrix[31][34].is_live = 1;
-		matrix[32][30].is_live = 1; matrix[32][32].is_live = 1;
-		matrix[33][32].is_live = 1;
-		break;
-	/**часы*/
-	case 6:
-		matrix[24][32].is_live = 1; matrix[24][33].is_live = 1;
-		matrix[25][32].is_live = 1; matrix[25][33].is_live = 1;
-		matrix[27][30].is_live = 1; matrix[27][31].is_live = 1;
-		matrix[27][32].is_live = 1; matrix[27][33].is_live = 1;
-		matrix[28][26].is_live = 1; matrix[28][27].is_live = 1;
-		matrix[29][26].is_live = 1; matrix[29][27].is_live = 1;
-		matrix[28][29].is_live = 1; matrix[28][32].is_live = 1;
-		matrix[28][34].is_live = 1; matrix[29][34].is_live = 1; 
-		matrix[29][29].is_live = 1; matrix[29][31].is_live = 1;
-		matrix[30][36].is_live = 1; matrix[30][37].is_live = 1;
-		matrix[31][36].is_live = 1; matrix[31][37].is_live = 1;
-		matrix[30][29].is_live = 1; matrix[30][31].is_live = 1;
-		matrix[30][34].is_live = 1; 
-		matrix[31][29].is_live = 1; matrix[31][34].is_live = 1;
-		matrix[32][30].is_live = 1; matrix[32][31].is_live = 1;
-		matrix[32][32].is_live = 1; matrix[32][33].is_live = 1;
-		matrix[34][30].is_live = 1; matrix[34][31].is_live = 1;
-		matrix[35][30].is_live = 1; matrix[35][31].is_live = 1;
-		break;
-	/**бриллиант*/
-	case 7:
-		matrix[23][31].is_live = 1; matrix[24][30].is_live = 1;
-		matrix[24][32].is_live = 1; matrix[25][29].is_live = 1;
-		matrix[25][31].is_live = 1; matrix[25][33].is_live = 1;
-		matrix[26][29].is_live = 1; matrix[26][33].is_live = 1;
-		matrix[27][27].is_live = 1; matrix[27][28].is_live = 1;
-		matrix[27][31].is_live = 1; matrix[27][34].is_live = 1;
-		matrix[27][35].is_live = 1; matrix[28][26].is_live = 1;
-		matrix[28][31].is_live = 1; matrix[28][36].is_live = 1;
-		matrix[29][25].is_live = 1; matrix[29][27].is_live = 1;
-		matrix[29][29].is_live = 1; matrix[29][30].is_live = 1;
-		matrix[29][32].is_live = 1; matrix[29][33].is_live = 1;
-		matrix[29][35].is_live = 1; matrix[29][37].is_live = 1;
-		matrix[30][26].is_live = 1; matrix[30][31].is_live = 1;
-		matrix[30][36].is_live = 1; matrix[31][27].is_live = 1;
-		matrix[31][28].is_live = 1; matrix[31][31].is_live = 1;
-		matrix[31][34].is_live = 1; matrix[31][35].is_live = 1;
-		matrix[32][29].is_live = 1; matrix[32][33].is_live = 1;
-		matrix[33][29].is_live = 1; matrix[33][31].is_live = 1;
-		matrix[33][33].is_live = 1; matrix[34][30].is_live = 1;
-		matrix[34][32].is_live = 1; matrix[35][31].is_live = 1;
-		break;
-	/**звезда*/
-	case 8:
-		matrix[24][31].is_live = 1; matrix[25][30].is_live = 1;
-		matrix[25][31].is_live = 1; matrix[25][32].is_live = 1;
-		matrix[26][28].is_live = 1; matrix[26][29].is_live = 1;
-		matrix[26][30].is_live = 1; matrix[26][32].is_live = 1;
-		matrix[26][33].is_live = 1; matrix[26][34].is_live = 1;
-		matrix[27][28].is_live = 1; matrix[27][34].is_live = 1;
-		matrix[28][27].is_live = 1; matrix[28][28].is_live = 1;
-		matrix[28][34].is_live = 1; matrix[28][35].is_live = 1;
-		matrix[29][26].is_live = 1; matrix[29][27].is_live = 1;
-		matrix[29][35].is_live = 1; matrix[29][36].is_live = 1;
-		matrix[30][27].is_live = 1; matrix[30][28].is_live = 1;
-		matrix[30][34].is_live = 1; matrix[30][35].is_live = 1;
-		matrix[31][28].is_live = 1; matrix[31][34].is_live = 1;
-		matrix[32][28].is_live = 1; matrix[32][29].is_live = 1;
-		matrix[32][30].is_live = 1; matrix[32][32].is_live = 1;
-		matrix[32][33].is_live = 1; matrix[32][34].is_live = 1;
-		matrix[33][30].is_live = 1; matrix[33][31].is_live = 1;
-		matrix[33][32].is_live = 1; matrix[34][31].is_live = 1;
-		break;
-	/**галактика*/
-	case 9:
-		matrix[25][27].is_live = 1; matrix[25][28].is_live = 1;
-		matrix[25][29].is_live = 1; matrix[25][30].is_live = 1;
-		matrix[25][31].is_live = 1; matrix[25][32].is_live = 1;
-		matrix[26][27].is_live = 1; matrix[26][28].is_live = 1;
-		matrix[26][29].is_live = 1; matrix[26][30].is_live = 1;
-		matrix[26][31].is_live = 1; matrix[26][32].is_live = 1;
-		matrix[28][27].is_live = 1; matrix[29][27].is_live = 1;
-		matrix[30][27].is_live = 1; matrix[31][27].is_live = 1;
-		matrix[32][27].is_live = 1; matrix[33][27].is_live = 1;
-		matrix[28][28].is_live = 1; matrix[29][28].is_live = 1;
-		matrix[30][28].is_live = 1; matrix[31][28].is_live = 1;
-		matrix[32][28].is_live = 1; matrix[33][28].is_live = 1;
-		matrix[25][34].is_live = 1; matrix[26][34].is_live = 1;
-		matrix[27][34].is_live = 1; matrix[28][34].is_live = 1;
-		matrix[29][34].is_live = 1; matrix[30][34].is_live = 1;
-		matrix[25][35].is_live = 1; matrix[26][35].is_live = 1;
-		matrix[27][35].is_live = 1; matrix[28][35].is_live = 1;
-		matrix[29][35].is_live = 1; matrix[30][35].is_live = 1;
-		matrix[32][30].is_live = 1; matrix[32][31].is_live = 1;
-		matrix[32][32].is_live = 1; matrix[32][33].is_live = 1;
-		matrix[32][34].is_live = 1; matrix[32][35].is_live = 1;
-		matrix[33][30].is_live = 1; matrix[33][31].is_live = 1;
-		matrix[33][32].is_live = 1; matrix[33][33].is_live = 1;
-		matrix[33][34].is_live = 1; matrix[33][35].is_live = 1;
-		break;
-	/**тумблер*/
-	case 10:
-		matrix[26][29].is_live = 1; matrix[26][30].is_live = 1;
-		matrix[26][32].is_live = 1; matrix[26][33].is_live = 1;
-		matrix[28][30].is_live = 1; matrix[28][32].is_live = 1;
-		matrix[29][30].is_live = 1; matrix[29][32].is_live = 1;
-		matrix[29][27].is_live = 1; matrix[29][28].is_live = 1;
-		matrix[29][34].is_live = 1; matrix[29][35].is_live = 1;
-		matrix[30][27].is_live = 1; matrix[30][28].is_live = 1;
-		matrix[30][34].is_live = 1; matrix[30][35].is_live = 1;
-		matrix[30][29].is_live = 1; matrix[30][33].is_live = 1;
-		break;
-	/**лилия*/
-	case 11:
-		matrix[24][31].is_live = 1; matrix[25][30].is_live = 1;
-		matrix[25][32].is_live = 1; matrix[26][29].is_live = 1;
-		matrix[26][31].is_live = 1; matrix[26][33].is_live = 1;
-		matrix[27][29].is_live = 1; matrix[27][31].is_live = 1;
-		matrix[27][33].is_live = 1; matrix[28][26].is_live = 1;
-		matrix[28][27].is_live = 1; matrix[28][29].is_live = 1;
-		matrix[28][30].is_live = 1; matrix[28][31].is_live = 1;
-		matrix[28][32].is_live = 1; matrix[28][33].is_live = 1;
-		matrix[28][35].is_live = 1; matrix[28][36].is_live = 1;
-		matrix[29][26].is_live = 1; matrix[29][28].is_live = 1;
-		matrix[29][34].is_live = 1; matrix[29][36].is_live = 1;
-		matrix[30][29].is_live = 1; matrix[30][30].is_live = 1;
-		matrix[30][31].is_live = 1; matrix[30][32].is_live = 1;
-		matrix[30][33].is_live = 1; matrix[32][31].is_live = 1;
-		matrix[33][30].is_live = 1; matrix[33][32].is_live = 1;
-		matrix[34][31].is_live = 1;
-		break;
-	/**R2-D2*/
-	case 12:
-		matrix[24][31].is_live = 1; matrix[24][32].is_live = 1;
-		matrix[25][31].is_live = 1; matrix[25][32].is_live = 1;
-		matrix[27][29].is_live = 1; matrix[27][30].is_live = 1;
-		matrix[27][31].is_live = 1; matrix[27][32].is_live = 1;
-		matrix[27][33].is_live = 1; matrix[27][34].is_live = 1;
-		matrix[28][28].is_live = 1; matrix[28][35].is_live = 1;
-		matrix[29][28].is_live = 1; matrix[29][29].is_live = 1;
-		matrix[29][32].is_live = 1; matrix[29][33].is_live = 1;
-		matrix[29][34].is_live = 1; matrix[29][35].is_live = 1;
-		matrix[31][28].is_live = 1; matrix[31][29].is_live = 1;
-		matrix[31][30].is_live = 1; matrix[31][31].is_live = 1;
-		matrix[31][32].is_live = 1; matrix[31][33].is_live = 1;
-		matrix[31][34].is_live = 1; matrix[31][35].is_live = 1;
-		matrix[32][28].is_live = 1; matrix[32][35].is_live = 1;
-		matrix[33][31].is_live = 1; matrix[33][32].is_live = 1;
-		matrix[34][31].is_live = 1; matrix[34][32].is_live = 1;
-		break;
+	/**очистка видимой части водоёма*/
+	edits.push_back(editRect(EDIT_CLEAR, top, left, top + (int64_t)MW, left + (int64_t)MH));
+	/**выбор конфигурации: колонии лежат в таблице library в порядке кнопок*/
+	if (button < 1 || button > LIBRARY_SIZE)
+	{
+		return;
 	}
+	const libPattern& p = library[button - 1];
+	edits.push_back(editPlace(p, 0, false, top + p.top, left + p.left));
 }
 
+/**Столбцов и строк колоний на странице окна "фигуры"*/
+#define FIG_COLS 4
+#define FIG_ROWS 3
+/**Сторона атласа миниатюр в миниатюрах: мест хватает на видимую и следующую страницы*/
+#define FIG_ATLAS 8
+
 /**
- *\param matrix матрица водоёма
- *\details Выводит окна для выбора стандартной конфигурации колонии
+ *\param edits команды правки
+ *\param catalog каталог колоний с миниатюрами
+ *\param top, left левый верхний угол видимой части водоёма
+ *\details Выводит окно для выбора колонии из каталога: страница из FIG_COLS x FIG_ROWS колоний
+ * с миниатюрами, нарисованными по клеткам колоний. Колёсико мыши и стрелки прокручивают каталог
+ * на строку, PageUp и PageDown - на страницу, Home и End - к началу и концу. Миниатюры готовит
+ * поток каталога; готовые переносятся в общую текстуру-атлас, а пока миниатюры нет, выводится
+ * только название колонии.
 */
-void figures(point** matrix)
+void figures(vector<editCommand>& edits, thumbCatalog& catalog, int64_t top, int64_t left)
 {
 	/**создание окна*/
 	RenderWindow figW(VideoMode(800, 600), " ", Style::None);
@@ -554,181 +972,120 @@ void figures(point** matrix)
 	/**размер кнопки "крестик" в пиклеслях*/
 	int closeSizeX = 45;
 	int closeSizeY = 45;
-	/**размер 1-12 кнопкок в пиклеслях*/
+	/**размер кнопки колонии в пикселях и позиция первой кнопки*/
 	int SizeX = 200;
 	int SizeY = 173;
-	/**позиция по x и y спрайта 1 кнопки*/
-	int SpritePositionX1 = 0;
-	int SpritePositionY1 = 81;
-	/**позиция по x и y спрайта 2 кнопки*/
-	int SpritePositionX2 = 200;
-	int SpritePositionY2 = 81;
-	/**позиция по x и y спрайта 3 кнопки*/
-	int SpritePositionX3 = 400;
-	int SpritePositionY3 = 81;
-	/**позиция по x и y спрайта 4 кнопки*/
-	int SpritePositionX4 = 600;
-	int SpritePositionY4 = 81;
-	/**позиция по x и y спрайта 5 кнопки*/
-	int SpritePositionX5 = 0;
-	int SpritePositionY5 = 254;
-	/**позиция по x и y спрайта 6 кнопки*/
-	int SpritePositionX6 = 200;
-	int SpritePositionY6 = 254;
-	/**позиция по x и y спрайта 7 кнопки*/
-	int SpritePositionX7 = 400;
-	int SpritePositionY7 = 254;
-	/**позиция по x и y спрайта 8 кнопки*/
-	int SpritePositionX8 = 600;
-	int SpritePositionY8 = 254;
-	/**позиция по x и y спрайта 9 кнопки*/
-	int SpritePositionX9 = 0;
-	int SpritePositionY9 = 427;
-	/**позиция по x и y спрайта 10 кнопки*/
-	int SpritePositionX10 = 200;
-	int SpritePositionY10 = 427;
-	/**позиция по x и y спрайта 11 кнопки*/
-	int SpritePositionX11 = 400;
-	int SpritePositionY11 = 427;
-	/**позиция по x и y спрайта 12 кнопки*/
-	int SpritePositionX12 = 600;
-	int SpritePositionY12 = 427;
+	int firstX = 0;
+	int firstY = 81;
+	/**текстуры загружаются один раз при открытии окна*/
+	Texture tClose, water;
+	tClose.loadFromFile("picture\\close.png");
+	tClose.setSmooth(true);
+	water.loadFromFile("picture\\12.png");
+	/**цвета воды и бактерии из текстуры водоёма*/
+	Color pal[2];
+	statePalette(water, 2, pal);
+	/**атлас FIG_ATLAS x FIG_ATLAS миниатюр: номер колонии в каждом месте и время его использования*/
+	Texture atlas;
+	atlas.create(FIG_ATLAS * THUMB_SIZE, FIG_ATLAS * THUMB_SIZE);
+	atlas.setSmooth(true);
+	memAdd(MEM_TEXTURES, (int64_t)atlas.getSize().x * atlas.getSize().y * 4);
+	vector<int> slotOwner(FIG_ATLAS * FIG_ATLAS, -1);
+	vector<uint64_t> slotUsed(FIG_ATLAS * FIG_ATLAS, 0);
+	unordered_map<int, int> slotOf;
+	uint64_t tick = 0;
+	vector<uint8_t> thumb;
+	vector<Uint8> rgba((size_t)THUMB_SIZE * THUMB_SIZE * 4);
+	Font font;
+	font.loadFromFile("fonts\\arial.ttf");
+	/**первая строка страницы*/
+	int firstRow = 0;
 	/**основной цикл окна*/
 	while (figW.isOpen())
 	{
+		int count = thumbCount(catalog);
+		int rows = (count + FIG_COLS - 1) / FIG_COLS;
 		/**событие*/
 		Event e;
-		/**создаём текстуры*/
-		Texture tClose, b1, b2, b3, b4, b5, b6, b7, b8, b9, b10, b11, b12;
-		/**загружаем текстуры из файлов*/
-		b1.loadFromFile("picture\\glider.png");
-		b2.loadFromFile("picture\\spaceship.png");
-		b3.loadFromFile("picture\\gliderbase.png");
-		b4.loadFromFile("picture\\pentapole.png");
-		b5.loadFromFile("picture\\phoenix.png");
-		b6.loadFromFile("picture\\clock.png");
-		b7.loadFromFile("picture\\diamond.png");
-		b8.loadFromFile("picture\\star.png");
-		b9.loadFromFile("picture\\galaxy.png");
-		b10.loadFromFile("picture\\tumbler.png");
-		b11.loadFromFile("picture\\lili.png");
-		b12.loadFromFile("picture\\r2d2.png");
-		tClose.loadFromFile("picture\\close.png");
-		/**сглаживаем формы текстуры*/
-		tClose.setSmooth(true);
-		b1.setSmooth(true);	b2.setSmooth(true);
-		b3.setSmooth(true);	b4.setSmooth(true);
-		b5.setSmooth(true);	b6.setSmooth(true);
-		b7.setSmooth(true);	b8.setSmooth(true);
-		b9.setSmooth(true);	b10.setSmooth(true);
-		b11.setSmooth(true);b12.setSmooth(true);
 		/**отслеживание положения мыши*/
 		Vector2i posMouse = Mouse::getPosition(figW);
+		/**кнопка колонии под мышью (-1 - нет)*/
+		int hover = -1;
+		if (posMouse.x >= firstX && posMouse.x < firstX + FIG_COLS * SizeX && posMouse.y >= firstY && posMouse.y < firstY + FIG_ROWS * SizeY)
+		{
+			hover = (posMouse.y - firstY) / SizeY * FIG_COLS + (posMouse.x - firstX) / SizeX;
+		}
 		/**проверка событий в окне*/
 		while (figW.pollEvent(e))
 		{
+			if (e.type == Event::MouseWheelScrolled)
+			{
+				firstRow -= (int)e.mouseWheelScroll.delta;
+			}
+			else if (e.type == Event::KeyPressed)
+			{
+				switch (e.key.code)
+				{
+				case Keyboard::Escape:
+					figW.close();
+					break;
+				case Keyboard::Up:
+					firstRow--;
+					break;
+				case Keyboard::Down:
+					firstRow++;
+					break;
+				case Keyboard::PageUp:
+					firstRow -= FIG_ROWS;
+					break;
+				case Keyboard::PageDown:
+					firstRow += FIG_ROWS;
+					break;
+				case Keyboard::Home:
+					firstRow = 0;
+					break;
+				case Keyboard::End:
+					firstRow = rows;
+					break;
+				default:
+					break;
+				}
+			}
 			/**отслеживание нажатий мыши*/
-			if (e.type == Event::MouseButtonPressed)
+			else if (e.type == Event::MouseButtonPressed && e.mouseButton.button == Mouse::Left)
 			{
-				/**нажата левая кнопка мыши*/
-				if (e.key.code == Mouse::Left)
+				/**на "крестике"   => закрываем окно*/
+				if ((posMouse.x >= closeSpritePositionX) && (posMouse.x <= closeSpritePositionX + closeSizeX)
+					&& (posMouse.y >= closeSpritePositionY) && (posMouse.y <= closeSpritePositionY + closeSizeY))
 				{
-					/**на "крестике"   => закрываем окно*/
-					if ((posMouse.x >= closeSpritePositionX) && (posMouse.x <= closeSpritePositionX + closeSizeX)
-						&& (posMouse.y >= closeSpritePositionY) && (posMouse.y <= closeSpritePositionY + closeSizeY))
-					{
-						figW.close();
-					}
-					/**на кнопке 1*/
-					if ((posMouse.x >= SpritePositionX1) && (posMouse.x <= SpritePositionX1 + SizeX)
-						&& (posMouse.y >= SpritePositionY1) && (posMouse.y <= SpritePositionY1 + SizeY))
-					{
-						button(matrix, 1);
-						figW.close();
-					}
-					/**на кнопке 2*/
-					if ((posMouse.x >= SpritePositionX2) && (posMouse.x <= SpritePositionX2 + SizeX)
-						&& (posMouse.y >= SpritePositionY2) && (posMouse.y <= SpritePositionY2 + SizeY))
-					{
-						button(matrix, 2);
-						figW.close();
-					}
-					/**на кнопке 3*/
-					if ((posMouse.x >= SpritePositionX3) && (posMouse.x <= SpritePositionX3 + SizeX)
-						&& (posMouse.y >= SpritePositionY3) && (posMouse.y <= SpritePositionY3 + SizeY))
-					{
-						button(matrix, 3);
-						figW.close();
-					}
-					/**на кнопке 4*/
-					if ((posMouse.x >= SpritePositionX4) && (posMouse.x <= SpritePositionX4 + SizeX)
-						&& (posMouse.y >= SpritePositionY4) && (posMouse.y <= SpritePositionY4 + SizeY))
-					{
-						button(matrix, 4);
-						figW.close();
-					}
-					/**на кнопке 5*/
-					if ((posMouse.x >= SpritePositionX5) && (posMouse.x <= SpritePositionX5 + SizeX)
-						&& (posMouse.y >= SpritePositionY5) && (posMouse.y <= SpritePositionY5 + SizeY))
-					{
-						button(matrix, 5);
-						figW.close();
-					}
-					/**на кнопке 6*/
-					if ((posMouse.x >= SpritePositionX6) && (posMouse.x <= SpritePositionX6 + SizeX)
-						&& (posMouse.y >= SpritePositionY6) && (posMouse.y <= SpritePositionY6 + SizeY))
-					{
-						button(matrix, 6);
-						figW.close();
-					}
-					/**на кнопке 7*/
-					if ((posMouse.x >= SpritePositionX7) && (posMouse.x <= SpritePositionX7 + SizeX)
-						&& (posMouse.y >= SpritePositionY7) && (posMouse.y <= SpritePositionY7 + SizeY))
-					{
-						button(matrix, 7);
-						figW.close();
-					}
-					/**на кнопке 8*/
-					if ((posMouse.x >= SpritePositionX8) && (posMouse.x <= SpritePositionX8 + SizeX)
-						&& (posMouse.y >= SpritePositionY8) && (posMouse.y <= SpritePositionY8 + SizeY))
-					{
-						button(matrix, 8);
-						figW.close();
-					}
-					/**на кнопке 9*/
-					if ((posMouse.x >= SpritePositionX9) && (posMouse.x <= SpritePositionX9 + SizeX)
-						&& (posMouse.y >= SpritePositionY9) && (posMouse.y <= SpritePositionY9 + SizeY))
-					{
-						button(matrix, 9);
-						figW.close();
-					}
-					/**на кнопке 10*/
-					if ((posMouse.x >= SpritePositionX10) && (posMouse.x <= SpritePositionX10 + SizeX)
-						&& (posMouse.y >= SpritePositionY10) && (posMouse.y <= SpritePositionY10 + SizeY))
-					{
-						button(matrix, 10);
-						figW.close();
-					}
-					/**на кнопке 11*/
-					if ((posMouse.x >= SpritePositionX11) && (posMouse.x <= SpritePositionX11 + SizeX)
-						&& (posMouse.y >= SpritePositionY11) && (posMouse.y <= SpritePositionY11 + SizeY))
+					figW.close();
+				}
+				/**на кнопке колонии => колония библиотеки кладётся на своё место, колония из файла - в середину*/
+				thumbEntry p;
+				int index = firstRow * FIG_COLS + hover;
+				if (hover >= 0 && index < count && thumbCells(catalog, index, p))
+				{
+					if (p.library >= 0)
 					{
-						button(matrix, 11);
-						figW.close();
+						button(edits, p.library + 1, top, left);
 					}
-					/**на кнопке 12*/
-					if ((posMouse.x >= SpritePositionX12) && (posMouse.x <= SpritePositionX12 + SizeX)
-						&& (posMouse.y >= SpritePositionY12) && (posMouse.y <= SpritePositionY12 + SizeY))
+					else
 					{
-						button(matrix, 12);
-						figW.close();
+						edits.push_back(editRect(EDIT_CLEAR, top, left, top + (int64_t)MW, left + (int64_t)MH));
+						int64_t i0 = top + ((int64_t)MW - p.h) / 2, j0 = left + ((int64_t)MH - p.w) / 2;
+						editCommand c = editRect(EDIT_PASTE, i0, j0, i0 + p.h, j0 + p.w);
+						c.words = p.words;
+						c.bits = move(p.bits);
+						edits.push_back(move(c));
 					}
+					figW.close();
 				}
 			}
 		}
-		/**создаём и загружаем шрифт*/
-		Font font;
-		font.loadFromFile("fonts\\arial.ttf");
+		firstRow = max(0, min(firstRow, rows - FIG_ROWS));
+		int first = firstRow * FIG_COLS;
+		/**поток каталога готовит видимую и следующую страницы*/
+		thumbWant(catalog, first, 2 * FIG_COLS * FIG_ROWS);
 		/**создаём заголовок*/
 		Text fName(L"Фигуры", font, 45);
 		/**устанавливаем цвет текста*/
@@ -737,14 +1094,67 @@ void figures(point** matrix)
 		fName.setStyle(Text::Italic | Text::Bold);
 		/**установка позиции текста*/
 		fName.setPosition(320, 20);
+		/**номера колоний страницы*/
+		Text fPage(to_wstring(min(count, first + 1)) + L"-" + to_wstring(min(count, first + FIG_COLS * FIG_ROWS)) + L" из "
+			+ to_wstring(count), font, 14);
+		fPage.setFillColor(Color(54, 101, 169));
+		fPage.setPosition(12, 50);
 		/**установка цвета фона окна*/
 		figW.clear(Color(235, 241, 251));
-		/**создаём спрайты из текстур*/
-		Sprite sClose(tClose);
-		Sprite sb1(b1);	Sprite sb2(b2);	Sprite sb3(b3);	Sprite sb4(b4);
-		Sprite sb5(b5);	Sprite sb6(b6);	Sprite sb7(b7);	Sprite sb8(b8);
-		Sprite sb9(b9);	Sprite sb10(b10); Sprite sb11(b11);	Sprite sb12(b12);
+		for (int k = 0; k < FIG_COLS * FIG_ROWS && first + k < count; k++)
+		{
+			int index = first + k;
+			float x = (float)(firstX + k % FIG_COLS * SizeX), y = (float)(firstY + k / FIG_COLS * SizeY);
+			/**если мышь наведена на кнопку => подсвечиваем её*/
+			if (k == hover)
+			{
+				RectangleShape back(Vector2f((float)SizeX - 4, (float)SizeY - 4));
+				back.setPosition(x + 2, y + 2);
+				back.setFillColor(Color(214, 226, 245));
+				figW.draw(back);
+			}
+			/**готовая миниатюра переносится в место атласа, не занятое видимыми колониями*/
+			auto at = slotOf.find(index);
+			if (at == slotOf.end() && thumbTake(catalog, index, thumb))
+			{
+				int slot = 0;
+				for (int s = 1; s < FIG_ATLAS * FIG_ATLAS; s++)
+				{
+					if (slotUsed[s] < slotUsed[slot])
+					{
+						slot = s;
+					}
+				}
+				if (slotOwner[slot] >= 0)
+				{
+					slotOf.erase(slotOwner[slot]);
+				}
+				for (size_t t = 0; t < thumb.size(); t++)
+				{
+					int a = thumb[t];
+					rgba[t * 4] = (Uint8)(pal[0].r + (pal[1].r - pal[0].r) * a / 255);
+					rgba[t * 4 + 1] = (Uint8)(pal[0].g + (pal[1].g - pal[0].g) * a / 255);
+					rgba[t * 4 + 2] = (Uint8)(pal[0].b + (pal[1].b - pal[0].b) * a / 255);
+					rgba[t * 4 + 3] = 255;
+				}
+				atlas.update(rgba.data(), THUMB_SIZE, THUMB_SIZE, slot % FIG_ATLAS * THUMB_SIZE, slot / FIG_ATLAS * THUMB_SIZE);
+				slotOwner[slot] = index;
+				at = slotOf.emplace(index, slot).first;
+			}
+			if (at != slotOf.end())
+			{
+				slotUsed[at->second] = ++tick;
+				Sprite sThumb(atlas, IntRect(at->second % FIG_ATLAS * THUMB_SIZE, at->second / FIG_ATLAS * THUMB_SIZE, THUMB_SIZE, THUMB_SIZE));
+				sThumb.setPosition(x + (SizeX - THUMB_SIZE) / 2, y + 8);
+				figW.draw(sThumb);
+			}
+			Text fTitle(thumbName(catalog, index), font, 15);
+			fTitle.setFillColor(Color(54, 101, 169));
+			fTitle.setPosition(x + (SizeX - fTitle.getGlobalBounds().width) / 2, y + THUMB_SIZE + 14);
+			figW.draw(fTitle);
+		}
 		/**если мышь наведена на "крестик" => загружаем вторую часть текстуры*/
+		Sprite sClose(tClose);
 		if ((posMouse.x >= closeSpritePositionX) && (posMouse.x <= closeSpritePositionX + closeSizeX)
 			&& (posMouse.y >= closeSpritePositionY) && (posMouse.y <= closeSpritePositionY + closeSizeY))
 		{
@@ -755,179 +1165,588 @@ void figures(point** matrix)
 		{
 			sClose.setTextureRect(IntRect(0, 0, closeSizeX, closeSizeY));
 		}
-		/**если мышь наведена на 1 кнопку => загружаем вторую часть текстуры*/
-		if ((posMouse.x >= SpritePositionX1) && (posMouse.x <= SpritePositionX1 + SizeX)
-			&& (posMouse.y >= SpritePositionY1) && (posMouse.y <= SpritePositionY1 + SizeY))
-		{
-			sb1.setTextureRect(IntRect(SizeX, 0, SizeX, SizeY));
-		}
-		/**если мышь не наведена 1 кнопку => загружаем первую часть текстуры*/
-		else
-		{
-			sb1.setTextureRect(IntRect(0, 0, SizeX, SizeY));
-		}
-		/**если мышь наведена на 2 кнопку => загружаем вторую часть текстуры*/
-		if ((posMouse.x >= SpritePositionX2) && (posMouse.x <= SpritePositionX2 + SizeX)
-			&& (posMouse.y >= SpritePositionY2) && (posMouse.y <= SpritePositionY2 + SizeY))
-		{
-			sb2.setTextureRect(IntRect(SizeX, 0, SizeX, SizeY));
-		}
-		/**если мышь не наведена 2 кнопку => загружаем первую часть текстуры*/
-		else
-		{
-			sb2.setTextureRect(IntRect(0, 0, SizeX, SizeY));
-		}
-		/**если мышь наведена на 3 кнопку => загружаем вторую часть текстуры*/
-		if ((posMouse.x >= SpritePositionX3) && (posMouse.x <= SpritePositionX3 + SizeX)
-			&& (posMouse.y >= SpritePositionY3) && (posMouse.y <= SpritePositionY3 + SizeY))
-		{
-			sb3.setTextureRect(IntRect(SizeX, 0, SizeX, SizeY));
-		}
-		/**если мышь не наведена 3 кнопку => загружаем первую часть текстуры*/
-		else
-		{
-			sb3.setTextureRect(IntRect(0, 0, SizeX, SizeY));
-		}
-		/**если мышь наведена на 4 кнопку => загружаем вторую часть текстуры*/
-		if ((posMouse.x >= SpritePositionX4) && (posMouse.x <= SpritePositionX4 + SizeX)
-			&& (posMouse.y >= SpritePositionY4) && (posMouse.y <= SpritePositionY4 + SizeY))
-		{
-			sb4.setTextureRect(IntRect(SizeX, 0, SizeX, SizeY));
-		}
-		/**если мышь не наведена 4 кнопку => загружаем первую часть текстуры*/
-		else
-		{
-			sb4.setTextureRect(IntRect(0, 0, SizeX, SizeY));
-		}
-		/**если мышь наведена на 5 кнопку => загружаем вторую часть текстуры*/
-		if ((posMouse.x >= SpritePositionX5) && (posMouse.x <= SpritePositionX5 + SizeX)
-			&& (posMouse.y >= SpritePositionY5) && (posMouse.y <= SpritePositionY5 + SizeY))
-		{
-			sb5.setTextureRect(IntRect(SizeX, 0, SizeX, SizeY));
-		}
-		/**если мышь не наведена 5 кнопку => загружаем первую часть текстуры*/
-		else
-		{
-			sb5.setTextureRect(IntRect(0, 0, SizeX, SizeY));
-		}
-		/**если мышь наведена на 6 кнопку => загружаем вторую часть текстуры*/
-		if ((posMouse.x >= SpritePositionX6) && (posMouse.x <= SpritePositionX6 + SizeX)
-			&& (posMouse.y >= SpritePositionY6) && (posMouse.y <= SpritePositionY6 + SizeY))
-		{
-			sb6.setTextureRect(IntRect(SizeX, 0, SizeX, SizeY));
-		}
-		/**если мышь не наведена 6 кнопку => загружаем первую часть текстуры*/
-		else
-		{
-			sb6.setTextureRect(IntRect(0, 0, SizeX, SizeY));
-		}
-		/**если мышь наведена на 7 кнопку => загружаем вторую часть текстуры*/
-		if ((posMouse.x >= SpritePositionX7) && (posMouse.x <= SpritePositionX7 + SizeX)
-			&& (posMouse.y >= SpritePositionY7) && (posMouse.y <= SpritePositionY7 + SizeY))
+		sClose.setPosition((float)closeSpritePositionX, (float)closeSpritePositionY);
+		/**отрисовываем спрайты в окне*/
+		figW.draw(sClose);
+		figW.draw(fName);
+		figW.draw(fPage);
+		/**отрисовываем окно*/
+		figW.display();
+	}
+	/**окно закрыто - миниатюры больше не нужны*/
+	thumbWant(catalog, 0, 0);
+	memAdd(MEM_TEXTURES, -(int64_t)atlas.getSize().x * atlas.getSize().y * 4);
+}
+
+
+/**Режимы правки водоёма мышью: переключение клетки, кисть, прямоугольник,
+ случайное заполнение прямоугольника, вставка колонии*/
+#define EDITMODE_TOGGLE 0
+#define EDITMODE_BRUSH 1
+#define EDITMODE_RECT 2
+#define EDITMODE_RANDOM 3
+#define EDITMODE_PASTE 4
+#define EDITMODES 5
+
+/**
+ *\param mode    режим правки
+ *\param density плотность случайного заполнения
+ *\param pasteF  номер колонии для вставки
+ *\param rot     поворот колонии
+ *\param flip    отражение колонии
+ *\return строка с режимом правки для вывода в окне
+*/
+wstring editTitle(int mode, double density, int pasteF, int rot, bool flip)
+{
+	switch (mode)
+	{
+	case EDITMODE_BRUSH:
+		return L"правка: кисть";
+	case EDITMODE_RECT:
+		return L"правка: прямоугольник";
+	case EDITMODE_RANDOM:
+		return L"правка: случайно " + to_wstring((int)(density * 100 + 0.5)) + L"%";
+	case EDITMODE_PASTE:
+		return wstring(L"правка: ") + library[pasteF].name + L" " + to_wstring(rot * 90) + (flip ? L" отр." : L"");
+	}
+	return L"правка: клетка";
+}
+
+/**
+ *\struct frameStats
+ *\details Сводка для наложения: время кадра и скорость смены поколений за последние полсекунды,
+ * время мест замера (при сборке с LIFE_PROFILE) в миллисекундах на кадр и память частей программы
+*/
+struct frameStats
+{
+	/**кадры, поколения и время текущего интервала*/
+	int frames = 0;
+	long long gens = 0;
+	double sec = 0;
+	/**накопленное время мест замера в начале интервала*/
+	vector<pair<const profileSite*, uint64_t>> base;
+	/**текст наложения*/
+	wstring text;
+};
+
+/**
+ *\param st       сводка
+ *\param frameSec время последнего кадра в секундах
+ *\param gens     количество поколений, вычисленных за кадр
+ *\details Накопление кадра; раз в полсекунды текст наложения пересчитывается
+*/
+void frameUpdate(frameStats& st, double frameSec, int gens)
+{
+	st.frames++;
+	st.gens += gens;
+	st.sec += frameSec;
+	if (st.sec < 0.5)
+	{
+		return;
+	}
+	wchar_t buf[128];
+	swprintf(buf, 128, L"кадр %.1f мс\nпоколений/с %.0f", st.sec * 1000 / st.frames, st.gens / st.sec);
+	st.text = buf;
+	vector<pair<const profileSite*, uint64_t>> now;
+	for (const profileSite* p = profileSites(); p != nullptr; p = p->next)
+	{
+		uint64_t ns = p->ns.load(memory_order_relaxed), was = 0;
+		for (const auto& b : st.base)
 		{
-			sb7.setTextureRect(IntRect(SizeX, 0, SizeX, SizeY));
+			if (b.first == p)
+			{
+				was = b.second;
+			}
 		}
-		/**если мышь не наведена 7 кнопку => загружаем первую часть текстуры*/
-		else
+		if (ns > was)
 		{
-			sb7.setTextureRect(IntRect(0, 0, SizeX, SizeY));
+			swprintf(buf, 128, L"\n%hs %.2f мс", p->name, (ns - was) / 1e6 / st.frames);
+			st.text += buf;
 		}
-		/**если мышь наведена на 8 кнопку => загружаем вторую часть текстуры*/
-		if ((posMouse.x >= SpritePositionX8) && (posMouse.x <= SpritePositionX8 + SizeX)
-			&& (posMouse.y >= SpritePositionY8) && (posMouse.y <= SpritePositionY8 + SizeY))
+		now.push_back({p, ns});
+	}
+	/**память частей программы*/
+	string mem = memText();
+	st.text += L"\n" + wstring(mem.begin(), mem.end() - 1);
+	st.base.swap(now);
+	st.frames = 0;
+	st.gens = 0;
+	st.sec = 0;
+}
+
+/**
+ *\param gens количество поколений для каждого способа вычисления
+ *\return код завершения программы
+ *\details Сравнение скорости способов вычисления поколения на случайном водоёме:
+ * все способы из таблицы engines и побитовые сумматоры над битовыми плоскостями
+ * (nextGenerationRule с правилом B3/S23). После прогона конечные состояния всех способов сверяются.
+ * Отдельно измеряется время разметки объектов водоёма 1024 x 1024 после каждого поколения
+ * и вычисление водоёма 2048 x 2048 временными плитками (nextGenerationsBlocked) против отдельных шагов.
+*/
+int benchmark(int gens)
+{
+	int h = (int)MW, w = (int)MH;
+	point** m[ENGINES][2];
+	for (int e = 0; e < ENGINES; e++)
+	{
+		m[e][0] = newMatrix(inPlaceThreads, MEM_GRID);
+		m[e][1] = engines[e].twoBoards ? newMatrix(inPlaceThreads, MEM_SECOND) : nullptr;
+	}
+	rule life;
+	parseRule("B3/S23", life);
+	planeGrid g, g1;
+	planeInit(g, h, w, 1);
+	planeInit(g1, h, w, 1);
+	/**случайное начальное заполнение с плотностью 1/3*/
+	srand(1);
+	for (int i = 0; i < h; i++)
+	{
+		for (int j = 0; j < w; j++)
 		{
-			sb8.setTextureRect(IntRect(SizeX, 0, SizeX, SizeY));
+			unsigned v = rand() % 3 == 0;
+			for (int e = 0; e < ENGINES; e++)
+			{
+				m[e][0][i][j].is_live = v;
+			}
+			planeSet(g, i, j, v);
 		}
-		/**если мышь не наведена 8 кнопку => загружаем первую часть текстуры*/
-		else
+	}
+	const char* names[ENGINES + 1] = {"naive", "lut 4x4", "in-place", "bit-sliced"};
+	printf("board %dx%d, %d generations\n", w, h, gens);
+	for (int e = 0; e <= ENGINES; e++)
+	{
+		auto t0 = chrono::steady_clock::now();
+		for (int n = 0; n < gens; n++)
 		{
-			sb8.setTextureRect(IntRect(0, 0, SizeX, SizeY));
+			if (e < ENGINES)
+			{
+				engines[e].step(m[e][0], m[e][1]);
+			}
+			else
+			{
+				nextGenerationRule(g, g1, life);
+			}
 		}
-		/**если мышь наведена на 9 кнопку => загружаем вторую часть текстуры*/
-		if ((posMouse.x >= SpritePositionX9) && (posMouse.x <= SpritePositionX9 + SizeX)
-			&& (posMouse.y >= SpritePositionY9) && (posMouse.y <= SpritePositionY9 + SizeY))
+		double sec = chrono::duration<double>(chrono::steady_clock::now() - t0).count();
+		printf("%-12s %10.3f s %12.0f gens/s %14.0f cells/s\n", names[e], sec, gens / sec, (double)gens * w * h / sec);
+	}
+	bool same = true;
+	for (int i = 0; i < h; i++)
+	{
+		for (int j = 0; j < w; j++)
 		{
-			sb9.setTextureRect(IntRect(SizeX, 0, SizeX, SizeY));
+			unsigned v = m[0][0][i][j].is_live;
+			for (int e = 1; e < ENGINES; e++)
+			{
+				if (m[e][0][i][j].is_live != v)
+				{
+					same = false;
+				}
+			}
+			if ((unsigned)planeGet(g, i, j) != v)
+			{
+				same = false;
+			}
 		}
-		/**если мышь не наведена 9 кнопку => загружаем первую часть текстуры*/
-		else
+	}
+	printf("results %s\n", same ? "match" : "DIFFER");
+	/**разметка объектов водоёма 1024 x 1024 после каждого поколения*/
+	planeGrid big, big1;
+	planeInit(big, 1024, 1024, 1);
+	planeInit(big1, 1024, 1024, 1);
+	for (int i = 0; i < big.h; i++)
+	{
+		for (int j = 0; j < big.w; j++)
 		{
-			sb9.setTextureRect(IntRect(0, 0, SizeX, SizeY));
+			planeSet(big, i, j, rand() % 3 == 0);
 		}
-		/**если мышь наведена на 10 кнопку => загружаем вторую часть текстуры*/
-		if ((posMouse.x >= SpritePositionX10) && (posMouse.x <= SpritePositionX10 + SizeX)
-			&& (posMouse.y >= SpritePositionY10) && (posMouse.y <= SpritePositionY10 + SizeY))
+	}
+	objectTracker objs;
+	trackerInit(objs, big.h, big.w, 1);
+	int objGens = max(1, gens / 10);
+	double stepSec = 0, trackSec = 0;
+	for (int n = 0; n < objGens; n++)
+	{
+		auto t0 = chrono::steady_clock::now();
+		nextGenerationRule(big, big1, life);
+		auto t1 = chrono::steady_clock::now();
+		trackerUpdate(objs, big);
+		stepSec += chrono::duration<double>(t1 - t0).count();
+		trackSec += chrono::duration<double>(chrono::steady_clock::now() - t1).count();
+	}
+	printf("objects 1024x1024: %d generations, step %.2f ms, labeling %.2f ms per generation, %zu objects, %d gliders\n",
+		objGens, stepSec * 1000 / objGens, trackSec * 1000 / objGens, objs.objects.size(), objs.gliders);
+	/**временные плитки: k поколений на плитку против отдельных шагов на водоёме 2048 x 2048*/
+	planeGrid seq, seq1, blk, blk1;
+	planeInit(seq, 2048, 2048, 1);
+	planeInit(seq1, 2048, 2048, 1);
+	for (int i = 0; i < seq.h; i++)
+	{
+		for (int j = 0; j < seq.w; j++)
 		{
-			sb10.setTextureRect(IntRect(SizeX, 0, SizeX, SizeY));
+			planeSet(seq, i, j, rand() % 3 == 0);
 		}
-		/**если мышь не наведена 10 кнопку => загружаем первую часть текстуры*/
-		else
+	}
+	blk = seq;
+	planeInit(blk1, 2048, 2048, 1);
+	int tempK = 8, tempGens = max(tempK, gens / 100 / tempK * tempK);
+	auto t0 = chrono::steady_clock::now();
+	for (int n = 0; n < tempGens; n++)
+	{
+		nextGenerationRule(seq, seq1, life);
+	}
+	auto t1 = chrono::steady_clock::now();
+	for (int n = 0; n < tempGens; n += tempK)
+	{
+		nextGenerationsBlocked(blk, blk1, life, tempK);
+	}
+	auto t2 = chrono::steady_clock::now();
+	bool tempSame = seq.plane[0] == blk.plane[0];
+	printf("temporal 2048x2048: %d generations, step %.2f ms, blocked k=%d %.2f ms per generation, results %s\n", tempGens,
+		chrono::duration<double>(t1 - t0).count() * 1000 / tempGens, tempK,
+		chrono::duration<double>(t2 - t1).count() * 1000 / tempGens, tempSame ? "match" : "DIFFER");
+	/**кадр 3840x2160: 384x216 клеток по POINT_SIZE точек, выводимых одной текстурой*/
+	planeGrid screen;
+	planeInit(screen, 2160 / POINT_SIZE, 3840 / POINT_SIZE, 1);
+	for (int i = 0; i < screen.h; i++)
+	{
+		for (int j = 0; j < screen.w; j++)
 		{
-			sb10.setTextureRect(IntRect(0, 0, SizeX, SizeY));
+			planeSet(screen, i, j, rand() % 3 == 0);
 		}
-		/**если мышь наведена на 11 кнопку => загружаем вторую часть текстуры*/
-		if ((posMouse.x >= SpritePositionX11) && (posMouse.x <= SpritePositionX11 + SizeX)
-			&& (posMouse.y >= SpritePositionY11) && (posMouse.y <= SpritePositionY11 + SizeY))
+	}
+	Color classic[2] = {Color(225, 235, 254), Color(29, 173, 47)};
+	Image img;
+	img.loadFromFile("picture\\12.png");
+	cellStyle cells;
+	cellStyleFrom(img, classic, 2, true, POINT_SIZE, cells);
+	frameStyle style;
+	frameStyleFrom(cells, style);
+	workPool drawPool(0);
+	frameBuffer frame;
+	frameFill(frame, screen, style, &drawPool);
+	int frames = 100;
+	auto t3 = chrono::steady_clock::now();
+	for (int n = 0; n < frames; n++)
+	{
+		frameFill(frame, screen, style, &drawPool);
+	}
+	auto t4 = chrono::steady_clock::now();
+	printf("frame %dx%d: %.3f ms per fill, %d threads\n", frame.width, frame.height,
+		chrono::duration<double>(t4 - t3).count() * 1000 / frames, drawPool.size());
+	for (int e = 0; e < ENGINES; e++)
+	{
+		deleteMatrix(m[e][0], MEM_GRID);
+		deleteMatrix(m[e][1], MEM_SECOND);
+	}
+	return same && tempSame ? 0 : 1;
+}
+
+/**
+ *\param path    путь к файлу водоёма
+ *\param h       количество строк
+ *\param w       количество столбцов
+ *\param gens    количество поколений
+ *\param density доля живых клеток случайного заполнения (меньше 0 - оставить содержимое файла)
+ *\return код завершения программы
+ *\details Вычисление поколений водоёма из плиток без вывода окна
+*/
+int tiledRun(const char* path, int64_t h, int64_t w, int gens, double density)
+{
+	tiledGrid g;
+	if (!tiledOpen(g, path, h, w))
+	{
+		printf("cannot open %s or it exceeds the memory budget\n", path);
+		return 1;
+	}
+	if (density >= 0)
+	{
+		tiledRandom(g, density, 1);
+	}
+	auto t0 = chrono::steady_clock::now();
+	int n = 0;
+	while (n < gens)
+	{
+		n++;
+		/**водоём перестал меняться*/
+		if (nextGenerationTiled(g))
 		{
-			sb11.setTextureRect(IntRect(SizeX, 0, SizeX, SizeY));
+			break;
 		}
-		/**если мышь не наведена 11 кнопку => загружаем первую часть текстуры*/
-		else
+	}
+	double sec = chrono::duration<double>(chrono::steady_clock::now() - t0).count();
+	printf("board %lldx%lld, %d generations, %.3f s, %.3f gens/s, %.0f cells/s, population %lld, memory %.1f MB\n",
+		(long long)g.w, (long long)g.h, n, sec, n / sec, (double)n * g.w * g.h / sec, (long long)tiledPopulation(g),
+		memInfo(MEM_TOTAL).peak / 1048576.0);
+	tiledClose(g);
+	return 0;
+}
+
+/**
+ *\param argc количество параметров после ключа --png
+ *\param argv параметры: файл водоёма, строк, столбцов, файл PNG и необязательные cell=, threads=, memory=
+ *\return код завершения программы
+ *\details Вывод водоёма из плиток в PNG в полном размере без окна. Клетки выводятся
+ * цветами текстуры воды picture\12.png.
+*/
+int tiledPngRun(int argc, char* argv[])
+{
+	if (argc < 4)
+	{
+		printf("usage: --png board rows cols out.png [cell=1] [threads=0] [memory=64]\n");
+		return 1;
+	}
+	tiledGrid g;
+	if (!tiledOpen(g, argv[0], atoll(argv[1]), atoll(argv[2])))
+	{
+		printf("cannot open %s or it exceeds the memory budget\n", argv[0]);
+		return 1;
+	}
+	int cell = max(1, atoi(option(argc, argv, "cell", "1").c_str()));
+	workPool pool(atoi(option(argc, argv, "threads", "0").c_str()));
+	size_t budget = (size_t)max(1, atoi(option(argc, argv, "memory", "64").c_str())) << 20;
+	/**цвета на случай, если текстура не загружена*/
+	Color pal[2] = {Color(225, 235, 254), Color(29, 173, 47)};
+	Image img;
+	img.loadFromFile("picture\\12.png");
+	cellStyle style;
+	cellStyleFrom(img, pal, 2, true, cell, style);
+	auto t0 = chrono::steady_clock::now();
+	bool ok = tiledPng(g, argv[3], style, pool, budget);
+	double sec = chrono::duration<double>(chrono::steady_clock::now() - t0).count();
+	printf("%s %lldx%lld pixels, %d colors, %.3f s%s\n", argv[3], (long long)(g.w * cell), (long long)(g.h * cell),
+		style.colors, sec, ok ? "" : ", write failed");
+	tiledClose(g);
+	return ok ? 0 : 1;
+}
+
+/**
+ *\param argc количество параметров после ключа --view
+ *\param argv параметры host=, port=, unix=, lod= (начальный уровень детализации) и draw= (потоков вывода кадра)
+ *\return код завершения программы
+ *\details Окно зрителя сервера показа (--serve): видимая часть MH x MW клеток показа, каждая
+ * на квадрат lod x lod клеток водоёма. Стрелки сдвигают видимую часть на половину окна,
+ * клавиши + и - меняют уровень детализации, Escape закрывает окно.
+*/
+int viewerRun(int argc, char* argv[])
+{
+	viewClient c;
+	int port = atoi(option(argc, argv, "port", to_string(VIEW_PORT).c_str()).c_str());
+	if (!viewConnect(c, option(argc, argv, "host", "127.0.0.1"), port, option(argc, argv, "unix", "")))
+	{
+		printf("cannot connect to the viewer server\n");
+		return 1;
+	}
+	int lod = max(1, atoi(option(argc, argv, "lod", "1").c_str()));
+	int64_t i0 = 0, j0 = 0;
+	viewRegion(c, i0, j0, (int64_t)MW * lod, (int64_t)MH * lod, lod);
+	RenderWindow window(VideoMode((int)MH * POINT_SIZE, (int)MW * POINT_SIZE), "Life viewer");
+	window.setFramerateLimit(60);
+	Texture texture;
+	texture.loadFromFile("picture\\12.png");
+	workPool pool(atoi(option(argc, argv, "draw", "0").c_str()));
+	boardView board;
+	board.pool = &pool;
+	boardStyle(board, texture, c.states, false);
+	int got = 0;
+	while (window.isOpen() && got >= 0)
+	{
+		Event event;
+		bool moved = false;
+		while (window.pollEvent(event))
 		{
-			sb11.setTextureRect(IntRect(0, 0, SizeX, SizeY));
+			if (event.type == Event::Closed || (event.type == Event::KeyPressed && event.key.code == Keyboard::Escape))
+			{
+				window.close();
+			}
+			else if (event.type == Event::KeyPressed)
+			{
+				int64_t di = (int64_t)MW * lod / 2, dj = (int64_t)MH * lod / 2;
+				moved = true;
+				switch (event.key.code)
+				{
+				case Keyboard::Left:
+					j0 -= dj;
+					break;
+				case Keyboard::Right:
+					j0 += dj;
+					break;
+				case Keyboard::Up:
+					i0 -= di;
+					break;
+				case Keyboard::Down:
+					i0 += di;
+					break;
+				case Keyboard::Add:
+				case Keyboard::Equal:
+					lod = max(1, lod / 2);
+					break;
+				case Keyboard::Subtract:
+				case Keyboard::Hyphen:
+					lod = min(1 << 10, lod * 2);
+					break;
+				default:
+					moved = false;
+					break;
+				}
+			}
 		}
-		/**если мышь наведена на 12 кнопку => загружаем вторую часть текстуры*/
-		if ((posMouse.x >= SpritePositionX12) && (posMouse.x <= SpritePositionX12 + SizeX)
-			&& (posMouse.y >= SpritePositionY12) && (posMouse.y <= SpritePositionY12 + SizeY))
+		if (moved)
 		{
-			sb12.setTextureRect(IntRect(SizeX, 0, SizeX, SizeY));
+			i0 = max<int64_t>(0, min(i0, c.rows - 1));
+			j0 = max<int64_t>(0, min(j0, c.cols - 1));
+			viewRegion(c, i0, j0, (int64_t)MW * lod, (int64_t)MH * lod, lod);
 		}
-		/**если мышь не наведена 12 кнопку => загружаем первую часть текстуры*/
-		else
+		/**применяем все пришедшие кадры, выводится последний*/
+		while ((got = viewReceive(c, 0)) > 0)
 		{
-			sb12.setTextureRect(IntRect(0, 0, SizeX, SizeY));
 		}
-		/**утанавливаем позиции вывода спрайтов*/
-		sClose.setPosition((float)closeSpritePositionX, (float)closeSpritePositionY);
-		sb1.setPosition((float)SpritePositionX1, (float)SpritePositionY1);
-		sb2.setPosition((float)SpritePositionX2, (float)SpritePositionY2);
-		sb3.setPosition((float)SpritePositionX3, (float)SpritePositionY3);
-		sb4.setPosition((float)SpritePositionX4, (float)SpritePositionY4);
-		sb5.setPosition((float)SpritePositionX5, (float)SpritePositionY5);
-		sb6.setPosition((float)SpritePositionX6, (float)SpritePositionY6);
-		sb7.setPosition((float)SpritePositionX7, (float)SpritePositionY7);
-		sb8.setPosition((float)SpritePositionX8, (float)SpritePositionY8);
-		sb9.setPosition((float)SpritePositionX9, (float)SpritePositionY9);
-		sb10.setPosition((float)SpritePositionX10, (float)SpritePositionY10);
-		sb11.setPosition((float)SpritePositionX11, (float)SpritePositionY11);
-		sb12.setPosition((float)SpritePositionX12, (float)SpritePositionY12);
-		/**отрисовываем спрайты в окне*/
-		figW.draw(sClose);
-		figW.draw(fName); 
-		figW.draw(sb1); figW.draw(sb2); figW.draw(sb3);	figW.draw(sb4);
-		figW.draw(sb5); figW.draw(sb6);	figW.draw(sb7);	figW.draw(sb8);
-		figW.draw(sb9);	figW.draw(sb10); figW.draw(sb11); figW.draw(sb12);
-		/**отрисовываем окно*/
-		figW.display();
+		window.clear(Color::White);
+		boardDraw(window, board, c.view);
+		window.setTitle("Life viewer: generation " + to_string(c.generation) + ", population " + to_string(c.population)
+			+ ", lod " + to_string(c.area.lod) + ", skipped " + to_string(c.skipped));
+		window.display();
 	}
+	if (got < 0)
+	{
+		printf("connection lost\n");
+	}
+	viewClose(c);
+	return 0;
 }
 
-
 /**
  *\details Основная функция программы. 
  *Осуществляется создание и вывод основного окна. 
  *Управляет и согласовывает работу других частей программы.
+ *Запуск с ключом --bench [поколений] выполняет сравнение скорости способов вычисления поколения.
+ *Запуск с ключом --tiled файл строк столбцов открывает водоём из плиток в файле,
+ *а с указанием количества поколений (и плотности случайного заполнения) вычисляет их без окна.
+ *Ключи --dist-coord и --dist-worker запускают координатор и рабочий процесс распределённого вычисления.
+ *Ключ --ensemble вычисляет ансамбль случайных водоёмов размера MH x MW.
+ *Ключ --census проводит перепись объектов, остающихся от случайных суп.
+ *Ключ --census-check сверяет коды переписи известных объектов и длинных серий нулей.
+ *Ключ --png выводит водоём из плиток в PNG в полном размере.
+ *Ключ --serve запускает сервер показа, --view открывает окно зрителя, --watch - зрителя без окна.
+ *Ключ budget=часть:размер,... задаёт бюджеты памяти частей программы (grid, second, history, render,
+ *textures, cache, total), memlog=файл выгружает текущий и наибольший объём памяти частей при выходе.
+ *Ключ --dedup вычисляет поколения повторяющегося водоёма из общих плиток.
+ *Ключ --sparse вычисляет поколения огромного почти пустого водоёма, хранимого списком живых клеток.
+ *Ключ draw=потоков задаёт количество потоков, заполняющих кадр водоёма (0 - по количеству ядер).
+ *Ключ step=потоков задаёт количество полос строк, вычисляемых параллельно способом "на месте" (0 - по количеству ядер).
+ *Ключ --search ищет колонию во всех поворотах и отражениях в большом водоёме.
+ *Ключ slice=миллисекунд ограничивает время вычисления поколения водоёма из плиток за кадр (0 - поколение целиком).
+ *Ключ patterns=папка добавляет в окно "фигуры" колонии из файлов RLE и .cells, thumbs=файл - файл кэша миниатюр.
+ *Ключ --parent ищет родителей колонии (водоёмы, дающие её за одно поколение) или доказывает, что это Сад Эдема.
 */
-int main()
+int main(int argc, char* argv[])
 { 
-	/**создаём матрицы водоёма*/
-	point** matrix = new point * [MW];
-	point** matrix1 = new point * [MW];
-	for (int i = 0; i < MW; i++)
+	/**большие страницы для водоёмов: huge=off, thp (прозрачные) или explicit (явные)*/
+	string huge = option(argc, argv, "huge", "thp");
+	slabHugePages(huge == "off" ? SLAB_HUGE_OFF : huge == "explicit" ? SLAB_HUGE_EXPLICIT : SLAB_HUGE_THP);
+	/**бюджеты памяти (budget=total:1G,history:16M) и файл сводки памяти при выходе*/
+	if (!memBudgets(option(argc, argv, "budget", "")))
+	{
+		printf("bad budget: use part:size[K|M|G],... with parts grid, second, history, render, textures, cache, total\n");
+		return 1;
+	}
+	string memLog = option(argc, argv, "memlog", "");
+	/**потоки вычисления поколения на месте: step=потоков (0 - по количеству ядер)*/
+	inPlaceThreads = atoi(option(argc, argv, "step", "1").c_str());
+	if (inPlaceThreads <= 0)
+	{
+		inPlaceThreads = max(1, (int)thread::hardware_concurrency());
+	}
+	if (argc > 1 && strcmp(argv[1], "--bench") == 0)
+	{
+		return benchmark(argc > 2 ? atoi(argv[2]) : 1000);
+	}
+	if (argc > 1 && strcmp(argv[1], "--dist-coord") == 0)
+	{
+		return distCoordinator(argc - 2, argv + 2);
+	}
+	if (argc > 1 && strcmp(argv[1], "--dist-worker") == 0)
+	{
+		return distWorker(argc - 2, argv + 2);
+	}
+	if (argc > 1 && strcmp(argv[1], "--ensemble") == 0)
+	{
+		return ensembleRun(argc - 2, argv + 2);
+	}
+	if (argc > 1 && strcmp(argv[1], "--census-check") == 0)
+	{
+		return censusCheck();
+	}
+	if (argc > 1 && strcmp(argv[1], "--census") == 0)
+	{
+		return censusRun(argc - 2, argv + 2);
+	}
+	if (argc > 1 && strcmp(argv[1], "--png") == 0)
+	{
+		return tiledPngRun(argc - 2, argv + 2);
+	}
+	if (argc > 1 && strcmp(argv[1], "--serve") == 0)
+	{
+		return viewServe(argc - 2, argv + 2);
+	}
+	if (argc > 1 && strcmp(argv[1], "--view") == 0)
+	{
+		return viewerRun(argc - 2, argv + 2);
+	}
+	if (argc > 1 && strcmp(argv[1], "--watch") == 0)
+	{
+		return viewWatch(argc - 2, argv + 2);
+	}
+	if (argc > 1 && strcmp(argv[1], "--dedup") == 0)
+	{
+		return dedupRun(argc - 2, argv + 2);
+	}
+	if (argc > 1 && strcmp(argv[1], "--sparse") == 0)
+	{
+		return sparseRun(argc - 2, argv + 2);
+	}
+	if (argc > 1 && strcmp(argv[1], "--search") == 0)
+	{
+		return searchRun(argc - 2, argv + 2);
+	}
+	if (argc > 1 && strcmp(argv[1], "--parent") == 0)
+	{
+		return parentRun(argc - 2, argv + 2);
+	}
+	/**водоём из плиток в отображённом в память файле*/
+	tiledGrid big;
+	bool tiled = false;
+	/**левый верхний угол видимой части водоёма из плиток*/
+	int64_t viewI = 0, viewJ = 0;
+	/**количество параметров без параметров вида ключ=значение в конце*/
+	int positional = argc;
+	while (positional > 2 && strchr(argv[positional - 1], '=') != nullptr)
+	{
+		positional--;
+	}
+	if (positional > 4 && strcmp(argv[1], "--tiled") == 0)
 	{
-		matrix[i] = new point[MH];
-		matrix1[i] = new point[MH];
+		if (positional > 5)
+		{
+			int code = tiledRun(argv[2], atoll(argv[3]), atoll(argv[4]), atoi(argv[5]), positional > 6 ? atof(argv[6]) : -1.0);
+			if (!memLog.empty() && !memExport(memLog.c_str(), string("tiled board ") + argv[3] + "x" + argv[4]))
+			{
+				printf("cannot write %s\n", memLog.c_str());
+			}
+			return code;
+		}
+		tiled = tiledOpen(big, argv[2], atoll(argv[3]), atoll(argv[4]));
+		if (!tiled)
+		{
+			printf("cannot open %s or it exceeds the memory budget\n", argv[2]);
+			return 1;
+		}
 	}
+	/**номер способа вычисления поколения классической "Жизни"*/
+	int engineF = 0;
+	/**создаём матрицы водоёма, вторая нужна не всем способам вычисления*/
+	point** matrix = newMatrix(inPlaceThreads, MEM_GRID);
+	point** matrix1 = engines[engineF].twoBoards ? newMatrix(inPlaceThreads, MEM_SECOND) : nullptr;
 	/**заполняем матрицу "водой" (0)*/
 	fGeneration(matrix);
 	/**флаг состояния работы программы (true - цикл жизни запущен, false - остановлен)*/
@@ -978,6 +1797,10 @@ int main()
 	int helpSizeY = 35;
 	/**задержка между сменой "поколений" в секундах*/
 	double timer = 0;
+	/**поколение водоёма из плиток вычисляется частями не дольше slice= миллисекунд за кадр
+	 (0 - целиком), между частями окно обрабатывает события и выводит прежнее поколение*/
+	double sliceSec = atof(option(argc, argv, "slice", "8").c_str()) / 1000;
+	tiledCursor cursor;
 	/**объект времени для регулирования задержки*/
 	Clock clock;
 	/**создание и загрузка шрифта*/
@@ -1006,6 +1829,97 @@ int main()
 	tStart.setSmooth(true);	tClear.setSmooth(true);
 	tStop.setSmooth(true);	tPlus.setSmooth(true);
 	tMinus.setSmooth(true);	tHelp.setSmooth(true);
+	/**текстуры учитываются по размеру изображения, 4 байта на точку*/
+	for (const Texture* t : {&texture, &tClose, &tFig, &tStart, &tStop, &tClear, &tPlus, &tMinus, &tHelp})
+	{
+		memAdd(MEM_TEXTURES, (int64_t)t->getSize().x * t->getSize().y * 4);
+	}
+	/**каталог окна "фигуры": колонии библиотеки и файлы папки patterns=, миниатюры в файле thumbs=;
+	 папка просматривается и миниатюры готовятся в своём потоке с самого запуска*/
+	thumbCatalog catalog;
+	thumbOpen(catalog, option(argc, argv, "patterns", "patterns"), option(argc, argv, "thumbs", "thumbs.cache"));
+	/**вывод водоёма одной текстурой; кадр заполняют draw= потоков (0 - по количеству ядер)*/
+	workPool drawPool(atoi(option(argc, argv, "draw", "0").c_str()));
+	boardView board;
+	board.pool = &drawPool;
+	boardStyle(board, texture, 2, true);
+	/**набор правил, переключаемых клавишей R: классическая "Жизнь" и многоцветные правила*/
+	const char* ruleNames[4] = {"B3/S23", "B2/S/C3", "B2/S345/C4", "R5,C0,M1,S34..58,B34..45,NM"};
+	/**названия правил для вывода в окне*/
+	const wchar_t* ruleTitles[4] = {L"Жизнь", L"Brian's Brain", L"Star Wars", L"Bosco (LtL)"};
+	/**номер текущего правила (0 - классическая "Жизнь" на матрице водоёма)*/
+	int ruleF = 0;
+	rule curRule;
+	parseRule(ruleNames[ruleF], curRule);
+	/**водоёмы с многобитными клетками для многоцветных правил*/
+	planeGrid multi, multi1;
+	/**цвета состояний клеток*/
+	Color pal[16];
+	/**слежение за объектами классической "Жизни" (клавиша O) и упакованная копия матрицы для него*/
+	bool tracking = false;
+	objectTracker objs;
+	/**колонии, найденные поиском (клавиша S), и признак показа их рамок*/
+	vector<searchMatch> matches;
+	bool searched = false;
+	planeGrid packed;
+	planeInit(packed, (int)MW, (int)MH, 1);
+	/**режим правки (клавиша M), команды правки текущего кадра и протягивание мыши*/
+	int editMode = EDITMODE_TOGGLE;
+	vector<editCommand> edits;
+	/**очередь команд от окна к вычислению поколений и журнал отмены (Ctrl+Z, Ctrl+Y)*/
+	static editQueue queue;
+	editJournal journal;
+	bool dragging = false, dragErase = false;
+	int64_t dragI = 0, dragJ = 0;
+	/**плотность и номер случайного заполнения, колония для вставки, её поворот и отражение*/
+	double density = 0.35;
+	uint64_t randomSeed = 1;
+	int pasteF = 0, pasteRot = 0;
+	bool pasteFlip = false;
+	/**клетка водоёма под точкой окна (в водоёме из плиток - с учётом видимой части)*/
+	auto cellAt = [&](int px, int py, int64_t& ci, int64_t& cj)
+	{
+		ci = py / POINT_SIZE + (tiled ? viewI : 0);
+		cj = px / POINT_SIZE + (tiled ? viewJ : 0);
+	};
+	/**начало правки в точке окна: кисть сразу ставит клетку, вставка кладёт колонию*/
+	auto editStart = [&](int px, int py, bool erase)
+	{
+		cellAt(px, py, dragI, dragJ);
+		dragErase = erase;
+		dragging = editMode != EDITMODE_PASTE;
+		if (editMode == EDITMODE_BRUSH)
+		{
+			edits.push_back(editRect(erase ? EDIT_CLEAR : EDIT_SET, dragI, dragJ, dragI + 1, dragJ + 1));
+		}
+		else if (editMode == EDITMODE_PASTE)
+		{
+			edits.push_back(editPaste(library[pasteF], pasteRot, pasteFlip, dragI, dragJ));
+		}
+	};
+	/**запись поколений (клавиша V): вид (record=gif, png, raw), файл или команда кодировщика,
+	 размер клетки в точках, каждое every-е поколение, задержка кадра GIF в сотых долях секунды*/
+	recorder rec;
+	string recFormat = option(argc, argv, "record", "gif");
+	int recKind = recFormat == "png" ? REC_PNG : recFormat == "raw" ? REC_RAW : REC_GIF;
+	int recCell = max(1, atoi(option(argc, argv, "cell", "4").c_str()));
+	int recEvery = atoi(option(argc, argv, "every", "1").c_str());
+	int recDelay = atoi(option(argc, argv, "delay", "10").c_str());
+	string recOut = option(argc, argv, "out", recKind == REC_GIF ? "life.gif" : recKind == REC_PNG ? "life_" : "");
+	if (recKind == REC_RAW && recOut.empty())
+	{
+		recOut = "ffmpeg -y -loglevel error -f rawvideo -pix_fmt rgb24 -s " + to_string((int)MH * recCell) + "x"
+			+ to_string((int)MW * recCell) + " -r 30 -i - life.mp4";
+	}
+	/**видимая часть водоёма из плиток для записи*/
+	planeGrid view;
+	planeInit(view, (int)MW, (int)MH, 1);
+	/**память многобитных водоёмов, буферов вывода и журнала, учтённая в memtrack*/
+	uint64_t memMulti = 0, memMulti1 = 0, memRender = 0, memHistory = 0, memBoard = 0;
+	/**наложение со сводкой времени (клавиша P) и количество поколений за текущий кадр*/
+	bool overlay = false;
+	frameStats stats;
+	int framesGens = 0;
 
 	/**основной цикл главного окна*/
 	while (window.isOpen())
@@ -1020,6 +1934,7 @@ int main()
 		/**событие*/
 		Event event;
 		/**цикл реакций на события*/
+		PROFILE_BEGIN(pollSpan, "pollEvent");
 		while (window.pollEvent(event))
 		{
 			/**отслеживание нажатий мыши*/
@@ -1038,16 +1953,24 @@ int main()
 					else if ((posMouse.x >= 0) && (posMouse.x <= MH * POINT_SIZE)
 						&& (posMouse.y >= 0) && (posMouse.y <= MW * POINT_SIZE))
 					{
-						int x, y;
-						x = posMouse.x / POINT_SIZE;
-						y = posMouse.y / POINT_SIZE;
-						matrix[y][x].is_live = !matrix[y][x].is_live;
+						/**в режимах правки областей начинается протягивание или вставляется колония*/
+						if (editMode != EDITMODE_TOGGLE)
+						{
+							editStart(posMouse.x, posMouse.y, false);
+						}
+						/**клетка (в водоёме из плиток - клетка видимой части) становится живой или водой*/
+						else
+						{
+							int64_t ci, cj;
+							cellAt(posMouse.x, posMouse.y, ci, cj);
+							edits.push_back(editRect(EDIT_TOGGLE, ci, cj, ci + 1, cj + 1));
+						}
 					}
 					/**на "очистить" => обнуляем всё значения клеток*/
 					else if ((posMouse.x >= clearSpritePositionX) && (posMouse.x <= clearSpritePositionX + clearSizeX)
 						&& (posMouse.y >= clearSpritePositionY) && (posMouse.y <= clearSpritePositionY + clearSizeY))
 					{
-						clear(matrix);
+						edits.push_back(editRect(EDIT_CLEAR, 0, 0, tiled ? big.h : (int64_t)MW, tiled ? big.w : (int64_t)MH));
 					}
 					/**на "старт" => запускаем или останавливаем программу, с помощью флага starting*/
 					else if ((posMouse.x >= startSpritePositionX) && (posMouse.x <= startSpritePositionX + startSizeX)
@@ -1091,12 +2014,314 @@ int main()
 						/**делаем главное окно невидимым*/
 						window.setVisible(false);
 						/**отрисовываем вспомогательное окно*/
-						figures(matrix);
+						/**фигура записывается в видимую часть водоёма*/
+						figures(edits, catalog, tiled ? viewI : 0, tiled ? viewJ : 0);
 						/**делаем главное окно видимым*/
 						window.setVisible(true);
 					}
 				}
 			}
+			/**правая кнопка мыши на водоёме => стирание кистью или прямоугольником*/
+			if (event.type == Event::MouseButtonPressed && event.mouseButton.button == Mouse::Right
+				&& editMode != EDITMODE_TOGGLE && editMode != EDITMODE_PASTE
+				&& event.mouseButton.x < MH * POINT_SIZE && event.mouseButton.y < MW * POINT_SIZE)
+			{
+				editStart(event.mouseButton.x, event.mouseButton.y, true);
+			}
+			/**движение мыши с нажатой кнопкой => кисть рисует линию от прежней клетки*/
+			if (event.type == Event::MouseMoved && dragging && editMode == EDITMODE_BRUSH)
+			{
+				int64_t ci, cj;
+				cellAt(event.mouseMove.x, event.mouseMove.y, ci, cj);
+				int64_t steps = max(llabs(ci - dragI), llabs(cj - dragJ));
+				for (int64_t k = 1; k <= steps; k++)
+				{
+					int64_t i = dragI + (ci - dragI) * k / steps, j = dragJ + (cj - dragJ) * k / steps;
+					edits.push_back(editRect(dragErase ? EDIT_CLEAR : EDIT_SET, i, j, i + 1, j + 1));
+				}
+				dragI = ci;
+				dragJ = cj;
+			}
+			/**отпускание кнопки => заливка, стирание или случайное заполнение протянутого прямоугольника*/
+			if (event.type == Event::MouseButtonReleased && dragging)
+			{
+				dragging = false;
+				int64_t ci, cj;
+				cellAt(event.mouseButton.x, event.mouseButton.y, ci, cj);
+				int64_t i0 = min(ci, dragI), i1 = max(ci, dragI) + 1, j0 = min(cj, dragJ), j1 = max(cj, dragJ) + 1;
+				if (editMode == EDITMODE_RECT || (editMode == EDITMODE_RANDOM && dragErase))
+				{
+					edits.push_back(editRect(dragErase ? EDIT_CLEAR : EDIT_SET, i0, j0, i1, j1));
+				}
+				else if (editMode == EDITMODE_RANDOM)
+				{
+					edits.push_back(editRandom(i0, j0, i1, j1, density, randomSeed++));
+				}
+			}
+			/**клавиша M => следующий режим правки; [ и ] => плотность случайного заполнения;
+			 N, Q, F => колония для вставки, её поворот и отражение*/
+			if (event.type == Event::KeyPressed)
+			{
+				if (event.key.code == Keyboard::M)
+				{
+					editMode = (editMode + 1) % EDITMODES;
+					dragging = false;
+				}
+				else if (event.key.code == Keyboard::LBracket)
+				{
+					density = max(0.05, density - 0.05);
+				}
+				else if (event.key.code == Keyboard::RBracket)
+				{
+					density = min(1.0, density + 0.05);
+				}
+				else if (event.key.code == Keyboard::N)
+				{
+					pasteF = (pasteF + 1) % LIBRARY_SIZE;
+				}
+				else if (event.key.code == Keyboard::Q)
+				{
+					pasteRot = (pasteRot + 1) % 4;
+				}
+				else if (event.key.code == Keyboard::F)
+				{
+					pasteFlip = !pasteFlip;
+				}
+			}
+			/**Ctrl+Z => отмена последней правки; Ctrl+Y или Ctrl+Shift+Z => повтор отменённой*/
+			if (event.type == Event::KeyPressed && event.key.control)
+			{
+				if (event.key.code == Keyboard::Z && !event.key.shift)
+				{
+					edits.push_back(editAction(EDIT_UNDO));
+				}
+				else if (event.key.code == Keyboard::Y || event.key.code == Keyboard::Z)
+				{
+					edits.push_back(editAction(EDIT_REDO));
+				}
+			}
+			/**клавиша R => переключаем правило, живые клетки переносятся в новый водоём*/
+			if (event.type == Event::KeyPressed && event.key.code == Keyboard::R && !tiled)
+			{
+				/**новое правило не включается, если его водоёмы не укладываются в бюджет памяти*/
+				int nextRuleF = (ruleF + 1) % 4;
+				rule nextRule;
+				parseRule(ruleNames[nextRuleF], nextRule);
+				uint64_t ruleBytes = (uint64_t)MW * (((int)MH + 63) / 64) * sizeof(uint64_t) * planesFor(nextRule.states);
+				if (nextRuleF != 0 && (!memFits(MEM_GRID, ruleBytes > memMulti ? ruleBytes - memMulti : 0)
+					|| !memFits(MEM_SECOND, ruleBytes > memMulti1 ? ruleBytes - memMulti1 : 0)))
+				{
+					printf("rule %s does not fit the memory budget\n", ruleNames[nextRuleF]);
+					continue;
+				}
+				if (ruleF != 0)
+				{
+					fromPlanes(multi, matrix);
+				}
+				/**у нового правила другие состояния клеток, поэтому запись завершается*/
+				if (rec.active)
+				{
+					recordStop(rec);
+				}
+				ruleF = (ruleF + 1) % 4;
+				/**биты слов меняют смысл, поэтому прежние правки не отменяются*/
+				journalClear(journal);
+				parseRule(ruleNames[ruleF], curRule);
+				if (ruleF != 0)
+				{
+					planeInit(multi, (int)MW, (int)MH, planesFor(curRule.states));
+					planeInit(multi1, (int)MW, (int)MH, planesFor(curRule.states));
+					toPlanes(matrix, multi);
+					statePalette(texture, curRule.states, pal);
+				}
+				boardStyle(board, texture, curRule.states, ruleF == 0);
+			}
+			/**клавиша V => начинаем или завершаем запись поколений*/
+			if (event.type == Event::KeyPressed && event.key.code == Keyboard::V)
+			{
+				if (rec.active)
+				{
+					if (!recordStop(rec))
+					{
+						printf("recording to %s failed\n", recOut.c_str());
+					}
+				}
+				else
+				{
+					bool classic = tiled || ruleF == 0;
+					Color recPal[16];
+					statePalette(texture, 2, recPal);
+					cellStyle style;
+					cellStyleFrom(texture.copyToImage(), classic ? recPal : pal, classic ? 2 : curRule.states, classic, recCell, style);
+					if (!recordStart(rec, recKind, recOut, style, (int)MW, (int)MH, classic ? 1 : multi.bits, recEvery, recDelay))
+					{
+						printf("cannot start recording to %s\n", recOut.c_str());
+					}
+					else if (recKind == REC_RAW)
+					{
+						printf("raw rgb24 frames %dx%d\n", (int)MH * recCell, (int)MW * recCell);
+					}
+				}
+			}
+			/**клавиша P => показываем или скрываем наложение со сводкой времени*/
+			if (event.type == Event::KeyPressed && event.key.code == Keyboard::P)
+			{
+				overlay = !overlay;
+			}
+			/**клавиша T => выгружаем замеры в trace.json (при сборке с LIFE_PROFILE)*/
+			if (event.type == Event::KeyPressed && event.key.code == Keyboard::T)
+			{
+				printf(profileExport("trace.json") ? "trace.json written\n" : "cannot write trace.json\n");
+			}
+			/**клавиша S => ищем колонию для вставки во всех поворотах и отражениях, повторное нажатие
+			 снимает рамки найденных*/
+			if (event.type == Event::KeyPressed && event.key.code == Keyboard::S && !event.key.control)
+			{
+				matches.clear();
+				searched = !searched && (ruleF == 0 || tiled);
+				if (searched)
+				{
+					editCommand p = editPlace(library[pasteF], 0, false, 0, 0);
+					searchQuery q;
+					searchPrepare(q, (int)p.i1, (int)p.j1, p.words, p.bits, true);
+					if (tiled)
+					{
+						matches = searchTiled(q, big, drawPool);
+					}
+					else
+					{
+						toPlanes(matrix, packed);
+						matches = searchPlanes(q, packed, drawPool);
+					}
+				}
+			}
+			/**клавиша O => включаем или выключаем слежение за объектами*/
+			if (event.type == Event::KeyPressed && event.key.code == Keyboard::O)
+			{
+				tracking = !tracking;
+				if (tracking)
+				{
+					trackerInit(objs, (int)MW, (int)MH, 1);
+					toPlanes(matrix, packed);
+					trackerUpdate(objs, packed);
+				}
+			}
+			/**стрелки => сдвигаем видимую часть водоёма из плиток на 10 клеток*/
+			if (event.type == Event::KeyPressed && tiled)
+			{
+				if (event.key.code == Keyboard::Left)
+				{
+					viewJ = max<int64_t>(0, viewJ - 10);
+				}
+				else if (event.key.code == Keyboard::Right)
+				{
+					viewJ = max<int64_t>(0, min<int64_t>(big.w - (int64_t)MH, viewJ + 10));
+				}
+				else if (event.key.code == Keyboard::Up)
+				{
+					viewI = max<int64_t>(0, viewI - 10);
+				}
+				else if (event.key.code == Keyboard::Down)
+				{
+					viewI = max<int64_t>(0, min<int64_t>(big.h - (int64_t)MW, viewI + 10));
+				}
+			}
+			/**клавиша E => переключаем способ вычисления поколения*/
+			if (event.type == Event::KeyPressed && event.key.code == Keyboard::E)
+			{
+				int nextEngine = (engineF + 1) % ENGINES;
+				/**вторая матрица создаётся или освобождается в зависимости от способа;
+				 способ, второй матрице которого не хватает бюджета памяти, не включается*/
+				if (engines[nextEngine].twoBoards && matrix1 == nullptr)
+				{
+					if (memFits(MEM_SECOND, matrixBytes()))
+					{
+						matrix1 = newMatrix(inPlaceThreads, MEM_SECOND);
+						engineF = nextEngine;
+					}
+					else
+					{
+						printf("second board does not fit the memory budget\n");
+					}
+				}
+				else
+				{
+					if (!engines[nextEngine].twoBoards)
+					{
+						deleteMatrix(matrix1, MEM_SECOND);
+						matrix1 = nullptr;
+					}
+					engineF = nextEngine;
+				}
+			}
+		}
+		PROFILE_END(pollSpan);
+		/**правки кадра передаются в очередь; не поместившиеся ждут следующего кадра*/
+		size_t sent = 0;
+		while (sent < edits.size() && editPush(queue, edits[sent]))
+		{
+			sent++;
+		}
+		edits.erase(edits.begin(), edits.begin() + sent);
+		/**между поколениями выполняются все команды, уже лежащие в очереди*/
+		editCommand command;
+		if (editPop(queue, command))
+		{
+			PROFILE_SCOPE("edits");
+			if (ruleF == 0 && !tiled)
+			{
+				toPlanes(matrix, packed);
+			}
+			do
+			{
+				if (tiled)
+				{
+					/**правка меняет текущее поколение, поэтому незавершённое следующее вычисляется заново*/
+					editApplyTiled(big, command, &journal);
+					cursor = tiledCursor();
+				}
+				else if (ruleF == 0)
+				{
+					editApply(packed, command, &journal);
+				}
+				else
+				{
+					editApply(multi, command, &journal);
+				}
+			} while (editPop(queue, command));
+			if (ruleF == 0 && !tiled)
+			{
+				fromPlanes(packed, matrix);
+			}
+			/**рамки найденных колоний относятся к прежнему водоёму*/
+			matches.clear();
+			searched = false;
+		}
+		/**учёт памяти водоёмов, буферов вывода и журнала; при превышении бюджета журнал
+		 укорачивается, а пул освобождённых участков возвращается системе*/
+		memAccount(MEM_GRID, memMulti, planeBytes(multi));
+		memAccount(MEM_SECOND, memMulti1, planeBytes(multi1));
+		uint64_t renderBytes = planeBytes(packed) + planeBytes(view) + planeBytes(board.cells)
+			+ board.frame.pixels.capacity() * sizeof(uint32_t);
+		for (const planeGrid& slot : rec.slot)
+		{
+			renderBytes += planeBytes(slot);
+		}
+		memAccount(MEM_RENDER, memRender, renderBytes);
+		memAccount(MEM_TEXTURES, memBoard, (uint64_t)board.texture.getSize().x * board.texture.getSize().y * 4);
+		uint64_t historyBudget = memInfo(MEM_HISTORY).budget;
+		if (historyBudget != 0 && journal.limit != historyBudget / sizeof(editDiff))
+		{
+			journalLimit(journal, historyBudget / sizeof(editDiff));
+		}
+		if (memOver(MEM_HISTORY))
+		{
+			journalLimit(journal, journal.size / 2);
+		}
+		memAccount(MEM_HISTORY, memHistory, journal.size * sizeof(editDiff));
+		if (memOver(MEM_CACHE))
+		{
+			slabTrim();
 		}
 		/**устанавливаем цвет фона главного окна (RGB)*/
 		window.clear(Color(235, 241, 251));
@@ -1104,18 +2329,64 @@ int main()
 		/**если после смены предыдущего поколения прошло больше времени, чем было задано текущей скоростью игры, 
 		 *то делаем попытку запустить следущий цикл смены поколений
 		*/
-		if (timer > delay[speedF])
+		if (timer > delay[speedF] || cursor.tile > 0)
 		{
 			/**если нажата кнопка "старт", то запускаем смену поколений*/
 			if (starting)
 			{
+				PROFILE_SCOPE("step");
 				/**запуск смены поколений. 
 				 *проверка необходимости дальнейшей смены поколений
 				 *игра остановится, если в водоёме не произошли изменения или водоём пуст
 				*/
-				if (nextGeneration(matrix, matrix1))
+				bool stop = false, done = true;
+				if (tiled)
+				{
+					/**поколение водоёма из плиток, не уложившееся в кадр, продолжается в следующем*/
+					done = nextGenerationTiledSlice(big, cursor, sliceSec, stop);
+				}
+				else
 				{
-					starting = !starting;
+					stop = ruleF == 0 ? engines[engineF].step(matrix, matrix1) : nextGenerationRule(multi, multi1, curRule);
+				}
+				if (done)
+				{
+					framesGens++;
+					matches.clear();
+					searched = false;
+					/**объекты прослеживаются по поколениям, поэтому разметка обновляется после каждого шага*/
+					if ((tracking || rec.active) && ruleF == 0 && !tiled)
+					{
+						toPlanes(matrix, packed);
+					}
+					if (tracking && ruleF == 0 && !tiled)
+					{
+						trackerUpdate(objs, packed);
+					}
+					/**записывается водоём (у водоёма из плиток - видимая часть); кодирование идёт в своём потоке*/
+					if (rec.active)
+					{
+						if (tiled)
+						{
+							planeClear(view);
+							for (int i = 0; i < MW && viewI + i < big.h; i++)
+							{
+								for (int j = 0; j < MH && viewJ + j < big.w; j++)
+								{
+									planeSet(view, i, j, tiledGet(big, viewI + i, viewJ + j) ? 1 : 0);
+								}
+							}
+							recordFrame(rec, view);
+						}
+						else
+						{
+							recordFrame(rec, ruleF == 0 ? packed : multi);
+						}
+					}
+					if (stop)
+					{
+						starting = !starting;
+					}
 				}
 			}
 			/**обнуление таймера*/
@@ -1239,10 +2510,90 @@ int main()
 		fName.setStyle(Text::Bold);
 		/**установка позиции показателя скорости (координаты середины между кнопками "+" и "-")*/
 		fName.setPosition((plusSpritePositionX + minusSizeX - (float)minusSpritePositionX)/2 + (float)minusSpritePositionX  - 5, (float)minusSpritePositionY);
+		/**название текущего правила*/
+		wstring ruleText = ruleF == 0 ? wstring(ruleTitles[0]) + L"\n" + engines[engineF].title : wstring(ruleTitles[ruleF]);
+		ruleText += L"\n" + editTitle(editMode, density, pasteF, pasteRot, pasteFlip);
+		if (rec.active)
+		{
+			ruleText += L"\nзапись: " + to_wstring(rec.written.load()) + L" кадров";
+			if (rec.dropped > 0)
+			{
+				ruleText += L", пропущено " + to_wstring(rec.dropped.load());
+			}
+		}
+		if (tracking && ruleF == 0 && !tiled)
+		{
+			ruleText += L"\nобъектов: " + to_wstring(objs.objects.size()) + L"\nпланеров: " + to_wstring(objs.gliders);
+		}
+		if (searched)
+		{
+			ruleText += L"\nнайдено: " + to_wstring(matches.size());
+		}
+		Text fRule(ruleText, font, 14);
+		fRule.setFillColor(Color(54, 101, 169));
+		fRule.setPosition((float)helpSpritePositionX, (float)helpSpritePositionY + helpSizeY + 15);
 		/**отрисовка водоёма*/
-		waterDraw(window, texture, matrix);
+		PROFILE_BEGIN(drawSpan, "waterDraw");
+		if (tiled)
+		{
+			waterDrawTiled(window, board, big, viewI, viewJ);
+		}
+		else if (ruleF == 0)
+		{
+			waterDraw(window, board, matrix, tracking ? &objs : nullptr);
+		}
+		else
+		{
+			boardDraw(window, board, multi);
+		}
+		PROFILE_END(drawSpan);
+		/**рамки найденных колоний в видимой части; колонии упорядочены по строкам*/
+		int64_t top = tiled ? viewI : 0, left = tiled ? viewJ : 0;
+		auto near = lower_bound(matches.begin(), matches.end(), top - SEARCH_SIDE, [](const searchMatch& m, int64_t i) { return m.i < i; });
+		for (auto m = near; m != matches.end() && m->i < top + (int64_t)MW; ++m)
+		{
+			if (m->i + m->h <= top || m->j + m->w <= left || m->j >= left + (int64_t)MH)
+			{
+				continue;
+			}
+			RectangleShape frame(Vector2f((float)m->w * POINT_SIZE, (float)m->h * POINT_SIZE));
+			frame.setPosition((float)(m->j - left) * POINT_SIZE, (float)(m->i - top) * POINT_SIZE);
+			frame.setFillColor(Color::Transparent);
+			frame.setOutlineThickness(2);
+			frame.setOutlineColor(Color(150, 60, 200));
+			window.draw(frame);
+		}
+		/**протягиваемый прямоугольник*/
+		if (dragging && editMode != EDITMODE_BRUSH)
+		{
+			int64_t ci, cj;
+			cellAt(posMouse.x, posMouse.y, ci, cj);
+			int64_t i0 = min(ci, dragI) - (tiled ? viewI : 0), j0 = min(cj, dragJ) - (tiled ? viewJ : 0);
+			RectangleShape frame(Vector2f((float)(llabs(cj - dragJ) + 1) * POINT_SIZE, (float)(llabs(ci - dragI) + 1) * POINT_SIZE));
+			frame.setPosition((float)j0 * POINT_SIZE, (float)i0 * POINT_SIZE);
+			frame.setFillColor(Color::Transparent);
+			frame.setOutlineThickness(1);
+			frame.setOutlineColor(dragErase ? Color(54, 101, 169) : Color(29, 173, 47));
+			window.draw(frame);
+		}
+		/**наложение с временем кадра, скоростью и временем участков*/
+		frameUpdate(stats, time, framesGens);
+		framesGens = 0;
+		if (overlay)
+		{
+			Text fStats(stats.text, font, 12);
+			fStats.setFillColor(Color(54, 101, 169));
+			fStats.setPosition(8, 6);
+			FloatRect r = fStats.getGlobalBounds();
+			RectangleShape back(Vector2f(r.width + 10, r.height + 10));
+			back.setPosition(3, 3);
+			back.setFillColor(Color(235, 241, 251, 210));
+			window.draw(back);
+			window.draw(fStats);
+		}
 		/**вывод спрайтов кнопок на экран*/
-		window.draw(fName);	window.draw(sClose);
+		window.draw(fName);	window.draw(fRule);
+		window.draw(sClose);
 		window.draw(sFig);  window.draw(sPlus);
 		window.draw(sMinus);window.draw(sClear);
 		window.draw(sHelp);
@@ -1255,15 +2606,28 @@ int main()
 			window.draw(sStart);
 		}
 		/**отрисовка главного окна*/
+		PROFILE_BEGIN(displaySpan, "display");
 		window.display();
+		PROFILE_END(displaySpan);
+	}
+	/**дописываем запись*/
+	if (rec.active)
+	{
+		recordStop(rec);
 	}
+	thumbClose(catalog);
 	/**удаляем матрицы*/
-	for (int i = 0; i < MW; i++)
+	deleteMatrix(matrix, MEM_GRID);
+	deleteMatrix(matrix1, MEM_SECOND);
+	string memNote = "board " + to_string((int)MW) + "x" + to_string((int)MH)
+		+ (tiled ? ", tiled " + to_string(big.h) + "x" + to_string(big.w) : "");
+	if (tiled)
+	{
+		tiledClose(big);
+	}
+	if (!memLog.empty() && !memExport(memLog.c_str(), memNote))
 	{
-		delete matrix[i];
-		delete matrix1[i];
+		printf("cannot write %s\n", memLog.c_str());
 	}
-	delete[] matrix;
-	delete[] matrix1;
 	return 0;
 }
\ No newline at end of file
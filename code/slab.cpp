@@ -0,0 +1,270 @@
+﻿/**
+ *\file slab.cpp
+ *\version 1.0
+ *\date October 2026
+ *\details Участки памяти водоёмов, большие страницы и пул освобождённых участков
+ */
+
+#include "slab.h"
+#include "memtrack.h"
+
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#endif
+
+using namespace std;
+
+/**Участок из кучи*/
+#define SLAB_HEAP 0
+/**Участок, отображённый обычными или прозрачными большими страницами*/
+#define SLAB_MAP 1
+/**Участок из явных больших страниц*/
+#define SLAB_PINNED 2
+
+/**
+ *\struct slabHeader
+ *\details Заголовок участка; занимает первую строку кэша, данные начинаются за ней
+*/
+struct slabHeader
+{
+	/**размер участка вместе с заголовком*/
+	size_t size;
+	/**SLAB_HEAP, SLAB_MAP или SLAB_PINNED*/
+	int kind;
+};
+
+static_assert(sizeof(slabHeader) <= SLAB_ALIGN, "slab header must fit one cache line");
+
+/**
+ *\struct slabState
+ *\details Пул освобождённых участков по размеру и счётчики
+*/
+struct slabState
+{
+	mutex m;
+	unordered_map<size_t, vector<slabHeader*>> pool;
+	slabStats stats = {0, 0, 0, 0, 0};
+	int huge = SLAB_HUGE_THP;
+};
+
+/**
+ *\return пул участков
+ *\details Пул создаётся при первом обращении и не разрушается, поэтому водоёмы в статических
+ * переменных можно освобождать и после завершения main
+*/
+static slabState& slabs()
+{
+	static slabState* s = new slabState;
+	return *s;
+}
+
+/**
+ *\param bytes размер данных
+ *\return размер участка вместе с заголовком: кратный строке кэша, а для больших участков - большой странице
+*/
+static size_t slabSize(size_t bytes)
+{
+	size_t size = (bytes + 2 * SLAB_ALIGN - 1) / SLAB_ALIGN * SLAB_ALIGN;
+	return size >= SLAB_HUGE ? (size + SLAB_HUGE - 1) / SLAB_HUGE * SLAB_HUGE : size;
+}
+
+/**
+ *\param size размер участка
+ *\param huge режим больших страниц
+ *\param kind вид полученного участка
+ *\return участок или nullptr
+*/
+static void* systemAlloc(size_t size, int huge, int& kind)
+{
+	if (size >= SLAB_HUGE)
+	{
+#ifdef _WIN32
+		SIZE_T large = GetLargePageMinimum();
+		if (huge == SLAB_HUGE_EXPLICIT && large != 0 && size % large == 0)
+		{
+			void* p = VirtualAlloc(NULL, size, MEM_RESERVE | MEM_COMMIT | MEM_LARGE_PAGES, PAGE_READWRITE);
+			if (p != NULL)
+			{
+				kind = SLAB_PINNED;
+				return p;
+			}
+		}
+		kind = SLAB_MAP;
+		return VirtualAlloc(NULL, size, MEM_RESERVE | MEM_COMMIT, PAGE_READWRITE);
+#else
+#ifdef MAP_HUGETLB
+		if (huge == SLAB_HUGE_EXPLICIT)
+		{
+			void* p = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+			if (p != MAP_FAILED)
+			{
+				kind = SLAB_PINNED;
+				return p;
+			}
+		}
+#endif
+		/**отображение с запасом, обрезанное до границы большой страницы*/
+		size_t span = size + SLAB_HUGE;
+		void* raw = mmap(NULL, span, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+		if (raw == MAP_FAILED)
+		{
+			return nullptr;
+		}
+		char* p = (char*)(((uintptr_t)raw + SLAB_HUGE - 1) & ~(uintptr_t)(SLAB_HUGE - 1));
+		size_t before = (size_t)(p - (char*)raw), after = span - before - size;
+		if (before > 0)
+		{
+			munmap(raw, before);
+		}
+		if (after > 0)
+		{
+			munmap(p + size, after);
+		}
+#ifdef MADV_HUGEPAGE
+		if (huge != SLAB_HUGE_OFF)
+		{
+			madvise(p, size, MADV_HUGEPAGE);
+		}
+#endif
+		kind = SLAB_MAP;
+		return p;
+#endif
+	}
+	kind = SLAB_HEAP;
+	return operator new(size, align_val_t(SLAB_ALIGN), nothrow);
+}
+
+/**
+ *\param h участок
+*/
+static void systemFree(slabHeader* h)
+{
+	if (h->kind == SLAB_HEAP)
+	{
+		operator delete(h, align_val_t(SLAB_ALIGN));
+		return;
+	}
+#ifdef _WIN32
+	VirtualFree(h, 0, MEM_RELEASE);
+#else
+	munmap(h, h->size);
+#endif
+}
+
+/**
+ *\param bytes размер данных
+ *\return начало данных, выровненное по SLAB_ALIGN, или nullptr
+ *\details Участок того же размера берётся из пула, иначе выделяется у системы.
+ * Содержимое участка не определено.
+*/
+void* slabAlloc(size_t bytes)
+{
+	slabState& s = slabs();
+	size_t size = slabSize(bytes);
+	slabHeader* h = nullptr;
+	int huge = SLAB_HUGE_THP;
+	{
+		lock_guard<mutex> lk(s.m);
+		auto it = s.pool.find(size);
+		if (it != s.pool.end() && !it->second.empty())
+		{
+			h = it->second.back();
+			it->second.pop_back();
+			s.stats.cached -= size;
+			s.stats.reused++;
+			s.stats.used += size;
+			memAdd(MEM_CACHE, -(int64_t)size);
+			return (char*)h + SLAB_ALIGN;
+		}
+		huge = s.huge;
+	}
+	int kind = SLAB_HEAP;
+	h = (slabHeader*)systemAlloc(size, huge, kind);
+	if (h == nullptr)
+	{
+		return nullptr;
+	}
+	h->size = size;
+	h->kind = kind;
+	lock_guard<mutex> lk(s.m);
+	s.stats.allocs++;
+	s.stats.huge += kind != SLAB_HEAP && (kind == SLAB_PINNED || huge != SLAB_HUGE_OFF);
+	s.stats.used += size;
+	return (char*)h + SLAB_ALIGN;
+}
+
+/**
+ *\param p начало данных участка (nullptr - ничего не делать)
+ *\details Участок возвращается в пул, пока объём пула не больше SLAB_CACHE и бюджета кэшей
+*/
+void slabFree(void* p)
+{
+	if (p == nullptr)
+	{
+		return;
+	}
+	slabState& s = slabs();
+	slabHeader* h = (slabHeader*)((char*)p - SLAB_ALIGN);
+	{
+		lock_guard<mutex> lk(s.m);
+		s.stats.used -= h->size;
+		if (s.stats.cached + h->size <= SLAB_CACHE && memFits(MEM_CACHE, h->size))
+		{
+			s.pool[h->size].push_back(h);
+			s.stats.cached += h->size;
+			memAdd(MEM_CACHE, (int64_t)h->size);
+			return;
+		}
+	}
+	systemFree(h);
+}
+
+/**
+ *\param mode SLAB_HUGE_OFF, SLAB_HUGE_THP или SLAB_HUGE_EXPLICIT
+ *\details Режим действует на участки, выделяемые у системы после вызова
+*/
+void slabHugePages(int mode)
+{
+	slabState& s = slabs();
+	lock_guard<mutex> lk(s.m);
+	s.huge = mode;
+}
+
+/**
+ *\details Возврат системе всех участков пула
+*/
+void slabTrim()
+{
+	slabState& s = slabs();
+	vector<slabHeader*> all;
+	{
+		lock_guard<mutex> lk(s.m);
+		for (auto& kv : s.pool)
+		{
+			all.insert(all.end(), kv.second.begin(), kv.second.end());
+		}
+		s.pool.clear();
+		memAdd(MEM_CACHE, -(int64_t)s.stats.cached);
+		s.stats.cached = 0;
+	}
+	for (slabHeader* h : all)
+	{
+		systemFree(h);
+	}
+}
+
+/**
+ *\return счётчики выделения участков
+*/
+slabStats slabInfo()
+{
+	slabState& s = slabs();
+	lock_guard<mutex> lk(s.m);
+	return s.stats;
+}
@@ -0,0 +1,92 @@
+﻿/**
+ *\file slab.h
+ *\version 1.0
+ *\date October 2026
+ *\details Выделение памяти под водоёмы. Водоём получает один непрерывный участок, выровненный
+ * по строке кэша. Участки от SLAB_HUGE байт отображаются по границе большой страницы и
+ * отмечаются для прозрачных больших страниц (или берутся явными большими страницами), что
+ * уменьшает промахи TLB. Освобождённые участки хранятся в пуле по размеру и выдаются снова,
+ * поэтому пересоздание водоёма того же размера не обращается к системе.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <new>
+
+/**Выравнивание участков (строка кэша)*/
+#define SLAB_ALIGN 64
+/**Размер большой страницы; участки от этого размера отображаются большими страницами*/
+#define SLAB_HUGE ((size_t)2 << 20)
+/**Наибольший объём участков, хранимых в пуле*/
+#define SLAB_CACHE ((size_t)256 << 20)
+
+/**Большие страницы не используются*/
+#define SLAB_HUGE_OFF 0
+/**Прозрачные большие страницы (по умолчанию)*/
+#define SLAB_HUGE_THP 1
+/**Явные большие страницы, при их нехватке - прозрачные*/
+#define SLAB_HUGE_EXPLICIT 2
+
+/**
+ *\struct slabStats
+ *\details Счётчики выделения участков
+*/
+struct slabStats
+{
+	/**участков выделено у системы, выдано из пула, отображено большими страницами*/
+	uint64_t allocs, reused, huge;
+	/**байт в выданных участках и в пуле*/
+	size_t used, cached;
+};
+
+void* slabAlloc(size_t bytes);
+void slabFree(void* p);
+void slabHugePages(int mode);
+void slabTrim();
+slabStats slabInfo();
+
+/**
+ *\struct slabAllocator
+ *\details Распределитель для std::vector, берущий память из slabAlloc
+*/
+template <typename T>
+struct slabAllocator
+{
+	typedef T value_type;
+
+	slabAllocator() = default;
+
+	template <typename U>
+	slabAllocator(const slabAllocator<U>&)
+	{
+	}
+
+	T* allocate(size_t n)
+	{
+		void* p = slabAlloc(n * sizeof(T));
+		if (p == nullptr)
+		{
+			throw std::bad_alloc();
+		}
+		return (T*)p;
+	}
+
+	void deallocate(T* p, size_t)
+	{
+		slabFree(p);
+	}
+};
+
+template <typename T, typename U>
+bool operator==(const slabAllocator<T>&, const slabAllocator<U>&)
+{
+	return true;
+}
+
+template <typename T, typename U>
+bool operator!=(const slabAllocator<T>&, const slabAllocator<U>&)
+{
+	return false;
+}
@@ -0,0 +1,399 @@
+﻿/**
+ *\file sparse.cpp
+ *\version 1.0
+ *\date October 2026
+ *\details Разреженный водоём: список живых клеток, шаг слиянием сдвинутых списков, формат Life 1.06
+ */
+
+#include "sparse.h"
+#include "edit.h"
+#include "library.h"
+#include "options.h"
+#include "profile.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+using namespace std;
+
+/**
+ *\param g водоём
+ *\param h количество строк
+ *\param w количество столбцов
+ *\return false, если размеры вне 1..SPARSE_MAX
+*/
+bool sparseInit(sparseGrid& g, int64_t h, int64_t w)
+{
+	if (h < 1 || w < 1 || h > SPARSE_MAX || w > SPARSE_MAX)
+	{
+		return false;
+	}
+	g.h = h;
+	g.w = w;
+	sparseClear(g);
+	return true;
+}
+
+/**
+ *\param g водоём
+ *\details Все клетки становятся мёртвыми, память списков возвращается
+*/
+void sparseClear(sparseGrid& g)
+{
+	vector<uint64_t>().swap(g.cells);
+	vector<uint64_t>().swap(g.next);
+	vector<sparseCount>().swap(g.rowSum);
+	vector<sparseCount>().swap(g.sum);
+}
+
+/**
+ *\param g водоём
+ *\param i строка
+ *\param j столбец
+ *\return жива ли клетка (клетки за границей водоёма мертвы)
+*/
+bool sparseGet(const sparseGrid& g, int64_t i, int64_t j)
+{
+	if (i < 0 || i >= g.h || j < 0 || j >= g.w)
+	{
+		return false;
+	}
+	return binary_search(g.cells.begin(), g.cells.end(), sparseKey(i, j));
+}
+
+/**
+ *\param g    водоём
+ *\param i    строка
+ *\param j    столбец
+ *\param live новое состояние клетки
+ *\details Вставка в середину списка линейна по количеству живых клеток;
+ * много клеток сразу добавляет sparseInsert
+*/
+void sparseSet(sparseGrid& g, int64_t i, int64_t j, bool live)
+{
+	if (i < 0 || i >= g.h || j < 0 || j >= g.w)
+	{
+		return;
+	}
+	uint64_t key = sparseKey(i, j);
+	auto it = lower_bound(g.cells.begin(), g.cells.end(), key);
+	bool found = it != g.cells.end() && *it == key;
+	if (live && !found)
+	{
+		g.cells.insert(it, key);
+	}
+	else if (!live && found)
+	{
+		g.cells.erase(it);
+	}
+}
+
+/**
+ *\param g    водоём
+ *\param keys ключи клеток в любом порядке, ключи за границей водоёма недопустимы; список очищается
+ *\details Клетки становятся живыми за O((n + k) log (n + k))
+*/
+void sparseInsert(sparseGrid& g, vector<uint64_t>& keys)
+{
+	sort(keys.begin(), keys.end());
+	size_t n = g.cells.size();
+	g.cells.insert(g.cells.end(), keys.begin(), keys.end());
+	inplace_merge(g.cells.begin(), g.cells.begin() + n, g.cells.end());
+	g.cells.erase(unique(g.cells.begin(), g.cells.end()), g.cells.end());
+	keys.clear();
+}
+
+/**
+ *\param g водоём
+ *\return количество живых клеток
+*/
+int64_t sparsePopulation(const sparseGrid& g)
+{
+	return (int64_t)g.cells.size();
+}
+
+/**
+ *\param src   клетки с количествами по возрастанию ключей
+ *\param shift номер младшего бита сдвигаемой координаты в ключе (0 - столбец, 32 - строка)
+ *\param limit количество столбцов или строк водоёма
+ *\param out   суммы трёх копий src, сдвинутых по координате на -1, 0 и +1, по возрастанию ключей
+ *\details Копии упорядочены, поэтому слияние трёх курсоров линейно; клетки, ушедшие
+ * за границу водоёма, пропускаются
+*/
+static void mergeShifted(const vector<sparseCount>& src, int shift, int64_t limit, vector<sparseCount>& out)
+{
+	const uint64_t unit = 1ull << shift, none = ~0ull;
+	const size_t n = src.size();
+	out.clear();
+	/**курсоры копий со сдвигом -1 (a), 0 (b) и +1 (c)*/
+	size_t a = 0, b = 0, c = 0;
+	auto coord = [&](size_t k)
+	{
+		return (int64_t)((src[k].key >> shift) & 0xffffffffull);
+	};
+	while (a < n && coord(a) == 0)
+	{
+		a++;
+	}
+	while (c < n && coord(c) + 1 >= limit)
+	{
+		c++;
+	}
+	for (;;)
+	{
+		uint64_t ka = a < n ? src[a].key - unit : none;
+		uint64_t kb = b < n ? src[b].key : none;
+		uint64_t kc = c < n ? src[c].key + unit : none;
+		uint64_t key = min(ka, min(kb, kc));
+		if (key == none)
+		{
+			break;
+		}
+		uint32_t sum = 0;
+		if (ka == key)
+		{
+			sum += src[a].n;
+			for (a++; a < n && coord(a) == 0; a++)
+			{
+			}
+		}
+		if (kb == key)
+		{
+			sum += src[b].n;
+			b++;
+		}
+		if (kc == key)
+		{
+			sum += src[c].n;
+			for (c++; c < n && coord(c) + 1 >= limit; c++)
+			{
+			}
+		}
+		out.push_back({key, sum});
+	}
+}
+
+/**
+ *\param g водоём
+ *\param r правило (Generations с двумя состояниями и радиусом 1, без B0)
+ *\return true, если поколение не изменилось
+ *\details Сначала для каждой клетки рядом с живыми считается сумма живых клеток в трёх соседних
+ * столбцах её строки, затем сумма таких сумм по трём соседним строкам - это количество живых
+ * клеток квадрата 3x3 вместе с самой клеткой. Оба слияния линейны по длине списков, которые
+ * не длиннее 3 и 9 количеств живых клеток. Клетки за границей водоёма мертвы.
+*/
+bool nextGenerationSparse(sparseGrid& g, const rule& r)
+{
+	PROFILE_SCOPE("nextGenerationSparse");
+	g.rowSum.resize(g.cells.size());
+	for (size_t k = 0; k < g.cells.size(); k++)
+	{
+		g.rowSum[k] = {g.cells[k], 1};
+	}
+	mergeShifted(g.rowSum, 0, g.w, g.sum);
+	mergeShifted(g.sum, 32, g.h, g.rowSum);
+	/**каждая живая клетка входит в свою окрестность, поэтому список живых обходится вместе с суммами*/
+	g.next.clear();
+	size_t p = 0;
+	for (const sparseCount& s : g.rowSum)
+	{
+		bool alive = p < g.cells.size() && g.cells[p] == s.key;
+		p += alive;
+		unsigned mask = alive ? r.survive : r.birth;
+		if ((mask >> (s.n - alive)) & 1)
+		{
+			g.next.push_back(s.key);
+		}
+	}
+	bool same = g.next == g.cells;
+	g.cells.swap(g.next);
+	return same;
+}
+
+/**
+ *\param p водоём с битовыми плоскостями
+ *\param g разреженный водоём тех же размеров; живыми становятся клетки с ненулевым состоянием
+*/
+void sparseFromPlanes(const planeGrid& p, sparseGrid& g)
+{
+	sparseInit(g, p.h, p.w);
+	for (int i = 0; i < p.h; i++)
+	{
+		for (int k = 0; k < p.words; k++)
+		{
+			uint64_t v = 0;
+			for (int b = 0; b < p.bits; b++)
+			{
+				v |= p.plane[b][(size_t)i * p.words + k];
+			}
+			while (v != 0)
+			{
+				int bit = lowBit(v);
+				g.cells.push_back(sparseKey(i, (int64_t)k * 64 + bit));
+				v &= v - 1;
+			}
+		}
+	}
+}
+
+/**
+ *\param g разреженный водоём
+ *\param p водоём с одной плоскостью размером с g (g не больше INT_MAX клеток по каждой стороне)
+*/
+void sparseToPlanes(const sparseGrid& g, planeGrid& p)
+{
+	planeInit(p, (int)g.h, (int)g.w, 1);
+	for (uint64_t key : g.cells)
+	{
+		size_t i = (size_t)(key >> 32), j = (size_t)(uint32_t)key;
+		p.plane[0][i * p.words + j / 64] |= 1ull << (j % 64);
+	}
+}
+
+/**
+ *\param g    водоём (размеры должны быть заданы)
+ *\param path файл Life 1.06: строка "#Life 1.06" и строки "x y" с координатами живых клеток
+ *\return false, если файл не открылся или не в формате Life 1.06
+ *\details Начало координат файла помещается в середину водоёма, x - столбец, y - строка;
+ * клетки за границей водоёма пропускаются
+*/
+bool sparseLoad(sparseGrid& g, const string& path)
+{
+	FILE* f = fopen(path.c_str(), "r");
+	if (f == nullptr)
+	{
+		return false;
+	}
+	char line[256];
+	if (fgets(line, sizeof(line), f) == nullptr || strncmp(line, "#Life 1.06", 10) != 0)
+	{
+		fclose(f);
+		return false;
+	}
+	vector<uint64_t> keys;
+	while (fgets(line, sizeof(line), f) != nullptr)
+	{
+		long long x, y;
+		if (line[0] == '#' || sscanf(line, "%lld %lld", &x, &y) != 2)
+		{
+			continue;
+		}
+		int64_t i = g.h / 2 + y, j = g.w / 2 + x;
+		if (i >= 0 && i < g.h && j >= 0 && j < g.w)
+		{
+			keys.push_back(sparseKey(i, j));
+		}
+	}
+	fclose(f);
+	sparseClear(g);
+	sparseInsert(g, keys);
+	return true;
+}
+
+/**
+ *\param g    водоём
+ *\param path файл Life 1.06
+ *\return false, если файл не записался
+*/
+bool sparseSave(const sparseGrid& g, const string& path)
+{
+	FILE* f = fopen(path.c_str(), "w");
+	if (f == nullptr)
+	{
+		return false;
+	}
+	fprintf(f, "#Life 1.06\n");
+	for (uint64_t key : g.cells)
+	{
+		fprintf(f, "%lld %lld\n", (long long)((int64_t)(uint32_t)key - g.w / 2),
+			(long long)((int64_t)(key >> 32) - g.h / 2));
+	}
+	return fclose(f) == 0;
+}
+
+/**
+ *\param argc количество параметров
+ *\param argv параметры ключ=значение
+ *\return код завершения программы
+ *\details Вычисление поколений огромного почти пустого водоёма. Начальная колония читается
+ * из файла Life 1.06 или составляется из ships случайно разбросанных глайдеров и звездолётов.
+*/
+int sparseRun(int argc, char* argv[])
+{
+	int64_t rows = atoll(option(argc, argv, "rows", "1000000000").c_str());
+	int64_t cols = atoll(option(argc, argv, "cols", "1000000000").c_str());
+	long long gens = atoll(option(argc, argv, "gens", "1000").c_str());
+	long long ships = atoll(option(argc, argv, "ships", "10000").c_str());
+	uint64_t seed = strtoull(option(argc, argv, "seed", "1").c_str(), nullptr, 10);
+	string in = option(argc, argv, "in", "");
+	string out = option(argc, argv, "out", "");
+	rule r;
+	if (!parseRule(option(argc, argv, "rule", "B3/S23"), r) || r.family != RULE_GENERATIONS ||
+		r.states != 2 || r.radius != 1 || (r.birth & 1) != 0)
+	{
+		printf("sparse boards need a two-state Moore rule without B0\n");
+		return 1;
+	}
+	sparseGrid g;
+	if (!sparseInit(g, rows, cols))
+	{
+		printf("board sides must be 1..%lld\n", (long long)SPARSE_MAX);
+		return 1;
+	}
+	if (!in.empty())
+	{
+		if (!sparseLoad(g, in))
+		{
+			printf("cannot read Life 1.06 file %s\n", in.c_str());
+			return 1;
+		}
+	}
+	else
+	{
+		vector<uint64_t> keys;
+		uint64_t s = seed * 0x9e3779b97f4a7c15ull + 1;
+		for (long long n = 0; n < ships; n++)
+		{
+			s ^= s << 13;
+			s ^= s >> 7;
+			s ^= s << 17;
+			editCommand c = editPlace(library[s & 1], (int)((s >> 1) & 3), ((s >> 3) & 1) != 0,
+				(int64_t)((s >> 8) % (uint64_t)rows), (int64_t)((s >> 36) % (uint64_t)cols));
+			for (int64_t i = c.i0; i < c.i1 && i < rows; i++)
+			{
+				for (int64_t j = c.j0; j < c.j1 && j < cols; j++)
+				{
+					uint64_t word = c.bits[(size_t)(i - c.i0) * c.words + (size_t)(j - c.j0) / 64];
+					if ((word >> ((j - c.j0) % 64)) & 1)
+					{
+						keys.push_back(sparseKey(i, j));
+					}
+				}
+			}
+		}
+		sparseInsert(g, keys);
+	}
+	int64_t start = sparsePopulation(g);
+	auto t0 = chrono::steady_clock::now();
+	long long gen = 0;
+	while (gen < gens && !nextGenerationSparse(g, r))
+	{
+		gen++;
+	}
+	double sec = chrono::duration<double>(chrono::steady_clock::now() - t0).count();
+	size_t bytes = (g.cells.capacity() + g.next.capacity()) * sizeof(uint64_t) +
+		(g.rowSum.capacity() + g.sum.capacity()) * sizeof(sparseCount);
+	printf("%lldx%lld %s: %lld gens%s, population %lld -> %lld, %.3f s, %.1f ns/cell, %.1f MB\n",
+		(long long)rows, (long long)cols, r.name.c_str(), gen, gen < gens ? " (still life)" : "",
+		(long long)start, (long long)sparsePopulation(g), sec,
+		sec * 1e9 / max(1.0, (double)start * (double)max(gen, 1ll)), bytes / 1048576.0);
+	if (!out.empty() && !sparseSave(g, out))
+	{
+		printf("cannot write %s\n", out.c_str());
+		return 1;
+	}
+	return 0;
+}
@@ -0,0 +1,69 @@
+﻿/**
+ *\file sparse.h
+ *\version 1.0
+ *\date October 2026
+ *\details Разреженный водоём для огромных почти пустых полей. Живые клетки хранятся
+ * упорядоченным списком координат, как в формате Life 1.06. Следующее поколение строится
+ * слиянием сдвинутых копий списка: сначала суммы по трём соседним столбцам, затем по трём
+ * соседним строкам. Память и время шага зависят только от количества живых клеток.
+ * Поддерживаются правила с двумя состояниями и окрестностью Мура (без B0).
+ */
+
+#pragma once
+
+#include "rules.h"
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/**Наибольшая сторона разреженного водоёма*/
+#define SPARSE_MAX ((int64_t)1 << 31)
+
+/**
+ *\struct sparseCount
+ *\details Клетка и количество живых клеток, приходящихся на неё при слиянии
+*/
+struct sparseCount
+{
+	uint64_t key;
+	uint32_t n;
+};
+
+/**
+ *\struct sparseGrid
+ *\details Разреженный водоём
+*/
+struct sparseGrid
+{
+	/**количество строк и столбцов (не больше SPARSE_MAX)*/
+	int64_t h, w;
+	/**живые клетки: ключи (строка << 32) | столбец по возрастанию*/
+	std::vector<uint64_t> cells;
+	/**буферы шага: следующее поколение, суммы по столбцам и по окрестности*/
+	std::vector<uint64_t> next;
+	std::vector<sparseCount> rowSum, sum;
+};
+
+/**
+ *\param i строка
+ *\param j столбец
+ *\return ключ клетки в списке
+*/
+inline uint64_t sparseKey(int64_t i, int64_t j)
+{
+	return ((uint64_t)i << 32) | (uint32_t)j;
+}
+
+bool sparseInit(sparseGrid& g, int64_t h, int64_t w);
+void sparseClear(sparseGrid& g);
+bool sparseGet(const sparseGrid& g, int64_t i, int64_t j);
+void sparseSet(sparseGrid& g, int64_t i, int64_t j, bool live);
+void sparseInsert(sparseGrid& g, std::vector<uint64_t>& keys);
+int64_t sparsePopulation(const sparseGrid& g);
+bool nextGenerationSparse(sparseGrid& g, const rule& r);
+void sparseFromPlanes(const planeGrid& p, sparseGrid& g);
+void sparseToPlanes(const sparseGrid& g, planeGrid& p);
+bool sparseLoad(sparseGrid& g, const std::string& path);
+bool sparseSave(const sparseGrid& g, const std::string& path);
+int sparseRun(int argc, char* argv[]);
@@ -0,0 +1,567 @@
+﻿/**
+ *\file thumbs.cpp
+ *\version 1.0
+ *\date October 2026
+ *\details Каталог колоний, чтение RLE и .cells, рисование миниатюр и файл кэша миниатюр
+ */
+
+#include "thumbs.h"
+#include "edit.h"
+#include "library.h"
+#include "memtrack.h"
+
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+#include <cstring>
+#include <filesystem>
+
+#ifdef _WIN32
+#define fseeko _fseeki64
+#define ftello _ftelli64
+#endif
+
+using namespace std;
+
+/**Начало файла кэша; за ним сторона миниатюры (4 байта), затем записи: хеш (8 байт) и точки*/
+static const char thumbMagic[8] = {'L', 'I', 'F', 'E', 'T', 'H', 'M', 'B'};
+
+/**
+ *\param e     колония
+ *\param cells живые клетки (строка, столбец), отсчёт от 0
+ *\param h, w  размеры колонии
+ *\details Запись клеток в строки колонии и подсчёт хеша
+*/
+static void setCells(thumbEntry& e, const vector<pair<int, int>>& cells, int h, int w)
+{
+	e.h = max(1, h);
+	e.w = max(1, w);
+	e.words = (e.w + 63) / 64;
+	e.bits.assign((size_t)e.h * e.words, 0);
+	for (const auto& x : cells)
+	{
+		e.bits[(size_t)x.first * e.words + x.second / 64] |= 1ull << (x.second % 64);
+	}
+	uint64_t hash = 0x9e3779b97f4a7c15ull ^ ((uint64_t)e.h << 32 | (uint32_t)e.w);
+	for (uint64_t word : e.bits)
+	{
+		hash = (hash ^ word) * 0xff51afd7ed558ccdull;
+		hash ^= hash >> 29;
+	}
+	e.hash = hash;
+	e.loaded = true;
+}
+
+/**
+ *\param text содержимое файла колонии: RLE (строка заголовка "x = ...") или .cells ('O' - бактерия, '.' - вода,
+ * строки с '!' - комментарии)
+ *\param e    колония; заполняются клетки, размеры и хеш
+ *\return false, если запись не разобрана или колония больше THUMB_CELLS клеток по стороне
+ *\details В RLE все состояния, кроме воды, считаются живыми клетками
+*/
+bool thumbParse(const string& text, thumbEntry& e)
+{
+	vector<pair<int, int>> cells;
+	int h = 0, w = 0;
+	bool rle = false;
+	for (size_t pos = 0; pos < text.size() && !rle;)
+	{
+		size_t end = text.find('\n', pos);
+		end = end == string::npos ? text.size() : end;
+		size_t k = pos;
+		while (k < end && isspace((unsigned char)text[k]))
+		{
+			k++;
+		}
+		rle = k < end && text[k] == 'x' && text.find('=', k) < end;
+		pos = end + 1;
+	}
+	if (rle)
+	{
+		int i = 0, j = 0, count = 0;
+		bool lineStart = true;
+		for (size_t p = 0; p < text.size() && text[p] != '!'; p++)
+		{
+			char ch = text[p];
+			/**строки комментариев и заголовка пропускаются целиком*/
+			if (lineStart && (ch == '#' || ch == 'x'))
+			{
+				p = text.find('\n', p);
+				if (p == string::npos)
+				{
+					break;
+				}
+				continue;
+			}
+			lineStart = ch == '\n';
+			if (isspace((unsigned char)ch))
+			{
+				continue;
+			}
+			if (isdigit((unsigned char)ch))
+			{
+				count = min(count * 10 + (ch - '0'), THUMB_CELLS + 1);
+				continue;
+			}
+			int n = count == 0 ? 1 : count;
+			count = 0;
+			if (ch == '$')
+			{
+				i += n;
+				j = 0;
+			}
+			else if (ch == 'b' || ch == '.')
+			{
+				j += n;
+			}
+			else if (ch == 'o' || (ch >= 'A' && ch <= 'X'))
+			{
+				if (j + n > THUMB_CELLS || i >= THUMB_CELLS)
+				{
+					return false;
+				}
+				for (int k = 0; k < n; k++, j++)
+				{
+					cells.push_back({i, j});
+				}
+				h = max(h, i + 1);
+				w = max(w, j);
+			}
+			else
+			{
+				return false;
+			}
+			if (i >= THUMB_CELLS || j > THUMB_CELLS)
+			{
+				return false;
+			}
+		}
+	}
+	else
+	{
+		int i = 0;
+		for (size_t pos = 0; pos < text.size(); i++)
+		{
+			size_t end = text.find('\n', pos);
+			end = end == string::npos ? text.size() : end;
+			if (text[pos] == '!')
+			{
+				i--;
+				pos = end + 1;
+				continue;
+			}
+			for (size_t k = pos; k < end; k++)
+			{
+				char ch = text[k];
+				int j = (int)(k - pos);
+				if (ch == 'O' || ch == '*')
+				{
+					if (i >= THUMB_CELLS || j >= THUMB_CELLS)
+					{
+						return false;
+					}
+					cells.push_back({i, j});
+					h = max(h, i + 1);
+					w = max(w, j + 1);
+				}
+				else if (ch != '.' && !isspace((unsigned char)ch))
+				{
+					return false;
+				}
+			}
+			pos = end + 1;
+		}
+	}
+	setCells(e, cells, h, w);
+	return true;
+}
+
+/**
+ *\param e      колония с прочитанными клетками
+ *\param pixels THUMB_SIZE x THUMB_SIZE точек по строкам: доля живых клеток под точкой (0..255)
+ *\details Колония вписывается в квадрат миниатюры с полем в одну клетку и выводится по центру.
+ * Крупные клетки сглаживаются по 16 точкам внутри точки миниатюры, а у колоний больше миниатюры
+ * считаются все клетки под точкой; доля берётся под корнем, чтобы редкие клетки оставались видны.
+*/
+void thumbRender(const thumbEntry& e, uint8_t* pixels)
+{
+	double scale = (double)THUMB_SIZE / (max(e.h, e.w) + 2);
+	double ox = (THUMB_SIZE - e.w * scale) / 2, oy = (THUMB_SIZE - e.h * scale) / 2;
+	auto live = [&](int i, int j)
+	{
+		return i >= 0 && j >= 0 && i < e.h && j < e.w && ((e.bits[(size_t)i * e.words + j / 64] >> (j % 64)) & 1) != 0;
+	};
+	for (int y = 0; y < THUMB_SIZE; y++)
+	{
+		for (int x = 0; x < THUMB_SIZE; x++)
+		{
+			double frac;
+			if (scale >= 1)
+			{
+				int hits = 0;
+				for (int a = 0; a < 4; a++)
+				{
+					for (int b = 0; b < 4; b++)
+					{
+						hits += live((int)floor((y + (a + 0.5) / 4 - oy) / scale), (int)floor((x + (b + 0.5) / 4 - ox) / scale));
+					}
+				}
+				frac = hits / 16.0;
+			}
+			else
+			{
+				int i0 = (int)floor((y - oy) / scale), i1 = (int)ceil((y + 1 - oy) / scale);
+				int j0 = (int)floor((x - ox) / scale), j1 = (int)ceil((x + 1 - ox) / scale);
+				int hits = 0;
+				for (int i = max(i0, 0); i < min(i1, e.h); i++)
+				{
+					for (int j = max(j0, 0); j < min(j1, e.w); j++)
+					{
+						hits += live(i, j);
+					}
+				}
+				frac = (double)hits / max(1, (i1 - i0) * (j1 - j0));
+			}
+			pixels[(size_t)y * THUMB_SIZE + x] = (uint8_t)lround(sqrt(frac) * 255);
+		}
+	}
+}
+
+/**
+ *\param path файл колонии
+ *\param e    колония
+ *\return false, если файл не читается или не разобран
+ *\details Чтение клеток колонии из файла; при ошибке колония помечается failed
+*/
+bool thumbLoad(const string& path, thumbEntry& e)
+{
+	string text;
+	FILE* f = fopen(path.c_str(), "rb");
+	if (f != nullptr)
+	{
+		char buf[65536];
+		size_t n;
+		while ((n = fread(buf, 1, sizeof(buf), f)) > 0)
+		{
+			text.append(buf, n);
+		}
+		fclose(f);
+	}
+	e.failed = f == nullptr || !thumbParse(text, e);
+	if (e.failed)
+	{
+		setCells(e, {}, 1, 1);
+	}
+	e.loaded = true;
+	return !e.failed;
+}
+
+/**
+ *\param c каталог
+ *\details Открытие файла кэша и чтение хешей записей. Файл с другой стороной миниатюры или
+ * испорченным началом создаётся заново; неполная последняя запись перезаписывается.
+*/
+static void cacheIndex(thumbCatalog& c)
+{
+	const int64_t record = 8 + THUMB_SIZE * THUMB_SIZE;
+	c.cache = fopen(c.cachePath.c_str(), "r+b");
+	char magic[8];
+	int32_t size = 0;
+	bool valid = c.cache != nullptr && fread(magic, 1, 8, c.cache) == 8 && memcmp(magic, thumbMagic, 8) == 0
+		&& fread(&size, 4, 1, c.cache) == 1 && size == THUMB_SIZE;
+	if (!valid)
+	{
+		if (c.cache != nullptr)
+		{
+			fclose(c.cache);
+		}
+		c.cache = fopen(c.cachePath.c_str(), "w+b");
+		if (c.cache == nullptr)
+		{
+			return;
+		}
+		size = THUMB_SIZE;
+		fwrite(thumbMagic, 1, 8, c.cache);
+		fwrite(&size, 4, 1, c.cache);
+		fflush(c.cache);
+	}
+	int64_t pos = 12;
+	fseeko(c.cache, 0, SEEK_END);
+	int64_t end = ftello(c.cache);
+	uint64_t hash;
+	unordered_map<uint64_t, int64_t> offsets;
+	while (pos + record <= end && fseeko(c.cache, pos, SEEK_SET) == 0 && fread(&hash, 8, 1, c.cache) == 1)
+	{
+		offsets[hash] = pos + 8;
+		pos += record;
+	}
+	lock_guard<mutex> g(c.lock);
+	c.offsets = move(offsets);
+	c.cacheEnd = pos;
+}
+
+/**
+ *\param c каталог
+ *\details Файлы колоний папки в порядке имён добавляются в каталог после колоний библиотеки
+*/
+static void scanDir(thumbCatalog& c)
+{
+	namespace fs = std::filesystem;
+	vector<fs::path> files;
+	error_code err;
+	for (fs::directory_iterator it(c.dir, err), end; !err && it != end; it.increment(err))
+	{
+		string ext = it->path().extension().string();
+		transform(ext.begin(), ext.end(), ext.begin(), [](char ch) { return (char)tolower((unsigned char)ch); });
+		if (ext == ".rle" || ext == ".cells")
+		{
+			files.push_back(it->path());
+		}
+	}
+	sort(files.begin(), files.end());
+	vector<thumbEntry> found(files.size());
+	for (size_t k = 0; k < files.size(); k++)
+	{
+		found[k].name = files[k].stem().wstring();
+		found[k].path = files[k].string();
+		found[k].library = -1;
+	}
+	lock_guard<mutex> g(c.lock);
+	c.entries.insert(c.entries.end(), make_move_iterator(found.begin()), make_move_iterator(found.end()));
+	c.scanned = true;
+}
+
+/**
+ *\param c каталог (вызывается под блокировкой)
+ *\return первая видимая колония без готовой миниатюры (-1 - все готовы)
+*/
+static int nextWanted(thumbCatalog& c)
+{
+	for (int k = max(0, c.first); k < min(c.first + c.count, (int)c.entries.size()); k++)
+	{
+		if (c.ready.count(k) == 0)
+		{
+			return k;
+		}
+	}
+	return -1;
+}
+
+/**
+ *\param c каталог (вызывается под блокировкой)
+ *\details Пока миниатюр в памяти больше THUMB_KEEP, освобождается давнее всех использованная
+ * из невидимых; память миниатюр учитывается как кэш
+*/
+static void evict(thumbCatalog& c)
+{
+	while (c.ready.size() > THUMB_KEEP)
+	{
+		int oldest = -1;
+		for (const auto& r : c.ready)
+		{
+			bool visible = r.first >= c.first && r.first < c.first + c.count;
+			if (!visible && (oldest < 0 || c.used[r.first] < c.used[oldest]))
+			{
+				oldest = r.first;
+			}
+		}
+		if (oldest < 0)
+		{
+			break;
+		}
+		c.ready.erase(oldest);
+		c.used.erase(oldest);
+	}
+	memAccount(MEM_CACHE, c.bytes, (uint64_t)c.ready.size() * THUMB_SIZE * THUMB_SIZE);
+}
+
+/**
+ *\param c каталог
+ *\details Поток миниатюр: читает кэш, просматривает папку, затем готовит миниатюры видимых
+ * колоний - из файла кэша по хешу клеток или рисует и дописывает в кэш
+*/
+static void thumbWork(thumbCatalog* c)
+{
+	cacheIndex(*c);
+	scanDir(*c);
+	vector<uint8_t> pixels((size_t)THUMB_SIZE * THUMB_SIZE);
+	unique_lock<mutex> g(c->lock);
+	while (true)
+	{
+		c->wake.wait(g, [&] { return c->stop || nextWanted(*c) >= 0; });
+		if (c->stop)
+		{
+			return;
+		}
+		int k = nextWanted(*c);
+		thumbEntry e = c->entries[k];
+		g.unlock();
+		if (!e.loaded)
+		{
+			thumbLoad(e.path, e);
+		}
+		/**хеши в кэш дописывает только этот поток, поэтому место записи можно искать без блокировки*/
+		auto found = c->offsets.find(e.hash);
+		bool read = !e.failed && c->cache != nullptr && found != c->offsets.end()
+			&& fseeko(c->cache, found->second, SEEK_SET) == 0 && fread(pixels.data(), 1, pixels.size(), c->cache) == pixels.size();
+		if (!read)
+		{
+			thumbRender(e, pixels.data());
+		}
+		int64_t at = -1;
+		if (!read && !e.failed && c->cache != nullptr && fseeko(c->cache, c->cacheEnd, SEEK_SET) == 0
+			&& fwrite(&e.hash, 8, 1, c->cache) == 1 && fwrite(pixels.data(), 1, pixels.size(), c->cache) == pixels.size())
+		{
+			fflush(c->cache);
+			at = c->cacheEnd + 8;
+		}
+		g.lock();
+		if (at >= 0)
+		{
+			c->offsets[e.hash] = at;
+			c->cacheEnd = at + (int64_t)pixels.size();
+		}
+		(read ? c->cached : c->built)++;
+		c->entries[k] = move(e);
+		c->ready[k] = pixels;
+		c->used[k] = ++c->tick;
+		evict(*c);
+	}
+}
+
+/**
+ *\param c         каталог
+ *\param dir       папка файлов колоний (RLE и .cells)
+ *\param cachePath файл кэша миниатюр
+ *\details Колонии библиотеки попадают в каталог сразу, а папка просматривается в потоке миниатюр
+*/
+void thumbOpen(thumbCatalog& c, const string& dir, const string& cachePath)
+{
+	c.dir = dir;
+	c.cachePath = cachePath;
+	for (int k = 0; k < LIBRARY_SIZE; k++)
+	{
+		editCommand p = editPlace(library[k], 0, false, 0, 0);
+		thumbEntry e;
+		e.name = library[k].name;
+		e.library = k;
+		vector<pair<int, int>> cells;
+		for (int i = 0; i < (int)p.i1; i++)
+		{
+			for (int j = 0; j < (int)p.j1; j++)
+			{
+				if ((p.bits[(size_t)i * p.words + j / 64] >> (j % 64)) & 1)
+				{
+					cells.push_back({i, j});
+				}
+			}
+		}
+		setCells(e, cells, (int)p.i1, (int)p.j1);
+		c.entries.push_back(move(e));
+	}
+	c.worker = thread(thumbWork, &c);
+}
+
+/**
+ *\param c каталог
+ *\details Остановка потока миниатюр, закрытие файла кэша и освобождение миниатюр
+*/
+void thumbClose(thumbCatalog& c)
+{
+	{
+		lock_guard<mutex> g(c.lock);
+		c.stop = true;
+	}
+	c.wake.notify_all();
+	if (c.worker.joinable())
+	{
+		c.worker.join();
+	}
+	if (c.cache != nullptr)
+	{
+		fclose(c.cache);
+		c.cache = nullptr;
+	}
+	c.ready.clear();
+	c.used.clear();
+	memAccount(MEM_CACHE, c.bytes, 0);
+}
+
+/**
+ *\param c каталог
+ *\return количество колоний (растёт, пока папка просматривается)
+*/
+int thumbCount(thumbCatalog& c)
+{
+	lock_guard<mutex> g(c.lock);
+	return (int)c.entries.size();
+}
+
+/**
+ *\param c     каталог
+ *\param index номер колонии
+ *\return название колонии
+*/
+wstring thumbName(thumbCatalog& c, int index)
+{
+	lock_guard<mutex> g(c.lock);
+	return index >= 0 && index < (int)c.entries.size() ? c.entries[index].name : wstring();
+}
+
+/**
+ *\param c     каталог
+ *\param first первая видимая колония
+ *\param count количество видимых колоний (вместе с колониями следующей страницы, которые стоит подготовить заранее)
+ *\details Поток миниатюр переключается на эти колонии; прежние просьбы отменяются
+*/
+void thumbWant(thumbCatalog& c, int first, int count)
+{
+	{
+		lock_guard<mutex> g(c.lock);
+		c.first = first;
+		c.count = count;
+	}
+	c.wake.notify_all();
+}
+
+/**
+ *\param c      каталог
+ *\param index  номер колонии
+ *\param pixels миниатюра (THUMB_SIZE x THUMB_SIZE долей живых клеток)
+ *\return false, если миниатюра ещё не готова
+*/
+bool thumbTake(thumbCatalog& c, int index, vector<uint8_t>& pixels)
+{
+	lock_guard<mutex> g(c.lock);
+	auto r = c.ready.find(index);
+	if (r == c.ready.end())
+	{
+		return false;
+	}
+	pixels = r->second;
+	c.used[index] = ++c.tick;
+	return true;
+}
+
+/**
+ *\param c     каталог
+ *\param index номер колонии
+ *\param e     колония с клетками; файл, ещё не прочитанный потоком миниатюр, читается сразу
+ *\return false, если колонии нет или файл не читается
+*/
+bool thumbCells(thumbCatalog& c, int index, thumbEntry& e)
+{
+	{
+		lock_guard<mutex> g(c.lock);
+		if (index < 0 || index >= (int)c.entries.size())
+		{
+			return false;
+		}
+		e = c.entries[index];
+	}
+	if (!e.loaded)
+	{
+		thumbLoad(e.path, e);
+	}
+	return !e.failed;
+}
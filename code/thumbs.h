@@ -0,0 +1,91 @@
+﻿/**
+ *\file thumbs.h
+ *\version 1.0
+ *\date October 2026
+ *\details Каталог колоний окна "фигуры" и их миниатюры. В каталог входят колонии библиотеки
+ * и файлы RLE и .cells из папки колоний. Миниатюра рисуется по клеткам колонии: точка
+ * миниатюры - доля живых клеток под ней (0..255), цвета подставляет окно. Миниатюры
+ * хранятся в файле кэша по хешу клеток колонии и строятся заново только для новых или
+ * изменённых колоний. Папка просматривается, файлы читаются, а миниатюры строятся и
+ * читаются из кэша в своём потоке, поэтому окно открывается сразу при любом размере
+ * каталога и просит миниатюры только видимых колоний.
+ */
+
+#pragma once
+
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+/**Сторона миниатюры в точках*/
+#define THUMB_SIZE 128
+/**Наибольшее количество миниатюр в памяти; остальные читаются из файла кэша*/
+#define THUMB_KEEP 512
+/**Наибольшая сторона колонии из файла в клетках*/
+#define THUMB_CELLS 4096
+
+/**
+ *\struct thumbEntry
+ *\details Колония каталога
+*/
+struct thumbEntry
+{
+	/**название колонии (для файла - имя без расширения)*/
+	std::wstring name;
+	/**файл колонии (пусто - колония библиотеки с номером library)*/
+	std::string path;
+	int library = -1;
+	/**клетки прочитаны (или файл не читается - тогда failed)*/
+	bool loaded = false, failed = false;
+	/**размеры колонии и её строки по words слов*/
+	int h = 0, w = 0, words = 0;
+	std::vector<uint64_t> bits;
+	/**хеш клеток колонии - ключ миниатюры в файле кэша*/
+	uint64_t hash = 0;
+};
+
+/**
+ *\struct thumbCatalog
+ *\details Каталог колоний, миниатюры и поток, который их готовит
+*/
+struct thumbCatalog
+{
+	std::vector<thumbEntry> entries;
+	/**готовые миниатюры по номеру колонии и порядок их использования*/
+	std::unordered_map<int, std::vector<uint8_t>> ready;
+	std::unordered_map<int, uint64_t> used;
+	uint64_t tick = 0;
+	/**видимые колонии first..first+count-1; поток готовит их миниатюры по порядку*/
+	int first = 0, count = 0;
+	/**место миниатюры в файле кэша по хешу колонии*/
+	std::unordered_map<uint64_t, int64_t> offsets;
+	std::string cachePath, dir;
+	FILE* cache = nullptr;
+	/**конец последней целой записи файла кэша*/
+	int64_t cacheEnd = 0;
+	/**миниатюр построено и прочитано из кэша*/
+	uint64_t built = 0, cached = 0;
+	/**папка просмотрена*/
+	bool scanned = false, stop = false;
+	/**память готовых миниатюр, учтённая как кэш (MEM_CACHE)*/
+	uint64_t bytes = 0;
+	std::mutex lock;
+	std::condition_variable wake;
+	std::thread worker;
+};
+
+void thumbOpen(thumbCatalog& c, const std::string& dir, const std::string& cachePath);
+void thumbClose(thumbCatalog& c);
+int thumbCount(thumbCatalog& c);
+std::wstring thumbName(thumbCatalog& c, int index);
+void thumbWant(thumbCatalog& c, int first, int count);
+bool thumbTake(thumbCatalog& c, int index, std::vector<uint8_t>& pixels);
+bool thumbCells(thumbCatalog& c, int index, thumbEntry& e);
+bool thumbParse(const std::string& text, thumbEntry& e);
+bool thumbLoad(const std::string& path, thumbEntry& e);
+void thumbRender(const thumbEntry& e, uint8_t* pixels);
@@ -0,0 +1,500 @@
+﻿/**
+ *\file tiled.cpp
+ *\version 1.0
+ *\date October 2026
+ *\details Водоём из плиток в отображённом в память файле. Поколение вычисляется
+ * потоковым проходом по строкам плиток: каждая плитка читается и записывается один раз,
+ * а от соседних плиток берутся только граничные строки и столбцы.
+ */
+
+#include "tiled.h"
+#include "memtrack.h"
+#include "profile.h"
+#include "random.h"
+#include "rules.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+
+#ifdef _WIN32
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+using namespace std;
+
+/**Размер заголовка файла (одна страница)*/
+#define TILED_HEADER 4096
+/**Количество слов в одной плитке*/
+#define TILE_CELLS_WORDS ((uint64_t)TILE_SIZE * TILE_WORDS)
+/**Строк плиток, нужных вычислению одновременно: соседние строки выше и ниже, текущая строка
+ * и строка результата*/
+#define TILED_WINDOW_ROWS 4
+
+/**
+ *\struct tiledHeader
+ *\details Заголовок файла водоёма
+*/
+struct tiledHeader
+{
+	/**признак формата "LIFETILE"*/
+	char magic[8];
+	/**количество строк и столбцов водоёма*/
+	int64_t h, w;
+	/**размер плитки*/
+	int32_t tile;
+	/**номер текущего поколения*/
+	int32_t cur;
+};
+
+/**
+ *\param g   водоём
+ *\param gen номер поколения в файле
+ *\param ty  строка плиток
+ *\param tx  столбец плиток
+ *\return начало плитки или nullptr, если плитка за границей водоёма
+*/
+static uint64_t* tilePtr(const tiledGrid& g, int gen, int64_t ty, int64_t tx)
+{
+	if (ty < 0 || tx < 0 || ty >= g.tilesY || tx >= g.tilesX)
+	{
+		return nullptr;
+	}
+	return g.gen[gen] + (uint64_t)(ty * g.tilesX + tx) * TILE_CELLS_WORDS;
+}
+
+/**
+ *\param g  водоём
+ *\param tx столбец плиток
+ *\param k  слово строки плитки
+ *\return маска существующих столбцов слова
+*/
+static uint64_t colMask(const tiledGrid& g, int64_t tx, int k)
+{
+	int64_t first = tx * TILE_SIZE + (int64_t)k * 64;
+	if (first + 64 <= g.w)
+	{
+		return ~0ull;
+	}
+	if (first >= g.w)
+	{
+		return 0;
+	}
+	return (1ull << (g.w - first)) - 1;
+}
+
+/**
+ *\param addr начало области
+ *\param len  длина области в байтах
+ *\details Подсказка системе заранее прочитать область файла с диска.
+*/
+static void prefetch(void* addr, uint64_t len)
+{
+#ifdef _WIN32
+	WIN32_MEMORY_RANGE_ENTRY range;
+	range.VirtualAddress = addr;
+	range.NumberOfBytes = (SIZE_T)len;
+	PrefetchVirtualMemory(GetCurrentProcess(), 1, &range, 0);
+#else
+	/**адрес должен быть выровнен на страницу*/
+	uintptr_t a = (uintptr_t)addr & ~(uintptr_t)4095;
+	madvise((void*)a, (size_t)(len + ((uintptr_t)addr - a)), MADV_WILLNEED);
+#endif
+}
+
+/**
+ *\param g    водоём
+ *\param path путь к файлу
+ *\param h    количество строк (0 - взять из существующего файла)
+ *\param w    количество столбцов (0 - взять из существующего файла)
+ *\return true, если файл открыт или создан
+ *\details Открытие файла водоёма. Новый файл создаётся пустым (все клетки - вода),
+ * размеры существующего файла должны совпадать с заданными. Файл отображается целиком, но
+ * в памяти одновременно нужны только TILED_WINDOW_ROWS строк плиток, поэтому как память
+ * водоёма (MEM_GRID) учитывается это окно; водоём, окно которого не укладывается в бюджет,
+ * не открывается.
+*/
+bool tiledOpen(tiledGrid& g, const char* path, int64_t h, int64_t w)
+{
+	memset(&g, 0, sizeof(g));
+	uint64_t existing = 0;
+#ifdef _WIN32
+	HANDLE f = CreateFileA(path, GENERIC_READ | GENERIC_WRITE, 0, NULL, OPEN_ALWAYS, FILE_ATTRIBUTE_NORMAL, NULL);
+	if (f == INVALID_HANDLE_VALUE)
+	{
+		return false;
+	}
+	LARGE_INTEGER fs;
+	GetFileSizeEx(f, &fs);
+	existing = (uint64_t)fs.QuadPart;
+	g.file = (intptr_t)f;
+#else
+	int fd = open(path, O_RDWR | O_CREAT, 0644);
+	if (fd < 0)
+	{
+		return false;
+	}
+	struct stat st;
+	fstat(fd, &st);
+	existing = (uint64_t)st.st_size;
+	g.file = fd;
+#endif
+	tiledHeader hdr;
+	memset(&hdr, 0, sizeof(hdr));
+	if (existing >= sizeof(hdr))
+	{
+#ifdef _WIN32
+		DWORD got = 0;
+		ReadFile(f, &hdr, sizeof(hdr), &got, NULL);
+#else
+		if (pread(fd, &hdr, sizeof(hdr), 0) != (ssize_t)sizeof(hdr))
+		{
+			hdr.magic[0] = 0;
+		}
+#endif
+		if (memcmp(hdr.magic, "LIFETILE", 8) != 0 || hdr.tile != TILE_SIZE
+			|| (h > 0 && hdr.h != h) || (w > 0 && hdr.w != w))
+		{
+			tiledClose(g);
+			return false;
+		}
+		h = hdr.h;
+		w = hdr.w;
+	}
+	else if (h <= 0 || w <= 0)
+	{
+		tiledClose(g);
+		return false;
+	}
+	g.h = h;
+	g.w = w;
+	g.tilesY = (h + TILE_SIZE - 1) / TILE_SIZE;
+	g.tilesX = (w + TILE_SIZE - 1) / TILE_SIZE;
+	uint64_t genBytes = (uint64_t)(g.tilesY * g.tilesX) * TILE_CELLS_WORDS * sizeof(uint64_t);
+	g.size = TILED_HEADER + 2 * genBytes;
+	g.resident = min<uint64_t>(2 * genBytes, TILED_WINDOW_ROWS * (uint64_t)g.tilesX * TILE_CELLS_WORDS * sizeof(uint64_t));
+	if (!memFits(MEM_GRID, g.resident))
+	{
+		tiledClose(g);
+		return false;
+	}
+#ifdef _WIN32
+	HANDLE m = CreateFileMappingA(f, NULL, PAGE_READWRITE, (DWORD)(g.size >> 32), (DWORD)g.size, NULL);
+	if (m == NULL)
+	{
+		tiledClose(g);
+		return false;
+	}
+	g.mapping = (intptr_t)m;
+	g.base = (unsigned char*)MapViewOfFile(m, FILE_MAP_ALL_ACCESS, 0, 0, 0);
+#else
+	if (existing < g.size && ftruncate(fd, (off_t)g.size) != 0)
+	{
+		tiledClose(g);
+		return false;
+	}
+	void* p = mmap(NULL, (size_t)g.size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+	g.base = p == MAP_FAILED ? nullptr : (unsigned char*)p;
+#endif
+	if (g.base == nullptr)
+	{
+		tiledClose(g);
+		return false;
+	}
+	if (existing < sizeof(hdr))
+	{
+		memcpy(hdr.magic, "LIFETILE", 8);
+		hdr.h = h;
+		hdr.w = w;
+		hdr.tile = TILE_SIZE;
+		hdr.cur = 0;
+		memcpy(g.base, &hdr, sizeof(hdr));
+	}
+	memAdd(MEM_GRID, (int64_t)g.resident);
+	g.cur = hdr.cur & 1;
+	g.gen[0] = (uint64_t*)(g.base + TILED_HEADER);
+	g.gen[1] = (uint64_t*)(g.base + TILED_HEADER + genBytes);
+	return true;
+}
+
+/**
+ *\param g водоём
+ *\details Закрытие отображения и файла водоёма
+*/
+void tiledClose(tiledGrid& g)
+{
+	if (g.base)
+	{
+		memAdd(MEM_GRID, -(int64_t)g.resident);
+	}
+#ifdef _WIN32
+	if (g.base)
+	{
+		UnmapViewOfFile(g.base);
+	}
+	if (g.mapping)
+	{
+		CloseHandle((HANDLE)g.mapping);
+	}
+	if (g.file)
+	{
+		CloseHandle((HANDLE)g.file);
+	}
+#else
+	if (g.base)
+	{
+		munmap(g.base, (size_t)g.size);
+	}
+	if (g.file > 0)
+	{
+		close((int)g.file);
+	}
+#endif
+	memset(&g, 0, sizeof(g));
+}
+
+/**
+ *\param g водоём
+ *\param i строка
+ *\param j столбец
+ *\return true, если клетка живая
+*/
+bool tiledGet(const tiledGrid& g, int64_t i, int64_t j)
+{
+	const uint64_t* t = tilePtr(g, g.cur, i / TILE_SIZE, j / TILE_SIZE);
+	int r = (int)(i % TILE_SIZE), c = (int)(j % TILE_SIZE);
+	return (t[r * TILE_WORDS + (c >> 6)] >> (c & 63)) & 1;
+}
+
+/**
+ *\param g    водоём
+ *\param i    строка
+ *\param j    столбец
+ *\param live новое состояние клетки
+*/
+void tiledSet(tiledGrid& g, int64_t i, int64_t j, bool live)
+{
+	uint64_t* t = tilePtr(g, g.cur, i / TILE_SIZE, j / TILE_SIZE);
+	int r = (int)(i % TILE_SIZE), c = (int)(j % TILE_SIZE);
+	uint64_t bit = 1ull << (c & 63);
+	if (live)
+	{
+		t[r * TILE_WORDS + (c >> 6)] |= bit;
+	}
+	else
+	{
+		t[r * TILE_WORDS + (c >> 6)] &= ~bit;
+	}
+}
+
+/**
+ *\param g водоём
+ *\details Очистка текущего поколения
+*/
+void tiledClear(tiledGrid& g)
+{
+	memset(g.gen[g.cur], 0, (size_t)(g.tilesY * g.tilesX) * TILE_CELLS_WORDS * sizeof(uint64_t));
+}
+
+/**
+ *\param g       водоём
+ *\param density доля живых клеток (0..1)
+ *\param seed    начальное значение генератора
+ *\details Случайное заполнение. Вероятность задаётся 8 двоичными разрядами, и каждое слово
+ * получается из 8 случайных слов операциями И/ИЛИ, без обработки отдельных клеток.
+*/
+void tiledRandom(tiledGrid& g, double density, unsigned seed)
+{
+	unsigned p = (unsigned)(density * 256.0 + 0.5);
+	for (int64_t ty = 0; ty < g.tilesY; ty++)
+	{
+		for (int64_t tx = 0; tx < g.tilesX; tx++)
+		{
+			uint64_t s = ((uint64_t)seed << 40) ^ (uint64_t)(ty * g.tilesX + tx);
+			uint64_t* t = tilePtr(g, g.cur, ty, tx);
+			for (int r = 0; r < TILE_SIZE; r++)
+			{
+				bool rowIn = ty * TILE_SIZE + r < g.h;
+				for (int k = 0; k < TILE_WORDS; k++)
+				{
+					uint64_t x = randomWord(s, p);
+					t[r * TILE_WORDS + k] = rowIn ? x & colMask(g, tx, k) : 0;
+				}
+			}
+		}
+	}
+}
+
+/**
+ *\param g водоём
+ *\return количество живых клеток текущего поколения
+*/
+int64_t tiledPopulation(const tiledGrid& g)
+{
+	int64_t n = 0;
+	const uint64_t* p = g.gen[g.cur];
+	uint64_t words = (uint64_t)(g.tilesY * g.tilesX) * TILE_CELLS_WORDS;
+	for (uint64_t k = 0; k < words; k++)
+	{
+		uint64_t v = p[k];
+		while (v)
+		{
+			v &= v - 1;
+			n++;
+		}
+	}
+	return n;
+}
+
+/**
+ *\param g   водоём
+ *\param ty  строка плиток
+ *\param tx  столбец плиток
+ *\param out плитка следующего поколения
+ *\return true, если плитка не изменилась
+ *\details Вычисление плитки с окаймлением в одну клетку. Окаймление собирается из граничных
+ * строк и столбцов восьми соседних плиток, клетки за границей водоёма считаются мёртвыми.
+ * Соседи считаются побитовыми сумматорами сразу для 64 клеток.
+*/
+static bool stepTile(const tiledGrid& g, int64_t ty, int64_t tx, uint64_t* out)
+{
+	const uint64_t* nb[3][3];
+	for (int dy = 0; dy < 3; dy++)
+	{
+		for (int dx = 0; dx < 3; dx++)
+		{
+			nb[dy][dx] = tilePtr(g, g.cur, ty + dy - 1, tx + dx - 1);
+		}
+	}
+	/**строки -1..TILE_SIZE и биты столбцов -1 и TILE_SIZE*/
+	uint64_t ext[TILE_SIZE + 2][TILE_WORDS];
+	uint64_t left[TILE_SIZE + 2], right[TILE_SIZE + 2];
+	uint64_t any = 0;
+	for (int r = 0; r < TILE_SIZE + 2; r++)
+	{
+		int dy = r == 0 ? 0 : (r == TILE_SIZE + 1 ? 2 : 1);
+		int rr = r == 0 ? TILE_SIZE - 1 : (r == TILE_SIZE + 1 ? 0 : r - 1);
+		const uint64_t* row = nb[dy][1] ? nb[dy][1] + rr * TILE_WORDS : nullptr;
+		for (int k = 0; k < TILE_WORDS; k++)
+		{
+			ext[r][k] = row ? row[k] : 0;
+			any |= ext[r][k];
+		}
+		left[r] = nb[dy][0] ? nb[dy][0][rr * TILE_WORDS + TILE_WORDS - 1] >> 63 : 0;
+		right[r] = nb[dy][2] ? nb[dy][2][rr * TILE_WORDS] & 1 : 0;
+		any |= left[r] | right[r];
+	}
+	/**пустая плитка с пустым окаймлением остаётся пустой*/
+	if (any == 0)
+	{
+		memset(out, 0, TILE_CELLS_WORDS * sizeof(uint64_t));
+		return true;
+	}
+	uint64_t mask[TILE_WORDS];
+	for (int k = 0; k < TILE_WORDS; k++)
+	{
+		mask[k] = colMask(g, tx, k);
+	}
+	bool same = true;
+	for (int r = 0; r < TILE_SIZE; r++)
+	{
+		if (ty * TILE_SIZE + r >= g.h)
+		{
+			memset(out + r * TILE_WORDS, 0, TILE_WORDS * sizeof(uint64_t));
+			continue;
+		}
+		for (int k = 0; k < TILE_WORDS; k++)
+		{
+			uint64_t sh[3][3];
+			for (int t = 0; t < 3; t++)
+			{
+				const uint64_t* row = ext[r + t];
+				uint64_t a = row[k];
+				uint64_t prev = k > 0 ? row[k - 1] >> 63 : left[r + t];
+				uint64_t next = k + 1 < TILE_WORDS ? row[k + 1] & 1 : right[r + t];
+				sh[t][0] = (a << 1) | prev;
+				sh[t][1] = a;
+				sh[t][2] = (a >> 1) | (next << 63);
+			}
+			uint64_t v = lifeWord(sh) & mask[k];
+			if (v != sh[1][1])
+			{
+				same = false;
+			}
+			out[r * TILE_WORDS + k] = v;
+		}
+	}
+	return same;
+}
+
+/**
+ *\param g  водоём
+ *\param i  строка
+ *\param tx столбец плиток
+ *\return TILE_WORDS слов строки i в плитке столбца tx текущего поколения
+*/
+uint64_t* tiledRow(tiledGrid& g, int64_t i, int64_t tx)
+{
+	return tilePtr(g, g.cur, i / TILE_SIZE, tx) + (i % TILE_SIZE) * TILE_WORDS;
+}
+
+/**
+ *\param g       водоём
+ *\param c       незавершённое поколение; после завершения начинается заново
+ *\param seconds наибольшее время вычисления (0 и меньше - до конца поколения)
+ *\param isOpt   флаг остановки цикла жизни, если поколение завершено
+ *\return true, если поколение завершено и стало текущим
+ *\details Вычисление части следующего поколения. Плитки обходятся по строкам в порядке
+ * расположения в файле; перед обработкой строки плиток система заранее читает следующую.
+ * Результат записывается во вторую половину файла, а половины меняются ролями только после
+ * последней плитки, поэтому до завершения поколения водоём читается и выводится целиком
+ * в прежнем поколении. Время проверяется после каждой плитки.
+*/
+bool nextGenerationTiledSlice(tiledGrid& g, tiledCursor& c, double seconds, bool& isOpt)
+{
+	PROFILE_SCOPE("nextGenerationTiled");
+	auto deadline = chrono::steady_clock::now() + chrono::duration<double>(seconds);
+	int next = 1 - g.cur;
+	uint64_t rowBytes = (uint64_t)g.tilesX * TILE_CELLS_WORDS * sizeof(uint64_t);
+	for (int64_t end = g.tilesY * g.tilesX; c.tile < end; c.tile++)
+	{
+		int64_t ty = c.tile / g.tilesX, tx = c.tile % g.tilesX;
+		if (tx == 0 && ty + 1 < g.tilesY)
+		{
+			prefetch(tilePtr(g, g.cur, ty + 1, 0), rowBytes);
+		}
+		if (!stepTile(g, ty, tx, tilePtr(g, next, ty, tx)))
+		{
+			c.changed = true;
+		}
+		if (seconds > 0 && c.tile + 1 < end && chrono::steady_clock::now() >= deadline)
+		{
+			c.tile++;
+			return false;
+		}
+	}
+	isOpt = !c.changed;
+	c = tiledCursor();
+	g.cur = next;
+	((tiledHeader*)g.base)->cur = next;
+	return true;
+}
+
+/**
+ *\param g водоём
+ *\return isOpt флаг остановки цикла жизни
+ *\details Генерирование следующего поколения целиком
+*/
+bool nextGenerationTiled(tiledGrid& g)
+{
+	tiledCursor c;
+	bool isOpt = true;
+	nextGenerationTiledSlice(g, c, 0, isOpt);
+	return isOpt;
+}
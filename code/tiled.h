@@ -0,0 +1,62 @@
+﻿/**
+ *\file tiled.h
+ *\version 1.0
+ *\date October 2026
+ *\details Водоём, не помещающийся в оперативную память. Клетки хранятся по одному биту
+ * в плитках TILE_SIZE x TILE_SIZE, плитки лежат в файле, отображённом в память.
+ * Файл содержит два поколения: текущее и следующее.
+ */
+
+#pragma once
+
+#include <cstdint>
+
+/**Размер стороны плитки в клетках*/
+#define TILE_SIZE 256
+/**Количество 64-битных слов в строке плитки*/
+#define TILE_WORDS (TILE_SIZE / 64)
+
+/**
+ *\struct tiledGrid
+ *\details Водоём из плиток в отображённом в память файле
+*/
+struct tiledGrid
+{
+	/**количество строк и столбцов водоёма*/
+	int64_t h, w;
+	/**количество плиток по вертикали и горизонтали*/
+	int64_t tilesY, tilesX;
+	/**номер текущего поколения в файле (0 или 1)*/
+	int cur;
+	/**начало плиток каждого из двух поколений*/
+	uint64_t* gen[2];
+	/**начало и размер отображения файла*/
+	unsigned char* base;
+	uint64_t size;
+	/**окно строк плиток, учитываемое как память водоёма (MEM_GRID)*/
+	uint64_t resident;
+	/**дескрипторы файла и отображения*/
+	intptr_t file, mapping;
+};
+
+/**
+ *\struct tiledCursor
+ *\details Незавершённое поколение: номер следующей плитки (по строкам плиток) и признак
+ * изменения уже вычисленных плиток
+*/
+struct tiledCursor
+{
+	int64_t tile = 0;
+	bool changed = false;
+};
+
+bool tiledOpen(tiledGrid& g, const char* path, int64_t h, int64_t w);
+void tiledClose(tiledGrid& g);
+bool tiledGet(const tiledGrid& g, int64_t i, int64_t j);
+void tiledSet(tiledGrid& g, int64_t i, int64_t j, bool live);
+void tiledClear(tiledGrid& g);
+void tiledRandom(tiledGrid& g, double density, unsigned seed);
+int64_t tiledPopulation(const tiledGrid& g);
+uint64_t* tiledRow(tiledGrid& g, int64_t i, int64_t tx);
+bool nextGenerationTiled(tiledGrid& g);
+bool nextGenerationTiledSlice(tiledGrid& g, tiledCursor& c, double seconds, bool& isOpt);
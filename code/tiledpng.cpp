@@ -0,0 +1,141 @@
+﻿/**
+ *\file tiledpng.cpp
+ *\version 1.0
+ *\date October 2026
+ *\details Построение и параллельное сжатие полос изображения водоёма из плиток
+ */
+
+#include "tiledpng.h"
+#include "profile.h"
+
+#include <algorithm>
+#include <array>
+#include <cstdio>
+#include <vector>
+
+using namespace std;
+
+/**
+ *\param g   водоём
+ *\param s   внешний вид клеток
+ *\param depth бит на точку
+ *\param i   строка клеток
+ *\param y   строка точек внутри клетки
+ *\param states состояния клеток строки (буфер на g.w клеток)
+ *\param px     номера цветов строки точек (буфер)
+ *\param out    упакованная строка PNG
+ *\details Строка точек. Если клетка - одна точка глубиной 1 бит, байты строки получаются
+ * прямо из слов плиток: в слове левая клетка - младший бит, в PNG - старший, поэтому биты
+ * каждого байта переставляются в обратном порядке.
+*/
+static void pngRow(tiledGrid& g, const cellStyle& s, int depth, int64_t i, int y, vector<uint8_t>& states, vector<uint8_t>& px, uint8_t* out)
+{
+	static const array<uint8_t, 256> rev = []
+	{
+		array<uint8_t, 256> t;
+		for (int b = 0; b < 256; b++)
+		{
+			int r = 0;
+			for (int k = 0; k < 8; k++)
+			{
+				r |= ((b >> k) & 1) << (7 - k);
+			}
+			t[b] = (uint8_t)r;
+		}
+		return t;
+	}();
+	if (s.cell == 1 && depth == 1)
+	{
+		/**образцы состояний - точки цветов 0 и 1 в каком-то порядке*/
+		uint8_t invert = s.tile[1] == 0 ? 0xff : 0;
+		int64_t bytes = (g.w + 7) / 8;
+		for (int64_t tx = 0; tx < g.tilesX; tx++)
+		{
+			const uint8_t* row = (const uint8_t*)tiledRow(g, i, tx);
+			int64_t b0 = tx * TILE_SIZE / 8, n = min<int64_t>(TILE_SIZE / 8, bytes - b0);
+			for (int64_t k = 0; k < n; k++)
+			{
+				out[b0 + k] = rev[row[k]] ^ invert;
+			}
+		}
+		return;
+	}
+	for (int64_t tx = 0; tx < g.tilesX; tx++)
+	{
+		const uint64_t* row = tiledRow(g, i, tx);
+		int64_t j0 = tx * TILE_SIZE, n = min<int64_t>(TILE_SIZE, g.w - j0);
+		for (int64_t j = 0; j < n; j++)
+		{
+			states[j0 + j] = (uint8_t)((row[j / 64] >> (j % 64)) & 1);
+		}
+	}
+	styleRow(s, states.data(), g.w, y, px.data());
+	pngPack(px.data(), g.w * s.cell, depth, out);
+}
+
+/**
+ *\param g      водоём из плиток
+ *\param path   файл PNG
+ *\param s      внешний вид клеток (два состояния)
+ *\param pool   пул потоков
+ *\param budget память под полосы одной пачки в байтах
+ *\return true, если файл записан
+ *\details Полоса - несколько строк клеток; пачка - по две полосы на поток. Высота полосы
+ * выбирается так, чтобы несжатые и сжатые полосы пачки уложились в budget. Полосы пачки
+ * строятся и сжимаются в пуле, затем записываются по порядку, и строится следующая пачка.
+*/
+bool tiledPng(tiledGrid& g, const char* path, const cellStyle& s, workPool& pool, size_t budget)
+{
+	PROFILE_SCOPE("tiledPng");
+	int64_t pw = g.w * s.cell, ph = g.h * s.cell;
+	/**размеры изображения PNG - 31-битные*/
+	if (pw > 0x7fffffff || ph > 0x7fffffff)
+	{
+		return false;
+	}
+	int depth = pngDepth(s.colors);
+	size_t rowBytes = 1 + (size_t)(pw * depth + 7) / 8;
+	int64_t batch = (int64_t)pool.size() * 2;
+	/**на полосу - несжатые строки и не больше стольких же сжатых байтов*/
+	int64_t rows = max<int64_t>(1, (int64_t)(budget / ((size_t)batch * 2 * rowBytes * s.cell)));
+	int64_t strips = (g.h + rows - 1) / rows;
+	FILE* f = fopen(path, "wb");
+	if (f == nullptr)
+	{
+		return false;
+	}
+	bool ok = pngBegin(f, pw, ph, depth, s);
+	uint32_t adler = 1;
+	vector<pngStrip> out((size_t)batch);
+	for (int64_t first = 0; first < strips && ok; first += batch)
+	{
+		int64_t n = min(batch, strips - first);
+		parallelFor(pool, n, 1, [&](int64_t lo, int64_t hi)
+		{
+			vector<uint8_t> raw, states((size_t)g.w), px((size_t)pw);
+			for (int64_t k = lo; k < hi; k++)
+			{
+				int64_t i0 = (first + k) * rows, i1 = min(g.h, i0 + rows);
+				raw.resize((size_t)(i1 - i0) * s.cell * rowBytes);
+				uint8_t* p = raw.data();
+				for (int64_t i = i0; i < i1; i++)
+				{
+					for (int y = 0; y < s.cell; y++)
+					{
+						/**байт фильтра 0 (без фильтра)*/
+						*p = 0;
+						pngRow(g, s, depth, i, y, states, px, p + 1);
+						p += rowBytes;
+					}
+				}
+				pngDeflate(raw.data(), raw.size(), first + k == strips - 1, out[(size_t)k]);
+			}
+		});
+		for (int64_t k = 0; k < n && ok; k++)
+		{
+			ok = pngPut(f, out[(size_t)k], adler);
+		}
+	}
+	ok = ok && pngEnd(f, adler);
+	return fclose(f) == 0 && ok;
+}
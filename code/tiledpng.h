@@ -0,0 +1,22 @@
+﻿/**
+ *\file tiledpng.h
+ *\version 1.0
+ *\date October 2026
+ *\details Вывод водоёма из плиток в PNG в полном размере. Изображение строится и сжимается
+ * полосами строк: несколько полос сжимаются параллельно, затем записываются в файл по порядку
+ * отдельными блоками IDAT. В памяти одновременно находятся только полосы одной пачки,
+ * поэтому водоём 64k x 64k выводится в пределах заданного объёма памяти.
+ */
+
+#pragma once
+
+#include "image.h"
+#include "pool.h"
+#include "tiled.h"
+
+#include <cstddef>
+
+/**Память под несжатые и сжатые полосы одной пачки по умолчанию*/
+#define PNG_BUDGET ((size_t)64 << 20)
+
+bool tiledPng(tiledGrid& g, const char* path, const cellStyle& s, workPool& pool, size_t budget);
@@ -0,0 +1,908 @@
+﻿/**
+ *\file viewer.cpp
+ *\version 1.0
+ *\date October 2026
+ *\details Сервер показа и зрители. Параметры задаются в виде ключ=значение:
+ * сервер: board=512x512 rule=B3/S23 density=0.3 seed=1 rate=30 gens=0 port=5600
+ * bind=127.0.0.1 unix=путь (rate - поколений в секунду, 0 - без ограничения; gens=0 - без конца;
+ * unix - локальный сокет вместо TCP);
+ * зритель: host=127.0.0.1 port=5600 unix=путь roi=строка,столбец,высота,ширина lod=1
+ * frames=100 slow=0 (slow - задержка в миллисекундах после каждого кадра).
+ */
+
+#include "viewer.h"
+#include "image.h"
+#include "options.h"
+#include "random.h"
+
+#include <cstdio>
+
+#ifdef _WIN32
+
+bool viewConnect(viewClient&, const std::string&, int, const std::string&)
+{
+	return false;
+}
+
+bool viewRegion(viewClient&, int64_t, int64_t, int64_t, int64_t, int)
+{
+	return false;
+}
+
+int viewReceive(viewClient&, int)
+{
+	return -1;
+}
+
+void viewClose(viewClient&)
+{
+}
+
+int viewServe(int, char*[])
+{
+	printf("viewer server is not supported on Windows\n");
+	return 1;
+}
+
+int viewWatch(int, char*[])
+{
+	printf("viewer server is not supported on Windows\n");
+	return 1;
+}
+
+#else
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdlib>
+#include <cstring>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+using namespace std;
+
+/**
+ *\struct viewHello
+ *\details Описание водоёма, которое сервер отправляет зрителю при подключении
+*/
+struct viewHello
+{
+	int64_t rows, cols;
+	int32_t states, bits;
+};
+
+/**
+ *\struct viewFrame
+ *\details Заголовок кадра; за ним следуют bytes байт изменений
+*/
+struct viewFrame
+{
+	/**поколение и количество живых клеток всего водоёма*/
+	uint64_t generation;
+	int64_t population;
+	/**видимая часть кадра, приведённая к границам водоёма*/
+	viewRequest area;
+	/**размеры картины в клетках показа*/
+	int32_t h, w;
+	/**VIEW_KEY или VIEW_DELTA, длина изменений и контрольная сумма картины (adler32)*/
+	int32_t kind;
+	uint32_t bytes, check;
+	int32_t pad;
+	/**поколения, пропущенные зрителем с предыдущего кадра*/
+	uint64_t skipped;
+};
+
+/**
+ *\param fd  сокет
+ *\param p   данные
+ *\param len длина
+ *\return true, если все данные отправлены
+*/
+static bool sendAll(int fd, const void* p, size_t len)
+{
+	const char* c = (const char*)p;
+	while (len > 0)
+	{
+		ssize_t n = send(fd, c, len, MSG_NOSIGNAL);
+		if (n <= 0)
+		{
+			return false;
+		}
+		c += n;
+		len -= (size_t)n;
+	}
+	return true;
+}
+
+/**
+ *\param fd  сокет
+ *\param p   буфер
+ *\param len длина
+ *\return true, если все данные получены
+*/
+static bool recvAll(int fd, void* p, size_t len)
+{
+	char* c = (char*)p;
+	while (len > 0)
+	{
+		ssize_t n = recv(fd, c, len, 0);
+		if (n <= 0)
+		{
+			return false;
+		}
+		c += n;
+		len -= (size_t)n;
+	}
+	return true;
+}
+
+/**
+ *\param q    запрошенная видимая часть
+ *\param rows количество строк водоёма
+ *\param cols количество столбцов водоёма
+ *\return видимая часть внутри водоёма; h, w <= 0 - до края водоёма
+*/
+static viewRequest viewClamp(viewRequest q, int64_t rows, int64_t cols)
+{
+	q.lod = max(1, min(q.lod, 1 << 16));
+	q.applied = 0;
+	q.i0 = max<int64_t>(0, min(q.i0, rows - 1));
+	q.j0 = max<int64_t>(0, min(q.j0, cols - 1));
+	q.h = q.h <= 0 ? rows - q.i0 : min(q.h, rows - q.i0);
+	q.w = q.w <= 0 ? cols - q.j0 : min(q.w, cols - q.j0);
+	q.h = min<int64_t>(q.h, (int64_t)VIEW_MAX * q.lod);
+	q.w = min<int64_t>(q.w, (int64_t)VIEW_MAX * q.lod);
+	return q;
+}
+
+/**
+ *\param g водоём
+ *\param q видимая часть внутри водоёма
+ *\param v картина
+ *\details Клетка показа - наименьшее ненулевое состояние своего квадрата lod x lod, поэтому
+ * живая бактерия видна и среди угасающих. При lod = 1 строки картины собираются сдвигом слов.
+*/
+static void viewBuild(const planeGrid& g, const viewRequest& q, planeGrid& v)
+{
+	int vh = (int)((q.h + q.lod - 1) / q.lod), vw = (int)((q.w + q.lod - 1) / q.lod);
+	if (v.h != vh || v.w != vw || v.bits != g.bits)
+	{
+		planeInit(v, vh, vw, g.bits);
+	}
+	if (q.lod == 1)
+	{
+		int s = (int)(q.j0 & 63), src0 = (int)(q.j0 >> 6), srcWords = g.words - src0;
+		uint64_t tail = vw & 63 ? (1ull << (vw & 63)) - 1 : ~0ull;
+		for (int b = 0; b < g.bits; b++)
+		{
+			for (int i = 0; i < vh; i++)
+			{
+				const uint64_t* src = &g.plane[b][(size_t)(q.i0 + i) * g.words + src0];
+				uint64_t* dst = &v.plane[b][(size_t)i * v.words];
+				for (int k = 0; k < v.words; k++)
+				{
+					uint64_t lo = k < srcWords ? src[k] : 0, hi = k + 1 < srcWords ? src[k + 1] : 0;
+					dst[k] = s ? (lo >> s) | (hi << (64 - s)) : lo;
+				}
+				dst[v.words - 1] &= tail;
+			}
+		}
+		return;
+	}
+	planeClear(v);
+	for (int i = 0; i < vh; i++)
+	{
+		int64_t r1 = min<int64_t>(q.i0 + (int64_t)(i + 1) * q.lod, q.i0 + q.h);
+		for (int j = 0; j < vw; j++)
+		{
+			int64_t c1 = min<int64_t>(q.j0 + (int64_t)(j + 1) * q.lod, q.j0 + q.w);
+			int best = 0;
+			for (int64_t a = q.i0 + (int64_t)i * q.lod; a < r1 && best != 1; a++)
+			{
+				for (int64_t c = q.j0 + (int64_t)j * q.lod; c < c1 && best != 1; c++)
+				{
+					int st = planeGet(g, (int)a, (int)c);
+					if (st != 0 && (best == 0 || st < best))
+					{
+						best = st;
+					}
+				}
+			}
+			if (best != 0)
+			{
+				planeSet(v, i, j, best);
+			}
+		}
+	}
+}
+
+/**
+ *\param v картина
+ *\return контрольная сумма слов всех плоскостей картины
+*/
+static uint32_t viewCheck(const planeGrid& v)
+{
+	uint32_t a = 1;
+	for (int b = 0; b < v.bits; b++)
+	{
+		a = adler32(a, (const uint8_t*)v.plane[b].data(), v.plane[b].size() * sizeof(uint64_t));
+	}
+	return a;
+}
+
+/**
+ *\param out буфер
+ *\param x   число
+ *\details Число записывается по 7 бит, старший бит байта - признак продолжения
+*/
+static void putVarint(vector<uint8_t>& out, uint64_t x)
+{
+	while (x >= 128)
+	{
+		out.push_back((uint8_t)(x | 128));
+		x >>= 7;
+	}
+	out.push_back((uint8_t)x);
+}
+
+/**
+ *\param p   чтение (сдвигается за число)
+ *\param end конец данных
+ *\param x   число
+ *\return true, если число прочитано
+*/
+static bool getVarint(const uint8_t*& p, const uint8_t* end, uint64_t& x)
+{
+	x = 0;
+	for (int s = 0; s < 64; s += 7)
+	{
+		if (p == end)
+		{
+			return false;
+		}
+		uint8_t c = *p++;
+		x |= (uint64_t)(c & 127) << s;
+		if (c < 128)
+		{
+			return true;
+		}
+	}
+	return false;
+}
+
+/**
+ *\param v    картина
+ *\param base предыдущая картина зрителя того же размера (nullptr - ключевой кадр)
+ *\param out  изменения
+ *\details Изменения - побайтовая разность картин, плоскости идут подряд. Разность записывается
+ * парами "пропуск, количество": skip нулевых байт пропускаются, затем следуют count байт
+ * (короткие промежутки нулей внутри них не разрывают запись).
+ * Ключевой кадр - разность с пустой картиной, поэтому редкое заселение сжимается и в нём.
+*/
+static void viewEncode(const planeGrid& v, const planeGrid* base, vector<uint8_t>& out)
+{
+	out.clear();
+	size_t n = (size_t)v.h * v.words * sizeof(uint64_t), total = n * v.bits, t = 0;
+	auto byte = [&](size_t k)
+	{
+		uint8_t x = ((const uint8_t*)v.plane[k / n].data())[k % n];
+		return base ? (uint8_t)(x ^ ((const uint8_t*)base->plane[k / n].data())[k % n]) : x;
+	};
+	while (t < total)
+	{
+		size_t s = t;
+		while (s < total && byte(s) == 0)
+		{
+			s++;
+		}
+		if (s == total)
+		{
+			break;
+		}
+		/**запись продолжается, пока нули идут не больше трёх байт подряд*/
+		size_t last = s;
+		for (size_t e = s + 1; e < total && e - last <= 3; e++)
+		{
+			if (byte(e) != 0)
+			{
+				last = e;
+			}
+		}
+		putVarint(out, s - t);
+		putVarint(out, last + 1 - s);
+		for (size_t k = s; k <= last; k++)
+		{
+			out.push_back(byte(k));
+		}
+		t = last + 1;
+	}
+}
+
+/**
+ *\param v   картина зрителя
+ *\param p   изменения
+ *\param len длина изменений
+ *\return true, если изменения применены целиком
+*/
+static bool viewDecode(planeGrid& v, const uint8_t* p, size_t len)
+{
+	const uint8_t* end = p + len;
+	size_t n = (size_t)v.h * v.words * sizeof(uint64_t), total = n * v.bits, t = 0;
+	while (p < end)
+	{
+		uint64_t skip, count;
+		if (!getVarint(p, end, skip) || !getVarint(p, end, count) || skip > total - t || count > total - t - skip
+			|| (uint64_t)(end - p) < count)
+		{
+			return false;
+		}
+		t += skip;
+		for (uint64_t k = 0; k < count; k++, t++)
+		{
+			((uint8_t*)v.plane[t / n].data())[t % n] ^= *p++;
+		}
+	}
+	return true;
+}
+
+/**
+ *\param c        зритель
+ *\param host     адрес сервера
+ *\param port     порт сервера
+ *\param unixPath путь локального сокета (пусто - TCP)
+ *\return true, если соединение установлено
+ *\details После подключения сервер присылает картину всего водоёма (до VIEW_MAX клеток по стороне),
+ * другую видимую часть можно запросить viewRegion.
+*/
+bool viewConnect(viewClient& c, const string& host, int port, const string& unixPath)
+{
+	if (!unixPath.empty())
+	{
+		sockaddr_un a;
+		memset(&a, 0, sizeof(a));
+		a.sun_family = AF_UNIX;
+		strncpy(a.sun_path, unixPath.c_str(), sizeof(a.sun_path) - 1);
+		c.fd = socket(AF_UNIX, SOCK_STREAM, 0);
+		if (connect(c.fd, (sockaddr*)&a, sizeof(a)) != 0)
+		{
+			viewClose(c);
+			return false;
+		}
+	}
+	else
+	{
+		sockaddr_in a;
+		memset(&a, 0, sizeof(a));
+		a.sin_family = AF_INET;
+		a.sin_addr.s_addr = inet_addr(host.c_str());
+		a.sin_port = htons((uint16_t)port);
+		c.fd = socket(AF_INET, SOCK_STREAM, 0);
+		if (connect(c.fd, (sockaddr*)&a, sizeof(a)) != 0)
+		{
+			viewClose(c);
+			return false;
+		}
+		int one = 1;
+		setsockopt(c.fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+	}
+	viewHello h;
+	if (!recvAll(c.fd, &h, sizeof(h)))
+	{
+		viewClose(c);
+		return false;
+	}
+	c.rows = h.rows;
+	c.cols = h.cols;
+	c.states = h.states;
+	planeInit(c.view, 0, 0, h.bits);
+	memset(&c.req, 0, sizeof(c.req));
+	c.req.lod = 1;
+	c.area = viewClamp(c.req, c.rows, c.cols);
+	c.generation = c.frames = c.keys = c.skipped = c.bytes = c.bad = 0;
+	c.population = 0;
+	return true;
+}
+
+/**
+ *\param c   зритель
+ *\param i0  первая строка
+ *\param j0  первый столбец
+ *\param h   количество строк (0 - до края водоёма)
+ *\param w   количество столбцов (0 - до края водоёма)
+ *\param lod сторона квадрата клеток водоёма на клетку показа
+ *\return true, если запрос отправлен
+ *\details Сервер применяет запрос к следующему кадру и присылает его ключевым
+*/
+bool viewRegion(viewClient& c, int64_t i0, int64_t j0, int64_t h, int64_t w, int lod)
+{
+	c.req.i0 = i0;
+	c.req.j0 = j0;
+	c.req.h = h;
+	c.req.w = w;
+	c.req.lod = lod;
+	c.req.applied = (uint32_t)c.frames;
+	return c.fd >= 0 && sendAll(c.fd, &c.req, sizeof(c.req));
+}
+
+/**
+ *\param c         зритель
+ *\param timeoutMs наибольшее время ожидания кадра в миллисекундах
+ *\return 1 - кадр получен и применён, 0 - кадра нет, -1 - соединение потеряно
+*/
+int viewReceive(viewClient& c, int timeoutMs)
+{
+	if (c.fd < 0)
+	{
+		return -1;
+	}
+	pollfd p = {c.fd, POLLIN, 0};
+	int n = poll(&p, 1, timeoutMs);
+	if (n <= 0)
+	{
+		return n < 0 && errno != EINTR ? -1 : 0;
+	}
+	viewFrame f;
+	if (!recvAll(c.fd, &f, sizeof(f)))
+	{
+		return -1;
+	}
+	c.buf.resize(f.bytes);
+	if (!recvAll(c.fd, c.buf.data(), f.bytes))
+	{
+		return -1;
+	}
+	bool ok = true;
+	if (f.h != c.view.h || f.w != c.view.w)
+	{
+		/**изменения относятся к картине другого размера: ждём ключевой кадр*/
+		ok = f.kind == VIEW_KEY;
+		planeInit(c.view, f.h, f.w, c.view.bits);
+	}
+	else if (f.kind == VIEW_KEY)
+	{
+		planeClear(c.view);
+	}
+	ok = ok && viewDecode(c.view, c.buf.data(), c.buf.size()) && viewCheck(c.view) == f.check;
+	c.bad += !ok;
+	c.area = f.area;
+	c.generation = f.generation;
+	c.population = f.population;
+	c.frames++;
+	c.keys += f.kind == VIEW_KEY;
+	c.skipped += f.skipped;
+	c.bytes += sizeof(f) + f.bytes;
+	/**подтверждение кадра разрешает серверу отправить следующий*/
+	c.req.applied = (uint32_t)c.frames;
+	return sendAll(c.fd, &c.req, sizeof(c.req)) ? 1 : -1;
+}
+
+/**
+ *\param c зритель
+*/
+void viewClose(viewClient& c)
+{
+	if (c.fd >= 0)
+	{
+		close(c.fd);
+	}
+	c.fd = -1;
+}
+
+/**
+ *\struct viewSnapshot
+ *\details Вычисленное поколение, общее для всех зрителей
+*/
+struct viewSnapshot
+{
+	uint64_t generation;
+	int64_t population;
+	planeGrid g;
+};
+
+/**
+ *\struct viewPeer
+ *\details Подключённый зритель и поток, отправляющий ему кадры
+*/
+struct viewPeer
+{
+	int fd;
+	thread th;
+	atomic<bool> done{false};
+};
+
+/**
+ *\struct viewServer
+ *\details Последнее вычисленное поколение и зрители
+*/
+struct viewServer
+{
+	viewHello hello;
+	mutex m;
+	condition_variable cv;
+	/**последнее поколение; заменяется целиком, поэтому зрители читают его без блокировки*/
+	shared_ptr<const viewSnapshot> latest;
+	bool stop = false;
+	/**количество подключённых зрителей (без них поколения не публикуются)*/
+	atomic<int> viewers{0};
+	list<unique_ptr<viewPeer>> peers;
+};
+
+/**
+ *\param fd сокет зрителя
+ *\param q  последний запрос зрителя
+ *\return 1 - зритель запросил другую видимую часть, 0 - нет, -1 - зритель отключился
+*/
+static int readRequests(int fd, viewRequest& q)
+{
+	int got = 0;
+	while (true)
+	{
+		viewRequest r;
+		ssize_t n = recv(fd, &r, sizeof(r), MSG_PEEK | MSG_DONTWAIT);
+		if (n == 0 || (n < 0 && errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR))
+		{
+			return -1;
+		}
+		if (n < (ssize_t)sizeof(r))
+		{
+			return got;
+		}
+		if (!recvAll(fd, &r, sizeof(r)))
+		{
+			return -1;
+		}
+		got = got || memcmp(&r, &q, offsetof(viewRequest, applied)) != 0;
+		q = r;
+	}
+}
+
+/**
+ *\param s сервер
+ *\param p зритель
+ *\details Поток зрителя берёт последнее вычисленное поколение, строит по нему картину
+ * видимой части и отправляет её разность с прошлой картиной зрителя или ключевой кадр,
+ * если он короче. Отправка блокирует только этот поток: пока она идёт, вычисление
+ * продолжается, а поколения, вычисленные за это время, зритель пропускает.
+*/
+static void serveViewer(viewServer& s, viewPeer& p)
+{
+	viewRequest q, area;
+	memset(&q, 0, sizeof(q));
+	q.lod = 1;
+	memset(&area, 0, sizeof(area));
+	planeGrid shown, cur;
+	planeInit(shown, 0, 0, s.hello.bits);
+	planeInit(cur, 0, 0, s.hello.bits);
+	vector<uint8_t> delta, full;
+	uint64_t sent = 0;
+	uint32_t frames = 0;
+	bool any = false, key = true;
+	if (sendAll(p.fd, &s.hello, sizeof(s.hello)))
+	{
+		while (true)
+		{
+			/**зритель ещё не применил VIEW_WINDOW кадров: ждём подтверждения*/
+			if (frames - q.applied >= VIEW_WINDOW)
+			{
+				pollfd pf = {p.fd, POLLIN, 0};
+				poll(&pf, 1, 50);
+				{
+					lock_guard<mutex> lk(s.m);
+					if (s.stop)
+					{
+						break;
+					}
+				}
+				if (readRequests(p.fd, q) < 0)
+				{
+					break;
+				}
+				continue;
+			}
+			shared_ptr<const viewSnapshot> snap;
+			{
+				unique_lock<mutex> lk(s.m);
+				s.cv.wait_for(lk, chrono::milliseconds(50),
+					[&] { return s.stop || (s.latest && (!any || s.latest->generation != sent)); });
+				if (s.stop)
+				{
+					break;
+				}
+				snap = s.latest;
+			}
+			int r = readRequests(p.fd, q);
+			if (r < 0)
+			{
+				break;
+			}
+			if (!snap || (any && snap->generation == sent && r == 0))
+			{
+				continue;
+			}
+			viewRequest c = viewClamp(q, s.hello.rows, s.hello.cols);
+			key = key || memcmp(&c, &area, sizeof(c)) != 0;
+			area = c;
+			viewBuild(snap->g, area, cur);
+			viewEncode(cur, nullptr, full);
+			if (!key)
+			{
+				viewEncode(cur, &shown, delta);
+				key = full.size() <= delta.size();
+			}
+			vector<uint8_t>& out = key ? full : delta;
+			viewFrame f;
+			memset(&f, 0, sizeof(f));
+			f.generation = snap->generation;
+			f.population = snap->population;
+			f.area = area;
+			f.h = cur.h;
+			f.w = cur.w;
+			f.kind = key ? VIEW_KEY : VIEW_DELTA;
+			f.bytes = (uint32_t)out.size();
+			f.check = viewCheck(cur);
+			f.skipped = any && snap->generation > sent + 1 ? snap->generation - sent - 1 : 0;
+			if (!sendAll(p.fd, &f, sizeof(f)) || !sendAll(p.fd, out.data(), out.size()))
+			{
+				break;
+			}
+			swap(shown, cur);
+			frames++;
+			sent = snap->generation;
+			any = true;
+			key = false;
+		}
+	}
+	s.viewers--;
+	p.done = true;
+}
+
+/**
+ *\param s   сервер
+ *\param lfd слушающий сокет
+ *\details Приём зрителей; завершившиеся потоки зрителей собираются при следующем подключении
+*/
+static void acceptViewers(viewServer& s, int lfd)
+{
+	while (true)
+	{
+		pollfd pf = {lfd, POLLIN, 0};
+		int n = poll(&pf, 1, 100);
+		lock_guard<mutex> lk(s.m);
+		if (s.stop)
+		{
+			return;
+		}
+		if (n <= 0)
+		{
+			continue;
+		}
+		int fd = accept(lfd, NULL, NULL);
+		if (fd < 0)
+		{
+			continue;
+		}
+		int one = 1;
+		setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+		for (auto it = s.peers.begin(); it != s.peers.end();)
+		{
+			if ((*it)->done)
+			{
+				(*it)->th.join();
+				close((*it)->fd);
+				it = s.peers.erase(it);
+			}
+			else
+			{
+				++it;
+			}
+		}
+		s.peers.emplace_back(new viewPeer);
+		viewPeer& p = *s.peers.back();
+		p.fd = fd;
+		s.viewers++;
+		p.th = thread(serveViewer, ref(s), ref(p));
+	}
+}
+
+/**
+ *\param argc количество параметров
+ *\param argv параметры ключ=значение
+ *\return код завершения процесса
+ *\details Сервер: заполняет водоём случайно, вычисляет поколения с заданной скоростью и,
+ * пока подключён хотя бы один зритель, публикует каждое поколение. При temporal=k каждый шаг
+ * сервера - k поколений временными плитками (nextGenerationsBlocked), и публикуется каждое
+ * k-е поколение. Раз в секунду выводит номер поколения, скорость и количество зрителей.
+*/
+int viewServe(int argc, char* argv[])
+{
+	int rows = 512, cols = 512;
+	sscanf(option(argc, argv, "board", "512x512").c_str(), "%dx%d", &rows, &cols);
+	rule r;
+	if (rows < 1 || cols < 1 || !parseRule(option(argc, argv, "rule", "B3/S23"), r))
+	{
+		printf("bad board size or rule\n");
+		return 1;
+	}
+	double density = atof(option(argc, argv, "density", "0.3").c_str());
+	uint64_t seed = strtoull(option(argc, argv, "seed", "1").c_str(), NULL, 10);
+	double rate = atof(option(argc, argv, "rate", "30").c_str());
+	long long gens = atoll(option(argc, argv, "gens", "0").c_str());
+	int temporal = max(1, min(TEMPORAL_MAX, atoi(option(argc, argv, "temporal", "1").c_str())));
+	string unixPath = option(argc, argv, "unix", "");
+	int port = atoi(option(argc, argv, "port", to_string(VIEW_PORT).c_str()).c_str());
+	int lfd;
+	if (!unixPath.empty())
+	{
+		sockaddr_un a;
+		memset(&a, 0, sizeof(a));
+		a.sun_family = AF_UNIX;
+		strncpy(a.sun_path, unixPath.c_str(), sizeof(a.sun_path) - 1);
+		unlink(unixPath.c_str());
+		lfd = socket(AF_UNIX, SOCK_STREAM, 0);
+		if (bind(lfd, (sockaddr*)&a, sizeof(a)) != 0 || listen(lfd, 64) != 0)
+		{
+			close(lfd);
+			lfd = -1;
+		}
+	}
+	else
+	{
+		sockaddr_in a;
+		memset(&a, 0, sizeof(a));
+		a.sin_family = AF_INET;
+		a.sin_addr.s_addr = inet_addr(option(argc, argv, "bind", "127.0.0.1").c_str());
+		a.sin_port = htons((uint16_t)port);
+		lfd = socket(AF_INET, SOCK_STREAM, 0);
+		int one = 1;
+		setsockopt(lfd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+		if (bind(lfd, (sockaddr*)&a, sizeof(a)) != 0 || listen(lfd, 64) != 0)
+		{
+			close(lfd);
+			lfd = -1;
+		}
+	}
+	if (lfd < 0)
+	{
+		printf("cannot listen on %s\n", unixPath.empty() ? to_string(port).c_str() : unixPath.c_str());
+		return 1;
+	}
+	viewServer s;
+	s.hello.rows = rows;
+	s.hello.cols = cols;
+	s.hello.states = r.states;
+	s.hello.bits = planesFor(r.states);
+	planeGrid g, g1;
+	planeInit(g, rows, cols, s.hello.bits);
+	planeInit(g1, rows, cols, s.hello.bits);
+	/**начальное заполнение зависит только от seed и координат клетки*/
+	uint64_t threshold = (uint64_t)(density * 18446744073709551615.0);
+	for (int i = 0; i < rows; i++)
+	{
+		for (int j = 0; j < cols; j++)
+		{
+			uint64_t z = (uint64_t)i * cols + j + (seed << 40);
+			if (splitmix64(z) < threshold)
+			{
+				planeSet(g, i, j, 1);
+			}
+		}
+	}
+	printf("serving %dx%d %s on %s\n", cols, rows, r.name.c_str(),
+		unixPath.empty() ? ("port " + to_string(port)).c_str() : unixPath.c_str());
+	fflush(stdout);
+	thread acceptor(acceptViewers, ref(s), lfd);
+	auto t0 = chrono::steady_clock::now(), report = t0;
+	uint64_t generation = 0, reported = 0;
+	while (gens <= 0 || (long long)generation < gens)
+	{
+		if (s.viewers > 0)
+		{
+			shared_ptr<viewSnapshot> snap = make_shared<viewSnapshot>();
+			snap->generation = generation;
+			snap->population = planePopulation(g);
+			snap->g = g;
+			{
+				lock_guard<mutex> lk(s.m);
+				s.latest = snap;
+			}
+			s.cv.notify_all();
+		}
+		nextGenerationsBlocked(g, g1, r, temporal);
+		generation += temporal;
+		auto now = chrono::steady_clock::now();
+		if (rate > 0)
+		{
+			this_thread::sleep_until(t0 + chrono::duration_cast<chrono::steady_clock::duration>(chrono::duration<double>(generation / rate)));
+			now = chrono::steady_clock::now();
+		}
+		if (now - report >= chrono::seconds(1))
+		{
+			double sec = chrono::duration<double>(now - report).count();
+			printf("generation %llu, %.1f gens/s, %d viewers\n", (unsigned long long)generation,
+				(generation - reported) / sec, s.viewers.load());
+			fflush(stdout);
+			report = now;
+			reported = generation;
+		}
+	}
+	{
+		lock_guard<mutex> lk(s.m);
+		s.stop = true;
+	}
+	s.cv.notify_all();
+	acceptor.join();
+	close(lfd);
+	for (auto& p : s.peers)
+	{
+		shutdown(p->fd, SHUT_RDWR);
+		p->th.join();
+		close(p->fd);
+	}
+	if (!unixPath.empty())
+	{
+		unlink(unixPath.c_str());
+	}
+	printf("%llu generations\n", (unsigned long long)generation);
+	return 0;
+}
+
+/**
+ *\param argc количество параметров
+ *\param argv параметры ключ=значение
+ *\return код завершения процесса
+ *\details Зритель без окна: получает frames кадров (slow - задержка после каждого, чтобы
+ * проверить пропуск поколений медленным зрителем) и выводит итог: количество кадров,
+ * пропущенных поколений, принятых байт и кадров с неверной контрольной суммой.
+*/
+int viewWatch(int argc, char* argv[])
+{
+	viewClient c;
+	int port = atoi(option(argc, argv, "port", to_string(VIEW_PORT).c_str()).c_str());
+	if (!viewConnect(c, option(argc, argv, "host", "127.0.0.1"), port, option(argc, argv, "unix", "")))
+	{
+		printf("cannot connect to the viewer server\n");
+		return 1;
+	}
+	long long i0 = 0, j0 = 0, h = 0, w = 0;
+	sscanf(option(argc, argv, "roi", "0,0,0,0").c_str(), "%lld,%lld,%lld,%lld", &i0, &j0, &h, &w);
+	int lod = max(1, atoi(option(argc, argv, "lod", "1").c_str()));
+	if ((i0 || j0 || h || w || lod > 1) && !viewRegion(c, i0, j0, h, w, lod))
+	{
+		printf("connection lost\n");
+		return 1;
+	}
+	long long frames = atoll(option(argc, argv, "frames", "100").c_str());
+	int slow = atoi(option(argc, argv, "slow", "0").c_str());
+	auto t0 = chrono::steady_clock::now();
+	int got = 0;
+	while ((long long)c.frames < frames && (got = viewReceive(c, 1000)) >= 0)
+	{
+		if (got > 0 && slow > 0)
+		{
+			this_thread::sleep_for(chrono::milliseconds(slow));
+		}
+	}
+	double sec = chrono::duration<double>(chrono::steady_clock::now() - t0).count();
+	viewClose(c);
+	printf("%llu frames (%llu keyframes) in %.2f s, generation %llu, %llu generations skipped, view %dx%d lod %d, "
+		"%.1f KB (%.2f KB/frame), %llu bad frames\n", (unsigned long long)c.frames, (unsigned long long)c.keys, sec,
+		(unsigned long long)c.generation, (unsigned long long)c.skipped, c.view.w, c.view.h, c.area.lod,
+		c.bytes / 1024.0, c.frames ? c.bytes / 1024.0 / c.frames : 0.0, (unsigned long long)c.bad);
+	return c.bad == 0 && (long long)c.frames >= frames ? 0 : 1;
+}
+
+#endif
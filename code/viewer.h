@@ -0,0 +1,80 @@
+﻿/**
+ *\file viewer.h
+ *\version 1.0
+ *\date October 2026
+ *\details Показ одного вычисления на нескольких экранах. Сервер вычисляет поколения водоёма
+ * и рассылает зрителям через TCP или локальный сокет (Unix) изменения видимой части после
+ * каждого поколения, а когда изменения больше самой картины - ключевой кадр. Каждый зритель
+ * задаёт видимую часть водоёма и уровень детализации (сторону квадрата клеток водоёма,
+ * показываемого одной клеткой). Медленный зритель не задерживает вычисление: он получает
+ * последнее вычисленное поколение и пропускает промежуточные, а сервер отправляет ему
+ * не больше VIEW_WINDOW кадров вперёд, поэтому кадры не копятся в буферах сокета.
+ * Работает только в POSIX-системах.
+ */
+
+#pragma once
+
+#include "rules.h"
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/**Порт сервера по умолчанию*/
+#define VIEW_PORT 5600
+/**Наибольшая сторона видимой части в клетках показа*/
+#define VIEW_MAX 4096
+
+/**Наибольшее количество кадров, отправленных зрителю и ещё не применённых им*/
+#define VIEW_WINDOW 2
+
+/**Кадр с изменениями относительно предыдущего кадра зрителя*/
+#define VIEW_DELTA 0
+/**Ключевой кадр: картина целиком*/
+#define VIEW_KEY 1
+
+/**
+ *\struct viewRequest
+ *\details Видимая часть, которую зритель запрашивает у сервера: строки [i0, i0 + h),
+ * столбцы [j0, j0 + w), одна клетка показа на квадрат lod x lod клеток водоёма.
+ * Зритель повторяет запрос после каждого применённого кадра, сообщая их количество
+*/
+struct viewRequest
+{
+	int64_t i0, j0, h, w;
+	int32_t lod;
+	/**количество кадров, применённых зрителем*/
+	uint32_t applied;
+};
+
+/**
+ *\struct viewClient
+ *\details Зритель: соединение с сервером, запрошенная видимая часть и её копия
+*/
+struct viewClient
+{
+	int fd = -1;
+	/**размеры водоёма сервера и количество состояний клетки*/
+	int64_t rows = 0, cols = 0;
+	int states = 2;
+	/**запрошенная видимая часть (сервер приводит её к границам водоёма)*/
+	viewRequest req;
+	/**видимая часть последнего кадра, приведённая сервером к границам водоёма*/
+	viewRequest area;
+	/**видимая часть: одна клетка на квадрат lod x lod клеток водоёма*/
+	planeGrid view;
+	/**поколение и количество живых клеток всего водоёма в последнем кадре*/
+	uint64_t generation = 0;
+	int64_t population = 0;
+	/**получено кадров, из них ключевых, пропущено поколений, получено байт, кадров с неверной суммой*/
+	uint64_t frames = 0, keys = 0, skipped = 0, bytes = 0, bad = 0;
+	std::vector<uint8_t> buf;
+};
+
+bool viewConnect(viewClient& c, const std::string& host, int port, const std::string& unixPath);
+bool viewRegion(viewClient& c, int64_t i0, int64_t j0, int64_t h, int64_t w, int lod);
+int viewReceive(viewClient& c, int timeoutMs);
+void viewClose(viewClient& c);
+
+int viewServe(int argc, char* argv[]);
+int viewWatch(int argc, char* argv[]);